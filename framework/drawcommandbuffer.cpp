@@ -0,0 +1,189 @@
+#include "framework/drawcommandbuffer.h"
+#include "framework/image.h"
+#include "framework/logger.h"
+#include "framework/palette.h"
+
+namespace OpenApoc
+{
+
+DrawCommandBuffer::~DrawCommandBuffer() = default;
+
+void DrawCommandBuffer::setSurface(sp<Surface>)
+{
+	LogError("Surfaces cannot be bound to a command buffer");
+}
+
+sp<Surface> DrawCommandBuffer::getSurface()
+{
+	LogError("Surfaces cannot be bound to a command buffer");
+	return nullptr;
+}
+
+void DrawCommandBuffer::clear(Colour c)
+{
+	commands.emplace_back(CommandType::Clear);
+	commands.back().colour = c;
+}
+
+void DrawCommandBuffer::setPalette(sp<Palette> p)
+{
+	commands.emplace_back(CommandType::SetPalette);
+	commands.back().palette = p;
+	palette = p;
+}
+
+sp<Palette> DrawCommandBuffer::getPalette() { return palette; }
+
+void DrawCommandBuffer::draw(sp<Image> i, Vec2<float> position)
+{
+	commands.emplace_back(CommandType::Draw);
+	auto &cmd = commands.back();
+	cmd.image = i;
+	cmd.position = position;
+}
+
+void DrawCommandBuffer::drawRotated(sp<Image> i, Vec2<float> center, Vec2<float> position,
+                                    float angle)
+{
+	commands.emplace_back(CommandType::DrawRotated);
+	auto &cmd = commands.back();
+	cmd.image = i;
+	cmd.extent = center;
+	cmd.position = position;
+	cmd.value = angle;
+}
+
+void DrawCommandBuffer::drawScaled(sp<Image> i, Vec2<float> position, Vec2<float> size,
+                                   Scaler scaler)
+{
+	commands.emplace_back(CommandType::DrawScaled);
+	auto &cmd = commands.back();
+	cmd.image = i;
+	cmd.position = position;
+	cmd.extent = size;
+	cmd.scaler = scaler;
+}
+
+void DrawCommandBuffer::drawTinted(sp<Image> i, Vec2<float> position, Colour tint)
+{
+	commands.emplace_back(CommandType::DrawTinted);
+	auto &cmd = commands.back();
+	cmd.image = i;
+	cmd.position = position;
+	cmd.colour = tint;
+}
+
+void DrawCommandBuffer::drawFilledRect(Vec2<float> position, Vec2<float> size, Colour c)
+{
+	commands.emplace_back(CommandType::DrawFilledRect);
+	auto &cmd = commands.back();
+	cmd.position = position;
+	cmd.extent = size;
+	cmd.colour = c;
+}
+
+void DrawCommandBuffer::drawRect(Vec2<float> position, Vec2<float> size, Colour c,
+                                 float thickness)
+{
+	commands.emplace_back(CommandType::DrawRect);
+	auto &cmd = commands.back();
+	cmd.position = position;
+	cmd.extent = size;
+	cmd.colour = c;
+	cmd.value = thickness;
+}
+
+void DrawCommandBuffer::drawLine(Vec2<float> p1, Vec2<float> p2, Colour c, float thickness)
+{
+	commands.emplace_back(CommandType::DrawLine);
+	auto &cmd = commands.back();
+	cmd.position = p1;
+	cmd.extent = p2;
+	cmd.colour = c;
+	cmd.value = thickness;
+}
+
+void DrawCommandBuffer::flush() {}
+
+UString DrawCommandBuffer::getName() { return "DrawCommandBuffer"; }
+
+sp<Surface> DrawCommandBuffer::getDefaultSurface()
+{
+	LogError("A command buffer has no default surface");
+	return nullptr;
+}
+
+void DrawCommandBuffer::submit(Renderer &r) const
+{
+	for (auto &cmd : commands)
+	{
+		switch (cmd.type)
+		{
+			case CommandType::Clear:
+				r.clear(cmd.colour);
+				break;
+			case CommandType::SetPalette:
+				r.setPalette(cmd.palette);
+				break;
+			case CommandType::Draw:
+				r.draw(cmd.image, cmd.position);
+				break;
+			case CommandType::DrawRotated:
+				r.drawRotated(cmd.image, cmd.extent, cmd.position, cmd.value);
+				break;
+			case CommandType::DrawScaled:
+				r.drawScaled(cmd.image, cmd.position, cmd.extent, cmd.scaler);
+				break;
+			case CommandType::DrawTinted:
+				r.drawTinted(cmd.image, cmd.position, cmd.colour);
+				break;
+			case CommandType::DrawFilledRect:
+				r.drawFilledRect(cmd.position, cmd.extent, cmd.colour);
+				break;
+			case CommandType::DrawRect:
+				r.drawRect(cmd.position, cmd.extent, cmd.colour, cmd.value);
+				break;
+			case CommandType::DrawLine:
+				r.drawLine(cmd.position, cmd.extent, cmd.colour, cmd.value);
+				break;
+		}
+	}
+}
+
+void DrawCommandBuffer::reset() { commands.clear(); }
+
+sp<DrawCommandBuffer> DrawCommandSnapshot::beginFrame()
+{
+	sp<DrawCommandBuffer> frame;
+	{
+		std::lock_guard<std::mutex> l(mutex);
+		// Frames are only handed out from 'latest', so nobody else can get hold of the spare once
+		// whoever was still submitting it is done
+		if (spare && spare.use_count() == 1)
+		{
+			frame = std::move(spare);
+		}
+		spare = nullptr;
+	}
+	if (!frame)
+	{
+		frame = mksp<DrawCommandBuffer>();
+	}
+	frame->reset();
+	return frame;
+}
+
+void DrawCommandSnapshot::publish(sp<DrawCommandBuffer> frame)
+{
+	std::lock_guard<std::mutex> l(mutex);
+	spare = std::move(latest);
+	latest = std::move(frame);
+}
+
+sp<DrawCommandBuffer> DrawCommandSnapshot::get()
+{
+	std::lock_guard<std::mutex> l(mutex);
+	return latest;
+}
+
+} // namespace OpenApoc
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "framework/renderer.h"
+#include "library/colour.h"
+#include "library/sp.h"
+#include "library/vec.h"
+#include <mutex>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class Image;
+class Palette;
+class Surface;
+
+// A renderer that records draw calls instead of executing them, so that they can be generated off
+// the main thread and later submitted to the real renderer in order
+class DrawCommandBuffer : public Renderer
+{
+  private:
+	enum class CommandType
+	{
+		Clear,
+		SetPalette,
+		Draw,
+		DrawRotated,
+		DrawScaled,
+		DrawTinted,
+		DrawFilledRect,
+		DrawRect,
+		DrawLine,
+	};
+	class Command
+	{
+	  public:
+		CommandType type;
+		sp<Image> image;
+		sp<Palette> palette;
+		Vec2<float> position;
+		// Second point of a line, size of a rect or scaled image, or center of rotation
+		Vec2<float> extent;
+		float value = 0.0f;
+		Colour colour;
+		Scaler scaler = Scaler::Linear;
+
+		Command(CommandType type) : type(type) {}
+	};
+
+	std::vector<Command> commands;
+	sp<Palette> palette;
+
+	void setSurface(sp<Surface> s) override;
+	sp<Surface> getSurface() override;
+
+  public:
+	DrawCommandBuffer() = default;
+	~DrawCommandBuffer() override;
+
+	void clear(Colour c = Colour{0, 0, 0, 0}) override;
+	void setPalette(sp<Palette> p) override;
+	sp<Palette> getPalette() override;
+	void draw(sp<Image> i, Vec2<float> position) override;
+	void drawRotated(sp<Image> i, Vec2<float> center, Vec2<float> position, float angle) override;
+	void drawScaled(sp<Image> i, Vec2<float> position, Vec2<float> size,
+	                Scaler scaler = Scaler::Linear) override;
+	void drawTinted(sp<Image> i, Vec2<float> position, Colour tint) override;
+	void drawFilledRect(Vec2<float> position, Vec2<float> size, Colour c) override;
+	void drawRect(Vec2<float> position, Vec2<float> size, Colour c,
+	              float thickness = 1.0) override;
+	void drawLine(Vec2<float> p1, Vec2<float> p2, Colour c, float thickness = 1.0) override;
+	void flush() override;
+	UString getName() override;
+	sp<Surface> getDefaultSurface() override;
+
+	// Executes all recorded commands on the renderer, in the order they were recorded
+	void submit(Renderer &r) const;
+	// Drops all recorded commands, keeping the storage around for the next frame
+	void reset();
+	bool empty() const { return commands.empty(); }
+};
+
+// The latest frame recorded into a DrawCommandBuffer by one thread, for another thread to submit
+// while the next one is recorded
+class DrawCommandSnapshot
+{
+  private:
+	std::mutex mutex;
+	sp<DrawCommandBuffer> latest;
+	sp<DrawCommandBuffer> spare;
+
+  public:
+	// An empty buffer to record the next frame into
+	sp<DrawCommandBuffer> beginFrame();
+	// Makes 'frame' the latest frame
+	void publish(sp<DrawCommandBuffer> frame);
+	// The latest frame published, or nullptr if there is none yet
+	sp<DrawCommandBuffer> get();
+};
+
+} // namespace OpenApoc
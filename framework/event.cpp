@@ -26,6 +26,16 @@ UserEvent::UserEvent(const UString &id, sp<void> data) : Event(EVENT_USER)
 	Data.data = data;
 }
 
+up<Event> DisplayEvent::clone() const { return mkup<DisplayEvent>(*this); }
+up<Event> JoystickEvent::clone() const { return mkup<JoystickEvent>(*this); }
+up<Event> KeyboardEvent::clone() const { return mkup<KeyboardEvent>(*this); }
+up<Event> MouseEvent::clone() const { return mkup<MouseEvent>(*this); }
+up<Event> FingerEvent::clone() const { return mkup<FingerEvent>(*this); }
+up<Event> TimerEvent::clone() const { return mkup<TimerEvent>(*this); }
+up<Event> FormsEvent::clone() const { return mkup<FormsEvent>(*this); }
+up<Event> TextEvent::clone() const { return mkup<TextEvent>(*this); }
+up<Event> UserEvent::clone() const { return mkup<UserEvent>(*this); }
+
 EventTypes Event::type() const { return this->eventType; }
 
 // FIXME: Can do validation here that typeof(this) is expected?
@@ -162,6 +162,9 @@ class Event
 	const FrameworkTextEvent &text() const;
 	const FrameworkUserEvent &user() const;
 
+	// A copy of the event, for handling it later than it was raised
+	virtual up<Event> clone() const = 0;
+
 	virtual ~Event() = default;
 };
 
@@ -174,6 +177,7 @@ class DisplayEvent : public Event
   public:
 	DisplayEvent(EventTypes type);
 	~DisplayEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class JoystickEvent : public Event
@@ -185,6 +189,7 @@ class JoystickEvent : public Event
   public:
 	JoystickEvent(EventTypes type);
 	~JoystickEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class KeyboardEvent : public Event
@@ -196,6 +201,7 @@ class KeyboardEvent : public Event
   public:
 	KeyboardEvent(EventTypes type);
 	~KeyboardEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class MouseEvent : public Event
@@ -207,6 +213,7 @@ class MouseEvent : public Event
   public:
 	MouseEvent(EventTypes type);
 	~MouseEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class FingerEvent : public Event
@@ -218,6 +225,7 @@ class FingerEvent : public Event
   public:
 	FingerEvent(EventTypes type);
 	~FingerEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class TimerEvent : public Event
@@ -229,6 +237,7 @@ class TimerEvent : public Event
   public:
 	TimerEvent(EventTypes type);
 	~TimerEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class FormsEvent : public Event
@@ -240,6 +249,7 @@ class FormsEvent : public Event
   public:
 	FormsEvent();
 	~FormsEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class TextEvent : public Event
@@ -251,6 +261,7 @@ class TextEvent : public Event
   public:
 	TextEvent();
 	~TextEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class UserEvent : public Event
@@ -262,6 +273,7 @@ class UserEvent : public Event
   public:
 	UserEvent(const UString &id, sp<void> data = nullptr);
 	~UserEvent() override = default;
+	up<Event> clone() const override;
 };
 
 }; // namespace OpenApoc
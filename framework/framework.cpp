@@ -175,11 +175,12 @@ class FrameworkPrivate
 
 	sp<Surface> scaleSurface;
 	up<ThreadPool> threadPool;
+	int threadPoolSize;
 
 	FrameworkPrivate()
 	    : quitProgram(false), window(nullptr), context(0), displaySize(0, 0), windowSize(0, 0)
 	{
-		int threadPoolSize = threadPoolSizeOption.get();
+		threadPoolSize = threadPoolSizeOption.get();
 		if (threadPoolSize > 0)
 		{
 			LogInfo("Set thread pool size to %d", threadPoolSize);
@@ -1034,4 +1035,6 @@ UString Framework::textGetClipboard()
 
 void Framework::threadPoolTaskEnqueue(std::function<void()> task) { p->threadPool->enqueue(task); }
 
+int Framework::threadPoolGetSize() const { return p->threadPoolSize; }
+
 }; // namespace OpenApoc
@@ -85,6 +85,7 @@ class Framework
 	UString textGetClipboard();
 
 	void threadPoolTaskEnqueue(std::function<void()> task);
+	int threadPoolGetSize() const;
 	// add new work item to the pool
 	template <class F, class... Args>
 	auto threadPoolEnqueue(F &&f, Args &&... args)
@@ -17,8 +17,12 @@
 #include <cstring> // for std::memcmp
 #include <fstream>
 #include <inttypes.h>
+#include <list>
 #include <map>
+#include <mutex>
 #include <physfs.h>
+#include <utility>
+#include <vector>
 
 using namespace OpenApoc;
 
@@ -445,149 +449,214 @@ static_assert(sizeof(Sint32LsbMsb) == 8, "Unexpedted int16_lsb_msb_size!");
 static_assert(sizeof(DecDatetime) == 17, "Unexpected dec_datetime size!");
 static_assert(sizeof(DirDatetime) == 7, "Unexpected dir_datetime size!");
 
-class CueIO
+// Size of the user data in each block
+int32_t getBlockSize(CueTrackMode trackMode)
 {
-  private:
-	friend class CueArchiver;
+	// FIXME: Reality check?
+	switch (trackMode)
+	{
+		case CueTrackMode::MODE1_2048:
+		case CueTrackMode::MODE2_2048:
+		case CueTrackMode::MODE1_2352:
+		case CueTrackMode::MODE2_2352:
+		// Some docs say mode2 contains 2336 bytes of user data per block,
+		// others insist on 2048 bytes...
+		case CueTrackMode::MODE2_2336:
+			return 2048;
+		case CueTrackMode::MODE2_2324:
+			return 2324;
+		default:
+			LogError("Bad track mode!");
+	}
+	// Unsupported track mode
+	return -1;
+}
 
-	UString imageFile;  // For stream duplication
-	int32_t lbaStart;   // Starting LBA for this stream
-	int32_t lbaCurrent; // Current block for this stream
-	int32_t posInLba;   // Current position in lba
-	int64_t length;     // Allowed length of the stream
-	CueFileType fileType;
-	CueTrackMode trackMode;
-	std::ifstream fileStream;
+// Size of each block in the image
+int32_t getBinBlockSize(CueTrackMode trackMode)
+{
+	switch (trackMode)
+	{
+		case CueTrackMode::MODE1_2048:
+		case CueTrackMode::MODE2_2048:
+			return 2048;
+		case CueTrackMode::MODE1_2352:
+		case CueTrackMode::MODE2_2352:
+			return 2352;
+		case CueTrackMode::MODE2_2336:
+			return 2336;
+		case CueTrackMode::MODE2_2324:
+			return 2324;
+		default:
+			LogError("Bad track mode!");
+	}
+	// Unsupported track mode
+	return -1;
+}
 
-	CueIO(const UString &fileName, uint32_t lbaStart, int64_t length,
-	      CueFileType fileType = CueFileType::FT_BINARY,
-	      CueTrackMode trackMode = CueTrackMode::MODE1_2048)
-	    : imageFile(fileName), lbaStart(lbaStart), lbaCurrent(lbaStart), posInLba(0),
-	      length(length), fileType(fileType), trackMode(trackMode)
+// Offset of the user data portion of the block
+int32_t getBinDataOffset(CueTrackMode trackMode)
+{
+	switch (trackMode)
+	{
+		// FIXME: Check mode2 correctness??
+		case CueTrackMode::MODE1_2048:
+		case CueTrackMode::MODE2_2048:
+			return 0; // Only user data is present here
+		case CueTrackMode::MODE2_2324:
+			return 0;
+		case CueTrackMode::MODE1_2352:
+			return 12 + 4; // 12 bytes sync, 4 bytes header
+		case CueTrackMode::MODE2_2352:
+			return 12 + 4 + 8; // 12 bytes sync, 4 bytes header, 8 bytes subheader
+		case CueTrackMode::MODE2_2336:
+			return 8; // 8 bytes subheader (?)
+		default:
+			LogError("Bad track mode!");
+	}
+	// Unsupported track mode
+	return -1;
+}
+
+// Reads the user data out of the image a run of blocks at a time, and keeps the runs read last
+// around, so that reading a file doesn't seek and read the image for every block and reading the
+// same file again doesn't touch the image at all.
+// Shared by every stream opened on the image, which may read from different threads
+class CueBlockCache
+{
+  public:
+	// Blocks read at once, 64KiB of user data with 2048 byte blocks
+	static const uint32_t BLOCKS_PER_RUN = 32;
+	// Runs kept around, 4MiB of user data with 2048 byte blocks
+	static const size_t MAX_RUNS = 64;
+
+	CueBlockCache(const UString &fileName, CueTrackMode trackMode)
+	    : blockSize(getBlockSize(trackMode)), binBlockSize(getBinBlockSize(trackMode)),
+	      binDataOffset(getBinDataOffset(trackMode))
 	{
 		fileStream.open(fileName.str(), std::ios::in | std::ios::binary);
-		fileStream.seekg(lbaToByteOffset(lbaStart));
 	}
 
-	// Convert LBA to actual position in the stream
-	int64_t lbaToByteOffset(uint32_t lba)
+	bool isOpen() const { return fileStream.is_open(); }
+
+	// Copies 'len' bytes of user data, starting 'offset' bytes into block 'lba', to 'buf'.
+	// Returns the number of bytes copied, which is less if the image ends first
+	int64_t read(uint32_t lba, int64_t offset, char *buf, int64_t len)
 	{
-		switch (trackMode)
+		std::lock_guard<std::mutex> l(this->lock);
+		uint32_t runIndex = lba / BLOCKS_PER_RUN;
+		int64_t runOffset = (int64_t)(lba % BLOCKS_PER_RUN) * blockSize + offset;
+		int64_t totalRead = 0;
+		while (totalRead < len)
 		{
-			// Each block is 2048 bytes, translation is trivial
-			case CueTrackMode::MODE1_2048:
-			case CueTrackMode::MODE2_2048:
-				return lba * 2048;
-			// Each block is 2048 bytes, but there's a prefix and
-			// a postfix area for each sector
-			case CueTrackMode::MODE1_2352:
-				return lba * 2352 + 12 + 4; // 12 sync bytes, 4 header bytes
-			// FIXME: Reality check?
-			// For mode2, each block might be slightly larger than for mode1
-			// These cases are dealing with "cooked" data
-			case CueTrackMode::MODE2_2324:
-				return lba * 2324; // Each sector is 2324 bytes
-			// Strangely enough, mode2/2336 is the same as mode2/2352 without header?
-			case CueTrackMode::MODE2_2336:
-				return lba * 2336 + 8;
-			case CueTrackMode::MODE2_2352:
-				return lba * 2048 + 12 + 4 + 8;
-			default:
-				LogError("Unknown track mode set!");
-				// Return negative offset to indicate error
-				return -1;
+			auto &data = getRun(runIndex);
+			if (runOffset >= (int64_t)data.size())
+			{
+				break;
+			}
+			auto readSize = std::min(len - totalRead, (int64_t)data.size() - runOffset);
+			std::memcpy(buf + totalRead, data.data() + runOffset, readSize);
+			totalRead += readSize;
+			// Carry on from the start of the next run
+			runOffset = 0;
+			runIndex++;
 		}
+		return totalRead;
 	}
 
-	// Get the "user data" block size
-	int32_t blockSize()
+  private:
+	class Run
 	{
-		// FIXME: Reality check?
-		switch (trackMode)
+	  public:
+		std::vector<char> data;
+		std::list<uint32_t>::iterator lruPosition;
+	};
+
+	std::mutex lock;
+	std::ifstream fileStream;
+	int32_t blockSize;
+	int32_t binBlockSize;
+	int32_t binDataOffset;
+	std::map<uint32_t, Run> runs;
+	// Indices of the runs kept around, most recently used first
+	std::list<uint32_t> lru;
+	// Blocks as they are in the image, before the user data is taken out
+	std::vector<char> binBuffer;
+
+	const std::vector<char> &getRun(uint32_t runIndex)
+	{
+		auto it = runs.find(runIndex);
+		if (it != runs.end())
 		{
-			case CueTrackMode::MODE1_2048:
-			case CueTrackMode::MODE2_2048:
-			case CueTrackMode::MODE1_2352:
-			case CueTrackMode::MODE2_2352:
-			// Some docs say mode2 contains 2336 bytes of user data per block,
-			// others insist on 2048 bytes...
-			case CueTrackMode::MODE2_2336:
-				return 2048;
-			case CueTrackMode::MODE2_2324:
-				return 2324;
-			default:
-				LogError("Bad track mode!");
+			lru.splice(lru.begin(), lru, it->second.lruPosition);
+			return it->second.data;
 		}
-		// Unsupported track mode
-		return -1;
+		if (runs.size() >= MAX_RUNS)
+		{
+			runs.erase(lru.back());
+			lru.pop_back();
+		}
+		auto &run = runs[runIndex];
+		lru.push_front(runIndex);
+		run.lruPosition = lru.begin();
+		readRun(runIndex, run.data);
+		return run.data;
 	}
 
-	// Get the "binary" block size
-	int32_t binBlockSize()
+	void readRun(uint32_t runIndex, std::vector<char> &data)
 	{
-		switch (trackMode)
+		// Don't let reading past the end of the image last time stop this one
+		fileStream.clear();
+		fileStream.seekg((int64_t)runIndex * BLOCKS_PER_RUN * binBlockSize);
+		// Images with nothing but user data in them are read as they are
+		if (binBlockSize == blockSize)
 		{
-			case CueTrackMode::MODE1_2048:
-			case CueTrackMode::MODE2_2048:
-				return 2048;
-			case CueTrackMode::MODE1_2352:
-			case CueTrackMode::MODE2_2352:
-				return 2352;
-			case CueTrackMode::MODE2_2336:
-				return 2336;
-			case CueTrackMode::MODE2_2324:
-				return 2324;
-			default:
-				LogError("Bad track mode!");
+			data.resize(BLOCKS_PER_RUN * blockSize);
+			fileStream.read(data.data(), data.size());
+			data.resize(fileStream.gcount());
+			return;
+		}
+		binBuffer.resize(BLOCKS_PER_RUN * binBlockSize);
+		fileStream.read(binBuffer.data(), binBuffer.size());
+		auto blocks = fileStream.gcount() / binBlockSize;
+		data.resize(blocks * blockSize);
+		for (int64_t i = 0; i < blocks; i++)
+		{
+			auto blockData = binBuffer.data() + i * binBlockSize + binDataOffset;
+			std::memcpy(data.data() + i * blockSize, blockData, blockSize);
 		}
-		// Unsupported track mode
-		return -1;
 	}
+};
 
-	// Offset of the user data portion of the block
-	int32_t binDataOffset()
+class CueIO
+{
+  private:
+	friend class CueArchiver;
+
+	sp<CueBlockCache> cache; // Shared by every stream on the image
+	int32_t lbaStart;        // Starting LBA for this stream
+	int32_t lbaCurrent;      // Current block for this stream
+	int32_t posInLba;        // Current position in lba
+	int64_t length;          // Allowed length of the stream
+	CueFileType fileType;
+	CueTrackMode trackMode;
+
+	CueIO(sp<CueBlockCache> cache, uint32_t lbaStart, int64_t length,
+	      CueFileType fileType = CueFileType::FT_BINARY,
+	      CueTrackMode trackMode = CueTrackMode::MODE1_2048)
+	    : cache(cache), lbaStart(lbaStart), lbaCurrent(lbaStart), posInLba(0), length(length),
+	      fileType(fileType), trackMode(trackMode)
 	{
-		switch (trackMode)
-		{
-			// FIXME: Check mode2 correctness??
-			case CueTrackMode::MODE1_2048:
-			case CueTrackMode::MODE2_2048:
-				return 0; // Only user data is present here
-			case CueTrackMode::MODE2_2324:
-				return 0;
-			case CueTrackMode::MODE1_2352:
-				return 12 + 4; // 12 bytes sync, 4 bytes header
-			case CueTrackMode::MODE2_2352:
-				return 12 + 4 + 8; // 12 bytes sync, 4 bytes header, 8 bytes subheader
-			case CueTrackMode::MODE2_2336:
-				return 8; // 8 bytes subheader (?)
-			default:
-				LogError("Bad track mode!");
-		}
-		// Unsupported track mode
-		return -1;
 	}
 
+	// Get the "user data" block size
+	int32_t blockSize() { return getBlockSize(trackMode); }
+
 	int64_t read(void *buf, int64_t len)
 	{
 		// Ignore size 0 reads
 		if (!len)
 			return 0;
-		// Since we probably will have to read in parts,
-		// we have to make the buffer seekable
-		char *bufWrite = (char *)buf;
-#if 0 // FIXME: This code won't work, actually.
-        // If the data is "cooked", just read it.
-        if (trackMode == CUE_TrackMode::MODE1_2048 ||
-            trackMode == CUE_TrackMode::MODE2_2048)
-        {
-            // FIXME: This won't correctly handle multi-extent files
-            lbaCurrent += len / 2048;
-            int64_t start = fileStream.tellg();
-            fileStream.read(bufWrite, len);
-            return fileStream.tellg() - start;
-        }
-#endif
 		int64_t remainLength = length - (lbaCurrent - lbaStart) * blockSize() - posInLba;
 		if (remainLength < 0)
 		{
@@ -602,27 +671,13 @@ class CueIO
 			//           len, remainLength);
 			len = remainLength;
 		}
-		int64_t totalRead = 0;
-		do
+		int64_t totalRead = cache->read(lbaCurrent, posInLba, (char *)buf, len);
+		if (totalRead != len)
 		{
-			int64_t readSize = std::min(len - totalRead, int64_t(blockSize() - posInLba));
-			fileStream.read(bufWrite + totalRead, readSize);
-			totalRead += fileStream.gcount();
-			if (fileStream.gcount() != readSize)
-			{
-				LogWarning("Read buffer underrun! Wanted %" PRId64 " bytes, got %" PRId64, readSize,
-				           fileStream.gcount());
-				return totalRead;
-			}
-			posInLba += readSize;
-			if (posInLba >= blockSize())
-			{
-				posInLba = 0;
-				lbaCurrent += 1;
-				// fileStream.seekg(lbaToByteOffset(lbaCurrent), std::ios::beg);
-				seek((lbaCurrent - lbaStart) * blockSize());
-			}
-		} while (len > totalRead);
+			LogWarning("Read buffer underrun! Wanted %" PRId64 " bytes, got %" PRId64, len,
+			           totalRead);
+		}
+		seek(tell() + totalRead);
 		return totalRead;
 	}
 
@@ -638,9 +693,7 @@ class CueIO
 
 		lbaCurrent = lbaStart + blockOffset;
 		posInLba = posInBlock;
-		uint64_t binOffset = lbaToByteOffset(lbaCurrent) + posInLba;
-		fileStream.seekg(binOffset, std::ios::beg);
-		return fileStream.good();
+		return 1;
 	}
 
 	PHYSFS_sint64 tell()
@@ -649,16 +702,7 @@ class CueIO
 		return blockSize() * (lbaCurrent - lbaStart) + posInLba;
 	}
 
-	CueIO(const CueIO &other)
-	    : imageFile(other.imageFile), lbaStart(other.lbaStart), lbaCurrent(other.lbaCurrent),
-	      posInLba(other.posInLba), length(other.length), fileType(other.fileType),
-	      trackMode(other.trackMode)
-	{
-		fileStream.open(imageFile.str(), std::ios::in | std::ios::binary);
-		fileStream.seekg(lbaToByteOffset(lbaStart) + posInLba);
-	}
-
-	~CueIO() { fileStream.close(); }
+	CueIO(const CueIO &other) = default;
 
 	static PHYSFS_Io *createIo()
 	{
@@ -709,10 +753,10 @@ class CueIO
 	static PHYSFS_Io *cueIoDuplicate(PHYSFS_Io *io)
 	{
 		CueIO *cio = (CueIO *)io->opaque;
-		// Just go ahead and construct a new file stream
+		// The copy reads through the same cache
 		PHYSFS_Io *retval = createIo();
 		// Set the appropriate fields
-		io->opaque = new CueIO(*cio);
+		retval->opaque = new CueIO(*cio);
 		return retval;
 	}
 
@@ -729,15 +773,10 @@ class CueIO
 		delete io;
 	}
 
-	static PHYSFS_Io *getIo(UString fileName, uint32_t lba, int64_t length, CueFileType ftype,
-	                        CueTrackMode tmode)
+	static PHYSFS_Io *getIo(sp<CueBlockCache> cache, uint32_t lba, int64_t length,
+	                        CueFileType ftype, CueTrackMode tmode)
 	{
-		auto cio = new CueIO(fileName, lba, length, ftype, tmode);
-		if (!cio->fileStream)
-		{
-			delete cio;
-			return nullptr;
-		}
+		auto cio = new CueIO(cache, lba, length, ftype, tmode);
 		PHYSFS_Io *io = createIo();
 		io->opaque = cio;
 		return io;
@@ -748,7 +787,7 @@ const int PHYSFS_API_VERSION = 0;
 class CueArchiver
 {
   private:
-	UString imageFile;
+	sp<CueBlockCache> cache;
 	CueFileType fileType;
 	CueTrackMode trackMode;
 
@@ -944,7 +983,7 @@ class CueArchiver
 			// Reset reading position
 			cio->seek(pos);
 			// cio->seek(cio->blockSize() * location + readpos);
-			parent.children[childEntry.name] = childEntry;
+			parent.children[childEntry.name] = std::move(childEntry);
 		} while ((childDirRecord.length > 0));
 	}
 
@@ -952,7 +991,7 @@ class CueArchiver
 	static_assert(sizeof(IsoDirRecord_hdr) == 255, "Unexpected direntry size!");
 	static_assert(offsetof(IsoDirRecord_hdr, fnLength) == 32, "Unexpected filename offset!");
 	CueArchiver(UString fileName, CueFileType ftype, CueTrackMode tmode)
-	    : imageFile(fileName), fileType(ftype), trackMode(tmode)
+	    : fileType(ftype), trackMode(tmode)
 	{
 		// "Hey, a .cue-.bin file pair should be really easy to read!" - sfalexrog, 15.04.2016
 		fs::path filePath(fileName.cStr());
@@ -960,8 +999,9 @@ class CueArchiver
 		// (mode1_2048)
 		uint64_t fsize = fs::file_size(filePath);
 		LogInfo("Opening file %s of size %" PRIu64, fileName, fsize);
-		cio = new CueIO(fileName, 0, fsize, ftype, tmode);
-		if (!cio->fileStream)
+		cache = mksp<CueBlockCache>(fileName, tmode);
+		cio = new CueIO(cache, 0, fsize, ftype, tmode);
+		if (!cache->isOpen())
 		{
 			LogError("Could not open file: bad stream!");
 		}
@@ -1030,7 +1070,7 @@ class CueArchiver
 		{
 			return nullptr;
 		}
-		return CueIO::getIo(imageFile, entry->offset, entry->length, fileType, trackMode);
+		return CueIO::getIo(cache, entry->offset, entry->length, fileType, trackMode);
 	}
 
 	int stat(const char *name, PHYSFS_Stat *stat)
@@ -47,5 +47,6 @@ void SoundBackend::playSample(sp<Sample> sample, Vec3<float> position, float gai
 	// Anything within CLOSE_RANGE is at full volume
 	this->playSample(sample, gain * gainMultiplier);
 }
+void SoundBackend::prepareSample(sp<Sample>) {}
 void SoundBackend::setListenerPosition(Vec3<float> position) { this->listenerPosition = position; }
 }; // namespace OpenApoc
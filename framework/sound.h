@@ -85,6 +85,10 @@ class SoundBackend
   public:
 	virtual ~SoundBackend() = default;
 	virtual void playSample(sp<Sample> sample, float gain = 1.0f) = 0;
+	/* Converts the sample to whatever the backend plays ahead of time, so that the first
+	 * playSample() doesn't have to. Samples are shared by everything loading the same path, so
+	 * this only ever happens once per sample */
+	virtual void prepareSample(sp<Sample> sample);
 	virtual void playMusic(std::function<void(void *)> finishedCallback,
 	                       void *callbackData = nullptr) = 0;
 	virtual void stopMusic() = 0;
@@ -3,14 +3,18 @@
 #include "framework/sound_interface.h"
 #include "framework/trace.h"
 #include "library/sp.h"
+#include "library/spscqueue.h"
 #include "library/vec.h"
 #include <SDL.h>
 #include <SDL_audio.h>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <functional>
-#include <list>
 #include <mutex>
-#include <queue>
+#include <thread>
 #include <vector>
 
 namespace
@@ -18,19 +22,13 @@ namespace
 
 using namespace OpenApoc;
 
-struct SampleData
-{
-	sp<Sample> sample;
-	float gain;
-	unsigned int sample_position; // in bytes
-	SampleData(sp<Sample> sample, float gain) : sample(sample), gain(gain), sample_position(0) {}
-};
-
 struct MusicData
 {
-	MusicData() : sample_position(0) {}
+	MusicData() : sample_position(0), generation(0) {}
 	std::vector<unsigned char> samples;
 	unsigned int sample_position; // in bytes
+	// Music decoded before the track last changed is dropped by the mixer
+	unsigned int generation;
 };
 
 // 'samples' must already be large enough to contain the full output size
@@ -99,179 +97,353 @@ class SDLSampleData : public BackendSampleData
 	std::vector<unsigned char> samples;
 };
 
+// Most samples mixed at once, when more are playing the quietest ones are cut off
+static const unsigned int MAX_VOICES = 32;
+// Commands waiting for the mixer, anything pushed while it's full is dropped
+static const size_t COMMAND_QUEUE_SIZE = 256;
+// Chunks of decoded music (a tenth of a second each) the mixer can be ahead of. The music thread
+// starts decoding when fewer than the low watermark are left, and stops at the high one
+static const size_t MUSIC_RING_SIZE = 8;
+static const size_t MUSIC_LOW_WATERMARK = 2;
+static const size_t MUSIC_HIGH_WATERMARK = 6;
+// The mixer wakes the music thread up without waiting for its lock, so a wake-up can get lost
+static const std::chrono::milliseconds MUSIC_WAKE_INTERVAL{20};
+
+// A sample being played, only ever touched by the mixer
+struct Voice
+{
+	sp<SDLSampleData> data;
+	float gain;
+	unsigned int sample_position; // in bytes
+	Voice(sp<SDLSampleData> data, float gain) : data(data), gain(gain), sample_position(0) {}
+};
+
+struct MixerCommand
+{
+	enum class Type
+	{
+		PlaySample,
+		SetGain,
+	};
+	Type type = Type::PlaySample;
+	sp<SDLSampleData> data;
+	SoundBackend::Gain gain_type = SoundBackend::Gain::Global;
+	float gain = 0.0f;
+};
+
 static void unwrap_callback(void *userdata, Uint8 *stream, int len);
 
 class SDLRawBackend : public SoundBackend
 {
+	// Only guards the music track and callbacks, the mixer never takes it, and the music thread
+	// lets go of it while decoding. Samples and volumes are passed on to the mixer through
+	// 'commands' and decoded music through 'music_ring', so that nothing ever waits for the mixer
+	// to finish, or the other way round
 	std::recursive_mutex audio_lock;
 
+	// The mixer is the only consumer, but samples can be played from several threads, so they
+	// take turns pushing. The mixer never takes this lock
+	std::mutex command_lock;
+	// Guards converting samples into the output format, which may happen on a loading thread
+	std::mutex sample_lock;
+	SpscQueue<MixerCommand, COMMAND_QUEUE_SIZE> commands;
+
+	// As last set, the mixer keeps its own copy
 	float overall_volume;
 	float music_volume;
 	float sound_volume;
 
+	// Everything below up to the music is only touched by the mixer
+	float mixer_overall_volume;
+	float mixer_music_volume;
+	float mixer_sound_volume;
+	std::vector<Voice> voices;
+	// Mixed in 32 bits and only saturated down to the output format once at the end
+	bool mix_s16;
+	std::vector<int32_t> mix_buffer;
+
 	sp<MusicTrack> track;
 	bool music_playing;
 
 	std::function<void(void *)> music_finished_callback;
 	void *music_callback_data;
-
-	std::list<SampleData> live_samples;
+	// Set while the finished callback picks the next track, so that what's decoded of the last one
+	// still gets played
+	bool advancing_track;
 
 	SDL_AudioDeviceID devID;
 	SDL_AudioSpec output_spec;
 	AudioFormat preferred_format;
 
+	// Only touched by the mixer
 	sp<MusicData> current_music_data;
-	std::queue<sp<MusicData>> music_queue;
-
-	std::shared_future<void> get_music_future;
 
-	unsigned int music_queue_size;
+	SpscQueue<sp<MusicData>, MUSIC_RING_SIZE> music_ring;
+	std::atomic<unsigned int> music_generation;
+	std::condition_variable_any music_wake;
+	bool music_thread_stop;
+	std::thread music_thread;
 
-	void getMoreMusic()
+	// Decodes music ahead of the mixer, on its own so that it never has to wait for loading or
+	// anything else running on the thread pool
+	void musicThread()
 	{
-		TRACE_FN;
-		std::lock_guard<std::recursive_mutex> lock(this->audio_lock);
-		if (!this->music_playing)
-		{
-			// Music probably disabled in the time it took us to be scheduled?
-			return;
-		}
-		if (!this->track)
+		std::unique_lock<std::recursive_mutex> lock(this->audio_lock);
+		bool refilling = true;
+		while (!this->music_thread_stop)
 		{
-			LogWarning("Music playing but no track?");
-			return;
+			auto buffered = this->music_ring.size();
+			if (buffered < MUSIC_LOW_WATERMARK)
+			{
+				refilling = true;
+			}
+			else if (buffered >= MUSIC_HIGH_WATERMARK)
+			{
+				refilling = false;
+			}
+			if (!refilling || !this->music_playing || !this->track)
+			{
+				this->music_wake.wait_for(lock, MUSIC_WAKE_INTERVAL);
+				continue;
+			}
+			decodeMusic(lock);
 		}
-		while (this->music_queue.size() < this->music_queue_size)
+	}
+
+	// Must be called with 'lock' held on audio_lock. It's let go of while the track decodes, so
+	// that stopping or changing the music never waits for the decoder
+	void decodeMusic(std::unique_lock<std::recursive_mutex> &lock)
+	{
+		TRACE_FN;
 		{
+			auto track = this->track;
 			auto data = mksp<MusicData>();
+			data->generation = this->music_generation.load();
 
-			unsigned int input_size = this->track->format.getSampleSize() *
-			                          this->track->format.channels *
-			                          this->track->requestedSampleBufferSize;
+			unsigned int input_size = track->format.getSampleSize() * track->format.channels *
+			                          track->requestedSampleBufferSize;
 			unsigned int output_size = (SDL_AUDIO_BITSIZE(this->output_spec.format) / 8) *
 			                           this->output_spec.channels *
-			                           this->track->requestedSampleBufferSize;
+			                           track->requestedSampleBufferSize;
 
 			data->samples.resize(std::max(input_size, output_size));
 
 			unsigned int returned_samples;
 
-			auto ret = this->track->callback(this->track, this->track->requestedSampleBufferSize,
-			                                 (void *)data->samples.data(), &returned_samples);
+			lock.unlock();
+			auto ret = track->callback(track, track->requestedSampleBufferSize,
+			                           (void *)data->samples.data(), &returned_samples);
 
 			// Reset the sizes, as we may have fewer returned_samples than asked for
-			input_size = this->track->format.getSampleSize() * this->track->format.channels *
-			             returned_samples;
+			input_size = track->format.getSampleSize() * track->format.channels * returned_samples;
 			output_size = (SDL_AUDIO_BITSIZE(this->output_spec.format) / 8) *
 			              this->output_spec.channels * returned_samples;
 
 			bool convert_ret =
-			    ConvertAudio(this->track->format, this->output_spec, input_size, data->samples);
+			    ConvertAudio(track->format, this->output_spec, input_size, data->samples);
+			lock.lock();
 			if (!convert_ret)
 			{
 				LogWarning("Failed to convert music data");
 			}
 
+			// The music was stopped or changed while this was decoded
+			if (this->track != track || this->music_generation.load() != data->generation)
+			{
+				return;
+			}
+
 			data->samples.resize(output_size);
+			if (!this->music_ring.push(std::move(data)))
+			{
+				LogWarning("Music ring full, dropping decoded music");
+			}
 
 			if (ret == MusicTrack::MusicCallbackReturn::End)
 			{
 				this->track = nullptr;
 				if (this->music_finished_callback)
 				{
+					this->advancing_track = true;
 					this->music_finished_callback(music_callback_data);
+					this->advancing_track = false;
 				}
 			}
-			this->music_queue.push(data);
 		}
 	}
 
-  public:
-	void mixingCallback(Uint8 *stream, int len)
+	void applyCommands()
 	{
-		TRACE_FN;
-		// initialize stream buffer
-		memset(stream, 0, len);
-		std::lock_guard<std::recursive_mutex> lock(this->audio_lock);
-
-		if (this->current_music_data || !this->music_queue.empty())
+		MixerCommand command;
+		while (this->commands.pop(command))
 		{
-			int int_music_volume =
-			    clamp((int)lrint(this->overall_volume * this->music_volume * 128.0f), 0, 128);
-			int music_bytes = 0;
-			while (music_bytes < len)
+			switch (command.type)
 			{
-				if (!this->current_music_data)
+				case MixerCommand::Type::PlaySample:
 				{
-					this->get_music_future =
-					    fw().threadPoolEnqueue(std::mem_fn(&SDLRawBackend::getMoreMusic), this);
-					if (this->music_queue.empty())
+					if (this->voices.size() < MAX_VOICES)
 					{
-						LogWarning("Music underrun!");
+						this->voices.emplace_back(command.data, command.gain);
 						break;
 					}
-					this->current_music_data = this->music_queue.front();
-					this->music_queue.pop();
-				}
-				int bytes_from_this_chunk =
-				    std::min(len - music_bytes, (int)(this->current_music_data->samples.size() -
-				                                      this->current_music_data->sample_position));
-				SDL_MixAudioFormat(stream + music_bytes,
-				                   this->current_music_data->samples.data() +
-				                       this->current_music_data->sample_position,
-				                   this->output_spec.format, bytes_from_this_chunk,
-				                   int_music_volume);
-				music_bytes += bytes_from_this_chunk;
-				this->current_music_data->sample_position += bytes_from_this_chunk;
-				LogAssert(this->current_music_data->sample_position <=
-				          this->current_music_data->samples.size());
-				if (this->current_music_data->sample_position ==
-				    this->current_music_data->samples.size())
-				{
-					this->current_music_data = nullptr;
+					// Steal the quietest voice, unless the new sample would be quieter still
+					auto quietest = std::min_element(
+					    this->voices.begin(), this->voices.end(),
+					    [](const Voice &a, const Voice &b) { return a.gain < b.gain; });
+					if (quietest->gain <= command.gain)
+					{
+						*quietest = Voice(command.data, command.gain);
+					}
+					break;
 				}
+				case MixerCommand::Type::SetGain:
+					switch (command.gain_type)
+					{
+						case Gain::Global:
+							this->mixer_overall_volume = command.gain;
+							break;
+						case Gain::Sample:
+							this->mixer_sound_volume = command.gain;
+							break;
+						case Gain::Music:
+							this->mixer_music_volume = command.gain;
+							break;
+					}
+					break;
 			}
 		}
+	}
 
-		auto sampleIt = this->live_samples.begin();
-		while (sampleIt != this->live_samples.end())
+	// Adds 'len' bytes of 'source' at 'volume' (0 to SDL_MIX_MAXVOLUME) to the output, starting
+	// 'offset' bytes in
+	void mix(Uint8 *stream, int offset, const unsigned char *source, int len, int volume)
+	{
+		if (!this->mix_s16)
+		{
+			SDL_MixAudioFormat(stream + offset, source, this->output_spec.format, len, volume);
+			return;
+		}
+		// Simple enough for the compiler to vectorize
+		auto *input = reinterpret_cast<const int16_t *>(source);
+		auto *output = this->mix_buffer.data() + offset / 2;
+		int count = len / 2;
+		for (int i = 0; i < count; i++)
+		{
+			output[i] += input[i] * volume / SDL_MIX_MAXVOLUME;
+		}
+	}
+
+	void mixMusic(Uint8 *stream, int len)
+	{
+		int int_music_volume =
+		    clamp((int)lrint(this->mixer_overall_volume * this->mixer_music_volume * 128.0f), 0,
+		          128);
+		auto generation = this->music_generation.load();
+		if (this->current_music_data && this->current_music_data->generation != generation)
+		{
+			this->current_music_data = nullptr;
+		}
+		int music_bytes = 0;
+		while (music_bytes < len)
 		{
-			int int_sample_volume = clamp(
-			    (int)lrint(this->overall_volume * this->sound_volume * sampleIt->gain * 128.0f), 0,
-			    128);
-			auto sampleData =
-			    std::dynamic_pointer_cast<SDLSampleData>(sampleIt->sample->backendData);
-			if (!sampleData)
+			if (!this->current_music_data)
 			{
-				LogWarning("Sample with invalid sample data");
-				// Clear it in case we've changed drivers or something
-				sampleIt->sample->backendData = nullptr;
-				sampleIt = this->live_samples.erase(sampleIt);
-				continue;
+				sp<MusicData> next;
+				while (this->music_ring.pop(next) && next->generation != generation)
+				{
+					next = nullptr;
+				}
+				this->music_wake.notify_one();
+				if (!next)
+				{
+					if (music_bytes > 0)
+					{
+						LogWarning("Music underrun!");
+					}
+					break;
+				}
+				this->current_music_data = next;
 			}
-			if (sampleIt->sample_position == sampleData->samples.size())
+			int bytes_from_this_chunk =
+			    std::min(len - music_bytes, (int)(this->current_music_data->samples.size() -
+			                                      this->current_music_data->sample_position));
+			mix(stream, music_bytes,
+			    this->current_music_data->samples.data() +
+			        this->current_music_data->sample_position,
+			    bytes_from_this_chunk, int_music_volume);
+			music_bytes += bytes_from_this_chunk;
+			this->current_music_data->sample_position += bytes_from_this_chunk;
+			LogAssert(this->current_music_data->sample_position <=
+			          this->current_music_data->samples.size());
+			if (this->current_music_data->sample_position ==
+			    this->current_music_data->samples.size())
 			{
-				// Reached the end of the sample
-				sampleIt = this->live_samples.erase(sampleIt);
-				continue;
+				this->current_music_data = nullptr;
 			}
+		}
+	}
 
+	void mixSamples(Uint8 *stream, int len)
+	{
+		for (size_t i = 0; i < this->voices.size();)
+		{
+			auto &voice = this->voices[i];
+			if (voice.sample_position == voice.data->samples.size())
+			{
+				// Reached the end of the sample, order doesn't matter
+				voice = std::move(this->voices.back());
+				this->voices.pop_back();
+				continue;
+			}
+			int int_sample_volume = clamp((int)lrint(this->mixer_overall_volume *
+			                                         this->mixer_sound_volume * voice.gain *
+			                                         128.0f),
+			                              0, 128);
 			unsigned bytes_to_mix =
-			    std::min(len, (int)(sampleData->samples.size() - sampleIt->sample_position));
-			SDL_MixAudioFormat(stream, sampleData->samples.data() + sampleIt->sample_position,
-			                   this->output_spec.format, bytes_to_mix, int_sample_volume);
-			sampleIt->sample_position += bytes_to_mix;
-			LogAssert(sampleIt->sample_position <= sampleData->samples.size());
+			    std::min(len, (int)(voice.data->samples.size() - voice.sample_position));
+			mix(stream, 0, voice.data->samples.data() + voice.sample_position, bytes_to_mix,
+			    int_sample_volume);
+			voice.sample_position += bytes_to_mix;
+			LogAssert(voice.sample_position <= voice.data->samples.size());
+			i++;
+		}
+	}
+
+  public:
+	void mixingCallback(Uint8 *stream, int len)
+	{
+		TRACE_FN;
+		// initialize stream buffer
+		memset(stream, 0, len);
+		applyCommands();
+		if (this->mix_s16)
+		{
+			this->mix_buffer.assign(len / 2, 0);
+		}
 
-			sampleIt++;
+		mixMusic(stream, len);
+		mixSamples(stream, len);
+
+		if (this->mix_s16)
+		{
+			auto *output = reinterpret_cast<int16_t *>(stream);
+			int count = len / 2;
+			for (int i = 0; i < count; i++)
+			{
+				output[i] =
+				    (int16_t)std::min(std::max(this->mix_buffer[i], (int32_t)INT16_MIN),
+				                      (int32_t)INT16_MAX);
+			}
 		}
 	}
 
 	SDLRawBackend()
-	    : overall_volume(1.0f), music_volume(1.0f), sound_volume(1.0f), music_playing(false),
-	      music_callback_data(nullptr), music_queue_size(2)
+	    : overall_volume(1.0f), music_volume(1.0f), sound_volume(1.0f),
+	      mixer_overall_volume(1.0f), mixer_music_volume(1.0f), mixer_sound_volume(1.0f),
+	      mix_s16(false), music_playing(false), music_callback_data(nullptr),
+	      advancing_track(false), music_generation(0), music_thread_stop(false)
 	{
+		this->voices.reserve(MAX_VOICES);
 		SDL_Init(SDL_INIT_AUDIO);
 		preferred_format.channels = 2;
 		preferred_format.format = AudioFormat::SampleFormat::PCM_SINT16;
@@ -305,18 +477,55 @@ class SDLRawBackend : public SoundBackend
 		LogInfo("Audio output format: Channels %d, format %d, freq %d, samples %d",
 		        (int)output_spec.channels, (int)output_spec.format, (int)output_spec.freq,
 		        (int)output_spec.samples);
+		this->mix_s16 = output_spec.format == AUDIO_S16SYS;
+		this->mix_buffer.reserve(output_spec.samples * output_spec.channels);
+		this->music_thread = std::thread(&SDLRawBackend::musicThread, this);
 	}
+	// Must be called with sample_lock held
+	sp<SDLSampleData> convertSample(sp<Sample> sample)
+	{
+		if (!sample->backendData)
+		{
+			sample->backendData.reset(new SDLSampleData(sample, this->output_spec));
+		}
+		auto data = std::dynamic_pointer_cast<SDLSampleData>(sample->backendData);
+		if (!data)
+		{
+			LogWarning("Sample with invalid sample data");
+			// Clear it in case we've changed drivers or something
+			sample->backendData = nullptr;
+		}
+		return data;
+	}
+
+	void prepareSample(sp<Sample> sample) override
+	{
+		std::lock_guard<std::mutex> l(this->sample_lock);
+		convertSample(sample);
+	}
+
 	void playSample(sp<Sample> sample, float gain) override
 	{
 		// Clamp to 0..1
 		gain = std::min(1.0f, std::max(0.0f, gain));
-		if (!sample->backendData)
+		MixerCommand command;
+		command.type = MixerCommand::Type::PlaySample;
+		command.gain = gain;
 		{
-			sample->backendData.reset(new SDLSampleData(sample, this->output_spec));
+			std::lock_guard<std::mutex> l(this->sample_lock);
+			command.data = convertSample(sample);
 		}
+		if (!command.data)
 		{
-			std::lock_guard<std::recursive_mutex> l(this->audio_lock);
-			this->live_samples.emplace_back(sample, gain);
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> l(this->command_lock);
+			if (!this->commands.push(std::move(command)))
+			{
+				LogWarning("Too many sounds waiting for the mixer, dropping %p", sample.get());
+				return;
+			}
 		}
 		LogInfo("Placed sound %p on queue", sample.get());
 	}
@@ -324,13 +533,11 @@ class SDLRawBackend : public SoundBackend
 	void playMusic(std::function<void(void *)> finishedCallback, void *callbackData) override
 	{
 		std::lock_guard<std::recursive_mutex> l(this->audio_lock);
-		while (!music_queue.empty())
-			music_queue.pop();
+		this->music_generation++;
 		music_finished_callback = finishedCallback;
 		music_callback_data = callbackData;
 		music_playing = true;
-		this->get_music_future =
-		    fw().threadPoolEnqueue(std::mem_fn(&SDLRawBackend::getMoreMusic), this);
+		this->music_wake.notify_one();
 		LogInfo("Playing music on SDL backend");
 	}
 
@@ -339,33 +546,35 @@ class SDLRawBackend : public SoundBackend
 		std::lock_guard<std::recursive_mutex> l(this->audio_lock);
 		LogInfo("Setting track to %p", track.get());
 		this->track = track;
-		while (!music_queue.empty())
-			music_queue.pop();
+		if (!this->advancing_track)
+		{
+			this->music_generation++;
+		}
+		this->music_wake.notify_one();
 	}
 
 	void stopMusic() override
 	{
-		std::shared_future<void> outstanding_get_music;
-		{
-			std::lock_guard<std::recursive_mutex> l(this->audio_lock);
-			this->music_playing = false;
-			this->track = nullptr;
-			if (this->get_music_future.valid())
-				outstanding_get_music = std::move(this->get_music_future);
-			while (!music_queue.empty())
-				music_queue.pop();
-		}
-		if (outstanding_get_music.valid())
-			outstanding_get_music.wait();
+		std::lock_guard<std::recursive_mutex> l(this->audio_lock);
+		this->music_playing = false;
+		this->track = nullptr;
+		// Whatever was decoded already is dropped by the mixer
+		this->music_generation++;
 	}
 
 	~SDLRawBackend() override
 	{
-		// Lock the device and stop any outstanding music threads to ensure everything is dead
-		// before destroying the device
+		// Lock the device and stop the music thread to ensure everything is dead before
+		// destroying the device
 		SDL_LockAudioDevice(devID);
 		SDL_PauseAudioDevice(devID, 1);
 		this->stopMusic();
+		{
+			std::lock_guard<std::recursive_mutex> l(this->audio_lock);
+			this->music_thread_stop = true;
+		}
+		this->music_wake.notify_one();
+		this->music_thread.join();
 		SDL_UnlockAudioDevice(devID);
 		SDL_CloseAudioDevice(devID);
 		SDL_QuitSubSystem(SDL_INIT_AUDIO);
@@ -394,6 +603,11 @@ class SDLRawBackend : public SoundBackend
 	{
 		// Clamp to 0..1
 		f = std::min(1.0f, std::max(0.0f, f));
+		MixerCommand command;
+		command.type = MixerCommand::Type::SetGain;
+		command.gain_type = g;
+		command.gain = f;
+		std::lock_guard<std::mutex> l(this->command_lock);
 		switch (g)
 		{
 			case Gain::Global:
@@ -406,6 +620,10 @@ class SDLRawBackend : public SoundBackend
 				music_volume = f;
 				break;
 		}
+		if (!this->commands.push(std::move(command)))
+		{
+			LogWarning("Too many commands waiting for the mixer, dropping gain change");
+		}
 	}
 };
 
@@ -23,6 +23,7 @@ const unsigned int TRACE_CHUNK_SIZE = 100000;
 
 std::mutex initTraceLock;
 static bool traceInited = false;
+static bool summaryOnly = false;
 
 static void initTrace()
 {
@@ -61,9 +62,27 @@ class EventList
   public:
 	UString tid;
 	std::vector<TraceEvent> *current_buffer;
+	// Only used when summing up, the start times of the trace points still open
+	std::vector<uint64_t> open_starts;
+	std::map<UString, OpenApoc::TraceSummary> summary;
 	void pushEvent(const EventType &type, const UString &name,
 	               const std::vector<std::pair<UString, UString>> &args, uint64_t &timeNS)
 	{
+		if (summaryOnly)
+		{
+			if (type == EventType::Begin)
+			{
+				this->open_starts.push_back(timeNS);
+			}
+			else if (!this->open_starts.empty())
+			{
+				auto &entry = this->summary[name];
+				entry.calls++;
+				entry.totalNS += timeNS - this->open_starts.back();
+				this->open_starts.pop_back();
+			}
+			return;
+		}
 		if (this->current_buffer->size() == TRACE_CHUNK_SIZE)
 		{
 			this->buffer_list.emplace_back();
@@ -79,7 +98,10 @@ class EventList
 	{
 		this->buffer_list.emplace_back();
 		this->current_buffer = &buffer_list.back();
-		this->current_buffer->reserve(TRACE_CHUNK_SIZE);
+		if (!summaryOnly)
+		{
+			this->current_buffer->reserve(TRACE_CHUNK_SIZE);
+		}
 	}
 };
 
@@ -103,8 +125,13 @@ class TraceManager
 	}
 	~TraceManager();
 	std::ofstream outFile;
-	TraceManager() : outFile(traceFile.get().str())
+	TraceManager()
 	{
+		if (summaryOnly)
+		{
+			return;
+		}
+		outFile.open(traceFile.get().str());
 		if (!outFile)
 		{
 			LogError("Failed to open trace file \"%s\"", traceFile.get());
@@ -139,7 +166,7 @@ static std::chrono::time_point<std::chrono::high_resolution_clock> traceStartTim
 
 TraceManager::~TraceManager()
 {
-	if (OpenApoc::Trace::enabled)
+	if (OpenApoc::Trace::enabled && !summaryOnly)
 		this->write();
 }
 
@@ -228,17 +255,43 @@ void Trace::enable()
 	traceStartTime = std::chrono::high_resolution_clock::now();
 }
 
+void Trace::enableSummary()
+{
+	summaryOnly = true;
+	enable();
+}
+
 void Trace::disable()
 {
 	if (!enabled)
 		return;
 	LogAssert(trace_manager);
-	trace_manager->write();
+	if (!summaryOnly)
+		trace_manager->write();
 	trace_manager.reset(nullptr);
 #if defined(BROKEN_THREAD_LOCAL)
 	pthread_key_delete(eventListKey);
 #endif
 	enabled = false;
+	summaryOnly = false;
+}
+
+std::map<UString, TraceSummary> Trace::getSummary()
+{
+	std::map<UString, TraceSummary> summary;
+	if (!enabled || !summaryOnly)
+		return summary;
+	std::lock_guard<std::mutex> l(trace_manager->listMutex);
+	for (auto &eventList : trace_manager->lists)
+	{
+		for (auto &entry : eventList->summary)
+		{
+			auto &total = summary[entry.first];
+			total.calls += entry.second.calls;
+			total.totalNS += entry.second.totalNS;
+		}
+	}
+	return summary;
 }
 
 void Trace::setThreadName(const UString &name)
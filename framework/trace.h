@@ -3,16 +3,32 @@
 #include "library/strings.h"
 // Include logger for 'LOGGER_PREFIX' definition
 #include "framework/logger.h"
+#include <cstdint>
+#include <map>
 #include <vector>
 
 namespace OpenApoc
 {
 
+class TraceSummary
+{
+  public:
+	uint64_t calls = 0;
+	// Including the time spent in any trace points within it
+	uint64_t totalNS = 0;
+};
+
 class Trace
 {
   public:
 	static void enable();
+	// Instead of recording every trace point for the trace file, only adds up the calls to and time
+	// spent in each, so that it can be left on for long runs
+	static void enableSummary();
 	static void disable();
+	// The totals since enableSummary() for every trace point, across all threads. Must not be
+	// called while other threads are tracing
+	static std::map<UString, TraceSummary> getSummary();
 
 	static void start(const UString &name,
 	                  const std::vector<std::pair<UString, UString>> &args = {});
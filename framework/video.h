@@ -37,6 +37,9 @@ class Video
 	virtual unsigned getFrameCount() const = 0;
 	virtual Vec2<int> getVideoSize() const = 0;
 
+	// Frames are decoded ahead on another thread, this is false while popImage() would have to wait
+	// for the next one
+	virtual bool imageReady() = 0;
 	virtual sp<FrameImage> popImage() = 0;
 	virtual sp<FrameAudio> popAudio() = 0;
 	virtual ~Video() = default;
@@ -5,9 +5,13 @@
 #include "framework/sound.h"
 #include "framework/trace.h"
 #include "framework/video.h"
+#include <array>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <mutex>
-#include <queue>
+#include <thread>
+#include <vector>
 
 // libsmacker.h doesn't set C abi by default, so wrap
 extern "C" {
@@ -25,8 +29,6 @@ class SMKMusicTrack : public MusicTrack
 {
   private:
 	sp<SMKVideo> video;
-	sp<FrameAudio> current_frame;
-	unsigned current_frame_sample_position;
 
   public:
 	SMKMusicTrack(sp<SMKVideo> video);
@@ -35,9 +37,37 @@ class SMKMusicTrack : public MusicTrack
 	                             unsigned int *returnedSamples);
 };
 
+// How many frames the decoder tries to stay ahead of both the screen and the music
+static const size_t FRAMES_AHEAD = 8;
+// The decoder stops even if the music falls behind when the screen has this many frames waiting.
+// Audio past this many is dropped, oldest first, as nothing may be playing it at all (like with
+// the null sound backend), and it mustn't hold up the screen
+static const size_t MAX_FRAMES_AHEAD = 32;
+// Frame images handed out to the screen that get reused once it's done with them
+static const size_t FRAME_IMAGE_POOL_SIZE = 4;
+
+// Buffers the decoder fills in, they are handed back to be reused once they've been consumed
+class SMKVideoFrame
+{
+  public:
+	unsigned frame = 0;
+	std::vector<uint8_t> indices;
+	std::array<uint8_t, 256 * 3> palette;
+};
+
+class SMKAudioFrame
+{
+  public:
+	unsigned frame = 0;
+	std::vector<char> samples;
+	unsigned sample_count = 0;
+	unsigned sample_position = 0;
+};
+
 class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 {
   public:
+	// Only touched by the decoder thread once it's started
 	smk smk_ctx;
 	std::chrono::duration<unsigned int, std::nano> frame_time;
 	unsigned long frame_count;
@@ -51,11 +81,22 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 	size_t video_data_size;
 	up<char[]> video_data;
 
+	// Guards everything the decoder thread shares below
+	std::mutex frame_queue_lock;
+	std::condition_variable frames_changed;
 	bool stopped;
-
-	std::recursive_mutex frame_queue_lock;
-	std::queue<sp<FrameImage>> image_queue;
-	std::queue<sp<FrameAudio>> audio_queue;
+	// Set by the decoder thread once there won't be any more frames
+	bool finished;
+	std::deque<up<SMKVideoFrame>> video_frames;
+	std::deque<up<SMKAudioFrame>> audio_frames;
+	std::vector<up<SMKVideoFrame>> free_video_frames;
+	std::vector<up<SMKAudioFrame>> free_audio_frames;
+	std::thread decoder;
+
+	// Only touched by whoever pops the images
+	std::vector<sp<FrameImage>> frame_images;
+	sp<Palette> last_palette;
+	std::array<uint8_t, 256 * 3> last_palette_data;
 
 	AudioFormat audio_format;
 	unsigned audio_bytes_per_sample;
@@ -66,7 +107,7 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 	SMKVideo()
 	    : smk_ctx(nullptr), frame_time(0), frame_count(0), current_frame_video(0),
 	      current_frame_audio(0), current_frame_read(0), frame_size(0, 0), video_data_size(0),
-	      stopped(false)
+	      stopped(false), finished(false)
 	{
 	}
 
@@ -77,47 +118,216 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 	unsigned getFrameCount() const override { return this->frame_count; }
 	Vec2<int> getVideoSize() const override { return this->frame_size; }
 
+	bool imageReady() override
+	{
+		std::lock_guard<std::mutex> l(this->frame_queue_lock);
+		return !this->video_frames.empty() || this->finished || this->stopped;
+	}
+
 	sp<FrameImage> popImage() override
 	{
 		TRACE_FN_ARGS1("Frame", Strings::fromInteger(this->current_frame_video));
-		std::lock_guard<std::recursive_mutex> l(this->frame_queue_lock);
-		if (this->image_queue.empty())
+		up<SMKVideoFrame> decoded;
 		{
-			if (this->readNextFrame() == false)
+			std::unique_lock<std::mutex> l(this->frame_queue_lock);
+			this->frames_changed.wait(l, [this] {
+				return !this->video_frames.empty() || this->finished || this->stopped;
+			});
+			if (this->video_frames.empty())
 			{
 				return nullptr;
 			}
+			decoded = std::move(this->video_frames.front());
+			this->video_frames.pop_front();
 		}
-		auto frame = this->image_queue.front();
-		this->image_queue.pop();
+
+		auto frame = this->getFrameImage();
+		frame->frame = decoded->frame;
+		auto img = std::static_pointer_cast<PaletteImage>(frame->image);
+		{
+			PaletteImageLock img_lock(img);
+			memcpy(img_lock.getData(), decoded->indices.data(), decoded->indices.size());
+		}
+		// Most videos hardly ever change palette, so don't make the renderer upload a new one for
+		// every frame
+		if (!this->last_palette || this->last_palette_data != decoded->palette)
+		{
+			this->last_palette = mksp<Palette>(256);
+			this->last_palette_data = decoded->palette;
+			const uint8_t *palette_data = decoded->palette.data();
+			for (unsigned int i = 0; i < 256; i++)
+			{
+				auto red = *palette_data++;
+				auto green = *palette_data++;
+				auto blue = *palette_data++;
+				this->last_palette->setColour(i, {red, green, blue});
+			}
+		}
+		frame->palette = this->last_palette;
+
+		{
+			std::lock_guard<std::mutex> l(this->frame_queue_lock);
+			this->free_video_frames.push_back(std::move(decoded));
+		}
+		this->frames_changed.notify_all();
 		this->current_frame_video++;
 		return frame;
 	}
 
-	sp<FrameAudio> popAudio() override
+	// Reuses a frame image nobody else holds on to any more, which has to happen on the thread
+	// that renders them as it drops whatever the renderer made of the old contents
+	sp<FrameImage> getFrameImage()
 	{
-		TRACE_FN_ARGS1("Frame", Strings::fromInteger(this->current_frame_audio));
-		std::lock_guard<std::recursive_mutex> l(this->frame_queue_lock);
-		if (this->audio_queue.empty())
+		for (auto &frame : this->frame_images)
 		{
-			if (this->readNextFrame() == false)
+			if (frame.use_count() == 1 && frame->image.use_count() == 1)
 			{
-				return nullptr;
+				frame->image->rendererPrivateData = nullptr;
+				return frame;
 			}
 		}
-		auto frame = this->audio_queue.front();
-		this->audio_queue.pop();
+		auto frame = mksp<FrameImage>();
+		frame->image = mksp<PaletteImage>(this->frame_size);
+		if (this->frame_images.size() < FRAME_IMAGE_POOL_SIZE)
+		{
+			this->frame_images.push_back(frame);
+		}
+		return frame;
+	}
+
+	sp<FrameAudio> popAudio() override
+	{
+		TRACE_FN_ARGS1("Frame", Strings::fromInteger(this->current_frame_audio));
+		std::unique_lock<std::mutex> l(this->frame_queue_lock);
+		this->frames_changed.wait(l, [this] {
+			return !this->audio_frames.empty() || this->finished || this->stopped;
+		});
+		if (this->audio_frames.empty())
+		{
+			return nullptr;
+		}
+		auto decoded = std::move(this->audio_frames.front());
+		this->audio_frames.pop_front();
+
+		auto frame = mksp<FrameAudio>();
+		frame->frame = decoded->frame;
+		frame->format = this->audio_format;
+		frame->sample_count = decoded->sample_count - decoded->sample_position;
+		auto sample_bytes = this->audio_bytes_per_sample * this->audio_format.channels;
+		frame->samples.reset(new char[frame->sample_count * sample_bytes]);
+		memcpy(frame->samples.get(), decoded->samples.data() + decoded->sample_position * sample_bytes,
+		       frame->sample_count * sample_bytes);
+
+		this->free_audio_frames.push_back(std::move(decoded));
+		l.unlock();
+		this->frames_changed.notify_all();
 		this->current_frame_audio++;
 		return frame;
 	}
 
-	bool readNextFrame()
+	// Copies up to maxSamples of the decoded audio straight into 'buffer', without going through a
+	// FrameAudio, and sets 'end' once there's none left
+	unsigned int readAudio(unsigned int maxSamples, void *buffer, bool &end)
 	{
-		TRACE_FN;
-		std::lock_guard<std::recursive_mutex> l(this->frame_queue_lock);
-		if (this->stopped)
-			return false;
+		TRACE_FN_ARGS1("Frame", Strings::fromInteger(this->current_frame_audio));
+		std::unique_lock<std::mutex> l(this->frame_queue_lock);
+		this->frames_changed.wait(l, [this] {
+			return !this->audio_frames.empty() || this->finished || this->stopped;
+		});
+		if (this->audio_frames.empty())
+		{
+			end = true;
+			return 0;
+		}
+		auto &decoded = this->audio_frames.front();
+		auto samples = std::min(maxSamples, decoded->sample_count - decoded->sample_position);
+		auto sample_bytes = this->audio_bytes_per_sample * this->audio_format.channels;
+		memcpy(buffer, decoded->samples.data() + decoded->sample_position * sample_bytes,
+		       samples * sample_bytes);
+		decoded->sample_position += samples;
+
+		bool consumed = decoded->sample_position == decoded->sample_count;
+		if (consumed)
+		{
+			this->free_audio_frames.push_back(std::move(decoded));
+			this->audio_frames.pop_front();
+			this->current_frame_audio++;
+		}
+		end = this->audio_frames.empty() && (this->finished || this->stopped);
+		l.unlock();
+		if (consumed)
+		{
+			this->frames_changed.notify_all();
+		}
+		return samples;
+	}
 
+	// Runs on its own thread, keeping a few frames decoded ahead of whoever pops them so that a
+	// slow frame (like a keyframe) doesn't hold up the screen
+	void decodeFrames()
+	{
+		std::unique_lock<std::mutex> l(this->frame_queue_lock);
+		while (!this->stopped)
+		{
+			bool behind = this->video_frames.size() < FRAMES_AHEAD ||
+			              this->audio_frames.size() < FRAMES_AHEAD;
+			bool full = this->video_frames.size() >= MAX_FRAMES_AHEAD;
+			if (!behind || full)
+			{
+				this->frames_changed.wait(l);
+				continue;
+			}
+
+			up<SMKVideoFrame> video_frame;
+			if (this->free_video_frames.empty())
+			{
+				video_frame.reset(new SMKVideoFrame());
+			}
+			else
+			{
+				video_frame = std::move(this->free_video_frames.back());
+				this->free_video_frames.pop_back();
+			}
+			up<SMKAudioFrame> audio_frame;
+			if (this->free_audio_frames.empty())
+			{
+				audio_frame.reset(new SMKAudioFrame());
+			}
+			else
+			{
+				audio_frame = std::move(this->free_audio_frames.back());
+				this->free_audio_frames.pop_back();
+			}
+
+			l.unlock();
+			bool last = false;
+			bool ok = this->readNextFrame(*video_frame, *audio_frame, last);
+			l.lock();
+
+			if (ok)
+			{
+				this->video_frames.push_back(std::move(video_frame));
+				if (this->audio_frames.size() >= MAX_FRAMES_AHEAD)
+				{
+					this->free_audio_frames.push_back(std::move(this->audio_frames.front()));
+					this->audio_frames.pop_front();
+				}
+				this->audio_frames.push_back(std::move(audio_frame));
+			}
+			if (!ok || last)
+			{
+				break;
+			}
+			this->frames_changed.notify_all();
+		}
+		this->finished = true;
+		l.unlock();
+		this->frames_changed.notify_all();
+	}
+
+	bool readNextFrame(SMKVideoFrame &frame, SMKAudioFrame &audio_frame, bool &last)
+	{
+		TRACE_FN;
 		char ret;
 		if (this->current_frame_read == 0)
 			ret = smk_first(this->smk_ctx);
@@ -133,7 +343,7 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 		if (ret == SMK_LAST)
 		{
 			LogInfo("Last frame %u", this->current_frame_read);
-			this->stopped = true;
+			last = true;
 		}
 
 		const unsigned char *palette_data = smk_get_palette(this->smk_ctx);
@@ -149,27 +359,12 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 			return false;
 		}
 
-		auto frame = mksp<FrameImage>();
-		frame->frame = this->current_frame_read;
-
-		auto img = mksp<PaletteImage>(this->frame_size);
-		frame->image = img;
-		frame->palette = mksp<Palette>(256);
-
-		PaletteImageLock img_lock(img);
-		memcpy(img_lock.getData(), image_data, this->frame_size.x * this->frame_size.y);
+		frame.frame = this->current_frame_read;
+		frame.indices.resize(this->frame_size.x * this->frame_size.y);
+		memcpy(frame.indices.data(), image_data, frame.indices.size());
+		memcpy(frame.palette.data(), palette_data, frame.palette.size());
 
-		for (unsigned int i = 0; i < 256; i++)
-		{
-			auto red = *palette_data++;
-			auto green = *palette_data++;
-			auto blue = *palette_data++;
-			frame->palette->setColour(i, {red, green, blue});
-		}
-
-		auto audio_frame = mksp<FrameAudio>();
-		audio_frame->frame = current_frame_read;
-		audio_frame->format = this->audio_format;
+		audio_frame.frame = current_frame_read;
 		unsigned long audio_bytes = smk_get_audio_size(this->smk_ctx, 0);
 		if (audio_bytes == 0)
 		{
@@ -179,27 +374,32 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 
 		auto sample_count =
 		    audio_bytes / (this->audio_bytes_per_sample * this->audio_format.channels);
-		audio_frame->samples.reset(new char[audio_bytes]);
-		audio_frame->sample_count = sample_count;
+		audio_frame.samples.resize(audio_bytes);
+		audio_frame.sample_count = sample_count;
+		audio_frame.sample_position = 0;
 		auto sample_pointer = smk_get_audio(this->smk_ctx, 0);
 		if (!sample_pointer)
 		{
 			LogWarning("Error reading audio data for frame %u", this->current_frame_read);
 			return false;
 		}
-		memcpy(audio_frame->samples.get(), sample_pointer, audio_bytes);
+		memcpy(audio_frame.samples.data(), sample_pointer, audio_bytes);
 
-		LogInfo("Read %lu samples bytes, %u samples", audio_bytes, audio_frame->sample_count);
-
-		this->image_queue.push(frame);
-		this->audio_queue.push(audio_frame);
+		LogInfo("Read %lu samples bytes, %u samples", audio_bytes, audio_frame.sample_count);
 
 		LogInfo("read frame %u", this->current_frame_read);
 		this->current_frame_read++;
 		return true;
 	}
 
-	void stop() override { this->stopped = true; }
+	void stop() override
+	{
+		{
+			std::lock_guard<std::mutex> l(this->frame_queue_lock);
+			this->stopped = true;
+		}
+		this->frames_changed.notify_all();
+	}
 
 	bool load(IFile &file)
 	{
@@ -323,6 +523,7 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 		}
 
 		// Everything looks  good
+		this->decoder = std::thread(&SMKVideo::decodeFrames, this);
 		return true;
 	}
 
@@ -339,6 +540,9 @@ class SMKVideo : public Video, public std::enable_shared_from_this<SMKVideo>
 
 	~SMKVideo() override
 	{
+		this->stop();
+		if (this->decoder.joinable())
+			this->decoder.join();
 		if (this->smk_ctx)
 			smk_close(this->smk_ctx);
 	}
@@ -351,8 +555,7 @@ MusicTrack::MusicCallbackReturn fillSMKMusicData(sp<MusicTrack> thisTrack, unsig
 	LogAssert(track);
 	return track->fillData(maxSamples, sampleBuffer, returnedSamples);
 }
-SMKMusicTrack::SMKMusicTrack(sp<SMKVideo> video)
-    : video(video), current_frame(video->popAudio()), current_frame_sample_position(0)
+SMKMusicTrack::SMKMusicTrack(sp<SMKVideo> video) : video(video)
 {
 	this->format = video->audio_format;
 	this->requestedSampleBufferSize = this->format.frequency / 10;
@@ -365,44 +568,15 @@ MusicTrack::MusicCallbackReturn SMKMusicTrack::fillData(unsigned int maxSamples,
                                                         unsigned int *returnedSamples)
 {
 	TRACE_FN;
-	if (!this->current_frame)
+	bool end = false;
+	*returnedSamples = this->video->readAudio(maxSamples, sampleBuffer, end);
+	if (end)
 	{
-		LogWarning("Playing beyond end of video");
-		*returnedSamples = 0;
 		return MusicCallbackReturn::End;
 	}
-
-	unsigned int samples_in_this_frame = std::min(
-	    maxSamples, this->current_frame->sample_count - this->current_frame_sample_position);
-
-	unsigned int audio_size_bytes = samples_in_this_frame *
-	                                this->current_frame->format.getSampleSize() *
-	                                this->current_frame->format.channels;
-
-	unsigned int audio_offset_bytes = this->current_frame_sample_position *
-	                                  this->current_frame->format.getSampleSize() *
-	                                  this->current_frame->format.channels;
-
-	memcpy(sampleBuffer, this->current_frame->samples.get() + audio_offset_bytes, audio_size_bytes);
-
-	*returnedSamples = samples_in_this_frame;
-
-	this->current_frame_sample_position += samples_in_this_frame;
-	LogAssert(this->current_frame_sample_position <= this->current_frame->sample_count);
-
-	if (this->current_frame_sample_position == this->current_frame->sample_count)
-	{
-		this->current_frame = video->popAudio();
-		this->current_frame_sample_position = 0;
-	}
-
-	if (this->current_frame)
-	{
-		return MusicCallbackReturn::Continue;
-	}
 	else
 	{
-		return MusicCallbackReturn::End;
+		return MusicCallbackReturn::Continue;
 	}
 }
 sp<Video> loadSMKVideo(IFile &file)
@@ -91,16 +91,44 @@ void AIBlockUnit::beginTurnRoutine(GameState &state, BattleUnit &u)
 }
 
 AIDecision AIBlockUnit::think(GameState &state, BattleUnit &u, bool forceInterrupt)
+{
+	auto decision = decide(state, u, forceInterrupt);
+	routine(state, u);
+	return decision;
+}
+
+void AIBlockUnit::routine(GameState &state, BattleUnit &u)
+{
+	for (auto &ai : routinesDue)
+	{
+		ai->routine(state, u);
+	}
+	routinesDue.clear();
+}
+
+bool AIBlockUnit::isThinkDue(GameState &state, const BattleUnit &u) const
 {
+	auto curTicks = state.gameTime.getTicks();
+	if (ticksLastThink + ticksUntilReThink <= curTicks)
+	{
+		return true;
+	}
+	// Something's in sight, think out of order if not busy
+	return !(u.visibleUnits.empty() || u.isMoving() || u.isAttacking() ||
+	         u.psiStatus != PsiStatus::NotEngaged ||
+	         ticksLastOutOfOrderThink + ticksUntilReThink > curTicks);
+}
+
+AIDecision AIBlockUnit::decide(GameState &state, BattleUnit &u, bool forceInterrupt)
+{
+	routinesDue.clear();
+	if (!isThinkDue(state, u))
+	{
+		return {};
+	}
 	auto curTicks = state.gameTime.getTicks();
 	if (ticksLastThink + ticksUntilReThink > curTicks)
 	{
-		if (u.visibleUnits.empty() || u.isMoving() || u.isAttacking() ||
-		    u.psiStatus != PsiStatus::NotEngaged ||
-		    ticksLastOutOfOrderThink + ticksUntilReThink > curTicks)
-		{
-			return {};
-		}
 		ticksLastOutOfOrderThink = curTicks;
 	}
 
@@ -137,6 +165,10 @@ AIDecision AIBlockUnit::think(GameState &state, BattleUnit &u, bool forceInterru
 		auto result = ai->think(state, u, interrupt);
 		auto newDecision = std::get<0>(result);
 		auto halt = std::get<1>(result);
+		if (ai->active)
+		{
+			routinesDue.push_back(ai);
+		}
 		if (!newDecision.isEmpty())
 		{
 			// We can keep last decision's movement if this one is action only,
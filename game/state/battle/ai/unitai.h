@@ -53,8 +53,19 @@ class AIBlockUnit
 	uint64_t ticksLastOutOfOrderThink = 0;
 	uint64_t ticksUntilReThink = 0;
 
+	// AIs that were active in the last decide(), not serialized
+	std::vector<sp<UnitAI>> routinesDue;
+
 	void beginTurnRoutine(GameState &state, BattleUnit &u);
+	// decide() followed by routine()
 	AIDecision think(GameState &state, BattleUnit &u, bool forceInterrupt = false);
+	// Decides what the unit should do without changing anything but the AIs' own memory, so that
+	// units can decide on different threads at once
+	AIDecision decide(GameState &state, BattleUnit &u, bool forceInterrupt = false);
+	// Whether decide() would think at all, rather than wait for the next time to
+	bool isThinkDue(GameState &state, const BattleUnit &u) const;
+	// Lets the AIs that were active in the last decide() look after the unit (reload, equip etc.)
+	void routine(GameState &state, BattleUnit &u);
 
 	void init(GameState &state, BattleUnit &u);
 	void reset(GameState &state, BattleUnit &u);
@@ -224,7 +224,7 @@ std::tuple<AIDecision, bool> UnitAIDefault::think(GameState &state, BattleUnit &
 		}
 		if (!possiblePositions.empty())
 		{
-			auto newPos = listRandomiser(state.rng, possiblePositions);
+			auto newPos = listRandomiser(u.aiRng, possiblePositions);
 			movement = mksp<AIMovement>();
 			movement->type = AIMovement::Type::Patrol;
 			movement->targetLocation = newPos;
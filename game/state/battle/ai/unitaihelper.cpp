@@ -1,14 +1,26 @@
 #include "game/state/battle/ai/unitaihelper.h"
 #include "game/state/aequipment.h"
 #include "game/state/battle/ai/aidecision.h"
+#include "game/state/battle/battle.h"
 #include "game/state/battle/battleunit.h"
+#include "game/state/battle/battleunitmission.h"
 #include "game/state/gamestate.h"
+#include "game/state/tileview/tile.h"
 #include <float.h>
 #include <glm/glm.hpp>
 
 namespace OpenApoc
 {
 
+namespace
+{
+// How much (in TUs) a way to cover may cost, walking five tiles with a few detours
+static const float TAKE_COVER_MAX_COST = 30.0f;
+// How many tiles the search for cover may expand, more than there are within that cost on the
+// unit's level
+static const int TAKE_COVER_MAX_ITERATIONS = 500;
+} // anonymous namespace
+
 sp<AIMovement> UnitAIHelper::getFallbackMovement(GameState &state, BattleUnit &u, bool forced)
 {
 	StateRef<BattleUnit> closestEnemy;
@@ -32,7 +44,7 @@ sp<AIMovement> UnitAIHelper::getFallbackMovement(GameState &state, BattleUnit &u
 	        u.agent->current_stats.health -
 	    (closestEnemy ? 20 * std::min(0, 6 - (int)glm::length(closestEnemy->position - u.position))
 	                  : 0);
-	if (!forced && randBoundsExclusive(state.rng, 0, 100) < chance)
+	if (!forced && randBoundsExclusive(u.aiRng, 0, 100) < chance)
 	{
 		return nullptr;
 	}
@@ -80,65 +92,23 @@ sp<AIMovement> UnitAIHelper::getFallbackMovement(GameState &state, BattleUnit &u
 sp<AIMovement> UnitAIHelper::getRetreatMovement(GameState &state, BattleUnit &u, bool forced)
 {
 	// Chance to take retreat is 1% per each morale missing
-	if (!forced && randBoundsExclusive(state.rng, 0, 100) >= u.agent->modified_stats.morale)
+	if (!forced && randBoundsExclusive(u.aiRng, 0, 100) >= u.agent->modified_stats.morale)
 	{
 		return nullptr;
 	}
 
-	StateRef<BattleUnit> closestEnemy;
-	for (auto &unit : state.current_battle->visibleEnemies[u.owner])
-	{
-		if (!closestEnemy ||
-		    glm::length(unit->position - u.position) <
-		        glm::length(closestEnemy->position - u.position))
-		{
-			closestEnemy = unit;
-		}
-	}
-
-	// Rate exits based (crudely) on distance to unit pos and from closest enemy
-	auto &map = *state.current_battle->map;
-	std::set<Vec3<int>> badExits;
-	std::list<Vec3<int>> goodExits;
-	float closestDistance = FLT_MAX;
-	for (auto &pos : state.current_battle->exits)
-	{
-		if (!map.getTile(pos)->hasExit)
-		{
-			badExits.insert(pos);
-			continue;
-		}
-		auto dist =
-		    BattleUnitTileHelper::getDistanceStatic(u.position, pos) -
-		    (closestEnemy ? BattleUnitTileHelper::getDistanceStatic(closestEnemy->position, pos)
-		                  : 0.0f);
-		if (dist < closestDistance)
-		{
-			closestDistance = dist;
-			goodExits.push_front(pos);
-		}
-		else
-		{
-			goodExits.push_back(pos);
-		}
-	}
-	for (auto &pos : badExits)
+	// Run for the exit that's the shortest way away
+	auto &battle = *state.current_battle;
+	Vec3<int> exit;
+	if (!battle.exitField->findExit(*battle.map, battle.exits, u.getType(), u.position, exit))
 	{
-		state.current_battle->exits.erase(pos);
-	}
-	for (auto &pos : goodExits)
-	{
-		if (state.current_battle->findShortestPath(u.position, pos, {map, u}).back() != pos)
-		{
-			continue;
-		}
-		auto result = mksp<AIMovement>();
-		result->type = AIMovement::Type::Retreat;
-		result->movementMode = MovementMode::Running;
-		result->targetLocation = pos;
-		return result;
+		return nullptr;
 	}
-	return nullptr;
+	auto result = mksp<AIMovement>();
+	result->type = AIMovement::Type::Retreat;
+	result->movementMode = MovementMode::Running;
+	result->targetLocation = exit;
+	return result;
 }
 
 sp<AIMovement> UnitAIHelper::getTakeCoverMovement(GameState &state, BattleUnit &u, bool forced)
@@ -146,21 +116,53 @@ sp<AIMovement> UnitAIHelper::getTakeCoverMovement(GameState &state, BattleUnit &
 	// Chance to take cover is 33% * sqrt(num_enemies_seen), if no one is seen then assume 3
 	if (!forced)
 	{
-		if (randBoundsExclusive(state.rng, 0, 100) >=
+		if (randBoundsExclusive(u.aiRng, 0, 100) >=
 		    33.0f * sqrtf(u.visibleEnemies.empty() ? 3 : (int)u.visibleEnemies.size()))
 		{
 			return nullptr;
 		}
-		// If already prone - ignore (for now, until we implement proper take cover)
-		if (u.movement_mode == MovementMode::Prone)
+	}
+
+	// Run to the nearby tile the fewest known enemies could fire at, of those the unit can reach
+	// cheaply enough
+	auto &battle = *state.current_battle;
+	Vec3<int> position = u.position;
+	int bestThreat = battle.threatField->getThreat(u.owner, position);
+	if (bestThreat > 0)
+	{
+		Vec3<int> bestPosition = position;
+		float bestCost = 0.0f;
+		auto costs =
+		    battle.map->findCostsAround(position, TAKE_COVER_MAX_COST, TAKE_COVER_MAX_ITERATIONS,
+		                                BattleUnitTileHelper(*battle.map, u));
+		for (auto &entry : costs)
 		{
-			return nullptr;
+			int threat = battle.threatField->getThreat(u.owner, entry.first);
+			if (threat > bestThreat || (threat == bestThreat && entry.second >= bestCost))
+			{
+				continue;
+			}
+			auto tile = battle.map->getTile(entry.first);
+			if (!tile->getCanStand(u.isLarge()) || tile->getUnitIfPresent())
+			{
+				continue;
+			}
+			bestThreat = threat;
+			bestPosition = entry.first;
+			bestCost = entry.second;
+		}
+		if (bestPosition != position)
+		{
+			auto result = mksp<AIMovement>();
+			result->type = AIMovement::Type::TakeCover;
+			result->movementMode = MovementMode::Running;
+			result->targetLocation = bestPosition;
+			return result;
 		}
 	}
 
-	LogWarning("Implement take cover (for now proning instead)");
-
-	if (!u.agent->isBodyStateAllowed(BodyState::Prone))
+	// No better cover around, at least make a smaller target
+	if (u.movement_mode == MovementMode::Prone || !u.agent->isBodyStateAllowed(BodyState::Prone))
 	{
 		return nullptr;
 	}
@@ -183,7 +185,7 @@ sp<AIMovement> UnitAIHelper::getKneelMovement(GameState &state, BattleUnit &u, b
 	if (!forced)
 	{
 		// Chance to kneel is 33% * sqrt(num_enemies_seen), if no one is seen then assume 3
-		if (randBoundsExclusive(state.rng, 0, 100) >=
+		if (randBoundsExclusive(u.aiRng, 0, 100) >=
 		    33.0f * sqrtf(u.visibleEnemies.empty() ? 3 : (int)u.visibleEnemies.size()))
 		{
 			return nullptr;
@@ -256,7 +258,7 @@ sp<AIMovement> UnitAIHelper::getPursueMovement(GameState &state, BattleUnit &u,
 {
 	// Chance to pursuit is 1% per morale point above 20
 	if (!forced &&
-	    randBoundsExclusive(state.rng, 0, 100) >= std::max(0, u.agent->modified_stats.morale - 20))
+	    randBoundsExclusive(u.aiRng, 0, 100) >= std::max(0, u.agent->modified_stats.morale - 20))
 	{
 		return nullptr;
 	}
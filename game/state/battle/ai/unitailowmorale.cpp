@@ -78,7 +78,7 @@ std::tuple<AIDecision, bool> UnitAILowMorale::think(GameState &state, BattleUnit
 					}
 					if (!adjacentBlocks.empty())
 					{
-						auto targetLB = listRandomiser(state.rng, adjacentBlocks);
+						auto targetLB = listRandomiser(u.aiRng, adjacentBlocks);
 						auto targetPos = state.current_battle->blockCenterPos[type][targetLB];
 						// Try 10 times to pick a valid position in that block, otherwise run to
 						// it's center
@@ -88,9 +88,9 @@ std::tuple<AIDecision, bool> UnitAILowMorale::think(GameState &state, BattleUnit
 						for (int i = 0; i < 10; i++)
 						{
 							auto randPos =
-							    Vec3<int>{randBoundsExclusive(state.rng, lb->start.x, lb->end.x),
-							              randBoundsExclusive(state.rng, lb->start.y, lb->end.y),
-							              randBoundsExclusive(state.rng, lb->start.z, lb->end.z)};
+							    Vec3<int>{randBoundsExclusive(u.aiRng, lb->start.x, lb->end.x),
+							              randBoundsExclusive(u.aiRng, lb->start.y, lb->end.y),
+							              randBoundsExclusive(u.aiRng, lb->start.z, lb->end.z)};
 							if (helper.canEnterTile(nullptr, map.getTile(randPos)))
 							{
 								targetPos = randPos;
@@ -103,7 +103,7 @@ std::tuple<AIDecision, bool> UnitAILowMorale::think(GameState &state, BattleUnit
 						decision.movement->kneelingMode = u.kneeling_mode;
 						// 33% chance to switch to run
 						decision.movement->movementMode =
-						    randBoundsExclusive(state.rng, 0, 100) < 33 ? MovementMode::Running
+						    randBoundsExclusive(u.aiRng, 0, 100) < 33 ? MovementMode::Running
 						                                                : u.movement_mode;
 					}
 				}
@@ -116,7 +116,7 @@ std::tuple<AIDecision, bool> UnitAILowMorale::think(GameState &state, BattleUnit
 				auto e2 = u.agent->getFirstItemInSlot(EquipmentSlotType::RightHand);
 				auto canFire = ((e1 && e1->canFire()) || (e2 && e2->canFire()));
 				// Roll for what kind of action we take with berserk
-				int roll = randBoundsExclusive(state.rng, 0, 100);
+				int roll = randBoundsExclusive(u.aiRng, 0, 100);
 				// 20% chance to attack a friendly, 40% chance to attack an enemy, 40% chance to
 				// attack random tile
 				int shootType = roll < 20 ? 1 : (roll < 60 ? 2 : 3);
@@ -141,7 +141,7 @@ std::tuple<AIDecision, bool> UnitAILowMorale::think(GameState &state, BattleUnit
 						}
 						if (!victims.empty())
 						{
-							auto victim = listRandomiser(state.rng, victims);
+							auto victim = listRandomiser(u.aiRng, victims);
 							if (!canFire)
 							{
 								decision.movement = mksp<AIMovement>();
@@ -167,7 +167,7 @@ std::tuple<AIDecision, bool> UnitAILowMorale::think(GameState &state, BattleUnit
 						// Pick a random visible enemy
 						if (!u.visibleEnemies.empty())
 						{
-							auto target = setRandomiser(state.rng, u.visibleEnemies);
+							auto target = setRandomiser(u.aiRng, u.visibleEnemies);
 							if (!canFire)
 							{
 								decision.movement = mksp<AIMovement>();
@@ -190,9 +190,9 @@ std::tuple<AIDecision, bool> UnitAILowMorale::think(GameState &state, BattleUnit
 					}
 					case 3:
 					{
-						int x = randBoundsInclusive(state.rng, -10, 10);
-						int y = randBoundsInclusive(state.rng, -10, 10);
-						int z = randBoundsInclusive(state.rng, -1, 1);
+						int x = randBoundsInclusive(u.aiRng, -10, 10);
+						int y = randBoundsInclusive(u.aiRng, -10, 10);
+						int z = randBoundsInclusive(u.aiRng, -1, 1);
 
 						auto targetPos = (Vec3<int>)u.position + Vec3<int>{x, y, z};
 						auto &map = u.tileObject->map;
@@ -141,7 +141,7 @@ UnitAIVanilla::getWeaponDecision(GameState &state, BattleUnit &u, sp<AEquipment>
 	float priority = cth * damage / time;
 
 	// Chance to advance is equal to chance to miss
-	if (randBoundsExclusive(state.rng, 0, 100) >= cth)
+	if (randBoundsExclusive(u.aiRng, 0, 100) >= cth)
 	{
 		movement->type = AIMovement::Type::Advance;
 		movement->targetLocation = target->position;
@@ -404,7 +404,7 @@ std::tuple<AIDecision, float, unsigned> UnitAIVanilla::getAttackDecision(GameSta
 	sp<AEquipment> grenade;
 
 	// List of stuff to actually use
-	std::list<sp<AEquipment>> items;
+	ArenaList<sp<AEquipment>> items;
 
 	bool brainsucker = false;
 	bool suicider = false;
@@ -749,8 +749,8 @@ std::tuple<AIDecision, bool> UnitAIVanilla::think(GameState &state, BattleUnit &
 		return NULLTUPLE2;
 	}
 
+	// The routine follows in AIBlockUnit::routine(), as it changes the unit
 	auto decision = thinkInternal(state, u);
-	routine(state, u);
 
 	if (!decision.isEmpty())
 	{
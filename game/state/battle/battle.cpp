@@ -1,4 +1,5 @@
 #include "game/state/battle/battle.h"
+#include "framework/configfile.h"
 #include "framework/framework.h"
 #include "framework/sound.h"
 #include "framework/trace.h"
@@ -30,18 +31,19 @@
 #include "game/state/rules/doodad_type.h"
 #include "game/state/tileview/collision.h"
 #include "game/state/tileview/tile.h"
-#include "game/state/tileview/tileobject_battlehazard.h"
 #include "game/state/tileview/tileobject_battleitem.h"
 #include "game/state/tileview/tileobject_battlemappart.h"
 #include "game/state/tileview/tileobject_battleunit.h"
 #include "game/state/tileview/tileobject_doodad.h"
 #include "game/state/tileview/tileobject_projectile.h"
 #include "game/state/tileview/tileobject_shadow.h"
+#include "library/arena.h"
 #include "library/strings_format.h"
 #include "library/xorshift.h"
 #include <algorithm>
 #include <glm/glm.hpp>
 #include <limits>
+#include <unordered_map>
 
 namespace OpenApoc
 {
@@ -57,6 +59,84 @@ static std::vector<std::set<TileObject::Type>> layerMap = {
      TileObject::Type::Hazard},
 };
 
+ConfigOptionBool parallelAIOption("Game", "ParallelAI",
+                                  "Let battle units decide what to do on multiple threads", true);
+
+namespace
+{
+// Minimum amount of units deciding in a tick to bother with threads
+static const int PARALLEL_AI_MIN_UNITS = 16;
+// Approximate amount of units given to each thread
+static const int PARALLEL_AI_UNITS_PER_BATCH = 8;
+
+// Units deciding on different threads must only read shared state. visibleEnemies adds a set for
+// an organisation on first lookup, so add them all here (StateRefs resolve safely on any thread)
+void prepareParallelAI(Battle &battle)
+{
+	for (auto &entry : battle.units)
+	{
+		battle.visibleEnemies[entry.second->owner];
+	}
+}
+
+// Map parts whose BattleMapPart::findSupport() might succeed now that 'part' found support: those
+// it could support directly, and those whose support lines could run through the row of its type
+// up to it (a line stops at a gap or at a part that already provides hard support)
+void findSupportDependents(TileMap &map, BattleMapPart &part,
+                           std::vector<BattleMapPart *> &dependents)
+{
+	dependents.clear();
+	auto pos = part.tileObject->getOwningTile()->position;
+	auto tileType = part.tileObject->getType();
+	for (int x = std::max(0, pos.x - 1); x <= std::min(map.size.x - 1, pos.x + 1); x++)
+	{
+		for (int y = std::max(0, pos.y - 1); y <= std::min(map.size.y - 1, pos.y + 1); y++)
+		{
+			for (int z = std::max(0, pos.z - 1); z <= std::min(map.size.z - 1, pos.z + 1); z++)
+			{
+				for (auto &o : map.getTile(x, y, z)->ownedObjects)
+				{
+					if (o->getType() == TileObject::Type::Ground ||
+					    o->getType() == TileObject::Type::Feature ||
+					    o->getType() == TileObject::Type::LeftWall ||
+					    o->getType() == TileObject::Type::RightWall)
+					{
+						auto mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner().get();
+						if (mp != &part)
+						{
+							dependents.push_back(mp);
+						}
+					}
+				}
+			}
+		}
+	}
+	static const Vec3<int> lineDirections[] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}};
+	for (auto &d : lineDirections)
+	{
+		for (auto p = pos + d; p.x >= 0 && p.x < map.size.x && p.y >= 0 && p.y < map.size.y;
+		     p += d)
+		{
+			// Lines only look at the last map part of the type in each tile
+			BattleMapPart *mp = nullptr;
+			for (auto &o : map.getTile(p)->ownedObjects)
+			{
+				if (o->getType() == tileType)
+				{
+					mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner().get();
+					dependents.push_back(mp);
+				}
+			}
+			if (!mp || mp->destroyed || mp->damaged || mp->falling ||
+			    (mp->providesHardSupport && !mp->willCollapse()))
+			{
+				break;
+			}
+		}
+	}
+}
+} // anonymous namespace
+
 Battle::~Battle()
 {
 	TRACE_FN;
@@ -100,6 +180,14 @@ Battle::~Battle()
 		i->item->ownerUnit.clear();
 	}
 	this->items.clear();
+	for (auto &d : this->doodads)
+	{
+		if (d->tileObject)
+			d->tileObject->removeFromMap();
+		d->tileObject = nullptr;
+	}
+	this->doodads.clear();
+	this->hazards.removeFromMap();
 	this->doors.clear();
 }
 
@@ -200,9 +288,14 @@ void Battle::initBattle(GameState &state, bool first)
 		}
 	}
 	// Hazards
-	for (auto &h : hazards)
+	for (auto h : hazards.getHazards())
+	{
+		hazards.updateTileVisionBlock(state, h);
+	}
+	// Map parts
+	for (auto &s : map_parts)
 	{
-		h->updateTileVisionBlock(state);
+		wakeMapPart(s);
 	}
 
 	// On first run, init support links and items, do vsibility and pathfinding, reset AI
@@ -211,7 +304,7 @@ void Battle::initBattle(GameState &state, bool first)
 		return;
 	}
 	initialMapPartRemoval(state);
-	initialMapPartLinkUp();
+	initialMapPartLinkUp(state);
 	for (auto &o : this->items)
 	{
 		o->tryCollapse();
@@ -236,19 +329,19 @@ void Battle::initBattle(GameState &state, bool first)
 	}
 	// Let pre-placed fires spawn smokes
 	StateRef<DamageType> dt = {&state, "DAMAGETYPE_INCENDIARY"};
-	std::list<sp<BattleHazard>> fires;
-	for (auto &h : hazards)
+	std::list<int> fires;
+	for (auto h : hazards.getHazards())
 	{
-		if (h->damageType == dt)
+		if (hazards.getDamageType(h) == dt)
 		{
 			fires.push_back(h);
 		}
 	}
-	for (auto &f : fires)
+	for (auto f : fires)
 	{
-		f->grow(state);
-		f->grow(state);
-		f->grow(state);
+		hazards.grow(state, f);
+		hazards.grow(state, f);
+		hazards.grow(state, f);
 	}
 	// Update units (uses TB function as that's the only thing that needs update)
 	for (auto &u : units)
@@ -284,10 +377,9 @@ void Battle::initMap()
 				exits.insert(s->position);
 			}
 		}
-		for (auto &h : this->hazards)
-		{
-			this->map->addObjectToMap(h);
-		}
+		this->exitField.reset(new BattleExitField(this->size));
+		this->threatField.reset(new BattleThreatField(this->size));
+		this->hazards.init(*this->map);
 		for (auto &o : this->items)
 		{
 			this->map->addObjectToMap(o);
@@ -437,8 +529,8 @@ void Battle::initialMapPartRemoval(GameState &state)
 					{
 						if (o->getType() == TileObject::Type::Ground)
 						{
-							partsToKill.push_back(
-							    std::static_pointer_cast<TileObjectBattleMapPart>(o));
+							partsToKill.push_back(std::static_pointer_cast<TileObjectBattleMapPart>(
+							    o->shared_from_this()));
 						}
 					}
 					for (auto &p : partsToKill)
@@ -456,70 +548,134 @@ void Battle::initialMapPartRemoval(GameState &state)
 	}
 }
 
-void Battle::initialMapPartLinkUp()
+void Battle::initialMapPartLinkUp(GameState &state)
 {
 	LogWarning("Begun initial map parts link up!");
 	auto &mapref = *map;
 
+	// Support is found for every map part bottom-up first, then parts are passed over again and
+	// again until no more find support. Only the parts next to one that found support can find it
+	// in another pass, so only those are looked at again, in the same order the full passes would
+	// look at them, which makes every part get its support from the same neighbour
+	std::vector<BattleMapPart *> parts;
+	std::unordered_map<BattleMapPart *, int> partIndex;
+	std::vector<std::vector<int>> partsByLevel(mapref.size.z);
 	for (auto &s : this->map_parts)
 	{
 		if (!s->destroyed)
 		{
-			s->queueCollapse();
+			s->queueCollapse(state);
+		}
+		int index = (int)parts.size();
+		parts.push_back(s.get());
+		partIndex[s.get()] = index;
+		int z = (int)s->position.z;
+		if (z >= 0 && z < mapref.size.z && !s->destroyed)
+		{
+			partsByLevel[z].push_back(index);
 		}
 	}
 
-	for (int z = 0; z < mapref.size.z; z++)
+	// Indices of parts to look at in the current and the next pass
+	std::set<int> currentPass;
+	std::set<int> nextPass;
+	std::vector<BattleMapPart *> dependents;
+	std::vector<bool> visited(parts.size(), false);
+	for (auto &level : partsByLevel)
 	{
-		for (auto &s : this->map_parts)
+		for (auto index : level)
 		{
-			if ((int)s->position.z == z && !s->destroyed && s->findSupport())
+			auto s = parts[index];
+			visited[index] = true;
+			if (!s->findSupport())
 			{
-				s->cancelCollapse();
+				continue;
 			}
+			s->cancelCollapse();
+			findSupportDependents(mapref, *s, dependents);
+			for (auto mp : dependents)
+			{
+				auto it = partIndex.find(mp);
+				if (it != partIndex.end() && visited[it->second] && mp->willCollapse())
+				{
+					currentPass.insert(it->second);
+				}
+			}
+		}
+	}
+	// Parts the bottom-up pass didn't reach would have been looked at by the first full pass
+	for (int index = 0; index < (int)parts.size(); index++)
+	{
+		if (!visited[index] && parts[index]->willCollapse())
+		{
+			currentPass.insert(index);
 		}
 	}
+
 	LogWarning("Begun map parts link up cycle!");
-	bool foundSupport;
 	// Establish support based on existing supported map parts
-	do
+	while (!currentPass.empty())
 	{
-		foundSupport = false;
-		for (auto &s : this->map_parts)
+		while (!currentPass.empty())
 		{
-			if (!s->willCollapse())
+			int index = *currentPass.begin();
+			currentPass.erase(currentPass.begin());
+			auto s = parts[index];
+			if (!s->willCollapse() || !s->findSupport())
 			{
 				continue;
 			}
-			if (s->findSupport())
+			s->cancelCollapse();
+			findSupportDependents(mapref, *s, dependents);
+			for (auto mp : dependents)
 			{
-				s->cancelCollapse();
-				foundSupport = true;
+				auto it = partIndex.find(mp);
+				if (it == partIndex.end() || !mp->willCollapse())
+				{
+					continue;
+				}
+				// A full pass would still get to parts after this one
+				if (it->second > index)
+				{
+					currentPass.insert(it->second);
+				}
+				else
+				{
+					nextPass.insert(it->second);
+				}
 			}
 		}
-	} while (foundSupport);
+		std::swap(currentPass, nextPass);
+	}
 
-	// Report unlinked parts
-	for (auto &mp : this->map_parts)
+	std::vector<BattleMapPart *> unlinked;
+	for (auto s : parts)
 	{
-		if (mp->willCollapse())
+		if (s->willCollapse())
 		{
-			auto pos = mp->tileObject->getOwningTile()->position;
-			LogWarning("MP %s SBT %d at %d %d %d is UNLINKED", mp->type.id,
-			           (int)mp->type->getVanillaSupportedById(), pos.x, pos.y, pos.z);
+			unlinked.push_back(s);
 		}
 	}
 
+	// Report unlinked parts
+	for (auto &mp : unlinked)
+	{
+		auto pos = mp->tileObject->getOwningTile()->position;
+		LogWarning("MP %s SBT %d at %d %d %d is UNLINKED", mp->type.id,
+		           (int)mp->type->getVanillaSupportedById(), pos.x, pos.y, pos.z);
+	}
+
 	LogWarning("Attempting link up of unlinked parts");
 	// Try to link to objects of same type first, then to anything
 	for (int iteration = 0; iteration <= 2; iteration++)
 	{
 		bool skipTypeCheck = iteration > 0;
 		bool skipHardCheck = iteration > 1;
+		bool foundSupport;
 		do
 		{
 			foundSupport = false;
-			for (auto &s : this->map_parts)
+			for (auto &s : unlinked)
 			{
 				if (!s->willCollapse())
 				{
@@ -535,7 +691,7 @@ void Battle::initialMapPartLinkUp()
 	}
 
 	// Report unlinked parts
-	for (auto &mp : this->map_parts)
+	for (auto &mp : unlinked)
 	{
 		if (mp->willCollapse())
 		{
@@ -1256,31 +1412,30 @@ sp<BattleItem> Battle::placeItem(GameState &state, sp<AEquipment> item, Vec3<flo
 	return bitem;
 }
 
-sp<BattleHazard> Battle::placeHazard(GameState &state, StateRef<Organisation> owner,
-                                     StateRef<BattleUnit> unit, StateRef<DamageType> type,
-                                     Vec3<int> position, int ttl, int power,
-                                     int initialAgeTTLDivizor, bool delayVisibility)
+int Battle::placeHazard(GameState &state, StateRef<Organisation> owner,
+                        StateRef<BattleUnit> unit, StateRef<DamageType> type, Vec3<int> position,
+                        int ttl, int power, int initialAgeTTLDivizor, bool delayVisibility)
 {
 	bool fire = type->hazardType->fire;
-	auto hazard = mksp<BattleHazard>(state, type, delayVisibility);
-	hazard->ownerOrganisation = owner;
-	hazard->ownerUnit = unit;
-	hazard->position = position;
-	hazard->position += Vec3<float>{0.5f, 0.5f, 0.5f};
+	BattleHazard hazard(state, type, delayVisibility);
+	hazard.ownerOrganisation = owner;
+	hazard.ownerUnit = unit;
+	hazard.position = position;
+	hazard.position += Vec3<float>{0.5f, 0.5f, 0.5f};
 	if (fire)
 	{
 		// lifetime means nothing for fire
-		hazard->lifetime = 0;
+		hazard.lifetime = 0;
 		// age means how "powerful" the fire is, where 10 is most powerful and 110 is almost dead
-		hazard->age = 100 - ttl * 6;
+		hazard.age = 100 - ttl * 6;
 		// Fire is growing, when fading this will be negative
-		hazard->power = randBoundsInclusive(state.rng, 1, 2);
+		hazard.power = randBoundsInclusive(state.rng, 1, 2);
 	}
 	else
 	{
-		hazard->lifetime = ttl;
-		hazard->age = hazard->lifetime * (initialAgeTTLDivizor - 1) / initialAgeTTLDivizor;
-		hazard->power = power;
+		hazard.lifetime = ttl;
+		hazard.age = hazard.lifetime * (initialAgeTTLDivizor - 1) / initialAgeTTLDivizor;
+		hazard.power = power;
 	}
 	// Remove existing hazard, ensure possible to do this, place this
 	if (map)
@@ -1290,41 +1445,38 @@ sp<BattleHazard> Battle::placeHazard(GameState &state, StateRef<Organisation> ow
 		// at
 		if ((!fire && tile->height * 40.0f > 38.0f) || (fire && tile->height * 40.0f < 1.0f))
 		{
-			return nullptr;
+			return -1;
 		}
 		// Clear existing hazards
-		sp<BattleHazard> existingHazard;
-		for (auto &obj : tile->ownedObjects)
-		{
-			if (obj->getType() == TileObject::Type::Hazard)
-			{
-				existingHazard = std::static_pointer_cast<TileObjectBattleHazard>(obj)->getHazard();
-			}
-		}
-		if (existingHazard)
+		int existingHazard = hazards.find(position);
+		if (existingHazard != -1)
 		{
 			// Fire cannot spread into another fire
-			if (fire && existingHazard->hazardType->fire)
+			if (fire && hazards.getHazardType(existingHazard)->fire)
 			{
-				return nullptr;
+				return -1;
 			}
 			else
 			{
 				// Nothing can spread into a fire that's eating up a feature
-				if (existingHazard->hazardType->fire)
+				if (hazards.getHazardType(existingHazard)->fire)
 				{
 					LogWarning(
 					    "Ensure we are not putting out a fire that is attached to a feature!");
 				}
-				existingHazard->die(state, false);
+				hazards.die(state, existingHazard, false);
 			}
 		}
-		map->addObjectToMap(hazard);
-		hazard->updateTileVisionBlock(state);
+		int index = hazards.add(hazard);
+		if (index != -1)
+		{
+			hazards.updateTileVisionBlock(state, index);
+		}
+		return index;
 	}
-	// Insert new hazard
-	hazards.insert(hazard);
-	return hazard;
+	// Kept aside until the map is built
+	hazards.add(hazard);
+	return -1;
 }
 
 sp<BattleScanner> Battle::addScanner(GameState &state, AEquipment &item)
@@ -1432,7 +1584,7 @@ void Battle::updateProjectiles(GameState &state, unsigned int ticks)
 
 void Battle::updateVision(GameState &state)
 {
-	std::set<sp<BattleUnit>> unitsToUpdate;
+	ArenaSet<sp<BattleUnit>> unitsToUpdate;
 	for (auto &entry : units)
 	{
 		auto unit = entry.second;
@@ -1666,8 +1818,8 @@ void Battle::update(GameState &state, unsigned int ticks)
 					    visibleUnits[currentPlayer].find({&state, u.first}) !=
 					        visibleUnits[currentPlayer].end())
 					{
-						fw().pushEvent(
-						    new GameLocationEvent(GameEventType::ZoomView, u.second->position));
+						state.events.raise<GameLocationEvent>(GameEventType::ZoomView,
+						                                      u.second->position);
 					}
 					break;
 				}
@@ -1745,11 +1897,7 @@ void Battle::update(GameState &state, unsigned int ticks)
 	}
 	Trace::end("Battle::update::doodads->update");
 	Trace::start("Battle::update::hazards->update");
-	for (auto it = this->hazards.begin(); it != this->hazards.end();)
-	{
-		auto d = *it++;
-		d->update(state, ticks);
-	}
+	hazards.update(state, ticks, mode == Mode::RealTime);
 	Trace::end("Battle::update::hazards->update");
 	Trace::start("Battle::update::explosions->update");
 	for (auto it = this->explosions.begin(); it != this->explosions.end();)
@@ -1759,9 +1907,20 @@ void Battle::update(GameState &state, unsigned int ticks)
 	}
 	Trace::end("Battle::update::explosions->update");
 	Trace::start("Battle::update::map_parts->update");
-	for (auto &o : this->map_parts)
+	// Parts woken up during the update are appended and updated in the same pass
+	for (auto it = this->awakeMapParts.begin(); it != this->awakeMapParts.end();)
 	{
+		auto o = *it;
 		o->update(state, ticks);
+		if (o->needsUpdate())
+		{
+			it++;
+		}
+		else
+		{
+			o->awake = false;
+			it = this->awakeMapParts.erase(it);
+		}
 	}
 	Trace::end("Battle::update::map_parts->update");
 	Trace::start("Battle::update::items->update");
@@ -1783,6 +1942,12 @@ void Battle::update(GameState &state, unsigned int ticks)
 		o.second->update(state, ticks);
 	}
 	Trace::end("Battle::update::units->update");
+	Trace::start("Battle::update::threat");
+	threatField->update(*this);
+	Trace::end("Battle::update::threat");
+	Trace::start("Battle::update::units->think");
+	updateUnitAI(state);
+	Trace::end("Battle::update::units->think");
 	Trace::start("Battle::update::ai->think");
 	{
 		auto result = aiBlock.think(state);
@@ -1804,6 +1969,84 @@ void Battle::update(GameState &state, unsigned int ticks)
 	Trace::end("Battle::update::pathfinding");
 }
 
+void Battle::updateUnitAI(GameState &state)
+{
+	std::vector<sp<BattleUnit>> deciding;
+	bool anyThinking = false;
+	for (auto &entry : this->units)
+	{
+		auto &u = entry.second;
+		if (u->destroyed || u->retreated || !u->isConscious())
+		{
+			continue;
+		}
+		deciding.push_back(u);
+		anyThinking = anyThinking || u->aiList.isThinkDue(state, *u);
+	}
+	// Every unit gets its own random numbers, so that what one unit decides doesn't depend on how
+	// many random numbers the units deciding before it used, or on which thread it decides. Only
+	// draw from the game's generator when someone is going to use them
+	if (anyThinking)
+	{
+		auto seed = state.rng();
+		uint64_t unitIndex = 0;
+		for (auto &entry : this->units)
+		{
+			entry.second->aiRng = Xorshift128Plus<uint32_t>(seed + unitIndex++);
+		}
+	}
+
+	// Decide, against the battle as it is after every unit has updated
+	int unitCount = deciding.size();
+	std::vector<AIDecision> decisions(unitCount);
+	auto decideRange = [&](int begin, int end) {
+		for (int i = begin; i < end; i++)
+		{
+			decisions[i] = deciding[i]->aiList.decide(state, *deciding[i]);
+		}
+	};
+	int batchCount = 1;
+	if (parallelAIOption.get() && unitCount >= PARALLEL_AI_MIN_UNITS)
+	{
+		batchCount = clamp(unitCount / PARALLEL_AI_UNITS_PER_BATCH, 1, fw().threadPoolGetSize());
+	}
+	if (batchCount == 1)
+	{
+		decideRange(0, unitCount);
+	}
+	else
+	{
+		prepareParallelAI(*this);
+		std::vector<std::shared_future<void>> tasks;
+		for (int i = 1; i < batchCount; i++)
+		{
+			tasks.push_back(fw().threadPoolEnqueue([&, i]() {
+				decideRange(i * unitCount / batchCount, (i + 1) * unitCount / batchCount);
+			}));
+		}
+		// This thread takes the first batch instead of idling
+		decideRange(0, unitCount / batchCount);
+		for (auto &task : tasks)
+		{
+			task.get();
+		}
+	}
+
+	// Carry the decisions out in the order of the units
+	for (int i = 0; i < unitCount; i++)
+	{
+		auto &u = *deciding[i];
+		u.aiList.routine(state, u);
+		auto &decision = decisions[i];
+		if (decision.isEmpty() || !u.isConscious())
+		{
+			continue;
+		}
+		LogWarning("AI %s for unit %s decided to %s", decision.ai, u.id, decision.getName());
+		u.executeAIDecision(state, decision);
+	}
+}
+
 void Battle::updateTBBegin(GameState &state)
 {
 	notifyAction();
@@ -1834,14 +2077,7 @@ void Battle::updateTBBegin(GameState &state)
 void Battle::updateTBEnd(GameState &state)
 {
 	Trace::start("Battle::updateTBEnd::hazards->update");
-	for (auto it = this->hazards.begin(); it != this->hazards.end();)
-	{
-		auto d = *it++;
-		if (d->ownerOrganisation == currentActiveOrganisation)
-		{
-			d->updateTB(state);
-		}
-	}
+	hazards.updateTB(state, currentActiveOrganisation);
 	Trace::end("Battle::updateTBEnd::hazards->update");
 	Trace::start("Battle::updateTBEnd::items->update");
 	for (auto it = this->items.begin(); it != this->items.end();)
@@ -1870,7 +2106,24 @@ void Battle::setVisible(StateRef<Organisation> org, int x, int y, int z, bool va
 	visibleTiles[org][z * size.x * size.y + y * size.x + x] = val;
 }
 
-void Battle::queueVisionRefresh(Vec3<int> tile) { tilesChangedForVision.insert(tile); }
+void Battle::queueVisionRefresh(Vec3<int> tile)
+{
+	tilesChangedForVision.insert(tile);
+	if (threatField)
+	{
+		threatField->mapChanged(tile);
+	}
+}
+
+void Battle::wakeMapPart(sp<BattleMapPart> mapPart)
+{
+	if (mapPart->awake || !mapPart->needsUpdate())
+	{
+		return;
+	}
+	mapPart->awake = true;
+	awakeMapParts.push_back(mapPart);
+}
 
 void Battle::notifyScanners(Vec3<int> position)
 {
@@ -2003,7 +2256,7 @@ void Battle::checkIfBuildingDisabled(GameState &state)
 	}
 	// Found nothing, building disabled
 	buildingDisabled = true;
-	fw().pushEvent(new GameEvent(GameEventType::BuildingDisabled));
+	state.events.raise<GameEvent>(GameEventType::BuildingDisabled);
 }
 
 void Battle::refreshLeadershipBonus(StateRef<Organisation> org)
@@ -2099,6 +2352,10 @@ void Battle::spawnReinforcements(GameState &state)
 
 void Battle::queuePathfindingRefresh(Vec3<int> tile)
 {
+	if (exitField)
+	{
+		exitField->invalidate();
+	}
 	blockNeedsUpdate[getLosBlockID(tile.x, tile.y, tile.z)] = true;
 	auto tXgt0 = tile.x > 0;
 	auto tYgt0 = tile.y > 0;
@@ -2223,7 +2480,7 @@ void Battle::beginTurn(GameState &state)
 		ticksWithoutSeenAction[p] = TICKS_PER_TURN;
 	}
 
-	fw().pushEvent(new GameBattleEvent(GameEventType::NewTurn, shared_from_this()));
+	state.events.raise<GameBattleEvent>(GameEventType::NewTurn, shared_from_this());
 }
 
 void Battle::endTurn(GameState &state)
@@ -2283,7 +2540,7 @@ void Battle::giveInterruptChanceToUnit(GameState &state, StateRef<BattleUnit> gi
 			receiver->aiList.reset(state, *receiver);
 			if (interruptQueue.empty())
 			{
-				fw().pushEvent(new GameLocationEvent(GameEventType::ZoomView, receiver->position));
+				state.events.raise<GameLocationEvent>(GameEventType::ZoomView, receiver->position);
 			}
 			interruptQueue.emplace(receiver, receiver->agent->getTULimit(reactionValue));
 			receiver->experiencePoints.reactions++;
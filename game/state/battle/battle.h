@@ -3,8 +3,11 @@
 #include "game/state/agent.h"
 #include "game/state/battle/ai/aitype.h"
 #include "game/state/battle/ai/tacticalai.h"
+#include "game/state/battle/battleexitfield.h"
 #include "game/state/battle/battleforces.h"
+#include "game/state/battle/battlehazardfield.h"
 #include "game/state/battle/battlemapsector.h"
+#include "game/state/battle/battlethreatfield.h"
 #include "game/state/gametime.h"
 #include "game/state/stateobject.h"
 #include "library/sp.h"
@@ -143,6 +146,8 @@ class Battle : public std::enable_shared_from_this<Battle>
 	StateRef<Vehicle> player_craft;
 
 	std::list<sp<BattleMapPart>> map_parts;
+	// Map parts that have something to update, not serialized but rebuilt in initBattle
+	std::list<sp<BattleMapPart>> awakeMapParts;
 	std::list<sp<BattleItem>> items;
 	StateRefMap<BattleUnit> units;
 	StateRefMap<BattleScanner> scanners;
@@ -150,9 +155,13 @@ class Battle : public std::enable_shared_from_this<Battle>
 	std::set<sp<Projectile>> projectiles;
 	StateRefMap<BattleDoor> doors;
 	std::set<sp<BattleExplosion>> explosions;
-	std::set<sp<BattleHazard>> hazards;
+	BattleHazardField hazards;
 
 	up<TileMap> map;
+	// Not serialized, found again from the exits when needed
+	up<BattleExitField> exitField;
+	// Not serialized, found again from the units when the battle is loaded
+	up<BattleThreatField> threatField;
 
 	std::list<StateRef<Organisation>> participants;
 	std::map<StateRef<Organisation>, int> leadershipBonus;
@@ -201,7 +210,7 @@ class Battle : public std::enable_shared_from_this<Battle>
 	void initMap();
 	bool initialMapCheck(GameState &state, std::list<StateRef<Agent>> agents);
 	void initialMapPartRemoval(GameState &state);
-	void initialMapPartLinkUp();
+	void initialMapPartLinkUp(GameState &state);
 
 	void initialUnitSpawn(GameState &state);
 
@@ -222,6 +231,9 @@ class Battle : public std::enable_shared_from_this<Battle>
 	// Queue tile for vision update
 	void queueVisionRefresh(Vec3<int> tile);
 
+	// Make map part updated every tick until it has nothing left to update
+	void wakeMapPart(sp<BattleMapPart> mapPart);
+
 	// Notify scanners about movement at position
 	void notifyScanners(Vec3<int> position);
 
@@ -241,6 +253,8 @@ class Battle : public std::enable_shared_from_this<Battle>
 
 	void updateProjectiles(GameState &state, unsigned int ticks);
 	void updateVision(GameState &state);
+	// Units decide what to do next, on multiple threads, then carry it out one after another
+	void updateUnitAI(GameState &state);
 	void updatePathfinding(GameState &state);
 
 	// Adding objects to battle
@@ -259,10 +273,10 @@ class Battle : public std::enable_shared_from_this<Battle>
 	sp<BattleUnit> placeUnit(GameState &state, StateRef<Agent> agent);
 	sp<BattleUnit> placeUnit(GameState &state, StateRef<Agent> agent, Vec3<float> position);
 	sp<BattleItem> placeItem(GameState &state, sp<AEquipment> item, Vec3<float> position);
-	sp<BattleHazard> placeHazard(GameState &state, StateRef<Organisation> owner,
-	                             StateRef<BattleUnit> unit, StateRef<DamageType> type,
-	                             Vec3<int> position, int ttl, int power,
-	                             int initialAgeTTLDivizor = 1, bool delayVisibility = true);
+	// Returns the hazard's index in the hazard field, -1 if it wasn't placed on the map
+	int placeHazard(GameState &state, StateRef<Organisation> owner, StateRef<BattleUnit> unit,
+	                StateRef<DamageType> type, Vec3<int> position, int ttl, int power,
+	                int initialAgeTTLDivizor = 1, bool delayVisibility = true);
 	sp<BattleScanner> addScanner(GameState &state, AEquipment &item);
 	void removeScanner(GameState &state, AEquipment &item);
 
@@ -0,0 +1,147 @@
+#include "game/state/battle/battleexitfield.h"
+#include "game/state/battle/battleunit.h"
+#include "game/state/battle/battleunitmission.h"
+#include "game/state/tileview/tile.h"
+#include <functional>
+#include <queue>
+
+namespace OpenApoc
+{
+
+BattleExitField::BattleExitField(Vec3<int> size) : size(size) {}
+
+int BattleExitField::getIndex(Vec3<int> position) const
+{
+	return position.z * size.x * size.y + position.y * size.x + position.x;
+}
+
+void BattleExitField::invalidate()
+{
+	std::lock_guard<std::mutex> l(lock);
+	for (auto &f : fields)
+	{
+		f.second.valid = false;
+	}
+}
+
+bool BattleExitField::findExit(TileMap &map, std::set<Vec3<int>> &exits, BattleUnitType type,
+                               Vec3<int> position, Vec3<int> &exit)
+{
+	std::lock_guard<std::mutex> l(lock);
+	auto &field = getField(map, exits, type);
+	if (!map.tileIsValid(position))
+	{
+		return false;
+	}
+	auto index = getIndex(position);
+	if (field.exit[index] == -1)
+	{
+		return false;
+	}
+	exit = field.exits[field.exit[index]];
+	return true;
+}
+
+BattleExitField::Field &BattleExitField::getField(TileMap &map, std::set<Vec3<int>> &exits,
+                                                  BattleUnitType type)
+{
+	auto &field = fields[type];
+	if (!field.valid)
+	{
+		build(field, map, exits, type);
+	}
+	return field;
+}
+
+// Dijkstra from every exit at once, walking the moves units make backwards: a tile is reached from
+// its neighbour if a unit could move from the tile to the neighbour. Units are ignored as they
+// will have moved by the time a retreating unit gets there, and so are jumps, which only ever
+// shorten a way that exists without them
+void BattleExitField::build(Field &field, TileMap &map, std::set<Vec3<int>> &exits,
+                            BattleUnitType type)
+{
+	BattleUnitTileHelper helper(map, type);
+	auto tileCount = size.x * size.y * size.z;
+	field.cost.assign(tileCount, -1.0f);
+	field.exit.assign(tileCount, -1);
+	field.exits.clear();
+
+	using Node = std::pair<float, int>;
+	std::priority_queue<Node, std::vector<Node>, std::greater<Node>> fringe;
+	for (auto it = exits.begin(); it != exits.end();)
+	{
+		auto tile = map.getTile(*it);
+		if (!tile->hasExit)
+		{
+			it = exits.erase(it);
+			continue;
+		}
+		if (helper.canEnterTile(nullptr, tile, false, true))
+		{
+			auto index = getIndex(*it);
+			field.cost[index] = 0.0f;
+			field.exit[index] = (int)field.exits.size();
+			fringe.emplace(0.0f, index);
+		}
+		field.exits.push_back(*it);
+		it++;
+	}
+
+	std::vector<bool> expanded(tileCount, false);
+	while (!fringe.empty())
+	{
+		auto node = fringe.top();
+		fringe.pop();
+		if (expanded[node.second])
+		{
+			continue;
+		}
+		expanded[node.second] = true;
+
+		Vec3<int> position{node.second % size.x, (node.second / size.x) % size.y,
+		                   node.second / (size.x * size.y)};
+		auto tile = map.getTile(position);
+		for (int z = -1; z <= 1; z++)
+		{
+			for (int y = -1; y <= 1; y++)
+			{
+				for (int x = -1; x <= 1; x++)
+				{
+					if (x == 0 && y == 0 && z == 0)
+					{
+						continue;
+					}
+					auto fromPosition = position + Vec3<int>{x, y, z};
+					if (!map.tileIsValid(fromPosition))
+					{
+						continue;
+					}
+					auto fromIndex = getIndex(fromPosition);
+					if (expanded[fromIndex])
+					{
+						continue;
+					}
+					float cost = 0.0f;
+					bool jumped = false;
+					bool doorInTheWay = false;
+					if (!helper.canEnterTile(map.getTile(fromPosition), tile, false, jumped, cost,
+					                         doorInTheWay, false, true))
+					{
+						continue;
+					}
+					auto newCost = node.first + cost;
+					if (field.cost[fromIndex] >= 0.0f && field.cost[fromIndex] <= newCost)
+					{
+						continue;
+					}
+					field.cost[fromIndex] = newCost;
+					field.exit[fromIndex] = field.exit[node.second];
+					fringe.emplace(newCost, fromIndex);
+				}
+			}
+		}
+	}
+	field.valid = true;
+}
+
+} // namespace OpenApoc
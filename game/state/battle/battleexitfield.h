@@ -0,0 +1,53 @@
+#pragma once
+
+#include "library/vec.h"
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class TileMap;
+enum class BattleUnitType;
+
+// Cost of the way from every tile of a battle to its closest exit, for every kind of unit, so that
+// a retreating unit finds its exit with a lookup instead of a path search to every exit.
+// A field is found with one search outwards from all the exits at once the first time it's needed,
+// and found again after the map changed. Units deciding to retreat on different threads may look
+// up exits at the same time
+class BattleExitField
+{
+  public:
+	BattleExitField(Vec3<int> size);
+
+	// Returns false if a unit of 'type' can't reach any exit from 'position'. Exits that stopped
+	// being exits are dropped from 'exits'
+	bool findExit(TileMap &map, std::set<Vec3<int>> &exits, BattleUnitType type,
+	              Vec3<int> position, Vec3<int> &exit);
+
+	void invalidate();
+
+  private:
+	class Field
+	{
+	  public:
+		bool valid = false;
+		std::vector<float> cost;
+		// Index into exits of the exit each tile's way leads to
+		std::vector<int> exit;
+		std::vector<Vec3<int>> exits;
+	};
+
+	Vec3<int> size;
+	std::map<BattleUnitType, Field> fields;
+	// Guards the fields while they're looked up or found
+	std::mutex lock;
+
+	int getIndex(Vec3<int> position) const;
+	Field &getField(TileMap &map, std::set<Vec3<int>> &exits, BattleUnitType type);
+	void build(Field &field, TileMap &map, std::set<Vec3<int>> &exits, BattleUnitType type);
+};
+
+} // namespace OpenApoc
@@ -3,7 +3,6 @@
 #include "framework/logger.h"
 #include "framework/sound.h"
 #include "game/state/battle/battle.h"
-#include "game/state/battle/battlehazard.h"
 #include "game/state/battle/battleitem.h"
 #include "game/state/battle/battlemappart.h"
 #include "game/state/battle/battlemappart_type.h"
@@ -12,15 +11,97 @@
 #include "game/state/rules/damage.h"
 #include "game/state/rules/doodad_type.h"
 #include "game/state/tileview/tile.h"
-#include "game/state/tileview/tileobject_battlehazard.h"
 #include "game/state/tileview/tileobject_battleitem.h"
 #include "game/state/tileview/tileobject_battlemappart.h"
 #include "game/state/tileview/tileobject_battleunit.h"
+#include "library/arena.h"
 #include "library/strings_format.h"
 #include <cmath>
 
 namespace OpenApoc
 {
+
+namespace
+{
+// Map parts of the types in 'types' (a mask of TileObject::Type bits) at 'offset' from the tile an
+// explosion expands from block it
+class ExpansionBlocker
+{
+  public:
+	Vec3<int> offset;
+	unsigned types;
+	ExpansionBlocker(Vec3<int> offset, std::initializer_list<TileObject::Type> typeList)
+	    : offset(offset), types(0)
+	{
+		for (auto t : typeList)
+		{
+			types |= 1u << (unsigned)t;
+		}
+	}
+};
+
+int getDirectionIndex(const Vec3<int> &dir)
+{
+	return (dir.z + 1) * 9 + (dir.y + 1) * 3 + dir.x + 1;
+}
+
+std::vector<std::vector<ExpansionBlocker>> buildExpansionBlockers()
+{
+	std::vector<std::vector<ExpansionBlocker>> blockers(27);
+	// Vertical
+	blockers[getDirectionIndex({0, 0, 1})] = {
+	    {{0, 0, 1}, {TileObject::Type::Ground, TileObject::Type::Feature}}};
+	blockers[getDirectionIndex({0, 0, -1})] = {{{0, 0, 0}, {TileObject::Type::Ground}},
+	                                           {{0, 0, -1}, {TileObject::Type::Feature}}};
+	// Horizontal direct
+	blockers[getDirectionIndex({0, -1, 0})] = {{{0, 0, 0}, {TileObject::Type::RightWall}},
+	                                           {{0, -1, 0}, {TileObject::Type::Feature}}};
+	blockers[getDirectionIndex({0, 1, 0})] = {{{0, 1, 0}, {TileObject::Type::RightWall}},
+	                                          {{0, 1, 0}, {TileObject::Type::Feature}}};
+	blockers[getDirectionIndex({-1, 0, 0})] = {{{0, 0, 0}, {TileObject::Type::LeftWall}},
+	                                           {{-1, 0, 0}, {TileObject::Type::Feature}}};
+	blockers[getDirectionIndex({1, 0, 0})] = {{{1, 0, 0}, {TileObject::Type::LeftWall}},
+	                                          {{1, 0, 0}, {TileObject::Type::Feature}}};
+	// Horizontal top-left
+	blockers[getDirectionIndex({-1, -1, 0})] = {
+	    {{-1, -1, 0}, {TileObject::Type::Feature}}, {{-1, 0, 0}, {TileObject::Type::Feature}},
+	    {{0, -1, 0}, {TileObject::Type::Feature}},  {{-1, 0, 0}, {TileObject::Type::RightWall}},
+	    {{0, -1, 0}, {TileObject::Type::LeftWall}}, {{0, 0, 0}, {TileObject::Type::RightWall}},
+	    {{0, 0, 0}, {TileObject::Type::LeftWall}},
+	};
+	// Horizontal bottom-right
+	blockers[getDirectionIndex({1, 1, 0})] = {
+	    {{1, 1, 0}, {TileObject::Type::Feature}},  {{0, 1, 0}, {TileObject::Type::Feature}},
+	    {{1, 0, 0}, {TileObject::Type::Feature}},  {{0, 1, 0}, {TileObject::Type::RightWall}},
+	    {{1, 0, 0}, {TileObject::Type::LeftWall}}, {{1, 1, 0}, {TileObject::Type::RightWall}},
+	    {{1, 1, 0}, {TileObject::Type::LeftWall}},
+	};
+	// Horizontal top-right
+	blockers[getDirectionIndex({1, -1, 0})] = {
+	    {{1, -1, 0}, {TileObject::Type::Feature}},  {{1, 0, 0}, {TileObject::Type::Feature}},
+	    {{0, -1, 0}, {TileObject::Type::Feature}},  {{0, 0, 0}, {TileObject::Type::RightWall}},
+	    {{1, -1, 0}, {TileObject::Type::LeftWall}}, {{1, 0, 0}, {TileObject::Type::RightWall}},
+	    {{1, 0, 0}, {TileObject::Type::LeftWall}},
+	};
+	// Horizontal bottom-left
+	blockers[getDirectionIndex({-1, 1, 0})] = {
+	    {{-1, 1, 0}, {TileObject::Type::Feature}},  {{-1, 0, 0}, {TileObject::Type::Feature}},
+	    {{0, 1, 0}, {TileObject::Type::Feature}},   {{-1, 1, 0}, {TileObject::Type::RightWall}},
+	    {{0, 0, 0}, {TileObject::Type::LeftWall}},  {{0, 1, 0}, {TileObject::Type::RightWall}},
+	    {{0, 1, 0}, {TileObject::Type::LeftWall}},
+	};
+	return blockers;
+}
+
+// What blocks an explosion going in 'dir', looked up by index instead of searching a map every
+// time a tile is expanded into
+const std::vector<ExpansionBlocker> &getExpansionBlockers(const Vec3<int> &dir)
+{
+	static const std::vector<std::vector<ExpansionBlocker>> blockers = buildExpansionBlockers();
+	return blockers[getDirectionIndex(dir)];
+}
+} // anonymous namespace
+
 BattleExplosion::BattleExplosion(Vec3<int> position, StateRef<DamageType> damageType, int power,
                                  int depletionRate, bool damageInTheEnd,
                                  StateRef<Organisation> ownerOrg, StateRef<BattleUnit> ownerUnit)
@@ -45,23 +126,9 @@ void BattleExplosion::die(GameState &state)
 		}
 	}
 	// Hack to make all hazards update at once
-	auto &map = *state.current_battle->map;
 	for (auto &pos : locationsVisited)
 	{
-		auto tile = map.getTile(pos.x, pos.y, pos.z);
-		sp<BattleHazard> existingHazard;
-		for (auto &obj : tile->ownedObjects)
-		{
-			if (obj->getType() == TileObject::Type::Hazard)
-			{
-				existingHazard = std::static_pointer_cast<TileObjectBattleHazard>(obj)->getHazard();
-				break;
-			}
-		}
-		if (existingHazard)
-		{
-			existingHazard->nextUpdateTicksAccumulated = 0;
-		}
+		state.current_battle->hazards.restartUpdateTimer(pos);
 	}
 }
 
@@ -102,10 +169,15 @@ void BattleExplosion::damage(GameState &state, const TileMap &map, Vec3<int> pos
 	// Gas does no direct damage
 	if (damageType->doesImpactDamage())
 	{
-		auto set = tile->ownedObjects;
-		for (auto &obj : set)
+		// Damage can move or destroy objects, so go through a snapshot that keeps them alive
+		ArenaVector<sp<TileObject>> objects;
+		for (auto &obj : tile->ownedObjects)
 		{
-			if (tile->ownedObjects.find(obj) == tile->ownedObjects.end())
+			objects.push_back(obj->shared_from_this());
+		}
+		for (auto &obj : objects)
+		{
+			if (!tile->ownedObjects.contains(obj.get()))
 			{
 				continue;
 			}
@@ -181,94 +253,36 @@ void BattleExplosion::damage(GameState &state, const TileMap &map, Vec3<int> pos
 void BattleExplosion::expand(GameState &state, const TileMap &map, const Vec3<int> &from,
                              const Vec3<int> &to, int nextPower)
 {
-	// list of coordinates to check
-	static const std::map<Vec3<int>, std::list<std::pair<Vec3<int>, std::set<TileObject::Type>>>>
-	    searchPattern = {
-	        // Vertical
-	        {{0, 0, 1}, {{{0, 0, 1}, {TileObject::Type::Ground, TileObject::Type::Feature}}}},
-	        {{0, 0, -1},
-	         {{{0, 0, 0}, {TileObject::Type::Ground}}, {{0, 0, -1}, {TileObject::Type::Feature}}}},
-	        // Horizontal direct
-	        {{0, -1, 0},
-	         {{{0, 0, 0}, {TileObject::Type::RightWall}},
-	          {{0, -1, 0}, {TileObject::Type::Feature}}}},
-	        {{0, 1, 0},
-	         {{{0, 1, 0}, {TileObject::Type::RightWall}},
-	          {{0, 1, 0}, {TileObject::Type::Feature}}}},
-	        {{-1, 0, 0},
-	         {{{0, 0, 0}, {TileObject::Type::LeftWall}},
-	          {{-1, 0, 0}, {TileObject::Type::Feature}}}},
-	        {{1, 0, 0},
-	         {{{1, 0, 0}, {TileObject::Type::LeftWall}}, {{1, 0, 0}, {TileObject::Type::Feature}}}},
-	        // Horizontal top-left
-	        {{-1, -1, 0},
-	         {
-	             {{-1, -1, 0}, {TileObject::Type::Feature}},
-	             {{-1, 0, 0}, {TileObject::Type::Feature}},
-	             {{0, -1, 0}, {TileObject::Type::Feature}},
-	             {{-1, 0, 0}, {TileObject::Type::RightWall}},
-	             {{0, -1, 0}, {TileObject::Type::LeftWall}},
-	             {{0, 0, 0}, {TileObject::Type::RightWall}},
-	             {{0, 0, 0}, {TileObject::Type::LeftWall}},
-	         }},
-	        // Horizontal bottom-right
-	        {{1, 1, 0},
-	         {
-	             {{1, 1, 0}, {TileObject::Type::Feature}},
-	             {{0, 1, 0}, {TileObject::Type::Feature}},
-	             {{1, 0, 0}, {TileObject::Type::Feature}},
-	             {{0, 1, 0}, {TileObject::Type::RightWall}},
-	             {{1, 0, 0}, {TileObject::Type::LeftWall}},
-	             {{1, 1, 0}, {TileObject::Type::RightWall}},
-	             {{1, 1, 0}, {TileObject::Type::LeftWall}},
-	         }},
-	        // Horizontal top-right
-	        {{1, -1, 0},
-	         {
-	             {{1, -1, 0}, {TileObject::Type::Feature}},
-	             {{1, 0, 0}, {TileObject::Type::Feature}},
-	             {{0, -1, 0}, {TileObject::Type::Feature}},
-	             {{0, 0, 0}, {TileObject::Type::RightWall}},
-	             {{1, -1, 0}, {TileObject::Type::LeftWall}},
-	             {{1, 0, 0}, {TileObject::Type::RightWall}},
-	             {{1, 0, 0}, {TileObject::Type::LeftWall}},
-	         }},
-	        // Horizontal bottom-left
-	        {{-1, 1, 0},
-	         {
-	             {{-1, 1, 0}, {TileObject::Type::Feature}},
-	             {{-1, 0, 0}, {TileObject::Type::Feature}},
-	             {{0, 1, 0}, {TileObject::Type::Feature}},
-	             {{-1, 1, 0}, {TileObject::Type::RightWall}},
-	             {{0, 0, 0}, {TileObject::Type::LeftWall}},
-	             {{0, 1, 0}, {TileObject::Type::RightWall}},
-	             {{0, 1, 0}, {TileObject::Type::LeftWall}},
-	         }},
-	    };
-
 	if (to.x < 0 || to.x >= map.size.x || to.y < 0 || to.y >= map.size.y || to.z < 0 ||
-	    to.z >= map.size.z || nextPower < 2 * depletionRate ||
-	    locationsVisited.find(to) != locationsVisited.end())
+	    to.z >= map.size.z || nextPower < 2 * depletionRate)
 	{
 		return;
 	}
+	// Most tiles are reached from several neighbours, so check the dense copy before the set
+	auto visitedIndex = (to.z * map.size.y + to.y) * map.size.x + to.x;
+	if (visitedTiles[visitedIndex])
+	{
+		return;
+	}
+	visitedTiles[visitedIndex] = true;
 	locationsVisited.insert(to);
 	auto dir = to - from;
 	int depletionThis = 0;
 	int depletionNext = 0;
 
 	// Deplete explosion according to map parts encountered
-	for (auto &pair : searchPattern.at(dir))
+	for (auto &blocker : getExpansionBlockers(dir))
 	{
-		auto pos = pair.first + from;
+		auto pos = blocker.offset + from;
 		auto tile = map.getTile(pos);
 		for (auto &obj : tile->ownedObjects)
 		{
-			if (pair.second.find(obj->getType()) != pair.second.end())
+			if (blocker.types & (1u << (unsigned)obj->getType()))
 			{
-				auto mp = std::static_pointer_cast<TileObjectBattleMapPart>(obj)->getOwner();
+				auto mp = static_cast<TileObjectBattleMapPart *>(obj)->getOwner();
 
-				int depletion = 2 * mp->type->block[damageType->blockType];
+				auto it = mp->type->block.find(damageType->blockType);
+				int depletion = it != mp->type->block.end() ? 2 * it->second : 0;
 
 				depletionNext = std::max(depletionNext, depletion);
 				// Feature in target tile does not block damage to the tile
@@ -320,8 +334,7 @@ void BattleExplosion::expand(GameState &state, const TileMap &map, const Vec3<in
 						velocity.x = 0;
 				}
 			}
-			doodadType = {&state,
-			              format("DOODAD_BATTLE_EXPLOSION_%d%d", velocity.x + 1, velocity.y + 1)};
+			doodadType = directionDoodads[(velocity.x + 1) * 3 + velocity.y + 1];
 		}
 		Vec3<float> doodadPos = to;
 		doodadPos += Vec3<float>{0.5f, 0.5f, 0.5f};
@@ -329,9 +342,33 @@ void BattleExplosion::expand(GameState &state, const TileMap &map, const Vec3<in
 	}
 }
 
+void BattleExplosion::prepareGrowth(GameState &state, const TileMap &map)
+{
+	if (visitedTiles.empty())
+	{
+		visitedTiles.resize(map.size.x * map.size.y * map.size.z, false);
+		for (auto &pos : locationsVisited)
+		{
+			visitedTiles[(pos.z * map.size.y + pos.y) * map.size.x + pos.x] = true;
+		}
+	}
+	if (directionDoodads.empty() && !damageType->explosionDoodad)
+	{
+		for (int x = 0; x < 3; x++)
+		{
+			for (int y = 0; y < 3; y++)
+			{
+				directionDoodads.emplace_back(&state,
+				                              format("DOODAD_BATTLE_EXPLOSION_%d%d", x, y));
+			}
+		}
+	}
+}
+
 void BattleExplosion::grow(GameState &state)
 {
 	auto &map = *state.current_battle->map;
+	prepareGrowth(state, map);
 
 	state.current_battle->notifyAction(position);
 
@@ -4,6 +4,7 @@
 #include "library/sp.h"
 #include "library/vec.h"
 #include <set>
+#include <vector>
 
 namespace OpenApoc
 {
@@ -12,6 +13,7 @@ class TileMap;
 class Battle;
 class BattleUnit;
 class DamageType;
+class DoodadType;
 class Organisation;
 class BattleUnit;
 
@@ -43,6 +45,15 @@ class BattleExplosion : public std::enable_shared_from_this<BattleExplosion>
 
 	std::set<StateRef<BattleUnit>> affectedUnits;
 
+	// Following members are not serialized, but rather rebuilt on the next growth
+
+	// Same as locationsVisited, one entry per tile of the map
+	std::vector<bool> visitedTiles;
+	// Doodads for explosions going in each direction, by (x + 1) * 3 + y + 1
+	std::vector<StateRef<DoodadType>> directionDoodads;
+
+	// Builds the members that aren't serialized if they aren't there yet
+	void prepareGrowth(GameState &state, const TileMap &map);
 	void grow(GameState &state);
 	void damage(GameState &state, const TileMap &map, Vec3<int> pos, int power);
 	void expand(GameState &state, const TileMap &map, const Vec3<int> &from, const Vec3<int> &to,
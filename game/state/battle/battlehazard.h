@@ -1,9 +1,7 @@
 #pragma once
 
-#include "game/state/battle/battle.h"
 #include "game/state/gametime.h"
 #include "game/state/stateobject.h"
-#include "library/sp.h"
 #include "library/vec.h"
 
 #define HAZARD_FRAME_COUNT 3
@@ -15,17 +13,18 @@
 
 namespace OpenApoc
 {
-static const unsigned TICKS_PER_HAZARD_UPDATE = TICKS_PER_TURN / 2;
+// Half a turn, battle.h (where turns are defined) can't be included here as it includes this
+static const unsigned TICKS_PER_HAZARD_UPDATE = TICKS_PER_SECOND * 2;
 
-class TileObjectBattleHazard;
 class DamageType;
 class HazardType;
 class GameState;
 class Organisation;
 class BattleUnit;
-class TileMap;
 
-class BattleHazard : public std::enable_shared_from_this<BattleHazard>
+// One hazard as it's saved. The battle simulates its hazards in a BattleHazardField, which keeps
+// them in per-tile arrays instead
+class BattleHazard
 {
   public:
 	Vec3<float> getPosition() const { return this->position; }
@@ -46,24 +45,9 @@ class BattleHazard : public std::enable_shared_from_this<BattleHazard>
 	StateRef<Organisation> ownerOrganisation;
 	StateRef<BattleUnit> ownerUnit;
 
-	bool expand(GameState &state, const TileMap &map, const Vec3<int> &to, unsigned ttl,
-	            bool fireSmoke = false);
-	void grow(GameState &state);
-	void applyEffect(GameState &state);
-	void die(GameState &state, bool violently = true);
-	void updateTileVisionBlock(GameState &state);
-
-	void update(GameState &state, unsigned int ticks);
-	void updateInner(GameState &state, unsigned int ticks);
-	void updateTB(GameState &state);
-
 	BattleHazard() = default;
 	BattleHazard(GameState &state, StateRef<DamageType> damageType, bool delayVisibility = true);
 	~BattleHazard() = default;
-
-	// Following members are not serialized, but rather are set up in the initBattle method
-
-	sp<TileObjectBattleHazard> tileObject;
 };
 } // namespace OpenApoc
 
@@ -0,0 +1,771 @@
+#include "game/state/battle/battlehazardfield.h"
+#include "framework/logger.h"
+#include "game/state/battle/battle.h"
+#include "game/state/battle/battleitem.h"
+#include "game/state/battle/battlemappart.h"
+#include "game/state/battle/battlemappart_type.h"
+#include "game/state/battle/battleunit.h"
+#include "game/state/gamestate.h"
+#include "game/state/rules/damage.h"
+#include "game/state/rules/doodad_type.h"
+#include "game/state/tileview/tile.h"
+#include "game/state/tileview/tileobject_battlehazard.h"
+#include "game/state/tileview/tileobject_battleitem.h"
+#include "game/state/tileview/tileobject_battlemappart.h"
+#include "game/state/tileview/tileobject_battleunit.h"
+#include <algorithm>
+#include <cmath>
+
+namespace OpenApoc
+{
+
+void BattleHazardField::init(TileMap &map)
+{
+	this->map = &map;
+	size = map.size;
+	auto tileCount = size.x * size.y * size.z;
+	ids.assign(tileCount, 0);
+	kindIndices.assign(tileCount, 0);
+	ownerIndices.assign(tileCount, 0);
+	power.assign(tileCount, 0);
+	lifetime.assign(tileCount, 0);
+	age.assign(tileCount, 0);
+	frame.assign(tileCount, 0);
+	ticksUntilVisible.assign(tileCount, 0);
+	frameChangeTicksAccumulated.assign(tileCount, 0);
+	nextUpdateTicksAccumulated.assign(tileCount, 0);
+	tileObjects.assign(tileCount, nullptr);
+	order.clear();
+
+	auto hazards = std::move(pending);
+	pending.clear();
+	for (auto &h : hazards)
+	{
+		add(h);
+	}
+}
+
+int BattleHazardField::getIndex(Vec3<int> position) const
+{
+	if (position.x < 0 || position.x >= size.x || position.y < 0 || position.y >= size.y ||
+	    position.z < 0 || position.z >= size.z)
+	{
+		return -1;
+	}
+	return position.z * size.x * size.y + position.y * size.x + position.x;
+}
+
+Vec3<int> BattleHazardField::getTile(int index) const
+{
+	return {index % size.x, index / size.x % size.y, index / (size.x * size.y)};
+}
+
+int BattleHazardField::find(Vec3<int> position) const
+{
+	if (!map)
+	{
+		return -1;
+	}
+	int index = getIndex(position);
+	if (index == -1 || ids[index] == 0)
+	{
+		return -1;
+	}
+	return index;
+}
+
+int BattleHazardField::add(const BattleHazard &hazard)
+{
+	if (!map)
+	{
+		pending.push_back(hazard);
+		return -1;
+	}
+	int index = getIndex((Vec3<int>)hazard.position);
+	if (index == -1)
+	{
+		LogError("Hazard at %s is outside the map", hazard.position);
+		return -1;
+	}
+	if (ids[index] != 0)
+	{
+		LogError("Tile %s already has a hazard", (Vec3<int>)hazard.position);
+		return -1;
+	}
+
+	unsigned kind = 0;
+	while (kind < kinds.size() && (kinds[kind].damageType != hazard.damageType ||
+	                               kinds[kind].hazardType != hazard.hazardType))
+	{
+		kind++;
+	}
+	if (kind == kinds.size())
+	{
+		kinds.push_back({hazard.damageType, hazard.hazardType});
+	}
+	unsigned owner = 0;
+	while (owner < owners.size() && (owners[owner].organisation != hazard.ownerOrganisation ||
+	                                 owners[owner].unit != hazard.ownerUnit))
+	{
+		owner++;
+	}
+	if (owner == owners.size())
+	{
+		owners.push_back({hazard.ownerOrganisation, hazard.ownerUnit});
+	}
+
+	ids[index] = ++lastId;
+	kindIndices[index] = kind;
+	ownerIndices[index] = owner;
+	power[index] = hazard.power;
+	lifetime[index] = hazard.lifetime;
+	age[index] = hazard.age;
+	frame[index] = hazard.frame;
+	ticksUntilVisible[index] = hazard.ticksUntilVisible;
+	frameChangeTicksAccumulated[index] = hazard.frameChangeTicksAccumulated;
+	nextUpdateTicksAccumulated[index] = hazard.nextUpdateTicksAccumulated;
+	order.emplace_back(index, lastId);
+	map->addObjectToMap(*this, index);
+	return index;
+}
+
+void BattleHazardField::removeFromMap()
+{
+	for (auto &tileObject : tileObjects)
+	{
+		if (tileObject)
+		{
+			tileObject->removeFromMap();
+			tileObject.reset();
+		}
+	}
+}
+
+void BattleHazardField::die(GameState &state, int index, bool violently)
+{
+	auto damageType = getDamageType(index);
+	auto owner = owners[ownerIndices[index]];
+	int hazardPower = power[index];
+
+	ids[index] = 0;
+	tileObjects[index]->removeFromMap();
+	tileObjects[index].reset();
+
+	if (!violently)
+	{
+		return;
+	}
+	// Place smoke where fire died off
+	if (damageType->effectType == DamageType::EffectType::Fire)
+	{
+		StateRef<DamageType> dtSmoke = {&state, "DAMAGETYPE_SMOKE"};
+		state.current_battle->placeHazard(state, owner.organisation, owner.unit, dtSmoke,
+		                                  getTile(index), dtSmoke->hazardType->getLifetime(state),
+		                                  hazardPower, 6);
+	}
+}
+
+ArenaVector<int> BattleHazardField::getHazards() const
+{
+	ArenaVector<int> result;
+	for (auto &entry : order)
+	{
+		if (ids[entry.first] == entry.second)
+		{
+			result.push_back(entry.first);
+		}
+	}
+	return result;
+}
+
+std::vector<BattleHazard> BattleHazardField::getRecords() const
+{
+	if (!map)
+	{
+		return pending;
+	}
+	std::vector<BattleHazard> result;
+	for (auto &entry : order)
+	{
+		if (ids[entry.first] == entry.second)
+		{
+			result.push_back(get(entry.first));
+		}
+	}
+	return result;
+}
+
+BattleHazard BattleHazardField::get(int index) const
+{
+	BattleHazard hazard;
+	hazard.position = getPosition(index);
+	hazard.damageType = getDamageType(index);
+	hazard.hazardType = getHazardType(index);
+	hazard.power = power[index];
+	hazard.lifetime = lifetime[index];
+	hazard.age = age[index];
+	hazard.frame = frame[index];
+	hazard.ticksUntilVisible = ticksUntilVisible[index];
+	hazard.frameChangeTicksAccumulated = frameChangeTicksAccumulated[index];
+	hazard.nextUpdateTicksAccumulated = nextUpdateTicksAccumulated[index];
+	hazard.ownerOrganisation = owners[ownerIndices[index]].organisation;
+	hazard.ownerUnit = owners[ownerIndices[index]].unit;
+	return hazard;
+}
+
+Vec3<float> BattleHazardField::getPosition(int index) const
+{
+	return Vec3<float>(getTile(index)) + Vec3<float>{0.5f, 0.5f, 0.5f};
+}
+
+const StateRef<DamageType> &BattleHazardField::getDamageType(int index) const
+{
+	return kinds[kindIndices[index]].damageType;
+}
+
+const StateRef<HazardType> &BattleHazardField::getHazardType(int index) const
+{
+	return kinds[kindIndices[index]].hazardType;
+}
+
+void BattleHazardField::restartUpdateTimer(Vec3<int> position)
+{
+	int index = find(position);
+	if (index != -1)
+	{
+		nextUpdateTicksAccumulated[index] = 0;
+	}
+}
+
+void BattleHazardField::removeStale()
+{
+	order.erase(std::remove_if(order.begin(), order.end(),
+	                           [this](const std::pair<int, uint32_t> &entry) {
+		                           return ids[entry.first] != entry.second;
+	                           }),
+	            order.end());
+}
+
+void BattleHazardField::update(GameState &state, unsigned int ticks, bool realTime)
+{
+	removeStale();
+	// Hazards created while the others are advanced wait for the next update
+	auto count = order.size();
+	for (size_t i = 0; i < count; i++)
+	{
+		auto entry = order[i];
+		if (ids[entry.first] != entry.second)
+		{
+			continue;
+		}
+		int index = entry.first;
+		if (ticksUntilVisible[index] > 0)
+		{
+			if (ticksUntilVisible[index] > ticks)
+			{
+				ticksUntilVisible[index] -= ticks;
+			}
+			else
+			{
+				ticksUntilVisible[index] = 0;
+			}
+		}
+		frameChangeTicksAccumulated[index] += ticks;
+		while (frameChangeTicksAccumulated[index] >= TICKS_PER_HAZARD_UPDATE)
+		{
+			frameChangeTicksAccumulated[index] -= TICKS_PER_HAZARD_UPDATE;
+			frame[index]++;
+			frame[index] %= getHazardType(index)->fire ? 2 : HAZARD_FRAME_COUNT;
+		}
+		if (realTime)
+		{
+			advance(state, index, ticks);
+		}
+	}
+}
+
+void BattleHazardField::updateTB(GameState &state, StateRef<Organisation> owner)
+{
+	removeStale();
+	auto count = order.size();
+	for (size_t i = 0; i < count; i++)
+	{
+		auto entry = order[i];
+		if (ids[entry.first] != entry.second ||
+		    owners[ownerIndices[entry.first]].organisation != owner)
+		{
+			continue;
+		}
+		advance(state, entry.first, TICKS_PER_TURN);
+	}
+}
+
+void BattleHazardField::advance(GameState &state, int index, unsigned int ticks)
+{
+	auto id = ids[index];
+	nextUpdateTicksAccumulated[index] += ticks;
+	while (ids[index] == id && nextUpdateTicksAccumulated[index] >= TICKS_PER_HAZARD_UPDATE)
+	{
+		nextUpdateTicksAccumulated[index] -= TICKS_PER_HAZARD_UPDATE;
+		step(state, index);
+	}
+}
+
+void BattleHazardField::step(GameState &state, int index)
+{
+	auto id = ids[index];
+	auto &hazardPower = power[index];
+	auto &hazardAge = age[index];
+	if (getHazardType(index)->fire)
+	{
+		// Explanation for how fire works is at the end of battlehazard.h
+		if (hazardPower > 0)
+		{
+			hazardAge -= 6;
+			if (hazardAge <= 10)
+			{
+				hazardPower = -hazardPower;
+			}
+		}
+		else
+		{
+			hazardAge += 10;
+		}
+		hazardPower += hazardPower / std::abs(hazardPower);
+		if (hazardPower % 2)
+		{
+			applyEffect(state, index);
+			// Damage can destroy what the hazard was on and put another hazard in its place
+			if (ids[index] != id)
+			{
+				return;
+			}
+			if (hazardAge < 130)
+			{
+				grow(state, index);
+			}
+		}
+		if (hazardAge >= 130)
+		{
+			die(state, index);
+		}
+	}
+	else
+	{
+		hazardAge++;
+		if (hazardAge % 2)
+		{
+			applyEffect(state, index);
+			if (ids[index] != id)
+			{
+				return;
+			}
+			updateTileVisionBlock(state, index);
+			if (hazardAge < lifetime[index])
+			{
+				grow(state, index);
+			}
+		}
+		if (hazardAge >= lifetime[index])
+		{
+			die(state, index);
+		}
+	}
+}
+
+bool BattleHazardField::expand(GameState &state, int index, const Vec3<int> &to, unsigned ttl,
+                               bool fireSmoke)
+{
+	// list of coordinates to check
+	static const std::map<Vec3<int>, std::list<std::pair<Vec3<int>, std::set<TileObject::Type>>>>
+	    searchPattern = {
+	        // Vertical
+	        {{0, 0, 1}, {{{0, 0, 1}, {TileObject::Type::Ground}}}},
+	        {{0, 0, -1},
+	         {
+	             {{0, 0, 0}, {TileObject::Type::Ground}},
+	         }},
+	        // Horizontal direct
+	        {{0, -1, 0},
+	         {
+	             {{0, 0, 0}, {TileObject::Type::RightWall}},
+	         }},
+	        {{0, 1, 0},
+	         {
+	             {{0, 1, 0}, {TileObject::Type::RightWall}},
+	         }},
+	        {{-1, 0, 0},
+	         {
+	             {{0, 0, 0}, {TileObject::Type::LeftWall}},
+	         }},
+	        {{1, 0, 0},
+	         {
+	             {{1, 0, 0}, {TileObject::Type::LeftWall}},
+	         }},
+	        // Horizontal top-left
+	        {{-1, -1, 0},
+	         {
+	             {{-1, 0, 0}, {TileObject::Type::Feature}},
+	             {{0, -1, 0}, {TileObject::Type::Feature}},
+	             {{-1, 0, 0}, {TileObject::Type::RightWall}},
+	             {{0, -1, 0}, {TileObject::Type::LeftWall}},
+	             {{0, 0, 0}, {TileObject::Type::RightWall}},
+	             {{0, 0, 0}, {TileObject::Type::LeftWall}},
+	         }},
+	        // Horizontal bottom-right
+	        {{1, 1, 0},
+	         {
+	             {{0, 1, 0}, {TileObject::Type::Feature}},
+	             {{1, 0, 0}, {TileObject::Type::Feature}},
+	             {{0, 1, 0}, {TileObject::Type::RightWall}},
+	             {{1, 0, 0}, {TileObject::Type::LeftWall}},
+	             {{1, 1, 0}, {TileObject::Type::RightWall}},
+	             {{1, 1, 0}, {TileObject::Type::LeftWall}},
+	         }},
+	        // Horizontal top-right
+	        {{1, -1, 0},
+	         {
+	             {{1, 0, 0}, {TileObject::Type::Feature}},
+	             {{0, -1, 0}, {TileObject::Type::Feature}},
+	             {{0, 0, 0}, {TileObject::Type::RightWall}},
+	             {{1, -1, 0}, {TileObject::Type::LeftWall}},
+	             {{1, 0, 0}, {TileObject::Type::RightWall}},
+	             {{1, 0, 0}, {TileObject::Type::LeftWall}},
+	         }},
+	        // Horizontal bottom-left
+	        {{-1, 1, 0},
+	         {
+	             {{-1, 0, 0}, {TileObject::Type::Feature}},
+	             {{0, 1, 0}, {TileObject::Type::Feature}},
+	             {{-1, 1, 0}, {TileObject::Type::RightWall}},
+	             {{0, 0, 0}, {TileObject::Type::LeftWall}},
+	             {{0, 1, 0}, {TileObject::Type::RightWall}},
+	             {{0, 1, 0}, {TileObject::Type::LeftWall}},
+	         }},
+	    };
+
+	// Ensure coordinates are ok
+	if (to.x < 0 || to.x >= size.x || to.y < 0 || to.y >= size.y || to.z < 0 || to.z >= size.z)
+	{
+		return false;
+	}
+
+	// Placing hazards can add to the kinds and owners, so copy what's needed from them
+	bool fire = getHazardType(index)->fire;
+	auto owner = owners[ownerIndices[index]];
+	auto position = getTile(index);
+
+	// Fire spreads smoke
+	// Actual spread of fire is handled in the effect application
+	auto spreadDamageType = getDamageType(index);
+	if (fireSmoke)
+	{
+		spreadDamageType = {&state, "DAMAGETYPE_SMOKE"};
+		ttl = spreadDamageType->hazardType->getLifetime(state);
+	}
+
+	// Ensure no hazard already there
+
+	bool replaceWeaker = false;
+	auto targetTile = map->getTile(to.x, to.y, to.z);
+	int existingHazard = find(to);
+	if (existingHazard != -1)
+	{
+		// Replace weaker hazards (if not smoke from fire or fire itself)
+		// Replace non-fire hazards if fire
+		if ((fire && !fireSmoke &&
+		     getDamageType(existingHazard) != spreadDamageType) ||
+		    (!fire && getDamageType(existingHazard) == spreadDamageType &&
+		     lifetime[existingHazard] - age[existingHazard] < ttl))
+		{
+			replaceWeaker = true;
+		}
+	}
+	if (!replaceWeaker && existingHazard != -1)
+	{
+		return false;
+	}
+
+	// Calculate target's resistance to hazard spread
+
+	auto dir = to - position;
+	int block = 0;
+	for (auto &pair : searchPattern.at(dir))
+	{
+		auto pos = pair.first + position;
+		auto tile = map->getTile(pos);
+		for (auto &obj : tile->ownedObjects)
+		{
+			if (pair.second.find(obj->getType()) != pair.second.end())
+			{
+				auto mp = static_cast<TileObjectBattleMapPart *>(obj)->getOwner();
+				block = std::max(block, mp->type->block[spreadDamageType->blockType]);
+			}
+		}
+	}
+	// FIXME: Made up, ensure this fits vanilla behavior
+	if ((fire && !fireSmoke && block == 255) || power[index] <= block)
+	{
+		return false;
+	}
+
+	// If spreading fire
+	if (fire && !fireSmoke)
+	{
+		// Find out if tile contains something flammable that we can penetrate
+		bool penetrationAchieved = false;
+		for (auto &obj : targetTile->ownedObjects)
+		{
+			if (obj->getType() == TileObject::Type::Ground ||
+			    obj->getType() == TileObject::Type::Feature)
+			{
+				auto mp = static_cast<TileObjectBattleMapPart *>(obj)->getOwner();
+				if (mp->canBurn(age[index]))
+				{
+					penetrationAchieved = true;
+				}
+				break;
+			}
+		}
+
+		if (penetrationAchieved)
+		{
+			if (replaceWeaker)
+			{
+				die(state, existingHazard, false);
+			}
+			state.current_battle->placeHazard(
+			    state, owner.organisation, owner.unit, spreadDamageType, {to.x, to.y, to.z},
+			    spreadDamageType->hazardType->getLifetime(state), 0, 1, false);
+		}
+	}
+	// If spreading something else
+	else
+	{
+		// If reached here try place hazard
+		if (replaceWeaker)
+		{
+			if (fireSmoke)
+			{
+				LogError("Smoke from fire should never try to replace weaker hazards");
+				return true;
+			}
+			lifetime[existingHazard] = lifetime[index];
+			age[existingHazard] = age[index];
+			ticksUntilVisible[existingHazard] = 0;
+		}
+		else
+		{
+			int hazard = state.current_battle->placeHazard(
+			    state, owner.organisation, owner.unit, spreadDamageType, {to.x, to.y, to.z},
+			    fireSmoke ? ttl : lifetime[index], fireSmoke ? 1 : power[index],
+			    fireSmoke ? 6 : 1, false);
+			if (hazard != -1 && !fireSmoke)
+			{
+				age[hazard] = age[index];
+			}
+		}
+	}
+
+	return true;
+}
+
+void BattleHazardField::grow(GameState &state, int index)
+{
+	auto position = getTile(index);
+	if (getHazardType(index)->fire)
+	{
+		// Try to light up adjacent stuff on fire
+
+		for (int x = position.x - 1; x <= position.x + 1; x++)
+		{
+			for (int y = position.y - 1; y <= position.y + 1; y++)
+			{
+				expand(state, index, {x, y, position.z}, 0);
+			}
+		}
+		for (int z = position.z - 1; z <= position.z + 1; z++)
+		{
+			expand(state, index, {position.x, position.y, z}, 0);
+		}
+
+		// Now spread smoke
+
+		if (randBoundsExclusive(state.rng, 0, 100) >= HAZARD_SPREAD_CHANCE)
+		{
+			return;
+		}
+
+		for (int x = position.x - 1; x <= position.x + 1; x++)
+		{
+			for (int y = position.y - 1; y <= position.y + 1; y++)
+			{
+				if (expand(state, index, {x, y, position.z}, 0, true))
+				{
+					return;
+				}
+			}
+		}
+		for (int z = position.z - 1; z <= position.z + 1; z++)
+		{
+			if (expand(state, index, {position.x, position.y, z}, 0, true))
+			{
+				return;
+			}
+		}
+	}
+	else
+	{
+		if (power[index] == 0)
+		{
+			return;
+		}
+		if (randBoundsExclusive(state.rng, 0, 100) >= HAZARD_SPREAD_CHANCE)
+		{
+			return;
+		}
+		int newTTL = lifetime[index] - age[index];
+
+		for (int x = position.x - 1; x <= position.x + 1; x++)
+		{
+			for (int y = position.y - 1; y <= position.y + 1; y++)
+			{
+				if (expand(state, index, {x, y, position.z}, newTTL))
+				{
+					return;
+				}
+			}
+		}
+		for (int z = position.z - 1; z <= position.z + 1; z++)
+		{
+			if (expand(state, index, {position.x, position.y, z}, newTTL))
+			{
+				return;
+			}
+		}
+	}
+}
+
+void BattleHazardField::applyEffect(GameState &state, int index)
+{
+	// Damage can replace the hazard, which then still hits everything on the tile as it was
+	auto id = ids[index];
+	auto damageType = getDamageType(index);
+	auto position = getPosition(index);
+	int hazardPower = power[index];
+	unsigned hazardAge = age[index];
+	auto tile = map->getTile(getTile(index));
+
+	// Damage can move or destroy objects, so go through a snapshot that keeps them alive
+	ArenaVector<sp<TileObject>> objects;
+	for (auto &obj : tile->ownedObjects)
+	{
+		objects.push_back(obj->shared_from_this());
+	}
+	for (auto &obj : objects)
+	{
+		if (!tile->ownedObjects.contains(obj.get()))
+		{
+			continue;
+		}
+		if (obj->getType() == TileObject::Type::Ground ||
+		    obj->getType() == TileObject::Type::Feature ||
+		    obj->getType() == TileObject::Type::LeftWall ||
+		    obj->getType() == TileObject::Type::RightWall)
+		{
+			auto mp = std::static_pointer_cast<TileObjectBattleMapPart>(obj)->getOwner();
+			switch (damageType->effectType)
+			{
+				case DamageType::EffectType::Fire:
+					if (mp->applyBurning(state, hazardAge))
+					{
+						// Map part burned and provided fuel for our fire, keep the fire raging
+						if (hazardPower < 0 && hazardAge > 10)
+						{
+							hazardPower = -hazardPower;
+							if (ids[index] == id)
+							{
+								power[index] = hazardPower;
+							}
+						}
+					}
+					break;
+				default:
+					switch (damageType->blockType)
+					{
+						case DamageType::BlockType::Gas:
+						case DamageType::BlockType::Psionic:
+							break;
+						default:
+							mp->applyDamage(state, hazardPower, damageType);
+							break;
+					}
+					break;
+			}
+		}
+		else if (obj->getType() == TileObject::Type::Item)
+		{
+			if (damageType->effectType == DamageType::EffectType::Fire)
+			{
+				// It was observed that armor resists fire damage deal to it
+				// It also appears that damage is applied gradually at a rate of around 1 damage per
+				// second
+				// In tests, marsec armor (20% modifier) was hurt by fire but X-Com armor (10%
+				// modifier) was not
+				// If we apply damage once per turn, we apply 4 at once. Since we round down, 4 *
+				// 20% will be rounded to 0
+				// while it should be 1. So we add 1 here
+				auto i = std::static_pointer_cast<TileObjectBattleItem>(obj)->getItem();
+				i->applyDamage(state, 2 * TICKS_PER_HAZARD_UPDATE / TICKS_PER_SECOND + 1,
+				               damageType);
+			}
+		}
+		else if (obj->getType() == TileObject::Type::Unit)
+		{
+			StateRef<BattleUnit> u = {
+			    &state, std::static_pointer_cast<TileObjectBattleUnit>(obj)->getUnit()->id};
+			// Determine direction of hit
+			Vec3<float> velocity = -position;
+			velocity -= Vec3<float>{0.5f, 0.5f, 0.5f};
+			velocity += u->position;
+			if (velocity.x == 0.0f && velocity.y == 0.0f)
+			{
+				velocity.z = 1.0f;
+			}
+			// Determine wether to hit head, legs or torso
+			auto cposition = u->position;
+			// Hit torso
+			if (sqrtf(velocity.x * velocity.x + velocity.y * velocity.y) > std::abs(velocity.z))
+			{
+				cposition.z += (float)u->getCurrentHeight() / 2.0f / 40.0f;
+			}
+			// Hit head
+			else if (velocity.z < 0)
+			{
+				cposition.z += (float)u->getCurrentHeight() / 40.0f;
+			}
+			else
+			{
+				// Legs are defeault already
+			}
+			// Apply
+			u->applyDamage(state, hazardPower, damageType,
+			               u->determineBodyPartHit(damageType, cposition, velocity),
+			               DamageSource::Hazard);
+		}
+	}
+}
+
+void BattleHazardField::updateTileVisionBlock(GameState &state, int index)
+{
+	int visionBlock = getDamageType(index)->effectType == DamageType::EffectType::Smoke
+	                      ? (lifetime[index] - age[index]) / 3
+	                      : 0;
+	auto position = getTile(index);
+	if (map->getTile(position)->updateVisionBlockage(visionBlock))
+	{
+		state.current_battle->queueVisionRefresh(position);
+	}
+}
+
+} // namespace OpenApoc
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "game/state/battle/battlehazard.h"
+#include "game/state/stateobject.h"
+#include "library/arena.h"
+#include "library/sp.h"
+#include "library/vec.h"
+#include <cstdint>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class GameState;
+class TileMap;
+class TileObjectBattleHazard;
+
+// The hazards of a battle, kept in flat per-tile arrays. There can only be one hazard per tile,
+// which is addressed by the index of its tile. The tile objects are only there to draw them.
+// Hazards are advanced in the order they were created, and each keeps its own update timer
+class BattleHazardField
+{
+  public:
+	// Hazards added before init() (while the battle is generated or loaded) are kept aside and
+	// placed on the map by it
+	void init(TileMap &map);
+
+	// Index of the hazard on the tile, -1 if there is none
+	int find(Vec3<int> position) const;
+	// Adds the hazard to its tile, which must have none, returns its index or -1 if it's only
+	// kept aside until init()
+	int add(const BattleHazard &hazard);
+	// Removes the hazard, fire leaves smoke behind if it dies violently
+	void die(GameState &state, int index, bool violently = true);
+
+	// Indices of the hazards in the order they were created
+	ArenaVector<int> getHazards() const;
+	// Copies of all hazards, kept aside ones included, in the order they were created
+	std::vector<BattleHazard> getRecords() const;
+	BattleHazard get(int index) const;
+
+	Vec3<float> getPosition(int index) const;
+	const StateRef<DamageType> &getDamageType(int index) const;
+	const StateRef<HazardType> &getHazardType(int index) const;
+	int getPower(int index) const { return power[index]; }
+	unsigned getLifetime(int index) const { return lifetime[index]; }
+	unsigned getAge(int index) const { return age[index]; }
+	unsigned getFrame(int index) const { return frame[index]; }
+	bool isVisible(int index) const { return ticksUntilVisible[index] == 0; }
+	void reveal(int index) { ticksUntilVisible[index] = 0; }
+	// Makes the hazard on the tile, if any, wait a whole hazard update before it's advanced again
+	void restartUpdateTimer(Vec3<int> position);
+
+	// Animates every hazard, and in real time advances each by the hazard updates it's due
+	void update(GameState &state, unsigned int ticks, bool realTime);
+	// Advances the hazards of 'owner' by a turn's worth of hazard updates
+	void updateTB(GameState &state, StateRef<Organisation> owner);
+	// Takes the hazards' tile objects off the map, which must be done before the map is destroyed
+	void removeFromMap();
+
+	// Lets the hazard spread to the tiles around it
+	void grow(GameState &state, int index);
+	void updateTileVisionBlock(GameState &state, int index);
+
+  private:
+	friend class TileMap;
+
+	class Kind
+	{
+	  public:
+		StateRef<DamageType> damageType;
+		StateRef<HazardType> hazardType;
+	};
+	class Owner
+	{
+	  public:
+		StateRef<Organisation> organisation;
+		StateRef<BattleUnit> unit;
+	};
+
+	TileMap *map = nullptr;
+	Vec3<int> size;
+	std::vector<BattleHazard> pending;
+
+	// Damage and hazard types and owners are shared by many hazards, so tiles only index them
+	std::vector<Kind> kinds;
+	std::vector<Owner> owners;
+
+	// Per tile, the hazard's id is 0 if there is none
+	std::vector<uint32_t> ids;
+	std::vector<uint16_t> kindIndices;
+	std::vector<uint16_t> ownerIndices;
+	// Power (damage) for most hazards, growing/fading flag for fire
+	std::vector<int> power;
+	// TTL for most hazards, Meaningless for fire
+	std::vector<unsigned> lifetime;
+	// Time already lived for most hazards, stage for fire
+	std::vector<unsigned> age;
+	std::vector<unsigned> frame;
+	std::vector<unsigned> ticksUntilVisible;
+	std::vector<unsigned> frameChangeTicksAccumulated;
+	std::vector<unsigned> nextUpdateTicksAccumulated;
+	std::vector<sp<TileObjectBattleHazard>> tileObjects;
+
+	// Tile index and id of every hazard in creation order, entries whose tile has since been
+	// given another id are dropped when the hazards are next advanced
+	std::vector<std::pair<int, uint32_t>> order;
+	uint32_t lastId = 0;
+
+	int getIndex(Vec3<int> position) const;
+	Vec3<int> getTile(int index) const;
+	int place(const BattleHazard &hazard);
+	void removeStale();
+	// Gives the hazard the ticks and advances it by the hazard updates they are worth
+	void advance(GameState &state, int index, unsigned int ticks);
+	void step(GameState &state, int index);
+	bool expand(GameState &state, int index, const Vec3<int> &to, unsigned ttl,
+	            bool fireSmoke = false);
+	void applyEffect(GameState &state, int index);
+};
+
+} // namespace OpenApoc
@@ -1,7 +1,6 @@
 #include "game/state/battle/battlemappart.h"
 #include "game/state/battle/battle.h"
 #include "game/state/battle/battledoor.h"
-#include "game/state/battle/battlehazard.h"
 #include "game/state/battle/battleitem.h"
 #include "game/state/battle/battlemappart_type.h"
 #include "game/state/city/projectile.h"
@@ -72,6 +71,7 @@ void BattleMapPart::die(GameState &state, bool explosive, bool violently)
 		{
 			this->type = type->damaged_map_part;
 			this->damaged = true;
+			tileObject->invalidateDrawing();
 		}
 		// Destroy
 		else
@@ -82,13 +82,14 @@ void BattleMapPart::die(GameState &state, bool explosive, bool violently)
 			{
 				this->damaged = true;
 				this->type = type->destroyed_ground_tile;
+				tileObject->invalidateDrawing();
 			}
 			// Destroy map part
 			else
 			{
 				if (explosive)
 				{
-					queueCollapse();
+					queueCollapse(state);
 				}
 				else
 				{
@@ -104,14 +105,14 @@ void BattleMapPart::die(GameState &state, bool explosive, bool violently)
 		// Cease functioning
 		ceaseBeingSupported();
 		ceaseDoorFunction();
-		ceaseSupportProvision();
+		ceaseSupportProvision(state);
 
 		// Re-establish support for this if still alive
 		if (isAlive())
 		{
 			if (!findSupport())
 			{
-				queueCollapse();
+				queueCollapse(state);
 			}
 		}
 		// Destroy if destroyed
@@ -122,6 +123,9 @@ void BattleMapPart::die(GameState &state, bool explosive, bool violently)
 		}
 	}
 
+	// Might have turned into something animated
+	state.current_battle->wakeMapPart(shared_from_this());
+
 	if (mustCheckForObjective)
 	{
 		state.current_battle->checkIfBuildingDisabled(state);
@@ -229,6 +233,10 @@ void BattleMapPart::ceaseDoorFunction()
 
 	if (alternative_type)
 		type = alternative_type;
+	if (tileObject)
+	{
+		tileObject->invalidateDrawing();
+	}
 	// Remove from door's map parts
 	wp<BattleMapPart> sft = shared_from_this();
 	door->mapParts.remove_if([sft](wp<BattleMapPart> p) {
@@ -314,7 +322,7 @@ bool BattleMapPart::attachToSomething(bool checkType, bool checkHard)
 			    o->getType() == TileObject::Type::LeftWall ||
 			    o->getType() == TileObject::Type::RightWall)
 			{
-				auto mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+				auto mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 				if (mp != sft && mp->isAlive())
 				{
 					bool canSupport =
@@ -534,7 +542,7 @@ bool BattleMapPart::findSupport()
 
 					if (canSupport)
 					{
-						auto mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+						auto mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 						// Seems that "provide support" flag only matters for providing support
 						// upwards
 						if (mp != sft && mp->isAlive() && !mp->damaged &&
@@ -708,7 +716,7 @@ bool BattleMapPart::findSupport()
 				// Also must provide support
 				if (o->getType() == pair.second)
 				{
-					auto mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+					auto mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 					if (mp != sft && mp->isAlive())
 					{
 						bool canSupport = !mp->damaged &&
@@ -774,7 +782,7 @@ bool BattleMapPart::findSupport()
 				(tileType == TileObject::Type::LeftWall ||
 					tileType == TileObject::Type::RightWall)))
 			{
-				auto mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+				auto mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 				if (mp != sft && mp->isAlive())
 				{
 					bool canSupport =
@@ -838,7 +846,7 @@ bool BattleMapPart::findSupport()
 				{
 					if (o->getType() == tileType)
 					{
-						mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+						mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 					}
 				}
 				// Could not find map part of this type or it cannot provide support
@@ -879,7 +887,7 @@ bool BattleMapPart::findSupport()
 				{
 					if (o->getType() == tileType)
 					{
-						mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+						mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 					}
 				}
 				if (!mp)
@@ -917,7 +925,7 @@ bool BattleMapPart::findSupport()
 				{
 					if (o->getType() == tileType)
 					{
-						mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+						mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 					}
 				}
 				// Could not find map part of this type or it cannot provide support
@@ -958,7 +966,7 @@ bool BattleMapPart::findSupport()
 				{
 					if (o->getType() == tileType)
 					{
-						mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+						mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 					}
 				}
 				if (!mp)
@@ -987,7 +995,7 @@ sp<std::set<BattleMapPart *>> BattleMapPart::getSupportedParts()
 		{
 			if (obj->getType() == TileObjectBattleMapPart::convertType(p.second))
 			{
-				auto mp = std::static_pointer_cast<TileObjectBattleMapPart>(obj)->getOwner();
+				auto mp = static_cast<TileObjectBattleMapPart *>(obj)->getOwner();
 				if (mp->destroyed)
 				{
 					continue;
@@ -1024,7 +1032,7 @@ void BattleMapPart::ceaseBeingSupported()
 					    o->getType() == TileObject::Type::LeftWall ||
 					    o->getType() == TileObject::Type::RightWall)
 					{
-						auto mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+						auto mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 						auto it = mp->supportedParts.begin();
 						while (it != mp->supportedParts.end())
 						{
@@ -1045,10 +1053,10 @@ void BattleMapPart::ceaseBeingSupported()
 	}
 }
 
-void BattleMapPart::ceaseSupportProvision()
+void BattleMapPart::ceaseSupportProvision(GameState &state)
 {
 	providesHardSupport = false;
-	attemptReLinkSupports(getSupportedParts());
+	attemptReLinkSupports(state, getSupportedParts());
 	supportedParts.clear();
 	if (supportedItems)
 	{
@@ -1056,14 +1064,14 @@ void BattleMapPart::ceaseSupportProvision()
 		{
 			if (obj->getType() == TileObject::Type::Item)
 			{
-				std::static_pointer_cast<TileObjectBattleItem>(obj)->getItem()->tryCollapse();
+				static_cast<TileObjectBattleItem *>(obj)->getItem()->tryCollapse();
 			}
 		}
 		supportedItems = false;
 	}
 }
 
-void BattleMapPart::attemptReLinkSupports(sp<std::set<BattleMapPart *>> set)
+void BattleMapPart::attemptReLinkSupports(GameState &state, sp<std::set<BattleMapPart *>> set)
 {
 	if (set->empty())
 	{
@@ -1075,7 +1083,7 @@ void BattleMapPart::attemptReLinkSupports(sp<std::set<BattleMapPart *>> set)
 	// First mark all those in list as about to fall
 	for (auto &mp : *set)
 	{
-		mp->queueCollapse();
+		mp->queueCollapse(state);
 		mp->ceaseBeingSupported();
 	}
 
@@ -1103,7 +1111,7 @@ void BattleMapPart::attemptReLinkSupports(sp<std::set<BattleMapPart *>> set)
 			auto supportedByThisMp = mp->getSupportedParts();
 			for (auto &newmp : *supportedByThisMp)
 			{
-				newmp->queueCollapse(mp->ticksUntilCollapse);
+				newmp->queueCollapse(state, mp->ticksUntilCollapse);
 			}
 			auto pos = mp->tileObject->getOwningTile()->position;
 			// Try to find support without those that depended on us
@@ -1134,8 +1142,7 @@ void BattleMapPart::attemptReLinkSupports(sp<std::set<BattleMapPart *>> set)
 									    o2->getType() == TileObject::Type::RightWall)
 									{
 										auto mp2 =
-										    std::static_pointer_cast<TileObjectBattleMapPart>(o2)
-										        ->getOwner();
+										    static_cast<TileObjectBattleMapPart *>(o2)->getOwner();
 										for (auto &p : mp2->supportedParts)
 										{
 											if (p.first == pos && p.second == mp->type->type)
@@ -1195,10 +1202,13 @@ void BattleMapPart::collapse(GameState &state)
 	{
 		this->damaged = true;
 		this->type = type->destroyed_ground_tile;
+		tileObject->invalidateDrawing();
 	}
 	else
 	{
 		falling = true;
+		// Views have to stop drawing it from where it was cached at
+		tileObject->invalidateDrawing();
 		state.current_battle->queueVisionRefresh(position);
 		state.current_battle->queuePathfindingRefresh(position);
 		// Note: Pathfinding refresh relies on tile's battlescape parameters being updated
@@ -1210,8 +1220,9 @@ void BattleMapPart::collapse(GameState &state)
 		// If we would somehow call collapse() in a way that would set falling to true but
 		// would not trigger the setPosition() afterwards, this logic would fail
 	}
-	ceaseSupportProvision();
+	ceaseSupportProvision(state);
 	ceaseDoorFunction();
+	state.current_battle->wakeMapPart(shared_from_this());
 }
 
 void BattleMapPart::update(GameState &state, unsigned int ticks)
@@ -1260,8 +1271,7 @@ void BattleMapPart::update(GameState &state, unsigned int ticks)
 					case TileObject::Type::RightWall:
 					case TileObject::Type::Feature:
 					{
-						auto mp =
-						    std::static_pointer_cast<TileObjectBattleMapPart>(obj)->getOwner();
+						auto mp = static_cast<TileObjectBattleMapPart *>(obj)->getOwner();
 
 						// Find if we collide into it
 						if (mp->type->type == type->type ||
@@ -1295,12 +1305,12 @@ void BattleMapPart::update(GameState &state, unsigned int ticks)
 			// Spawn smoke, more intense if we land here
 			{
 				StateRef<DamageType> dtSmoke = {&state, "DAMAGETYPE_SMOKE"};
-				auto hazard = state.current_battle->placeHazard(
+				int hazard = state.current_battle->placeHazard(
 				    state, owner, nullptr, dtSmoke, position,
 				    dtSmoke->hazardType->getLifetime(state), 2, destroyed ? 6 : 12);
-				if (hazard)
+				if (hazard != -1)
 				{
-					hazard->ticksUntilVisible = 0;
+					state.current_battle->hazards.reveal(hazard);
 				}
 			}
 			// Cease to exist if destroyed
@@ -1320,6 +1330,7 @@ void BattleMapPart::update(GameState &state, unsigned int ticks)
 						rubble->type = type->rubble.front();
 						state.current_battle->map_parts.push_back(rubble);
 						state.current_battle->map->addObjectToMap(rubble);
+						state.current_battle->wakeMapPart(rubble);
 					}
 					else
 					{
@@ -1329,6 +1340,7 @@ void BattleMapPart::update(GameState &state, unsigned int ticks)
 						{
 							rubble->type = *it;
 							rubble->setPosition(state, rubble->position);
+							state.current_battle->wakeMapPart(rubble);
 						}
 					}
 				}
@@ -1369,10 +1381,20 @@ bool BattleMapPart::isAlive() const
 	return true;
 }
 
-void BattleMapPart::queueCollapse(unsigned additionalDelay)
+bool BattleMapPart::needsUpdate() const
+{
+	if (!tileObject)
+	{
+		return false;
+	}
+	return ticksUntilCollapse > 0 || falling || (!door && type->animation_frames.size() > 0);
+}
+
+void BattleMapPart::queueCollapse(GameState &state, unsigned additionalDelay)
 {
 	ticksUntilCollapse = TICKS_MULTIPLIER + additionalDelay;
 	providesHardSupport = false;
+	state.current_battle->wakeMapPart(shared_from_this());
 }
 
 void BattleMapPart::cancelCollapse() { ticksUntilCollapse = 0; }
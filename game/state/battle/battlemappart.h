@@ -63,18 +63,20 @@ class BattleMapPart : public std::enable_shared_from_this<BattleMapPart>
 	void collapse(GameState &state);
 
 	// Makes mappart stop being valid for support and collapse in 1 vanilla tick
-	void queueCollapse(unsigned additionalDelay = 0);
+	void queueCollapse(GameState &state, unsigned additionalDelay = 0);
 	// Cancels queued collapse
 	void cancelCollapse();
 	// Wether mappart is queued to collapse
 	bool willCollapse() const { return ticksUntilCollapse > 0; }
 
 	sp<std::set<BattleMapPart *>> getSupportedParts();
-	static void attemptReLinkSupports(sp<std::set<BattleMapPart *>> set);
+	static void attemptReLinkSupports(GameState &state, sp<std::set<BattleMapPart *>> set);
 
 	void ceaseDoorFunction();
 
 	void update(GameState &state, unsigned int ticks);
+	// Wether update() has anything to do, static map parts are left out of battle updates
+	bool needsUpdate() const;
 
 	bool isAlive() const;
 
@@ -83,6 +85,8 @@ class BattleMapPart : public std::enable_shared_from_this<BattleMapPart>
 	// Following members are not serialized, but rather are set in initBattle method
 
 	sp<TileObjectBattleMapPart> tileObject;
+	// Wether the map part is in the battle's list of map parts to update
+	bool awake = false;
 
   private:
 	friend class Battle;
@@ -94,7 +98,7 @@ class BattleMapPart : public std::enable_shared_from_this<BattleMapPart>
 	bool attachToSomething(bool checkType, bool checkHard);
 
 	// Cease providing or requiring support
-	void ceaseSupportProvision();
+	void ceaseSupportProvision(GameState &state);
 
 	// Cease using support
 	void ceaseBeingSupported();
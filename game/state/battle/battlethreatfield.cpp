@@ -0,0 +1,172 @@
+#include "game/state/battle/battlethreatfield.h"
+#include "game/state/battle/battle.h"
+#include "game/state/battle/battleunit.h"
+#include "game/state/tileview/collision.h"
+#include "game/state/tileview/tile.h"
+#include "game/state/tileview/tileobject_battleunit.h"
+
+namespace OpenApoc
+{
+
+namespace
+{
+static const std::set<TileObject::Type> mapPartSet = {
+    TileObject::Type::Ground, TileObject::Type::LeftWall, TileObject::Type::RightWall,
+    TileObject::Type::Feature};
+} // anonymous namespace
+
+BattleThreatField::BattleThreatField(Vec3<int> size) : size(size) {}
+
+int BattleThreatField::getIndex(Vec3<int> position) const
+{
+	return position.z * size.x * size.y + position.y * size.x + position.x;
+}
+
+int BattleThreatField::getThreat(StateRef<Organisation> org, Vec3<int> position) const
+{
+	auto it = organisations.find(org);
+	if (it == organisations.end() || position.x < 0 || position.x >= size.x || position.y < 0 ||
+	    position.y >= size.y || position.z < 0 || position.z >= size.z)
+	{
+		return 0;
+	}
+	return it->second.threat[getIndex(position)];
+}
+
+// A tile is threatened if a line from the unit's muzzle to around the chest of someone standing in
+// it doesn't hit the map. The muzzle is where it will be once the unit is done changing stance
+sp<BattleThreatField::Coverage> BattleThreatField::findCoverage(TileMap &map, BattleUnit &u) const
+{
+	auto result = mksp<Coverage>();
+	result->position = u.position;
+	result->bodyState = u.target_body_state;
+	auto muzzle =
+	    u.position +
+	    Vec3<float>{0.0f, 0.0f,
+	                (float)u.agent->type->bodyType->muzzleZPosition.at(result->bodyState) / 40.0f};
+	for (int z = std::max(0, result->position.z - THREAT_LEVELS);
+	     z <= std::min(size.z - 1, result->position.z + THREAT_LEVELS); z++)
+	{
+		for (int y = std::max(0, result->position.y - THREAT_RANGE);
+		     y <= std::min(size.y - 1, result->position.y + THREAT_RANGE); y++)
+		{
+			for (int x = std::max(0, result->position.x - THREAT_RANGE);
+			     x <= std::min(size.x - 1, result->position.x + THREAT_RANGE); x++)
+			{
+				Vec3<int> position{x, y, z};
+				if (position == result->position)
+				{
+					continue;
+				}
+				Vec3<float> target{x + 0.5f, y + 0.5f, z + 0.6f};
+				if (!map.findCollision(muzzle, target, mapPartSet, u.tileObject))
+				{
+					result->tiles.push_back(getIndex(position));
+				}
+			}
+		}
+	}
+	return result;
+}
+
+void BattleThreatField::mapChanged(Vec3<int> tile) { changedTiles.insert(tile); }
+
+void BattleThreatField::update(Battle &battle)
+{
+	auto &map = *battle.map;
+
+	for (auto &position : changedTiles)
+	{
+		for (auto it = coverage.begin(); it != coverage.end();)
+		{
+			auto &from = it->second->position;
+			if (std::abs(from.x - position.x) <= THREAT_RANGE &&
+			    std::abs(from.y - position.y) <= THREAT_RANGE &&
+			    std::abs(from.z - position.z) <= THREAT_LEVELS + 1)
+			{
+				it = coverage.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+	}
+	changedTiles.clear();
+
+	// Only spotted enemies are counted, so only their lines of fire are needed
+	std::set<UString> spotted;
+	for (auto &entry : battle.visibleEnemies)
+	{
+		for (auto &enemy : entry.second)
+		{
+			spotted.insert(enemy.id);
+		}
+	}
+
+	// Find what units that moved or changed stance could fire at now, forget units that can't fire
+	// any more or that nobody sees
+	for (auto &entry : battle.units)
+	{
+		auto &u = *entry.second;
+		if (u.destroyed || u.retreated || !u.isConscious() ||
+		    spotted.find(entry.first) == spotted.end())
+		{
+			coverage.erase(entry.first);
+			continue;
+		}
+		auto it = coverage.find(entry.first);
+		if (it == coverage.end() || it->second->position != (Vec3<int>)u.position ||
+		    it->second->bodyState != u.target_body_state)
+		{
+			coverage[entry.first] = findCoverage(map, u);
+		}
+	}
+
+	// Count enemies that were spotted or moved, stop counting those that were lost or moved
+	auto tileCount = size.x * size.y * size.z;
+	for (auto &entry : battle.visibleEnemies)
+	{
+		auto &org = organisations[entry.first];
+		if (org.threat.empty())
+		{
+			org.threat.resize(tileCount, 0);
+		}
+		std::map<UString, sp<Coverage>> counted;
+		for (auto &enemy : entry.second)
+		{
+			auto it = coverage.find(enemy.id);
+			if (it != coverage.end())
+			{
+				counted[enemy.id] = it->second;
+			}
+		}
+		for (auto &c : org.counted)
+		{
+			auto it = counted.find(c.first);
+			if (it != counted.end() && it->second == c.second)
+			{
+				continue;
+			}
+			for (auto index : c.second->tiles)
+			{
+				org.threat[index]--;
+			}
+		}
+		for (auto &c : counted)
+		{
+			auto it = org.counted.find(c.first);
+			if (it != org.counted.end() && it->second == c.second)
+			{
+				continue;
+			}
+			for (auto index : c.second->tiles)
+			{
+				org.threat[index]++;
+			}
+		}
+		org.counted = std::move(counted);
+	}
+}
+
+} // namespace OpenApoc
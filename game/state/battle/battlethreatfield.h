@@ -0,0 +1,74 @@
+#pragma once
+
+#include "game/state/stateobject.h"
+#include "library/sp.h"
+#include "library/strings.h"
+#include "library/vec.h"
+#include <cstdint>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class Battle;
+class BattleUnit;
+class Organisation;
+class TileMap;
+enum class BodyState;
+
+// How many of the enemies an organisation knows about could fire at each tile of a battle, so that
+// the AI rates a tile as cover with a lookup instead of checking lines of fire to every enemy.
+// The tiles a unit could fire at are only found for units some organisation has spotted, and only
+// again when the unit moves to another tile, changes stance or the map around it changes. An
+// organisation's threats are only updated for the enemies it spotted, lost sight of or that moved
+class BattleThreatField
+{
+  public:
+	// How far (in tiles, horizontally) a unit is considered able to fire
+	static const int THREAT_RANGE = 10;
+	// How many levels above and below itself a unit is considered able to fire at
+	static const int THREAT_LEVELS = 1;
+
+	BattleThreatField(Vec3<int> size);
+
+	// Number of enemies known to 'org' that could fire at 'position'
+	int getThreat(StateRef<Organisation> org, Vec3<int> position) const;
+
+	// Lines of fire through 'tile' have to be found again
+	void mapChanged(Vec3<int> tile);
+
+	// Catches up with where units are, who sees whom and what changed on the map since the last
+	// update, must be called before the AI thinks
+	void update(Battle &battle);
+
+  private:
+	// Tiles a unit could fire at from one position in one stance
+	class Coverage
+	{
+	  public:
+		Vec3<int> position;
+		BodyState bodyState;
+		std::vector<int> tiles;
+	};
+
+	class OrganisationThreat
+	{
+	  public:
+		std::vector<uint16_t> threat;
+		// Coverage of every enemy currently counted in 'threat', by unit id
+		std::map<UString, sp<Coverage>> counted;
+	};
+
+	Vec3<int> size;
+	// By unit id, only for spotted units able to fire
+	std::map<UString, sp<Coverage>> coverage;
+	std::map<StateRef<Organisation>, OrganisationThreat> organisations;
+	std::set<Vec3<int>> changedTiles;
+
+	int getIndex(Vec3<int> position) const;
+	sp<Coverage> findCoverage(TileMap &map, BattleUnit &u) const;
+};
+
+} // namespace OpenApoc
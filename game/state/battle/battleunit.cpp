@@ -271,7 +271,7 @@ void BattleUnit::calculateVisionToTerrain(GameState &state, Battle &battle, Tile
                                           Vec3<float> eyesPos)
 {
 	static const int lazyLimit = 5 * 9;
-	std::set<int> discoveredBlocks;
+	ArenaSet<int> discoveredBlocks;
 	auto &visibleBlocks = battle.visibleBlocks.at(owner);
 
 	// Update unit's vision of los block he's standing in
@@ -284,7 +284,7 @@ void BattleUnit::calculateVisionToTerrain(GameState &state, Battle &battle, Tile
 		}
 	}
 
-	auto blocksToCheck = std::set<int>();
+	ArenaSet<int> blocksToCheck;
 	int totalChecks = 0;
 	// Calc los to other blocks we haven't seen yet
 	for (int idx = 0; idx < (int)visibleBlocks.size(); idx++)
@@ -330,8 +330,8 @@ void BattleUnit::calculateVisionToTerrain(GameState &state, Battle &battle, Tile
 }
 
 void BattleUnit::calculateVisionToLosBlocks(GameState &state, Battle &battle, TileMap &map,
-                                            Vec3<float> eyesPos, std::set<int> &discoveredBlocks,
-                                            std::set<int> &blocksToCheck)
+                                            Vec3<float> eyesPos, ArenaSet<int> &discoveredBlocks,
+                                            ArenaSet<int> &blocksToCheck)
 {
 	auto &visibleBlocks = battle.visibleBlocks.at(owner);
 	for (auto &idx : blocksToCheck)
@@ -419,7 +419,7 @@ void BattleUnit::calculateVisionToLosBlocks(GameState &state, Battle &battle, Ti
 
 void BattleUnit::calculateVisionToLosBlocksLazy(GameState &state, Battle &battle, TileMap &map,
                                                 Vec3<float> eyesPos,
-                                                std::set<int> &discoveredBlocks)
+                                                ArenaSet<int> &discoveredBlocks)
 {
 	auto &visibleBlocks = battle.visibleBlocks.at(owner);
 	auto &tileToLosBlock = battle.tileToLosBlock;
@@ -3410,22 +3410,6 @@ void BattleUnit::updatePsi(GameState &state, unsigned int ticks)
 	}
 }
 
-void BattleUnit::updateAI(GameState &state, unsigned int)
-{
-	if (!isConscious())
-	{
-		return;
-	}
-
-	// Decide
-	auto decision = aiList.think(state, *this);
-	if (!decision.isEmpty())
-	{
-		LogWarning("AI %s for unit %s decided to %s", decision.ai, id, decision.getName());
-		executeAIDecision(state, decision);
-	}
-}
-
 void BattleUnit::update(GameState &state, unsigned int ticks)
 {
 	bool realTime = state.current_battle->mode == Battle::Mode::RealTime;
@@ -3524,8 +3508,7 @@ void BattleUnit::update(GameState &state, unsigned int ticks)
 	updateAttacking(state, ticks);
 	// Unit's psi attack state
 	updatePsi(state, ticks);
-	// AI
-	updateAI(state, ticks);
+	// AI decides after every unit has updated, see Battle::updateUnitAI()
 	// Who else? :)
 	triggerBrainsuckers(state);
 }
@@ -3901,7 +3884,7 @@ void BattleUnit::sendAgentEvent(GameState &state, GameEventType type, bool check
 	         {&state, id}) !=
 	         state.current_battle->visibleUnits[state.current_battle->currentPlayer].end()))
 	{
-		fw().pushEvent(new GameAgentEvent(type, {&state, agent.id}));
+		state.events.raise<GameAgentEvent>(type, StateRef<Agent>(&state, agent.id));
 	}
 }
 
@@ -5396,7 +5379,7 @@ bool BattleUnit::cancelMissions(GameState &state, bool forced)
 	if (forced)
 	{
 		// Drop gear used by missions, remove headcrab
-		std::list<sp<AEquipment>> equipToDrop;
+		ArenaList<sp<AEquipment>> equipToDrop;
 		for (auto &m : missions)
 		{
 			if (m->item && m->item->ownerAgent)
@@ -7,9 +7,11 @@
 #include "game/state/battle/battle.h"
 #include "game/state/battle/battleunitmission.h"
 #include "game/state/gametime.h"
+#include "library/arena.h"
 #include "library/sp.h"
 #include "library/strings.h"
 #include "library/vec.h"
+#include "library/xorshift.h"
 #include <list>
 #include <map>
 #include <vector>
@@ -353,6 +355,9 @@ class BattleUnit : public StateObject, public std::enable_shared_from_this<Battl
 
 	// AI list
 	AIBlockUnit aiList;
+	// Random numbers for the unit's AI, reseeded from the game's before units decide every tick, so
+	// that units deciding on different threads still come to the same decisions. Not serialized
+	Xorshift128Plus<uint32_t> aiRng;
 
 	// [Methods]
 
@@ -648,8 +653,6 @@ class BattleUnit : public StateObject, public std::enable_shared_from_this<Battl
 	void updateAttacking(GameState &state, unsigned int ticks);
 	// Updates unit's psi attack (sustain payment, effect application etc.)
 	void updatePsi(GameState &state, unsigned int ticks);
-	// Updates unit's AI list
-	void updateAI(GameState &state, unsigned int ticks);
 
 	void triggerProximity(GameState &state);
 	void triggerBrainsuckers(GameState &state);
@@ -697,12 +700,12 @@ class BattleUnit : public StateObject, public std::enable_shared_from_this<Battl
 	// Calculate unit's vision to LBs checking every one independently
 	// Figure out a center tile of a block and check if it's visible (no collision)
 	void calculateVisionToLosBlocks(GameState &state, Battle &battle, TileMap &map,
-	                                Vec3<float> eyesPos, std::set<int> &discoveredBlocks,
-	                                std::set<int> &blocksToCheck);
+	                                Vec3<float> eyesPos, ArenaSet<int> &discoveredBlocks,
+	                                ArenaSet<int> &blocksToCheck);
 	// Calculate unit's vision to LBs using "shotgun" approach:
 	// Shoot 25 beams and include everything that was passed through into list of visible blocks
 	void calculateVisionToLosBlocksLazy(GameState &state, Battle &battle, TileMap &map,
-	                                    Vec3<float> eyesPos, std::set<int> &discoveredBlocks);
+	                                    Vec3<float> eyesPos, ArenaSet<int> &discoveredBlocks);
 	void calculateVisionToUnits(GameState &state, Battle &battle, TileMap &map,
 	                            Vec3<float> eyesPos);
 	bool calculateVisionToUnit(GameState &state, Battle &battle, TileMap &map, Vec3<float> eyesPos,
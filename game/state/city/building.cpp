@@ -86,32 +86,43 @@ bool Building::hasAliens() const
 	return false;
 }
 
-void Building::updateDetection(GameState &state, unsigned int ticks)
+void Building::updateDetection(GameState &state)
 {
-	if (ticksDetectionTimeOut > 0)
+	auto ticks = state.gameTime.getTicks();
+	if (ticksDetectionTimeOutEnd > ticks)
 	{
-		if (ticksDetectionTimeOut < ticks)
-		{
-			ticksDetectionTimeOut = 0;
-		}
-		else
-		{
-			ticksDetectionTimeOut -= ticks;
-		}
 		return;
 	}
 	detected = false;
-	ticksDetectionAttemptAccumulated += ticks;
-	while (ticksDetectionAttemptAccumulated >= TICKS_PER_DETECTION_ATTEMPT[state.difficulty])
+	if (ticksNextDetectionAttempt <= ticks && hasAliens())
 	{
-		ticksDetectionAttemptAccumulated -= TICKS_PER_DETECTION_ATTEMPT[state.difficulty];
+		ticksNextDetectionAttempt = ticks + TICKS_PER_DETECTION_ATTEMPT[state.difficulty];
 		detect(state, state.firstDetection || owner == state.getPlayer());
 	}
 }
 
+uint64_t Building::getNextDetectionUpdate(const GameState &state, uint64_t ticks) const
+{
+	if (ticksDetectionTimeOutEnd > ticks)
+	{
+		return ticksDetectionTimeOutEnd;
+	}
+	if (!hasAliens())
+	{
+		return 0;
+	}
+	if (ticksNextDetectionAttempt > ticks)
+	{
+		return ticksNextDetectionAttempt;
+	}
+	// Attempts that passed while there were no aliens are skipped, but stay in step
+	uint64_t period = TICKS_PER_DETECTION_ATTEMPT[state.difficulty];
+	return ticksNextDetectionAttempt + ((ticks - ticksNextDetectionAttempt) / period + 1) * period;
+}
+
 void Building::detect(GameState &state, bool forced)
 {
-	if (ticksDetectionTimeOut > 0)
+	if (ticksDetectionTimeOutEnd > state.gameTime.getTicks())
 	{
 		return;
 	}
@@ -172,7 +183,10 @@ void Building::detect(GameState &state, bool forced)
 		}
 	}
 	state.firstDetection = false;
-	ticksDetectionTimeOut = TICKS_DETECTION_TIMEOUT;
+	// Attempts are put on hold while timed out
+	ticksDetectionTimeOutEnd = state.gameTime.getTicks() + TICKS_DETECTION_TIMEOUT;
+	ticksNextDetectionAttempt =
+	    ticksDetectionTimeOutEnd + TICKS_PER_DETECTION_ATTEMPT[state.difficulty];
 	StateRef<Base> base;
 	if (owner == state.getPlayer())
 	{
@@ -188,16 +202,15 @@ void Building::detect(GameState &state, bool forced)
 	}
 	if (base)
 	{
-		auto event = new GameDefenseEvent(GameEventType::DefendTheBase, base, state.getAliens());
-		fw().pushEvent(event);
+		state.events.raise<GameDefenseEvent>(GameEventType::DefendTheBase, base, state.getAliens());
 	}
 	else
 	{
 		detected = true;
 
-		auto event = new GameBuildingEvent(GameEventType::AlienSpotted,
-		                                   {&state, Building::getId(state, shared_from_this())});
-		fw().pushEvent(event);
+		state.events.raise<GameBuildingEvent>(
+		    GameEventType::AlienSpotted,
+		    StateRef<Building>(&state, Building::getId(state, shared_from_this())));
 	}
 }
 
@@ -4,6 +4,7 @@
 #include "game/state/stateobject.h"
 #include "library/rect.h"
 #include "library/vec.h"
+#include <cstdint>
 #include <set>
 #include <vector>
 
@@ -51,12 +52,19 @@ class Building : public StateObject, public std::enable_shared_from_this<Buildin
 	std::vector<Vec3<int>> landingPadLocations;
 	std::set<StateRef<Vehicle>> landed_vehicles;
 
-	unsigned ticksDetectionTimeOut = 0;
-	unsigned ticksDetectionAttemptAccumulated = 0;
+	// Game time the current detection timeout ends at, and that of the next detection attempt.
+	// Attempts are only made while there are aliens in the building and it isn't timed out, and
+	// every period of TICKS_PER_DETECTION_ATTEMPT after the next attempt is one as well
+	uint64_t ticksDetectionTimeOutEnd = 0;
+	uint64_t ticksNextDetectionAttempt = 0;
 	bool detected = false;
 
 	bool hasAliens() const;
-	void updateDetection(GameState &state, unsigned int ticks);
+	// Ends the detection timeout or makes a detection attempt if either is due
+	void updateDetection(GameState &state);
+	// The game time after 'ticks' the detection timeout ends at or the next attempt is due at, or
+	// 0 if there's nothing to do until aliens move in
+	uint64_t getNextDetectionUpdate(const GameState &state, uint64_t ticks) const;
 	void detect(GameState &state, bool forced = false);
 	void alienGrowth(GameState &state);
 };
@@ -7,6 +7,7 @@
 #include "game/state/city/projectile.h"
 #include "game/state/city/scenery.h"
 #include "game/state/city/vehicle.h"
+#include "game/state/city/vehiclegrid.h"
 #include "game/state/city/vehiclemission.h"
 #include "game/state/city/vequipment.h"
 #include "game/state/gamestate.h"
@@ -14,7 +15,9 @@
 #include "game/state/rules/scenery_tile_type.h"
 #include "game/state/rules/vequipment_type.h"
 #include "game/state/tileview/collision.h"
+#include "game/state/tileview/pathsearch.h"
 #include "game/state/tileview/tile.h"
+#include "game/state/tileview/tileobject_doodad.h"
 #include "game/state/tileview/tileobject_projectile.h"
 #include "game/state/tileview/tileobject_scenery.h"
 #include "game/state/tileview/tileobject_vehicle.h"
@@ -45,6 +48,19 @@ City::~City()
 		p->tileObject = nullptr;
 	}
 	this->projectiles.clear();
+	for (auto &d : this->doodads)
+	{
+		if (d->tileObject)
+			d->tileObject->removeFromMap();
+		d->tileObject = nullptr;
+	}
+	this->doodads.clear();
+	for (auto &p : this->portals)
+	{
+		if (p->tileObject)
+			p->tileObject->removeFromMap();
+		p->tileObject = nullptr;
+	}
 	for (auto &s : this->scenery)
 	{
 		if (s->tileObject)
@@ -72,6 +88,8 @@ void City::initMap()
 		LogError("Called on city with existing map");
 		return;
 	}
+	this->vehicleGrid.reset(new VehicleGrid(this->size, VELOCITY_SCALE_CITY));
+	this->pathSearches.reset(new PathSearchQueue());
 	this->map.reset(new TileMap(this->size, VELOCITY_SCALE_CITY,
 	                            {VOXEL_X_CITY, VOXEL_Y_CITY, VOXEL_Z_CITY}, layerMap));
 	for (auto &s : this->scenery)
@@ -129,6 +147,11 @@ void City::update(GameState &state, unsigned int ticks)
 	 * some activity in the city*/
 	std::uniform_int_distribution<int> bld_distribution(0, (int)this->buildings.size() - 1);
 
+	this->vehicleGrid->updateHostility(state);
+	Trace::start("City::update::pathSearches->update");
+	this->pathSearches->update(ticks);
+	Trace::end("City::update::pathSearches->update");
+
 	// Need to use a 'safe' iterator method (IE keep the next it before calling ->update)
 	// as update() calls can erase it's object from the lists
 
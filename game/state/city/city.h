@@ -27,7 +27,9 @@ class Doodad;
 class DoodadType;
 class SceneryTileType;
 class BaseLayout;
+class PathSearchQueue;
 class TileMap;
+class VehicleGrid;
 
 class City : public StateObject
 {
@@ -49,7 +51,11 @@ class City : public StateObject
 
 	std::set<sp<Projectile>> projectiles;
 
+	// Declared before the map, so that it outlives the vehicles removed from it
+	up<VehicleGrid> vehicleGrid;
 	up<TileMap> map;
+	// Searches for vehicle paths carried on across ticks
+	up<PathSearchQueue> pathSearches;
 
 	void update(GameState &state, unsigned int ticks);
 	void hourlyLoop(GameState &state);
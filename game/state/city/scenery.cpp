@@ -64,6 +64,8 @@ void Scenery::collapse(GameState &state)
 	if (this->type->isLandingPad)
 		return;
 	this->falling = true;
+	// Falling scenery is drawn as a moving object, have views rebuild its entry
+	this->tileObject->invalidateDrawing();
 
 	for (auto &s : this->supports)
 		s->collapse(state);
@@ -91,7 +93,7 @@ void Scenery::update(GameState &state, unsigned int ticks)
 		{
 			case TileObject::Type::Scenery:
 			{
-				auto sceneryTile = std::static_pointer_cast<TileObjectScenery>(obj);
+				auto sceneryTile = static_cast<TileObjectScenery *>(obj);
 				// Skip stuff already falling (wil include this)
 				if (sceneryTile->getOwner()->falling)
 					continue;
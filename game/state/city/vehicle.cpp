@@ -3,6 +3,7 @@
 #include "game/state/city/building.h"
 #include "game/state/city/city.h"
 #include "game/state/city/projectile.h"
+#include "game/state/city/vehiclegrid.h"
 #include "game/state/city/vehiclemission.h"
 #include "game/state/city/vequipment.h"
 #include "game/state/gamestate.h"
@@ -271,7 +272,8 @@ void Vehicle::update(GameState &state, unsigned int ticks)
 			}
 			else
 			{
-				enemy = findClosestEnemy(state, vehicleTile);
+				// Enemies out of range couldn't be fired at anyway
+				enemy = findClosestEnemy(state, vehicleTile, getFiringRange());
 			}
 
 			if (enemy)
@@ -297,6 +299,16 @@ void Vehicle::update(GameState &state, unsigned int ticks)
 	}
 }
 
+unsigned int Vehicle::getTicksToNextEvent() const
+{
+	if (this->missions.empty())
+	{
+		// Idle vehicles only get something to do from the city update
+		return std::numeric_limits<unsigned int>::max();
+	}
+	return this->missions.front()->getTicksToNextEvent(*this);
+}
+
 bool Vehicle::isCrashed() const { return this->health < this->type->crash_health; }
 /* // Test code to make UFOs crash immediately upon hit,
 // may be useful in the future as crashing is not yet perfect
@@ -339,6 +351,10 @@ bool Vehicle::applyDamage(GameState &state, int damage, float armour)
 			}
 			else if (isCrashed())
 			{
+				if (this->city && this->city->vehicleGrid)
+				{
+					this->city->vehicleGrid->vehicleCrashed();
+				}
 				this->missions.clear();
 				this->missions.emplace_back(VehicleMission::crashLand(state, *this));
 				this->missions.front()->start(state, *this);
@@ -414,50 +430,16 @@ void Vehicle::handleCollision(GameState &state, Collision &c)
 	}
 }
 
-sp<TileObjectVehicle> Vehicle::findClosestEnemy(GameState &state, sp<TileObjectVehicle> vehicleTile)
+sp<TileObjectVehicle> Vehicle::findClosestEnemy(GameState &state, sp<TileObjectVehicle> vehicleTile,
+                                                float maxRange)
 {
-	// Find the closest enemy within the firing arc
-	float closestEnemyRange = std::numeric_limits<float>::max();
-	sp<TileObjectVehicle> closestEnemy;
-	for (auto &pair : state.vehicles)
+	std::ignore = state;
+	if (!vehicleTile || !this->city || !this->city->vehicleGrid)
 	{
-		auto otherVehicle = pair.second;
-		if (otherVehicle.get() == this)
-		{
-			/* Can't fire at yourself */
-			continue;
-		}
-		if (otherVehicle->isCrashed())
-		{
-			// Can't fire at crashed vehicles
-			continue;
-		}
-		if (otherVehicle->city != this->city)
-		{
-			/* Can't fire on things a world away */
-			continue;
-		}
-		if (this->owner->isRelatedTo(otherVehicle->owner) != Organisation::Relation::Hostile)
-		{
-			/* Not hostile, skip */
-			continue;
-		}
-		auto otherVehicleTile = otherVehicle->tileObject;
-		if (!otherVehicleTile)
-		{
-			/* Not in the map, ignore */
-			continue;
-		}
-		float distance = vehicleTile->getDistanceTo(otherVehicleTile);
-
-		// FIXME: Check weapon arc against otherVehicle
-		if (distance < closestEnemyRange)
-		{
-			closestEnemyRange = distance;
-			closestEnemy = otherVehicleTile;
-		}
+		return nullptr;
 	}
-	return closestEnemy;
+	// Find the closest enemy within the firing arc
+	return this->city->vehicleGrid->findClosestEnemy(*vehicleTile, maxRange);
 }
 
 void Vehicle::attackTarget(GameState &state, sp<TileObjectVehicle> vehicleTile,
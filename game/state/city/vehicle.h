@@ -99,7 +99,9 @@ class Vehicle : public StateObject,
 	bool isCrashed() const;
 	bool applyDamage(GameState &state, int damage, float armour);
 	void handleCollision(GameState &state, Collision &c);
-	sp<TileObjectVehicle> findClosestEnemy(GameState &state, sp<TileObjectVehicle> vehicleTile);
+	// Only enemies within maxRange voxels are considered if it's positive
+	sp<TileObjectVehicle> findClosestEnemy(GameState &state, sp<TileObjectVehicle> vehicleTile,
+	                                       float maxRange = 0.0f);
 	void attackTarget(GameState &state, sp<TileObjectVehicle> vehicleTile,
 	                  sp<TileObjectVehicle> enemyTile);
 	float getFiringRange() const;
@@ -136,6 +138,9 @@ class Vehicle : public StateObject,
 	void setPosition(const Vec3<float> &pos);
 
 	virtual void update(GameState &state, unsigned int ticks);
+	// Ticks until the vehicle has to decide on something, as far as its missions know. Until then
+	// it can be updated in a single step
+	unsigned int getTicksToNextEvent() const;
 
 	sp<Equipment> getEquipmentAt(const Vec2<int> &position) const override;
 	const std::list<EquipmentLayoutSlot> &getSlots() const override;
@@ -0,0 +1,255 @@
+#include "game/state/city/vehiclegrid.h"
+#include "game/state/city/vehicle.h"
+#include "game/state/gamestate.h"
+#include "game/state/organisation.h"
+#include "game/state/rules/vehicle_type.h"
+#include "game/state/tileview/tileobject_vehicle.h"
+#include "framework/logger.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace OpenApoc
+{
+
+VehicleGrid::VehicleGrid(Vec3<int> citySize, Vec3<float> velocityScale)
+    : size((citySize.x + CELL_SIZE - 1) / CELL_SIZE, (citySize.y + CELL_SIZE - 1) / CELL_SIZE),
+      velocityScale(velocityScale), cells(size.x * size.y)
+{
+}
+
+VehicleGrid::~VehicleGrid()
+{
+	for (auto &cell : cells)
+	{
+		for (auto *object : cell)
+		{
+			object->grid = nullptr;
+			object->gridCell = -1;
+		}
+	}
+}
+
+int VehicleGrid::getCell(Vec3<float> position) const
+{
+	// Objects can be slightly outside the map, so clamp them to the edge cells
+	int x = clamp((int)position.x / CELL_SIZE, 0, size.x - 1);
+	int y = clamp((int)position.y / CELL_SIZE, 0, size.y - 1);
+	return y * size.x + x;
+}
+
+void VehicleGrid::update(TileObjectVehicle &object, Vec3<float> position)
+{
+	int cell = getCell(position);
+	if (object.grid == this && object.gridCell == cell)
+	{
+		return;
+	}
+	if (object.grid == this)
+	{
+		removeFromCell(object);
+	}
+	else
+	{
+		// Vehicle could also have moved here from another city
+		if (object.grid)
+		{
+			object.grid->remove(object);
+		}
+		hostileVehiclesTo = nullptr;
+	}
+	cells[cell].push_back(&object);
+	object.grid = this;
+	object.gridCell = cell;
+}
+
+void VehicleGrid::remove(TileObjectVehicle &object)
+{
+	if (object.grid != this)
+	{
+		return;
+	}
+	removeFromCell(object);
+	object.grid = nullptr;
+	object.gridCell = -1;
+	hostileVehiclesTo = nullptr;
+}
+
+void VehicleGrid::vehicleCrashed() { hostileVehiclesTo = nullptr; }
+
+void VehicleGrid::removeFromCell(TileObjectVehicle &object)
+{
+	// Keep the order within the cell, so that queries are deterministic
+	auto &cell = cells[object.gridCell];
+	auto it = std::find(cell.begin(), cell.end(), &object);
+	if (it != cell.end())
+	{
+		cell.erase(it);
+	}
+	else
+	{
+		LogError("Vehicle not found in its grid cell %d", object.gridCell);
+	}
+}
+
+void VehicleGrid::updateHostility(GameState &state)
+{
+	auto count = (unsigned int)state.organisations.size();
+	organisationIndices.clear();
+	std::vector<bool> previousHostility;
+	previousHostility.swap(hostility);
+	hostility.assign(count * count, false);
+	std::vector<StateRef<Organisation>> organisations;
+	organisations.reserve(count);
+	for (auto &pair : state.organisations)
+	{
+		organisationIndices[pair.second.get()] = (unsigned int)organisations.size();
+		organisations.emplace_back(&state, pair.first);
+	}
+	for (unsigned int from = 0; from < count; from++)
+	{
+		for (unsigned int to = 0; to < count; to++)
+		{
+			hostility[from * count + to] = organisations[from]->isRelatedTo(organisations[to]) ==
+			                               Organisation::Relation::Hostile;
+		}
+	}
+	if (hostility != previousHostility)
+	{
+		hostileVehiclesTo = nullptr;
+	}
+}
+
+int VehicleGrid::getOrganisationIndex(const Organisation &organisation) const
+{
+	auto it = organisationIndices.find(&organisation);
+	if (it == organisationIndices.end())
+	{
+		return -1;
+	}
+	return it->second;
+}
+
+bool VehicleGrid::hasHostileVehicles(const StateRef<Organisation> &organisation) const
+{
+	if (hostileVehiclesTo == &*organisation)
+	{
+		return hostileVehiclesPresent;
+	}
+	hostileVehiclesTo = &*organisation;
+	hostileVehiclesPresent = false;
+	for (auto &cell : cells)
+	{
+		for (auto *object : cell)
+		{
+			auto vehicle = object->getVehicle();
+			// Relations are looked at directly, as they may have changed since the last tick
+			if (vehicle && vehicle->type->aggressiveness > 0 &&
+			    vehicle->owner->isRelatedTo(organisation) == Organisation::Relation::Hostile &&
+			    !vehicle->isCrashed())
+			{
+				hostileVehiclesPresent = true;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool VehicleGrid::isHostile(const Organisation &from, const Organisation &to) const
+{
+	int fromIndex = getOrganisationIndex(from);
+	int toIndex = getOrganisationIndex(to);
+	if (fromIndex == -1 || toIndex == -1)
+	{
+		return false;
+	}
+	return hostility[fromIndex * organisationIndices.size() + toIndex];
+}
+
+sp<TileObjectVehicle> VehicleGrid::findClosestEnemy(const TileObjectVehicle &from,
+                                                    float maxRange) const
+{
+	auto vehicle = from.getVehicle();
+	if (!vehicle)
+	{
+		return nullptr;
+	}
+	int ownerIndex = getOrganisationIndex(*vehicle->owner);
+	if (ownerIndex == -1)
+	{
+		return nullptr;
+	}
+	auto organisationCount = organisationIndices.size();
+
+	float closestEnemyRange =
+	    maxRange > 0.0f ? std::nextafter(maxRange, std::numeric_limits<float>::max())
+	                    : std::numeric_limits<float>::max();
+	TileObjectVehicle *closestEnemy = nullptr;
+
+	auto center = from.getCenter();
+	int cell = getCell(center);
+	Vec2<int> cellPos = {cell % size.x, cell / size.x};
+	// Anything outside the ring of cells around ours is at least this much further away
+	float ringDistance = CELL_SIZE * std::min(velocityScale.x, velocityScale.y);
+	int ringCount = std::max(size.x, size.y);
+	for (int ring = 0; ring < ringCount; ring++)
+	{
+		if (ring > 0 && (ring - 1) * ringDistance > closestEnemyRange)
+		{
+			break;
+		}
+		for (int y = cellPos.y - ring; y <= cellPos.y + ring; y++)
+		{
+			if (y < 0 || y >= size.y)
+			{
+				continue;
+			}
+			for (int x = cellPos.x - ring; x <= cellPos.x + ring; x++)
+			{
+				// Only go through the border of the ring
+				if (x < 0 || x >= size.x ||
+				    (std::abs(x - cellPos.x) != ring && std::abs(y - cellPos.y) != ring))
+				{
+					continue;
+				}
+				for (auto *otherVehicleTile : cells[y * size.x + x])
+				{
+					if (otherVehicleTile == &from)
+					{
+						/* Can't fire at yourself */
+						continue;
+					}
+					auto otherVehicle = otherVehicleTile->getVehicle();
+					if (!otherVehicle || otherVehicle->isCrashed())
+					{
+						// Can't fire at crashed vehicles
+						continue;
+					}
+					int otherIndex = getOrganisationIndex(*otherVehicle->owner);
+					if (otherIndex == -1 ||
+					    !hostility[ownerIndex * organisationCount + otherIndex])
+					{
+						/* Not hostile, skip */
+						continue;
+					}
+					float distance = glm::length((otherVehicleTile->getCenter() - center) *
+					                             velocityScale);
+					// FIXME: Check weapon arc against otherVehicle
+					if (distance < closestEnemyRange)
+					{
+						closestEnemyRange = distance;
+						closestEnemy = otherVehicleTile;
+					}
+				}
+			}
+		}
+	}
+	if (!closestEnemy)
+	{
+		return nullptr;
+	}
+	return std::static_pointer_cast<TileObjectVehicle>(closestEnemy->shared_from_this());
+}
+
+} // namespace OpenApoc
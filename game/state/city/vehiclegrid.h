@@ -0,0 +1,65 @@
+#pragma once
+
+#include "game/state/stateobject.h"
+#include "library/sp.h"
+#include "library/vec.h"
+#include <unordered_map>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class GameState;
+class Organisation;
+class TileObjectVehicle;
+
+// Uniform grid of the vehicles flying in a city, so that looking for vehicles near a location only
+// has to go through a few cells instead of every vehicle in the game
+class VehicleGrid
+{
+  public:
+	// Width and length of a cell, in tiles
+	static const int CELL_SIZE = 16;
+
+	VehicleGrid(Vec3<int> citySize, Vec3<float> velocityScale);
+	// Vehicles can outlive the city, so they're detached from the grid when it's destroyed
+	~VehicleGrid();
+
+	// Called by TileObjectVehicle whenever it's moved, and when it's removed from the map
+	void update(TileObjectVehicle &object, Vec3<float> position);
+	void remove(TileObjectVehicle &object);
+
+	// Called when a vehicle crashed, as it's no threat any more
+	void vehicleCrashed();
+
+	// Caches organisation relations, must be called every tick before any enemy is looked for
+	void updateHostility(GameState &state);
+	bool isHostile(const Organisation &from, const Organisation &to) const;
+
+	// Whether there's any armed vehicle hostile to 'organisation' that didn't crash. The vehicles
+	// are only gone through again once one was added, removed or crashed, or relations changed
+	bool hasHostileVehicles(const StateRef<Organisation> &organisation) const;
+
+	// Returns the closest vehicle that is hostile to the owner of 'from', considering only those
+	// within maxRange voxels if it's positive
+	sp<TileObjectVehicle> findClosestEnemy(const TileObjectVehicle &from,
+	                                       float maxRange = 0.0f) const;
+
+  private:
+	Vec2<int> size;
+	Vec3<float> velocityScale;
+	std::vector<std::vector<TileObjectVehicle *>> cells;
+
+	std::unordered_map<const Organisation *, unsigned int> organisationIndices;
+	// Row per organisation, true if it's hostile to the organisation of the column
+	std::vector<bool> hostility;
+
+	mutable const Organisation *hostileVehiclesTo = nullptr;
+	mutable bool hostileVehiclesPresent = false;
+
+	int getCell(Vec3<float> position) const;
+	void removeFromCell(TileObjectVehicle &object);
+	int getOrganisationIndex(const Organisation &organisation) const;
+};
+
+} // namespace OpenApoc
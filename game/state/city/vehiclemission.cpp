@@ -13,7 +13,9 @@
 #include "game/state/tileview/tileobject_scenery.h"
 #include "game/state/tileview/tileobject_shadow.h"
 #include "game/state/tileview/tileobject_vehicle.h"
+#include "library/arena.h"
 #include "library/strings_format.h"
+#include <algorithm>
 #include <glm/glm.hpp>
 
 namespace OpenApoc
@@ -75,7 +77,7 @@ class FlyingVehicleTileHelper : public CanEnterTileHelper
 				return false;
 			if (obj->getType() == TileObject::Type::Scenery)
 			{
-				auto sceneryTile = std::static_pointer_cast<TileObjectScenery>(obj);
+				auto sceneryTile = static_cast<TileObjectScenery *>(obj);
 				if (sceneryTile->scenery.lock()->type->isLandingPad)
 				{
 					continue;
@@ -164,8 +166,7 @@ class FlyingVehicleTileHelper : public CanEnterTileHelper
 				{
 					if (obj->getType() == TileObject::Type::Scenery)
 					{
-						auto scenery =
-						    std::static_pointer_cast<TileObjectScenery>(obj)->scenery.lock();
+						auto scenery = static_cast<TileObjectScenery *>(obj)->scenery.lock();
 						if (scenery->type->tile_type != SceneryTileType::TileType::General ||
 						    scenery->type->walk_mode == SceneryTileType::WalkMode::None ||
 						    scenery->type->isLandingPad || scenery->type->isHill)
@@ -433,6 +434,7 @@ bool VehicleMission::takeOffCheck(GameState &state, Vehicle &v, UString mission)
 
 bool VehicleMission::getNextDestination(GameState &state, Vehicle &v, Vec3<float> &dest)
 {
+	bool pathPending = isPathPending(v);
 	switch (this->type)
 	{
 		case MissionType::TakeOff:      // Fall-through
@@ -445,6 +447,9 @@ bool VehicleMission::getNextDestination(GameState &state, Vehicle &v, Vec3<float
 		case MissionType::Patrol:
 			if (!advanceAlongPath(state, dest, v))
 			{
+				// Next leg is still being looked for
+				if (pathPending)
+					return false;
 				if (missionCounter == 0)
 					return false;
 
@@ -501,11 +506,11 @@ bool VehicleMission::getNextDestination(GameState &state, Vehicle &v, Vec3<float
 					}
 					return false;
 				}
-				else if (targetTile->getOwningTile()->position != this->targetLocation ||
-				         currentPlannedPath.empty())
+				else if (!pathPending &&
+				         (targetTile->getOwningTile()->position != this->targetLocation ||
+				          currentPlannedPath.empty()))
 				{
 					// adjust the path if target moved
-					currentPlannedPath.clear();
 					this->targetLocation = targetTile->getOwningTile()->position;
 					setPathTo(state, v, this->targetLocation, 25, false);
 				}
@@ -662,7 +667,7 @@ void VehicleMission::update(GameState &state, Vehicle &v, unsigned int ticks, bo
 					}
 				}
 			}
-			if (vTile && !finished && this->currentPlannedPath.empty())
+			if (vTile && !finished && this->currentPlannedPath.empty() && !pathSearch)
 			{
 				// Forever path to portal, eventually it will work
 				setPathTo(state, v, targetLocation);
@@ -672,7 +677,7 @@ void VehicleMission::update(GameState &state, Vehicle &v, unsigned int ticks, bo
 		case MissionType::Crash:
 		{
 			auto vTile = v.tileObject;
-			if (vTile && !finished && this->currentPlannedPath.empty())
+			if (vTile && !finished && this->currentPlannedPath.empty() && !pathSearch)
 			{
 				LogWarning("Crash landing failed, restartng...");
 				auto *restartMision = restartNextMission(state, v);
@@ -684,7 +689,7 @@ void VehicleMission::update(GameState &state, Vehicle &v, unsigned int ticks, bo
 		case MissionType::GotoLocation:
 		{
 			auto vTile = v.tileObject;
-			if (vTile && !finished && this->currentPlannedPath.empty())
+			if (vTile && !finished && this->currentPlannedPath.empty() && !pathSearch)
 			{
 				if (reRouteAttempts > 0)
 				{
@@ -694,7 +699,7 @@ void VehicleMission::update(GameState &state, Vehicle &v, unsigned int ticks, bo
 				else
 				{
 					// Finall attempt, give up if fails
-					setPathTo(state, v, targetLocation, 500, true, true);
+					setPathTo(state, v, targetLocation, 2000, true, true);
 				}
 			}
 			return;
@@ -746,8 +751,54 @@ bool VehicleMission::isFinished(GameState &state, Vehicle &v, bool callUpdateIfF
 	return false;
 }
 
+unsigned int VehicleMission::getTicksToNextEvent(const Vehicle &v) const
+{
+	switch (this->type)
+	{
+		case MissionType::Snooze:
+			return this->timeToSnooze;
+		case MissionType::RestartNextMission:
+			return 0;
+		case MissionType::TakeOff:
+		case MissionType::Land:
+		case MissionType::GotoPortal:
+		case MissionType::GotoLocation:
+		case MissionType::GotoBuilding:
+		case MissionType::InfiltrateSubvert:
+		case MissionType::Crash:
+		case MissionType::Patrol:
+		{
+			float speed = v.getSpeed();
+			if (!v.tileObject || this->currentPlannedPath.empty() || speed <= 0)
+			{
+				break;
+			}
+			// Nothing changes until the end of the path, the mover takes care of every node on
+			// the way
+			float distance = 0.0f;
+			Vec3<float> from = v.getPosition();
+			for (auto &node : this->currentPlannedPath)
+			{
+				auto to = Vec3<float>{node.x, node.y, node.z} + Vec3<float>{0.5f, 0.5f, 0.5f};
+				distance += glm::length((to - from) * VELOCITY_SCALE_CITY);
+				from = to;
+			}
+			return (unsigned int)(distance * TICK_SCALE / speed);
+		}
+		default:
+			break;
+	}
+	// Anything else (like waiting for a landing pad, or chasing another vehicle) is looked at
+	// again every second
+	return TICKS_PER_SECOND;
+}
+
 bool VehicleMission::isFinishedInternal(GameState &, Vehicle &v)
 {
+	if (isPathPending(v))
+	{
+		return false;
+	}
 	switch (this->type)
 	{
 		case MissionType::TakeOff:
@@ -1063,7 +1114,7 @@ void VehicleMission::start(GameState &state, Vehicle &v)
 					    pos.y < b->bounds.p0.y || pos.y >= b->bounds.p1.y)
 					{
 						Vec3<int> goodPos{0, 0, 0};
-						std::set<Vec2<int>> rooftop;
+						ArenaSet<Vec2<int>> rooftop;
 						// Choose highest layer above building, choose middle tile within that
 						for (int z = map.size.z - 1; z > 0; z--)
 						{
@@ -1156,6 +1207,7 @@ void VehicleMission::start(GameState &state, Vehicle &v)
 						{
 							targetBuilding->current_crew[pair.first] += pair.second;
 						}
+						state.scheduleBuildingDetection(targetBuilding.id);
 					}
 					// Retreat
 					v.missions.emplace_back(VehicleMission::gotoPortal(state, v));
@@ -1193,7 +1245,7 @@ void VehicleMission::setPathTo(GameState &state, Vehicle &v, Vec3<int> target, i
 				{
 					if (obj->getType() == TileObject::Type::Scenery)
 					{
-						auto sceneryTile = std::static_pointer_cast<TileObjectScenery>(obj);
+						auto sceneryTile = static_cast<TileObjectScenery *>(obj);
 						if (sceneryTile->scenery.lock()->type->isLandingPad)
 						{
 							continue;
@@ -1295,7 +1347,7 @@ void VehicleMission::setPathTo(GameState &state, Vehicle &v, Vec3<int> target, i
 				}
 				else
 				{
-					std::list<Vec3<int>> sideStepLocations;
+					ArenaList<Vec3<int>> sideStepLocations;
 
 					for (int x = midX - maxDiff; x <= midX + maxDiff; x++)
 					{
@@ -1323,15 +1375,11 @@ void VehicleMission::setPathTo(GameState &state, Vehicle &v, Vec3<int> target, i
 			}
 		}
 
-		auto path = map.findShortestPath(vehicleTile->getOwningTile()->position, target,
-		                                 maxIterations, FlyingVehicleTileHelper{map, v});
-
-		// Always start with the current position
-		this->currentPlannedPath.push_back(vehicleTile->getOwningTile()->position);
-		for (auto &p : path)
-		{
-			this->currentPlannedPath.push_back(p);
-		}
+		pathSearch = mksp<PathSearchQueue::Job>(map, vehicleTile->getOwningTile()->position,
+		                                        target, maxIterations,
+		                                        mkup<FlyingVehicleTileHelper>(map, v));
+		v.city->pathSearches->submit(pathSearch);
+		isPathPending(v);
 	}
 	else
 	{
@@ -1339,6 +1387,41 @@ void VehicleMission::setPathTo(GameState &state, Vehicle &v, Vec3<int> target, i
 	}
 }
 
+bool VehicleMission::isPathPending(Vehicle &v)
+{
+	if (!pathSearch)
+	{
+		return false;
+	}
+	if (!pathSearch->isFinished())
+	{
+		return true;
+	}
+	// Always start with the current position
+	this->currentPlannedPath.clear();
+	this->currentPlannedPath.push_back(pathSearch->getOrigin());
+	for (auto &p : pathSearch->getPath())
+	{
+		this->currentPlannedPath.push_back(p);
+	}
+	pathSearch.reset();
+	// If the vehicle moved on while the path was searched for, skip to where it is now
+	if (v.tileObject)
+	{
+		auto position = v.tileObject->getOwningTile()->position;
+		auto it = std::find(currentPlannedPath.begin(), currentPlannedPath.end(), position);
+		if (it != currentPlannedPath.end())
+		{
+			currentPlannedPath.erase(currentPlannedPath.begin(), it);
+		}
+		else
+		{
+			currentPlannedPath.push_front(position);
+		}
+	}
+	return false;
+}
+
 bool VehicleMission::advanceAlongPath(GameState &state, Vec3<float> &dest, Vehicle &v)
 {
 	// Add {0.5,0.5,0.5} to make it route to the center of the tile
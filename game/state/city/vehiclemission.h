@@ -1,6 +1,7 @@
 #pragma once
 
 #include "game/state/stateobject.h"
+#include "game/state/tileview/pathsearch.h"
 #include "library/strings.h"
 #include "library/vec.h"
 #include <list>
@@ -28,6 +29,12 @@ class VehicleMission
 
 	bool takeOffCheck(GameState &state, Vehicle &v, UString mission);
 
+	// Not serialized, a mission loaded while searching for a path starts the search again
+	sp<PathSearchQueue::Job> pathSearch;
+	// Takes the path found once the search is finished, returns true while it is still running.
+	// The vehicle keeps following the old path meanwhile, so the new one is joined where it is
+	bool isPathPending(Vehicle &v);
+
   public:
 	VehicleMission() = default;
 
@@ -35,8 +42,13 @@ class VehicleMission
 	bool getNextDestination(GameState &state, Vehicle &v, Vec3<float> &dest);
 	void update(GameState &state, Vehicle &v, unsigned int ticks, bool finished = false);
 	bool isFinished(GameState &state, Vehicle &v, bool callUpdateIfFinished = true);
+	// Ticks until the mission could finish or change what it's doing. Until then the vehicle can
+	// be updated all at once
+	unsigned int getTicksToNextEvent(const Vehicle &v) const;
 	void start(GameState &state, Vehicle &v);
-	void setPathTo(GameState &state, Vehicle &v, Vec3<int> target, int maxIterations = 500,
+	// The path may only be there a few ticks later, until then the vehicle keeps following the
+	// path it has, if any. The path found replaces it
+	void setPathTo(GameState &state, Vehicle &v, Vec3<int> target, int maxIterations = 2000,
 	               bool checkValidity = true, bool giveUpIfInvalid = false);
 	bool advanceAlongPath(GameState &state, Vec3<float> &dest, Vehicle &v);
 	bool isTakingOff(Vehicle &v);
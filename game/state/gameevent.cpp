@@ -235,4 +235,17 @@ GameDefenseEvent::GameDefenseEvent(GameEventType type, StateRef<Base> base,
     : GameEvent(type), base(base), organisation(organisation)
 {
 }
+
+up<Event> GameEvent::clone() const { return mkup<GameEvent>(*this); }
+up<Event> GameVehicleEvent::clone() const { return mkup<GameVehicleEvent>(*this); }
+up<Event> GameBaseEvent::clone() const { return mkup<GameBaseEvent>(*this); }
+up<Event> GameBuildingEvent::clone() const { return mkup<GameBuildingEvent>(*this); }
+up<Event> GameOrganisationEvent::clone() const { return mkup<GameOrganisationEvent>(*this); }
+up<Event> GameDefenseEvent::clone() const { return mkup<GameDefenseEvent>(*this); }
+up<Event> GameAgentEvent::clone() const { return mkup<GameAgentEvent>(*this); }
+up<Event> GameResearchEvent::clone() const { return mkup<GameResearchEvent>(*this); }
+up<Event> GameManufactureEvent::clone() const { return mkup<GameManufactureEvent>(*this); }
+up<Event> GameFacilityEvent::clone() const { return mkup<GameFacilityEvent>(*this); }
+up<Event> GameBattleEvent::clone() const { return mkup<GameBattleEvent>(*this); }
+up<Event> GameLocationEvent::clone() const { return mkup<GameLocationEvent>(*this); }
 }
@@ -27,6 +27,7 @@ class GameEvent : public Event
 
 	GameEvent(GameEventType type);
 	~GameEvent() override = default;
+	up<Event> clone() const override;
 	virtual UString message();
 };
 
@@ -39,6 +40,7 @@ class GameVehicleEvent : public GameEvent
 	GameVehicleEvent(GameEventType type, StateRef<Vehicle> vehicle,
 	                 StateRef<Vehicle> actor = nullptr);
 	~GameVehicleEvent() override = default;
+	up<Event> clone() const override;
 	UString message() override;
 };
 
@@ -49,6 +51,7 @@ class GameBaseEvent : public GameEvent
 
 	GameBaseEvent(GameEventType type, StateRef<Base> base);
 	~GameBaseEvent() override = default;
+	up<Event> clone() const override;
 	UString message() override;
 };
 
@@ -59,6 +62,7 @@ class GameBuildingEvent : public GameEvent
 
 	GameBuildingEvent(GameEventType type, StateRef<Building> building);
 	~GameBuildingEvent() override = default;
+	up<Event> clone() const override;
 	UString message() override;
 };
 
@@ -69,6 +73,7 @@ class GameOrganisationEvent : public GameEvent
 
 	GameOrganisationEvent(GameEventType type, StateRef<Organisation> organisation);
 	~GameOrganisationEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class GameDefenseEvent : public GameEvent
@@ -79,6 +84,7 @@ class GameDefenseEvent : public GameEvent
 
 	GameDefenseEvent(GameEventType type, StateRef<Base> base, StateRef<Organisation> organisation);
 	~GameDefenseEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class GameAgentEvent : public GameEvent
@@ -88,6 +94,7 @@ class GameAgentEvent : public GameEvent
 
 	GameAgentEvent(GameEventType type, StateRef<Agent> agent);
 	~GameAgentEvent() override = default;
+	up<Event> clone() const override;
 	UString message() override;
 };
 
@@ -99,6 +106,7 @@ class GameResearchEvent : public GameEvent
 
 	GameResearchEvent(GameEventType type, StateRef<ResearchTopic> topic, StateRef<Lab> lab);
 	~GameResearchEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class GameManufactureEvent : public GameEvent
@@ -112,6 +120,7 @@ class GameManufactureEvent : public GameEvent
 	GameManufactureEvent(GameEventType type, StateRef<ResearchTopic> topic, unsigned done,
 	                     unsigned goal, StateRef<Lab> lab);
 	~GameManufactureEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class GameFacilityEvent : public GameEvent
@@ -122,6 +131,7 @@ class GameFacilityEvent : public GameEvent
 
 	GameFacilityEvent(GameEventType type, sp<Base> base, sp<Facility> facility);
 	~GameFacilityEvent() override = default;
+	up<Event> clone() const override;
 };
 
 class GameBattleEvent : public GameEvent
@@ -131,6 +141,7 @@ class GameBattleEvent : public GameEvent
 
 	GameBattleEvent(GameEventType type, sp<Battle> battle);
 	~GameBattleEvent() override = default;
+	up<Event> clone() const override;
 	UString message() override;
 };
 
@@ -141,5 +152,6 @@ class GameLocationEvent : public GameEvent
 
 	GameLocationEvent(GameEventType type, Vec3<int> location);
 	~GameLocationEvent() override = default;
+	up<Event> clone() const override;
 };
 }
@@ -0,0 +1,105 @@
+#include "game/state/gameeventbus.h"
+#include "game/state/gameevent.h"
+#include <algorithm>
+#include <atomic>
+
+namespace OpenApoc
+{
+
+namespace
+{
+template <typename T>
+void subscribeAs(GameEventBus &bus, const void *owner,
+                 const std::function<void(GameEvent &)> &handler)
+{
+	bus.subscribe<T>(owner, [handler](T &event) { handler(event); });
+}
+} // anonymous namespace
+
+void GameEventBus::subscribeAll(const void *owner, std::function<void(GameEvent &)> handler)
+{
+	subscribeAs<GameEvent>(*this, owner, handler);
+	subscribeAs<GameVehicleEvent>(*this, owner, handler);
+	subscribeAs<GameBaseEvent>(*this, owner, handler);
+	subscribeAs<GameBuildingEvent>(*this, owner, handler);
+	subscribeAs<GameOrganisationEvent>(*this, owner, handler);
+	subscribeAs<GameDefenseEvent>(*this, owner, handler);
+	subscribeAs<GameAgentEvent>(*this, owner, handler);
+	subscribeAs<GameResearchEvent>(*this, owner, handler);
+	subscribeAs<GameManufactureEvent>(*this, owner, handler);
+	subscribeAs<GameFacilityEvent>(*this, owner, handler);
+	subscribeAs<GameBattleEvent>(*this, owner, handler);
+	subscribeAs<GameLocationEvent>(*this, owner, handler);
+}
+
+void GameEventBus::unsubscribe(const void *owner)
+{
+	std::lock_guard<std::mutex> l(this->lock);
+	for (size_t i = 0; i < channels.size(); i++)
+	{
+		auto &channel = channels[i];
+		if (!channel)
+		{
+			continue;
+		}
+		channel->unsubscribe(owner);
+		// A channel left without subscribers drops its pending events
+		if (!channel->hasPending())
+		{
+			pendingOrder.erase(std::remove(pendingOrder.begin(), pendingOrder.end(), i),
+			                   pendingOrder.end());
+		}
+	}
+}
+
+void GameEventBus::drain()
+{
+	// Handlers may raise events, even of a type not seen yet adding channels, so what's handed
+	// out is taken all at once and the lock isn't held while handing it out
+	{
+		std::lock_guard<std::mutex> l(this->lock);
+		std::swap(pendingOrder, dispatchingOrder);
+		dispatchingChannels.clear();
+		for (auto &channel : channels)
+		{
+			dispatchingChannels.push_back(channel.get());
+			if (channel)
+			{
+				channel->takePending();
+			}
+		}
+	}
+	for (auto index : dispatchingOrder)
+	{
+		dispatchingChannels[index]->dispatchNext();
+	}
+	dispatchingOrder.clear();
+	for (auto channel : dispatchingChannels)
+	{
+		if (channel)
+		{
+			channel->finishDispatch();
+		}
+	}
+}
+
+bool GameEventBus::hasPending() const
+{
+	std::lock_guard<std::mutex> l(this->lock);
+	for (auto &channel : channels)
+	{
+		if (channel && channel->hasPending())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t GameEventBus::nextChannelIndex()
+{
+	static std::atomic<size_t> next{0};
+	return next++;
+}
+
+} // namespace OpenApoc
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "library/sp.h"
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class GameEvent;
+
+// Collects the game events raised by the simulation and hands them out to whoever subscribed to
+// their type in one batch, when drain() is called once per frame.
+// Events are stored by value in a list per type that is reused every frame, so raising one doesn't
+// allocate once the lists have grown, and raising one nobody subscribed to doesn't even construct
+// it. Which list each event went to is kept in the order they were raised, so that they're handed
+// out in that order whatever their type. Events raised while draining are handed out by the next
+// drain().
+// Events may be raised from any thread (like the one loading a battle), subscribing and draining
+// happen on the thread running the UI.
+class GameEventBus
+{
+  public:
+	template <typename T, typename... Args> void raise(Args &&... args)
+	{
+		std::lock_guard<std::mutex> l(this->lock);
+		auto &channel = getChannel<T>();
+		if (channel.subscribers.empty())
+		{
+			return;
+		}
+		channel.pending.emplace_back(std::forward<Args>(args)...);
+		pendingOrder.push_back(channelIndex<T>());
+	}
+
+	// 'owner' only identifies the subscription for unsubscribe()
+	template <typename T> void subscribe(const void *owner, std::function<void(T &)> handler)
+	{
+		std::lock_guard<std::mutex> l(this->lock);
+		getChannel<T>().subscribers.emplace_back(owner, std::move(handler));
+	}
+	// Subscribes to every type of GameEvent
+	void subscribeAll(const void *owner, std::function<void(GameEvent &)> handler);
+	void unsubscribe(const void *owner);
+
+	void drain();
+	bool hasPending() const;
+
+  private:
+	class ChannelBase
+	{
+	  public:
+		virtual ~ChannelBase() = default;
+		virtual void takePending() = 0;
+		// Hands out the next event taken, events must be handed out in the order they were raised
+		virtual void dispatchNext() = 0;
+		virtual void finishDispatch() = 0;
+		virtual bool hasPending() const = 0;
+		virtual void unsubscribe(const void *owner) = 0;
+	};
+
+	template <typename T> class Channel : public ChannelBase
+	{
+	  public:
+		std::vector<T> pending;
+		std::vector<T> dispatching;
+		size_t nextDispatched = 0;
+		std::vector<std::pair<const void *, std::function<void(T &)>>> subscribers;
+
+		void takePending() override
+		{
+			std::swap(pending, dispatching);
+			nextDispatched = 0;
+		}
+		void dispatchNext() override
+		{
+			auto &event = dispatching[nextDispatched++];
+			for (auto &subscriber : subscribers)
+			{
+				subscriber.second(event);
+			}
+		}
+		void finishDispatch() override { dispatching.clear(); }
+		bool hasPending() const override { return !pending.empty(); }
+		void unsubscribe(const void *owner) override
+		{
+			for (auto it = subscribers.begin(); it != subscribers.end();)
+			{
+				if (it->first == owner)
+				{
+					it = subscribers.erase(it);
+				}
+				else
+				{
+					it++;
+				}
+			}
+			if (subscribers.empty())
+			{
+				pending.clear();
+			}
+		}
+	};
+
+	// Guards the events pending and the channels, handlers are called without it so that they can
+	// raise events of their own
+	mutable std::mutex lock;
+	std::vector<up<ChannelBase>> channels;
+	// Channel index of every pending event, in the order they were raised
+	std::vector<size_t> pendingOrder;
+	// Only touched by drain(), the events being handed out and the channels they're in
+	std::vector<size_t> dispatchingOrder;
+	std::vector<ChannelBase *> dispatchingChannels;
+
+	static size_t nextChannelIndex();
+	template <typename T> static size_t channelIndex()
+	{
+		static const size_t index = nextChannelIndex();
+		return index;
+	}
+
+	template <typename T> Channel<T> &getChannel()
+	{
+		auto index = channelIndex<T>();
+		if (index >= channels.size())
+		{
+			channels.resize(index + 1);
+		}
+		if (!channels[index])
+		{
+			channels[index].reset(new Channel<T>());
+		}
+		return static_cast<Channel<T> &>(*channels[index]);
+	}
+};
+
+} // namespace OpenApoc
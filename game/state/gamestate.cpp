@@ -17,6 +17,7 @@
 #include "game/state/city/projectile.h"
 #include "game/state/city/scenery.h"
 #include "game/state/city/vehicle.h"
+#include "game/state/city/vehiclegrid.h"
 #include "game/state/city/vehiclemission.h"
 #include "game/state/gameevent.h"
 #include "game/state/gametime.h"
@@ -29,15 +30,40 @@
 #include "game/state/rules/ufo_incursion.h"
 #include "game/state/rules/vammo_type.h"
 #include "game/state/rules/vehicle_type.h"
+#include "game/state/staterecording.h"
 #include "game/state/tileview/tile.h"
 #include "game/state/tileview/tileobject_vehicle.h"
 #include "game/state/ufopaedia.h"
+#include "library/arena.h"
 #include "library/strings_format.h"
 #include <random>
 
 namespace OpenApoc
 {
 
+namespace
+{
+uint64_t getPeriod(GameState::ScheduledUpdate update)
+{
+	switch (update)
+	{
+		case GameState::ScheduledUpdate::EndOfFiveMinutes:
+			return 5 * TICKS_PER_MINUTE;
+		case GameState::ScheduledUpdate::EndOfHour:
+			return TICKS_PER_HOUR;
+		case GameState::ScheduledUpdate::EndOfDay:
+			return TICKS_PER_DAY;
+		case GameState::ScheduledUpdate::EndOfWeek:
+			return 7 * (uint64_t)TICKS_PER_DAY;
+		case GameState::ScheduledUpdate::BuildingDetection:
+		case GameState::ScheduledUpdate::LabProgress:
+			break;
+	}
+	LogError("Unknown scheduled update %d", (int)update);
+	return TICKS_PER_DAY;
+}
+} // anonymous namespace
+
 GameState::GameState() : player(this) {}
 
 GameState::~GameState()
@@ -174,6 +200,154 @@ void GameState::initState()
 	}
 	// Run nessecary methods for different types
 	research.updateTopicList();
+	initScheduledUpdates();
+}
+
+void GameState::initScheduledUpdates()
+{
+	auto ticks = getCityTicks();
+	scheduledUpdates = TimerWheel<ScheduledUpdate>(ticks + 1);
+	wakeUps.clear();
+	for (auto update : {ScheduledUpdate::EndOfFiveMinutes, ScheduledUpdate::EndOfHour,
+	                    ScheduledUpdate::EndOfDay, ScheduledUpdate::EndOfWeek})
+	{
+		auto period = getPeriod(update);
+		scheduledUpdates.schedule((ticks / period + 1) * period, update, (int)update);
+	}
+	for (auto &c : this->cities)
+	{
+		for (auto &b : c.second->buildings)
+		{
+			scheduleBuildingDetection(b.first);
+		}
+	}
+	for (auto &lab : this->research.labs)
+	{
+		scheduleLabProgress(lab.first);
+	}
+}
+
+uint64_t GameState::getCityTicks() const
+{
+	// Battles move the game time on but roll it back once they're over
+	return gameTimeBeforeBattle.getTicks() != 0 ? gameTimeBeforeBattle.getTicks()
+	                                            : gameTime.getTicks();
+}
+
+void GameState::scheduleBuildingDetection(const UString &buildingID)
+{
+	StateRef<Building> building = {this, buildingID};
+	auto tick = building->getNextDetectionUpdate(*this, getCityTicks());
+	if (tick != 0)
+	{
+		scheduleWakeUp(ScheduledUpdate::BuildingDetection, tick, buildingID);
+	}
+}
+
+void GameState::scheduleLabProgress(const UString &labID)
+{
+	StateRef<Lab> lab = {this, labID};
+	if (!lab->current_project)
+	{
+		return;
+	}
+	auto ticks = getCityTicks();
+	scheduleWakeUp(ScheduledUpdate::LabProgress, (ticks / TICKS_PER_HOUR + 1) * TICKS_PER_HOUR,
+	               labID);
+}
+
+void GameState::scheduleWakeUp(ScheduledUpdate update, uint64_t tick, const UString &id)
+{
+	// The wheel moves timers for ticks it already went through on, keep the key in step with it
+	tick = std::max(tick, scheduledUpdates.getCurrentTick());
+	auto &ids = wakeUps[update][tick];
+	if (ids.empty())
+	{
+		scheduledUpdates.schedule(tick, update, (int)update);
+	}
+	ids.insert(id);
+}
+
+std::set<UString> GameState::takeWakeUps(ScheduledUpdate update)
+{
+	std::set<UString> ids;
+	auto &due = wakeUps[update];
+	auto it = due.find(gameTime.getTicks());
+	if (it != due.end())
+	{
+		ids = std::move(it->second);
+		due.erase(it);
+	}
+	return ids;
+}
+
+void GameState::wakeBuildings(const std::set<UString> &buildingIDs)
+{
+	Trace::start("GameState::wakeBuildings");
+	auto ticks = gameTime.getTicks();
+	// Once a building was spotted the attempts of the others have to wait for the next period
+	bool spotted = false;
+	for (auto &id : buildingIDs)
+	{
+		StateRef<Building> building = {this, id};
+		// Only the buildings of the city on screen are checked
+		if (current_city->buildings.find(id) != current_city->buildings.end())
+		{
+			bool timedOut = building->ticksDetectionTimeOutEnd > ticks;
+			if (spotted && !timedOut && building->ticksNextDetectionAttempt <= ticks &&
+			    building->hasAliens())
+			{
+				building->ticksNextDetectionAttempt = ticks + 5 * TICKS_PER_MINUTE;
+			}
+			building->updateDetection(*this);
+			spotted = spotted || (!timedOut && building->ticksDetectionTimeOutEnd > ticks);
+		}
+		// Buildings schedule their next wake-up if they still have anything to do
+		scheduleBuildingDetection(id);
+	}
+	Trace::end("GameState::wakeBuildings");
+}
+
+void GameState::wakeLabs(const std::set<UString> &labIDs)
+{
+	Trace::start("GameState::wakeLabs");
+	for (auto &id : labIDs)
+	{
+		StateRef<Lab> lab = {this, id};
+		if (lab->current_project)
+		{
+			Lab::update(TICKS_PER_HOUR, lab, shared_from_this());
+		}
+		scheduleLabProgress(id);
+	}
+	Trace::end("GameState::wakeLabs");
+}
+
+void GameState::runScheduledUpdate(ScheduledUpdate update)
+{
+	switch (update)
+	{
+		case ScheduledUpdate::EndOfFiveMinutes:
+			updateEndOfFiveMinutes();
+			break;
+		// Wake-ups aren't periodic, the objects schedule them again as needed
+		case ScheduledUpdate::BuildingDetection:
+			wakeBuildings(takeWakeUps(update));
+			return;
+		case ScheduledUpdate::LabProgress:
+			wakeLabs(takeWakeUps(update));
+			return;
+		case ScheduledUpdate::EndOfHour:
+			updateEndOfHour();
+			break;
+		case ScheduledUpdate::EndOfDay:
+			updateEndOfDay();
+			break;
+		case ScheduledUpdate::EndOfWeek:
+			updateEndOfWeek();
+			break;
+	}
+	scheduledUpdates.schedule(gameTime.getTicks() + getPeriod(update), update, (int)update);
 }
 
 void GameState::startGame()
@@ -184,13 +358,14 @@ void GameState::startGame()
 		pair.second->ticksTakeOverAttemptAccumulated =
 		    randBoundsExclusive(rng, (unsigned)0, TICKS_PER_TAKEOVER_ATTEMPT);
 	}
-	// Setup buildings
+	// Setup buildings, detection attempts are made at the end of a random five minute period
+	auto detectionPeriods = TICKS_PER_DETECTION_ATTEMPT[difficulty] / (5 * TICKS_PER_MINUTE);
 	for (auto &pair : this->cities)
 	{
 		for (auto &b : pair.second->buildings)
 		{
-			b.second->ticksDetectionAttemptAccumulated =
-			    randBoundsExclusive(rng, (unsigned)0, TICKS_PER_DETECTION_ATTEMPT[difficulty]);
+			b.second->ticksNextDetectionAttempt =
+			    randBoundsInclusive(rng, (unsigned)1, detectionPeriods) * 5 * TICKS_PER_MINUTE;
 		}
 	}
 
@@ -397,21 +572,15 @@ bool GameState::canTurbo() const
 	{
 		return false;
 	}
-	for (auto &v : this->vehicles)
-	{
-		if (v.second->city == this->current_city && v.second->tileObject != nullptr &&
-		    v.second->type->aggressiveness > 0 &&
-		    v.second->owner->isRelatedTo(this->getPlayer()) == Organisation::Relation::Hostile &&
-		    !v.second->isCrashed())
-		{
-			return false;
-		}
-	}
-	return true;
+	// Only vehicles flying in the city are in its grid
+	auto &grid = this->current_city->vehicleGrid;
+	return !grid || !grid->hasHostileVehicles(this->getPlayer());
 }
 
 void GameState::update(unsigned int ticks)
 {
+	// Temporary containers used during the tick are all released at once when it ends
+	MemoryArena::Scope tickScope(tickArena());
 	if (this->current_battle)
 	{
 		// Save time to roll back to
@@ -425,45 +594,88 @@ void GameState::update(unsigned int ticks)
 	}
 	else
 	{
-		// Roll back to time before battle
-		if (gameTimeBeforeBattle.getTicks() != 0)
-		{
-			gameTime = GameTime(gameTimeBeforeBattle.getTicks());
-			gameTimeBeforeBattle = GameTime(0);
-		}
+		updateCity(ticks, false);
+	}
+}
 
-		Trace::start("GameState::update::cities");
-		for (auto &c : this->cities)
-		{
-			c.second->update(*this, ticks);
-		}
-		Trace::end("GameState::update::cities");
-		Trace::start("GameState::update::vehicles");
-		for (auto &v : this->vehicles)
-		{
-			v.second->update(*this, ticks);
-		}
-		Trace::end("GameState::update::vehicles");
+unsigned int GameState::fastForward(unsigned int ticks)
+{
+	if (this->current_battle)
+	{
+		LogError("Cannot fast forward during a battle");
+		return 0;
+	}
+	// The steps are worked out from the time the city is at, not where the battle left it
+	rollBackBattleTime();
+	auto ticksBefore = gameTime.getTicks();
+	unsigned int ticksAdvanced = 0;
+	// Stop as soon as the player has something to look at
+	while (ticksAdvanced < ticks && this->canTurbo() && !this->events.hasPending())
+	{
+		MemoryArena::Scope tickScope(tickArena());
+		// Nothing happens in the city in between scheduled updates that isn't a vehicle event,
+		// but always move on by at least a tick
+		auto currentTicks = gameTime.getTicks();
+		auto nextExpiry = scheduledUpdates.getNextExpiry();
+		uint64_t ticksToUpdate = nextExpiry > currentTicks ? nextExpiry - currentTicks : 1;
+		ticksToUpdate = std::min<uint64_t>(ticksToUpdate, ticks - ticksAdvanced);
+		updateCity((unsigned int)ticksToUpdate, true);
+		ticksAdvanced += (unsigned int)ticksToUpdate;
+	}
+	if (this->recorder)
+	{
+		this->recorder->recordStep(*this, ticksBefore, true, ticks, ticksAdvanced);
+	}
+	return ticksAdvanced;
+}
 
-		gameTime.addTicks(ticks);
-		if (gameTime.fiveMinutesPassed())
-		{
-			this->updateEndOfFiveMinutes();
-		}
-		if (gameTime.hourPassed())
-		{
-			this->updateEndOfHour();
-		}
-		if (gameTime.dayPassed())
+void GameState::rollBackBattleTime()
+{
+	// Roll back to time before battle
+	if (gameTimeBeforeBattle.getTicks() != 0)
+	{
+		gameTime = GameTime(gameTimeBeforeBattle.getTicks());
+		gameTimeBeforeBattle = GameTime(0);
+	}
+}
+
+void GameState::updateCity(unsigned int ticks, bool vehiclesByEvent)
+{
+	rollBackBattleTime();
+
+	Trace::start("GameState::update::cities");
+	for (auto &c : this->cities)
+	{
+		c.second->update(*this, ticks);
+	}
+	Trace::end("GameState::update::cities");
+	Trace::start("GameState::update::vehicles");
+	for (auto &v : this->vehicles)
+	{
+		if (!vehiclesByEvent)
 		{
-			this->updateEndOfDay();
+			v.second->update(*this, ticks);
+			continue;
 		}
-		if (gameTime.weekPassed())
+		// Vehicles go straight from one of their events to the next, so that e.g. a vehicle
+		// that's done snoozing still has the rest of the time to fly somewhere
+		unsigned int ticksLeft = ticks;
+		while (ticksLeft > 0)
 		{
-			this->updateEndOfWeek();
+			auto vehicleTicks = std::min(ticksLeft, std::max(1u, v.second->getTicksToNextEvent()));
+			v.second->update(*this, vehicleTicks);
+			ticksLeft -= vehicleTicks;
 		}
-		gameTime.clearFlags();
 	}
+	Trace::end("GameState::update::vehicles");
+
+	// Every update due is run at the time it was due at, even if several periods passed
+	auto targetTicks = gameTime.getTicks() + ticks;
+	scheduledUpdates.advance(targetTicks, [this](ScheduledUpdate update) {
+		gameTime.addTicks(scheduledUpdates.getCurrentTick() - gameTime.getTicks());
+		runScheduledUpdate(update);
+	});
+	gameTime.addTicks(targetTicks - gameTime.getTicks());
 }
 
 void GameState::updateEndOfFiveMinutes()
@@ -483,29 +695,10 @@ void GameState::updateEndOfFiveMinutes()
 		}
 	}
 	Trace::end("GameState::updateEndOfFiveMinutes::organisations");
-
-	// Detection calculation stops when detection happens
-	Trace::start("GameState::updateEndOfFiveMinutes::buildings");
-	for (auto &b : current_city->buildings)
-	{
-		bool detected = b.second->ticksDetectionTimeOut > 0;
-		b.second->updateDetection(*this, TICKS_PER_MINUTE * 5);
-		if (b.second->ticksDetectionTimeOut > 0 && !detected)
-		{
-			break;
-		}
-	}
-	Trace::end("GameState::updateEndOfFiveMinutes::buildings");
 }
 
 void GameState::updateEndOfHour()
 {
-	Trace::start("GameState::updateEndOfHour::labs");
-	for (auto &lab : this->research.labs)
-	{
-		Lab::update(TICKS_PER_HOUR, {this, lab.second}, shared_from_this());
-	}
-	Trace::end("GameState::updateEndOfHour::labs");
 	Trace::start("GameState::updateEndOfHour::cities");
 	for (auto &c : this->cities)
 	{
@@ -531,8 +724,8 @@ void GameState::updateEndOfDay()
 				f->buildTime--;
 				if (f->buildTime == 0)
 				{
-					fw().pushEvent(
-					    new GameFacilityEvent(GameEventType::FacilityCompleted, b.second, f));
+					this->events.raise<GameFacilityEvent>(GameEventType::FacilityCompleted, b.second,
+					                                      f);
 				}
 			}
 		}
@@ -581,7 +774,8 @@ void GameState::updateEndOfDay()
 			v->missions.emplace_back(VehicleMission::infiltrateOrSubvertBuilding(*this, *v, bld));
 			v->missions.front()->start(*this, *v);
 
-			fw().pushEvent(new GameVehicleEvent(GameEventType::UfoSpotted, {this, v}));
+			this->events.raise<GameVehicleEvent>(GameEventType::UfoSpotted,
+			                                     StateRef<Vehicle>(this, v));
 		}
 	}
 }
@@ -632,22 +826,14 @@ void GameState::updateEndOfWeek()
 	}
 }
 
-void GameState::update() { this->update(1); }
-
-void GameState::updateTurbo()
+void GameState::update()
 {
-	if (!this->canTurbo())
-	{
-		LogError("Called when canTurbo() is false");
-	}
-	unsigned ticksToUpdate = TURBO_TICKS;
-	// Turbo always re-aligns to TURBO_TICKS (5 minutes)
-	unsigned int align = this->gameTime.getTicks() % TURBO_TICKS;
-	if (align != 0)
+	auto ticksBefore = gameTime.getTicks();
+	this->update(1);
+	if (this->recorder)
 	{
-		ticksToUpdate -= align;
+		this->recorder->recordStep(*this, ticksBefore, false, 1, 1);
 	}
-	this->update(ticksToUpdate);
 }
 
 void GameState::logEvent(GameEvent *ev)
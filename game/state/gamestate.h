@@ -1,16 +1,19 @@
 #pragma once
 
 #include "game/state/agent.h"
+#include "game/state/gameeventbus.h"
 #include "game/state/gametime.h"
 #include "game/state/research.h"
 #include "game/state/stateobject.h"
 #include "library/sp.h"
 #include "library/strings.h"
+#include "library/timerwheel.h"
 #include "library/xorshift.h"
 #include <cstdint>
 #include <list>
 #include <map>
 #include <mutex>
+#include <set>
 
 namespace OpenApoc
 {
@@ -40,6 +43,7 @@ class BattleMapPartType;
 class EventMessage;
 class DamageType;
 class BuildingFunction;
+class StateRecorder;
 
 static const int MAX_MESSAGES = 50;
 static const unsigned ORIGINAL_TICKS = 36;
@@ -155,7 +159,7 @@ class GameState : public std::enable_shared_from_this<GameState>
 	// Fills out initial player property
 	void fillPlayerStartingProperty();
 
-	// Returns true if we can go at max speed (IE push all update loops to 5 minute intervals -
+	// Returns true if we can go at max speed (IE fastForward() through whole routes and snoozes -
 	// causes insta-completion of all routes etc.
 	// Cannot be done if:
 	// - there are any enemy units on the current map
@@ -164,20 +168,62 @@ class GameState : public std::enable_shared_from_this<GameState>
 
 	// Update progresses one 'tick'
 	void update();
-	// updateTurbo progresses 5 minutes at a time - can only be called if canTurbo() returns true.
-	// canTurbo() must be re-tested after each call to see if we should drop down to normal speed
-	// (e.g. enemy appeared, other user action required)
-	void updateTurbo();
+	// fastForward progresses up to 'ticks' while canTurbo() returns true, jumping from one
+	// scheduled update to the next, with every vehicle going from one of its own events to the
+	// next in between. It stops early once a game event was raised (e.g. something was spotted).
+	// Returns the number of ticks progressed
+	unsigned int fastForward(unsigned int ticks);
 
 	void updateEndOfFiveMinutes();
 	void updateEndOfHour();
 	void updateEndOfDay();
 	void updateEndOfWeek();
 
+	// Updates that happen at the end of every period of game time, and wake-ups of single objects,
+	// in the order they happen in when several are due at once
+	enum class ScheduledUpdate
+	{
+		EndOfFiveMinutes,
+		BuildingDetection,
+		LabProgress,
+		EndOfHour,
+		EndOfDay,
+		EndOfWeek
+	};
+	// Schedules the periodic updates and the wake-ups of every building and lab for the current
+	// game time, dropping any that were scheduled
+	void initScheduledUpdates();
+	// Wakes the building up once its detection timeout ends or its next detection attempt is due,
+	// needed whenever aliens move into a building that had none
+	void scheduleBuildingDetection(const UString &buildingID);
+	// Wakes the lab up at the end of the hour to progress its project, if it has one
+	void scheduleLabProgress(const UString &labID);
+
 	void logEvent(GameEvent *ev);
 
 	// Following members are not serialized
 	bool newGame = false;
+	// Game time updates and wake-ups, keyed on game time ticks
+	TimerWheel<ScheduledUpdate> scheduledUpdates;
+	// IDs of the objects to wake up, by the update and the tick it's due at. The ones due at the
+	// same tick are woken in the order of their IDs, whatever order they were scheduled in
+	std::map<ScheduledUpdate, std::map<uint64_t, std::set<UString>>> wakeUps;
+	// Game events raised by the simulation, drained once per frame by the view showing it
+	GameEventBus events;
+	// Logs every update() and fastForward() with the hash of the state it leaves, if set
+	up<StateRecorder> recorder;
+
+  private:
+	void rollBackBattleTime();
+	void updateCity(unsigned int ticks, bool vehiclesByEvent);
+	void runScheduledUpdate(ScheduledUpdate update);
+	void scheduleWakeUp(ScheduledUpdate update, uint64_t tick, const UString &id);
+	// Removes and returns the IDs of the objects due for the wake-up at the current game time
+	std::set<UString> takeWakeUps(ScheduledUpdate update);
+	void wakeBuildings(const std::set<UString> &buildingIDs);
+	void wakeLabs(const std::set<UString> &labIDs);
+	// The game time the city is at, which stays behind during a battle
+	uint64_t getCityTicks() const;
 };
 
 }; // namespace OpenApoc
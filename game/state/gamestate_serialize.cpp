@@ -110,6 +110,11 @@ void serializeIn(const GameState *, const sp<SerializationNode> &node, sp<Sample
 	if (!node)
 		return;
 	ptr = fw().data->loadSample(node->getValue());
+	// Convert it now rather than the first time it's played in the middle of a battle
+	if (ptr && fw().soundBackend)
+	{
+		fw().soundBackend->prepareSample(ptr);
+	}
 }
 
 void serializeIn(const GameState *state, const sp<SerializationNode> &node, VoxelMap &map)
@@ -142,6 +147,22 @@ void serializeIn(const GameState *state, const sp<SerializationNode> &node,
 	t.setState(s);
 }
 
+// Hazards are saved the same way as a set of them, in the order they were created
+void serializeIn(const GameState *state, const sp<SerializationNode> &node,
+                 BattleHazardField &hazards)
+{
+	if (!node)
+		return;
+	auto entry = node->getNodeOpt("entry");
+	while (entry)
+	{
+		BattleHazard hazard;
+		serializeIn(state, entry, hazard);
+		hazards.add(hazard);
+		entry = entry->getNextSiblingOpt("entry");
+	}
+}
+
 void serializeOut(const sp<SerializationNode> &node, const UString &string, const UString &)
 {
 	node->setValue(string);
@@ -246,6 +267,16 @@ void serializeOut(const sp<SerializationNode> &node, const Xorshift128Plus<uint3
 	serializeOut(node->addNode("s1"), s[1], sr[1]);
 }
 
+void serializeOut(const sp<SerializationNode> &node, const BattleHazardField &hazards,
+                  const BattleHazardField &)
+{
+	BattleHazard defaultRef;
+	for (auto &hazard : hazards.getRecords())
+	{
+		serializeOut(node->addNode("entry"), hazard, defaultRef);
+	}
+}
+
 void serializeIn(const GameState *state, sp<SerializationNode> node, sp<UnitAI> &ai)
 {
 	if (!node)
@@ -438,6 +469,26 @@ bool operator==(const TacticalAI &a, const TacticalAI &b)
 }
 bool operator!=(const TacticalAI &a, const TacticalAI &b) { return !(a == b); }
 
+bool operator==(const BattleHazardField &a, const BattleHazardField &b)
+{
+	auto aHazards = a.getRecords();
+	auto bHazards = b.getRecords();
+	if (aHazards.size() != bHazards.size())
+	{
+		return false;
+	}
+	for (size_t i = 0; i < aHazards.size(); i++)
+	{
+		if (aHazards[i] != bHazards[i])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool operator!=(const BattleHazardField &a, const BattleHazardField &b) { return !(a == b); }
+
 bool GameState::saveGame(const UString &path, bool pack, bool pretty)
 {
 	TRACE_FN_ARGS1("path", path);
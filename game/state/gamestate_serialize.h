@@ -22,6 +22,7 @@
 #include "game/state/battle/battledoor.h"
 #include "game/state/battle/battleexplosion.h"
 #include "game/state/battle/battlehazard.h"
+#include "game/state/battle/battlehazardfield.h"
 #include "game/state/battle/battleitem.h"
 #include "game/state/battle/battlemap.h"
 #include "game/state/battle/battlemappart.h"
@@ -132,6 +133,8 @@ void serializeIn(const GameState *state, const sp<SerializationNode> &node, Voxe
 void serializeIn(const GameState *state, const sp<SerializationNode> &node, Colour &c);
 void serializeIn(const GameState *state, const sp<SerializationNode> &node,
                  Xorshift128Plus<uint32_t> &t);
+void serializeIn(const GameState *state, const sp<SerializationNode> &node,
+                 BattleHazardField &hazards);
 
 template <typename T>
 void serializeIn(const GameState *state, const sp<SerializationNode> &node, StateRef<T> &ref)
@@ -359,6 +362,8 @@ void serializeOut(const sp<SerializationNode> &node, const VoxelMap &map, const
 void serializeOut(const sp<SerializationNode> &node, const Colour &c, const Colour &ref);
 void serializeOut(const sp<SerializationNode> &node, const Xorshift128Plus<uint32_t> &t,
                   const Xorshift128Plus<uint32_t> &ref);
+void serializeOut(const sp<SerializationNode> &node, const BattleHazardField &hazards,
+                  const BattleHazardField &ref);
 
 template <typename T>
 void serializeOut(const sp<SerializationNode> &node, const StateRef<T> &val, const StateRef<T> &)
@@ -566,4 +571,7 @@ void serializeOut(sp<SerializationNode> node, const sp<TacticalAI> &ptr, const s
 bool operator==(const TacticalAI &a, const TacticalAI &b);
 bool operator!=(const TacticalAI &a, const TacticalAI &b);
 
+bool operator==(const BattleHazardField &a, const BattleHazardField &b);
+bool operator!=(const BattleHazardField &a, const BattleHazardField &b);
+
 } // namespace OpenApoc
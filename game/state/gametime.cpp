@@ -150,46 +150,7 @@ unsigned int GameTime::getMinutes() const { return getPtime(this->ticks).time_of
 
 uint64_t GameTime::getTicks() const { return ticks; }
 
-bool GameTime::fiveMinutesPassed() const { return fiveMinutesPassedFlag; }
-
-bool GameTime::hourPassed() const { return hourPassedFlag; }
-
-bool GameTime::dayPassed() const { return dayPassedFlag; }
-
-bool GameTime::weekPassed() const { return weekPassedFlag; }
-
-void GameTime::clearFlags()
-{
-	fiveMinutesPassedFlag = false;
-	hourPassedFlag = false;
-	dayPassedFlag = false;
-	weekPassedFlag = false;
-}
-
-void GameTime::addTicks(uint64_t ticks)
-{
-	this->ticks += ticks;
-	uint64_t fiveMinutesTicks = this->ticks % (5 * TICKS_PER_MINUTE);
-	if (fiveMinutesTicks < ticks)
-	{
-		fiveMinutesPassedFlag = true;
-		uint64_t hourTicks = this->ticks % TICKS_PER_HOUR;
-		if (hourTicks < ticks)
-		{
-			hourPassedFlag = true;
-			uint64_t dayTicks = this->ticks % TICKS_PER_DAY;
-			if (dayTicks < ticks)
-			{
-				uint64_t days = this->ticks / TICKS_PER_DAY;
-				dayPassedFlag = true;
-				if (days % 7 == 0)
-				{
-					weekPassedFlag = true;
-				}
-			}
-		}
-	}
-}
+void GameTime::addTicks(uint64_t ticks) { this->ticks += ticks; }
 
 GameTime GameTime::midday() { return GameTime(TICKS_PER_HOUR * 12); }
 }
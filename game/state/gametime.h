@@ -16,12 +16,6 @@ static const unsigned TURBO_TICKS = 5 * 60 * TICKS_PER_SECOND;
 
 class GameTime
 {
-  private:
-	bool fiveMinutesPassedFlag = false;
-	bool hourPassedFlag = false;
-	bool dayPassedFlag = false;
-	bool weekPassedFlag = false;
-
   public:
 	uint64_t ticks = 0;
 	GameTime() = default;
@@ -54,20 +48,6 @@ class GameTime
 	// returns formatted date in format d m, y
 	UString getShortDateString() const;
 
-	// set at end of each 5 minutes
-	bool fiveMinutesPassed() const;
-
-	// set at end of each hour
-	bool hourPassed() const;
-
-	// set at midnight
-	bool dayPassed() const;
-
-	// set at sunday midnight
-	bool weekPassed() const;
-
-	void clearFlags();
-
 	static GameTime midday();
 };
 }
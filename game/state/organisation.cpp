@@ -38,8 +38,8 @@ void Organisation::takeOver(GameState &state, bool forced)
 		current_relations[{&state, pair.first}] = 90.0f;
 		pair.second->current_relations[org] = 90.0f;
 	}
-	auto event = new GameOrganisationEvent(GameEventType::AlienTakeover, {&state, id});
-	fw().pushEvent(event);
+	state.events.raise<GameOrganisationEvent>(GameEventType::AlienTakeover,
+	                                          StateRef<Organisation>(&state, id));
 }
 
 void Organisation::updateInfiltration(GameState &state)
@@ -211,6 +211,7 @@ void Lab::setResearch(StateRef<Lab> lab, StateRef<ResearchTopic> topic, sp<GameS
 			default:
 				break;
 		}
+		state->scheduleLabProgress(lab.id);
 	}
 }
 
@@ -298,9 +299,8 @@ void Lab::update(unsigned int ticks, StateRef<Lab> lab, sp<GameState> state)
 				lab->current_project->man_hours_progress += progress_hours;
 				if (lab->current_project->isComplete())
 				{
-					auto event = new GameResearchEvent(GameEventType::ResearchCompleted,
-					                                   lab->current_project, lab);
-					fw().pushEvent(event);
+					state->events.raise<GameResearchEvent>(GameEventType::ResearchCompleted,
+					                                       lab->current_project, lab);
 					Lab::setResearch(lab, {state.get(), ""}, state);
 				}
 				break;
@@ -384,10 +384,9 @@ void Lab::update(unsigned int ticks, StateRef<Lab> lab, sp<GameState> state)
 
 					if (lab->manufacture_done >= lab->manufacture_goal)
 					{
-						auto event = new GameManufactureEvent(
+						state->events.raise<GameManufactureEvent>(
 						    GameEventType::ManufactureCompleted, lab->current_project,
 						    lab->manufacture_done, lab->manufacture_goal, lab);
-						fw().pushEvent(event);
 						Lab::setResearch(lab, {state.get(), ""}, state);
 					}
 					else
@@ -399,10 +398,9 @@ void Lab::update(unsigned int ticks, StateRef<Lab> lab, sp<GameState> state)
 						}
 						else
 						{
-							auto event = new GameManufactureEvent(
+							state->events.raise<GameManufactureEvent>(
 							    GameEventType::ManufactureHalted, lab->current_project,
 							    lab->manufacture_done, lab->manufacture_goal, lab);
-							fw().pushEvent(event);
 							Lab::setResearch(lab, {state.get(), ""}, state);
 						}
 					}
@@ -29,7 +29,7 @@ class HazardType : public StateObject
 	bool fire = false;
 
 	// Get first frame used for age and offset
-	sp<Image> getFrame(unsigned age, int offset);
+	sp<Image> getFrame(unsigned age, int offset) const;
 
 	// Get a random lifetime for the hazard of this type
 	int getLifetime(GameState &state);
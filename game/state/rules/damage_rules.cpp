@@ -85,7 +85,7 @@ int DamageType::dealDamage(int damage, StateRef<DamageModifier> modifier) const
 		return damage * modifiers.at(modifier) / 100;
 }
 
-sp<Image> HazardType::getFrame(unsigned age, int offset)
+sp<Image> HazardType::getFrame(unsigned age, int offset) const
 {
 	if (fire)
 	{
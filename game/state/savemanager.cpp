@@ -6,8 +6,11 @@
 #include "framework/trace.h"
 #include "game/state/gamestate.h"
 #include <algorithm>
+#include <mutex>
 #include <sstream>
 
+#include "dependencies/pugixml/src/pugixml.hpp"
+
 // Disable automatic #pragma linking for boost - only enabled in msvc and that should provide boost
 // symbols as part of the module that uses it
 #define BOOST_ALL_NO_LIB
@@ -22,6 +25,7 @@ namespace OpenApoc
 {
 const UString saveManifestName = "save_manifest";
 const UString saveFileExtension = ".save";
+const UString saveIndexName = "save_index.xml";
 
 ConfigOptionString saveDirOption("Game.Save", "Directory", "Directory containing saved games",
                                  "./saves");
@@ -29,6 +33,149 @@ ConfigOptionBool packSaveOption("Game.Save", "Pack", "Pack saved games into a zi
 
 SaveManager::SaveManager() : saveDirectory(saveDirOption.get()) {}
 
+namespace
+{
+
+// Guards the index file, which is shared by every SaveManager
+std::mutex saveIndexMutex;
+
+class SaveIndexEntry
+{
+  public:
+	uint64_t size = 0;
+	int64_t modified = 0;
+	SaveMetadata metadata;
+};
+
+// Index entries by save file name, relative to the save directory
+using SaveIndex = std::map<UString, SaveIndexEntry>;
+
+// Identifies the version of a save file an index entry was made from. Saves that aren't regular
+// files (unpacked ones) are never indexed, as their directory doesn't change when they are
+// overwritten
+bool statSave(const fs::path &path, uint64_t &size, int64_t &modified)
+{
+	if (!fs::is_regular_file(path))
+	{
+		return false;
+	}
+	size = fs::file_size(path);
+#if defined(USE_BOOST_FILESYSTEM)
+	modified = fs::last_write_time(path);
+#else
+	// Only compared for equality, so whatever the clock's epoch is doesn't matter
+	modified = fs::last_write_time(path).time_since_epoch().count();
+#endif
+	return true;
+}
+
+UString indexPath(const UString &saveDirectory) { return saveDirectory + "/" + saveIndexName; }
+
+SaveIndex loadIndex(const UString &saveDirectory)
+{
+	SaveIndex index;
+	pugi::xml_document doc;
+	auto path = indexPath(saveDirectory);
+	if (!fs::exists(path.str()))
+	{
+		return index;
+	}
+	auto result = doc.load_file(path.cStr());
+	if (!result)
+	{
+		LogWarning("Failed to parse save index \"%s\": %s", path, result.description());
+		return index;
+	}
+	for (auto node = doc.child("saves").child("save"); node; node = node.next_sibling("save"))
+	{
+		UString file = node.attribute("file").value();
+		SaveIndexEntry entry;
+		entry.size = node.attribute("size").as_ullong();
+		entry.modified = node.attribute("modified").as_llong();
+		entry.metadata = SaveMetadata(
+		    node.attribute("name").value(), saveDirectory + "/" + file,
+		    node.attribute("difficulty").value(), (time_t)node.attribute("date").as_llong(),
+		    static_cast<SaveType>(node.attribute("type").as_uint()),
+		    node.attribute("ticks").as_ullong());
+		index[file] = entry;
+	}
+	return index;
+}
+
+void writeIndex(const UString &saveDirectory, const SaveIndex &index)
+{
+	pugi::xml_document doc;
+	auto decl = doc.prepend_child(pugi::node_declaration);
+	decl.append_attribute("version") = "1.0";
+	decl.append_attribute("encoding") = "UTF-8";
+	auto root = doc.append_child("saves");
+	for (auto &p : index)
+	{
+		auto &metadata = p.second.metadata;
+		auto node = root.append_child("save");
+		node.append_attribute("file") = p.first.cStr();
+		node.append_attribute("size") = (unsigned long long)p.second.size;
+		node.append_attribute("modified") = (long long)p.second.modified;
+		node.append_attribute("name") = metadata.getName().cStr();
+		node.append_attribute("difficulty") = metadata.getDifficulty().cStr();
+		node.append_attribute("date") = (long long)metadata.getCreationDate();
+		node.append_attribute("type") = static_cast<unsigned>(metadata.getType());
+		node.append_attribute("ticks") = (unsigned long long)metadata.getGameTicks();
+	}
+	auto path = indexPath(saveDirectory);
+	if (!doc.save_file(path.cStr(), "  "))
+	{
+		LogWarning("Failed to write save index \"%s\"", path);
+	}
+}
+
+// Updates the index entry of the save at 'file' to 'metadata', or removes it if that's null
+void updateIndex(const UString &saveDirectory, const UString &file, const SaveMetadata *metadata)
+{
+	std::lock_guard<std::mutex> l(saveIndexMutex);
+	try
+	{
+		fs::path path = file.str();
+		auto index = loadIndex(saveDirectory);
+		SaveIndexEntry entry;
+		if (metadata && statSave(path, entry.size, entry.modified))
+		{
+			entry.metadata = SaveMetadata(metadata->getName(), file, metadata->getDifficulty(),
+			                              metadata->getCreationDate(), metadata->getType(),
+			                              metadata->getGameTicks());
+			index[path.filename().string()] = entry;
+		}
+		else
+		{
+			index.erase(path.filename().string());
+		}
+		writeIndex(saveDirectory, index);
+	}
+	catch (fs::filesystem_error er)
+	{
+		LogWarning("Failed to update save index: \"%s\"", er.what());
+	}
+}
+
+// Returns null if the file isn't a save at all
+sp<SaveMetadata> readManifest(const UString &savePath)
+{
+	auto archive = SerializationArchive::readArchive(savePath);
+	if (!archive)
+	{
+		return nullptr;
+	}
+	auto metadata = mksp<SaveMetadata>();
+	if (!metadata->deserializeManifest(archive, savePath))
+	{
+		// accept saves with missing manifest if extension is correct
+		*metadata = SaveMetadata("Unknown(Missing manifest)", savePath, "", 0, SaveType::Manual, 0);
+	}
+	return metadata;
+}
+
+} // anonymous namespace
+
 UString SaveManager::createSavePath(const UString &name) const
 {
 	UString result;
@@ -214,6 +361,8 @@ bool SaveManager::overrideGame(const SaveMetadata &metadata, const UString &newN
 			try
 			{
 				fs::rename(metadata.getFile().str(), newFile.str());
+				updateIndex(saveDirectory, metadata.getFile(), nullptr);
+				updateIndex(saveDirectory, newFile, &updatedMetadata);
 			}
 			catch (fs::filesystem_error error)
 			{
@@ -233,7 +382,11 @@ bool SaveManager::saveGame(const SaveMetadata &metadata, const sp<GameState> gam
 	auto archive = SerializationArchive::createArchive();
 	if (gameState->serialize(archive) && metadata.serializeManifest(archive))
 	{
-		return writeArchiveWithBackup(archive, path, pack);
+		if (writeArchiveWithBackup(archive, path, pack))
+		{
+			updateIndex(saveDirectory, path, &metadata);
+			return true;
+		}
 	}
 
 	return false;
@@ -276,6 +429,14 @@ std::vector<SaveMetadata> SaveManager::getSaveList() const
 			return saveList;
 		}
 
+		std::lock_guard<std::mutex> l(saveIndexMutex);
+		auto index = loadIndex(dirString);
+		SaveIndex updatedIndex;
+		// Saves missing from the index, or changed since, have their manifest read on the thread
+		// pool
+		std::vector<std::pair<SaveIndexEntry, std::shared_future<sp<SaveMetadata>>>> refreshes;
+		std::vector<bool> refreshIndexed;
+
 		for (auto i = fs::directory_iterator(currentPath / saveDirectory);
 		     i != fs::directory_iterator(); ++i)
 		{
@@ -287,20 +448,41 @@ std::vector<SaveMetadata> SaveManager::getSaveList() const
 			std::string saveFileName = i->path().filename().string();
 			// miniz can't read paths not starting with dor or with windows slashes
 			UString savePath = saveDirectory.string() + "/" + saveFileName;
-			if (auto archive = SerializationArchive::readArchive(savePath))
+			SaveIndexEntry entry;
+			bool indexable = statSave(i->path(), entry.size, entry.modified);
+			auto indexed = index.find(saveFileName);
+			if (indexable && indexed != index.end() && indexed->second.size == entry.size &&
+			    indexed->second.modified == entry.modified)
 			{
-				SaveMetadata metadata;
-				if (metadata.deserializeManifest(archive, savePath))
-				{
-					saveList.push_back(metadata);
-				}
-				else // accept saves with missing manifest if extension is correct
-				{
-					saveList.push_back(SaveMetadata("Unknown(Missing manifest)", savePath, 0,
-					                                SaveType::Manual, nullptr));
-				}
+				saveList.push_back(indexed->second.metadata);
+				updatedIndex[saveFileName] = indexed->second;
+				continue;
+			}
+			refreshes.emplace_back(entry, fw().threadPoolEnqueue(readManifest, savePath));
+			refreshIndexed.push_back(indexable);
+		}
+
+		for (size_t i = 0; i < refreshes.size(); i++)
+		{
+			auto metadata = refreshes[i].second.get();
+			if (!metadata)
+			{
+				continue;
+			}
+			saveList.push_back(*metadata);
+			if (refreshIndexed[i])
+			{
+				auto &entry = refreshes[i].first;
+				entry.metadata = *metadata;
+				updatedIndex[fs::path(metadata->getFile().str()).filename().string()] = entry;
 			}
 		}
+
+		// Also drops the entries of saves that were deleted by something else
+		if (!refreshes.empty() || updatedIndex.size() != index.size())
+		{
+			writeIndex(dirString, updatedIndex);
+		}
 	}
 	catch (fs::filesystem_error er)
 	{
@@ -325,6 +507,7 @@ bool SaveManager::deleteGame(const sp<SaveMetadata> &slot) const
 		}
 
 		fs::remove_all(slot->getFile().str());
+		updateIndex(saveDirectory, slot->getFile(), nullptr);
 		return true;
 	}
 	catch (fs::filesystem_error exception)
@@ -438,6 +621,12 @@ SaveMetadata::SaveMetadata(const SaveMetadata &metdata, time_t creationDate,
 		// this->difficulty = gameState->difficulty; ?
 	}
 }
+SaveMetadata::SaveMetadata(UString name, UString file, UString difficulty, time_t creationDate,
+                           SaveType type, uint64_t gameTicks)
+    : name(name), file(file), difficulty(difficulty), creationDate(creationDate), type(type),
+      gameTicks(gameTicks)
+{
+}
 const UString &SaveMetadata::getName() const { return name; }
 const UString &SaveMetadata::getFile() const { return file; }
 const UString &SaveMetadata::getDifficulty() const { return difficulty; }
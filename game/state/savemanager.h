@@ -35,6 +35,8 @@ class SaveMetadata
 	SaveMetadata(UString name, UString file, time_t creationDate, SaveType type,
 	             const sp<GameState> gameState);
 	SaveMetadata(const SaveMetadata &metdata, time_t creationDate, const sp<GameState> gameState);
+	SaveMetadata(UString name, UString file, UString difficulty, time_t creationDate, SaveType type,
+	             uint64_t gameTicks);
 
 	/* Deserialize given manifest document	*/
 	bool deserializeManifest(const sp<SerializationArchive> archive, const UString &saveFileName);
@@ -93,6 +95,8 @@ class SaveManager
 	bool specialSaveGame(SaveType type, const sp<GameState> gameState) const;
 
 	// list all reachable saved games
+	// Manifests are kept in an index in the save directory, only saves that changed since they
+	// were indexed are opened
 	std::vector<SaveMetadata> getSaveList() const;
 
 	bool deleteGame(const sp<SaveMetadata> &slot) const;
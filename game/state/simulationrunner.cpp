@@ -0,0 +1,132 @@
+#include "game/state/simulationrunner.h"
+#include "framework/logger.h"
+#include <algorithm>
+#include <chrono>
+
+namespace OpenApoc
+{
+
+SimulationRunner::SimulationRunner(std::function<void(unsigned int ticks)> update)
+    : update(update)
+{
+}
+
+SimulationRunner::~SimulationRunner() { stop(); }
+
+void SimulationRunner::start()
+{
+	std::lock_guard<std::mutex> control(controlMutex);
+	if (running)
+	{
+		return;
+	}
+	running = true;
+	thread = std::thread(&SimulationRunner::run, this);
+}
+
+void SimulationRunner::stop()
+{
+	{
+		std::lock_guard<std::mutex> control(controlMutex);
+		if (!running)
+		{
+			return;
+		}
+		running = false;
+	}
+	controlChanged.notify_all();
+	thread.join();
+}
+
+void SimulationRunner::setTicksPerSecond(unsigned int ticksPerSecond)
+{
+	{
+		std::lock_guard<std::mutex> control(controlMutex);
+		if (this->ticksPerSecond == ticksPerSecond)
+		{
+			return;
+		}
+		this->ticksPerSecond = ticksPerSecond;
+	}
+	controlChanged.notify_all();
+}
+
+bool SimulationRunner::isPaused()
+{
+	std::lock_guard<std::mutex> control(controlMutex);
+	return !running || ticksPerSecond == 0;
+}
+
+std::unique_lock<std::mutex> SimulationRunner::lock()
+{
+	return std::unique_lock<std::mutex>(stateMutex);
+}
+
+std::unique_lock<std::mutex> SimulationRunner::tryLock()
+{
+	std::unique_lock<std::mutex> state(stateMutex, std::try_to_lock);
+	bool wasWanted;
+	{
+		std::lock_guard<std::mutex> control(controlMutex);
+		wasWanted = lockWanted;
+		lockWanted = !state.owns_lock();
+	}
+	if (wasWanted && state.owns_lock())
+	{
+		controlChanged.notify_all();
+	}
+	return state;
+}
+
+void SimulationRunner::run()
+{
+	using Clock = std::chrono::steady_clock;
+	using Seconds = std::chrono::duration<double>;
+
+	LogInfo("Simulation thread started");
+	auto lastTime = Clock::now();
+	// Ticks that became due but weren't run yet, including the fraction of the next one
+	double ticksDue = 0.0;
+	std::unique_lock<std::mutex> control(controlMutex);
+	while (running)
+	{
+		if (ticksPerSecond == 0)
+		{
+			controlChanged.wait(control);
+			lastTime = Clock::now();
+			ticksDue = 0.0;
+			continue;
+		}
+		auto now = Clock::now();
+		ticksDue += Seconds(now - lastTime).count() * ticksPerSecond;
+		ticksDue = std::min(ticksDue, (double)ticksPerSecond * MAX_CATCH_UP_MS / 1000);
+		lastTime = now;
+		if (ticksDue < 1.0)
+		{
+			// Also woken up early if the rate changes
+			auto wait = std::chrono::duration_cast<Clock::duration>(
+			    Seconds((1.0 - ticksDue) / ticksPerSecond));
+			controlChanged.wait_for(control, wait);
+			continue;
+		}
+		if (lockWanted)
+		{
+			// Someone couldn't get the state during the last update, let them have it first
+			controlChanged.wait_for(control, std::chrono::milliseconds(MAX_YIELD_MS),
+			                        [this]() { return !lockWanted || !running; });
+			lockWanted = false;
+			continue;
+		}
+		auto ticks = (unsigned int)ticksDue;
+		ticksDue -= ticks;
+		control.unlock();
+		{
+			std::lock_guard<std::mutex> state(stateMutex);
+			update(ticks);
+		}
+		control.lock();
+	}
+	LogInfo("Simulation thread stopped");
+}
+
+} // namespace OpenApoc
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace OpenApoc
+{
+
+// Runs the game simulation on its own thread at a fixed tick rate, independent of the frame rate:
+// a slow frame no longer slows down the game clock, and a slow tick no longer holds up frames.
+// The game state may only be touched with the lock held while the runner is started; the
+// simulation holds it for every update, so anything done with the lock held happens in between
+// ticks. Frames shouldn't wait for it: they draw what the simulation last published and take the
+// lock with tryLock(), putting off whatever needs the state if the simulation is busy.
+class SimulationRunner
+{
+  public:
+	// The rate the game used to be updated at when it got one tick per frame at 60 frames per
+	// second, which is what normal speed is based on
+	static const unsigned int BASE_TICKS_PER_SECOND = 60;
+	// When the simulation falls behind by more than this it drops the ticks instead of trying to
+	// catch up, so that a simulation slower than real time slows down the game clock rather than
+	// falling ever further behind
+	static const unsigned int MAX_CATCH_UP_MS = 250;
+	static const unsigned int MAX_YIELD_MS = 100;
+
+	// 'update' is called on the simulation thread with the lock held, with the number of ticks
+	// that became due since it was last called
+	SimulationRunner(std::function<void(unsigned int ticks)> update);
+	~SimulationRunner();
+
+	// stop() must not be called with the lock held, as it waits for the current update to finish
+	void start();
+	void stop();
+	// A rate of 0 pauses the simulation without stopping the thread
+	void setTicksPerSecond(unsigned int ticksPerSecond);
+	bool isPaused();
+
+	std::unique_lock<std::mutex> lock();
+	// Returns a lock that doesn't own the mutex if the simulation is in the middle of an update.
+	// The simulation then lets whoever asked have the state at the next tick boundary, unless they
+	// don't come back for it within MAX_YIELD_MS
+	std::unique_lock<std::mutex> tryLock();
+
+  private:
+	std::function<void(unsigned int ticks)> update;
+	std::mutex stateMutex;
+
+	// Guards everything below, and is never held while waiting for stateMutex
+	std::mutex controlMutex;
+	std::condition_variable controlChanged;
+	unsigned int ticksPerSecond = 0;
+	bool running = false;
+	// Set when tryLock() failed, until the caller got the state
+	bool lockWanted = false;
+	std::thread thread;
+
+	void run();
+};
+
+} // namespace OpenApoc
@@ -0,0 +1,196 @@
+#include "game/state/statehash.h"
+#include "game/state/agent.h"
+#include "game/state/battle/battle.h"
+#include "game/state/battle/battleexplosion.h"
+#include "game/state/battle/battlehazardfield.h"
+#include "game/state/battle/battleitem.h"
+#include "game/state/battle/battlemappart.h"
+#include "game/state/battle/battleunit.h"
+#include "game/state/battle/battleunitmission.h"
+#include "game/state/city/building.h"
+#include "game/state/city/city.h"
+#include "game/state/city/projectile.h"
+#include "game/state/city/vehicle.h"
+#include "game/state/city/vehiclemission.h"
+#include "game/state/gamestate.h"
+#include "game/state/organisation.h"
+#include <cstring>
+#include <set>
+
+namespace OpenApoc
+{
+
+void StateHash::add(uint64_t value)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		this->value ^= (value >> (i * 8)) & 0xff;
+		this->value *= 1099511628211ULL;
+	}
+}
+
+void StateHash::add(float value)
+{
+	uint32_t bits;
+	static_assert(sizeof(bits) == sizeof(value), "float isn't 32 bits");
+	std::memcpy(&bits, &value, sizeof(bits));
+	add(bits);
+}
+
+void StateHash::add(const UString &value)
+{
+	add((uint64_t)value.str().size());
+	for (auto c : value.str())
+	{
+		this->value ^= (uint8_t)c;
+		this->value *= 1099511628211ULL;
+	}
+}
+
+namespace
+{
+
+// Hashes every object in 'objects' on its own and adds up the results, which doesn't depend on
+// the order the set keeps them in
+template <typename T>
+void addUnordered(StateHash &hash, const std::set<sp<T>> &objects,
+                  void (*addObject)(StateHash &, const T &))
+{
+	uint64_t sum = 0;
+	for (auto &object : objects)
+	{
+		StateHash objectHash;
+		addObject(objectHash, *object);
+		sum += objectHash.get();
+	}
+	hash.add((uint64_t)objects.size());
+	hash.add(sum);
+}
+
+void addProjectile(StateHash &hash, const Projectile &projectile)
+{
+	hash.add(projectile.getPosition());
+	hash.add(projectile.getVelocity());
+	hash.add(projectile.getAge());
+	hash.add(projectile.getDamage());
+}
+
+void addVehicle(StateHash &hash, const Vehicle &vehicle)
+{
+	hash.add(vehicle.city.id);
+	hash.add(vehicle.position);
+	hash.add(vehicle.velocity);
+	hash.add(vehicle.health);
+	hash.add(vehicle.shield);
+	hash.add((uint64_t)vehicle.missions.size());
+	if (!vehicle.missions.empty())
+	{
+		auto &mission = *vehicle.missions.front();
+		hash.add((int)mission.type);
+		hash.add(mission.targetLocation);
+		hash.add((uint64_t)mission.currentPlannedPath.size());
+	}
+}
+
+void addCity(StateHash &hash, const City &city)
+{
+	for (auto &b : city.buildings)
+	{
+		auto &building = *b.second;
+		hash.add(b.first);
+		hash.add(building.owner.id);
+		hash.add(building.detected);
+		hash.add(building.ticksDetectionTimeOutEnd);
+		hash.add(building.ticksNextDetectionAttempt);
+		hash.add((uint64_t)building.landed_vehicles.size());
+	}
+	addUnordered(hash, city.projectiles, &addProjectile);
+}
+
+void addExplosion(StateHash &hash, const BattleExplosion &explosion)
+{
+	hash.add(explosion.position);
+	hash.add(explosion.power);
+	hash.add(explosion.ticksUntilExpansion);
+}
+
+void addHazard(StateHash &hash, const BattleHazard &hazard)
+{
+	hash.add(hazard.position);
+	hash.add(hazard.power);
+	hash.add(hazard.age);
+	hash.add(hazard.lifetime);
+}
+
+void addBattle(StateHash &hash, const Battle &battle)
+{
+	hash.add(battle.currentTurn);
+	hash.add(battle.ticksWithoutAction);
+	for (auto &u : battle.units)
+	{
+		auto &unit = *u.second;
+		hash.add(u.first);
+		hash.add(unit.position);
+		hash.add(unit.facing);
+		hash.add(unit.agent->modified_stats.health);
+		hash.add(unit.agent->modified_stats.morale);
+		hash.add(unit.stunDamage);
+		hash.add(unit.destroyed);
+		hash.add((uint64_t)unit.missions.size());
+	}
+	for (auto &part : battle.map_parts)
+	{
+		hash.add(part->destroyed);
+		hash.add(part->damaged);
+		hash.add(part->falling);
+	}
+	for (auto &item : battle.items)
+	{
+		hash.add(item->position);
+		hash.add(item->falling);
+	}
+	addUnordered(hash, battle.explosions, &addExplosion);
+	// Hazards are kept in the order they were created
+	auto hazards = battle.hazards.getRecords();
+	hash.add((uint64_t)hazards.size());
+	for (auto &hazard : hazards)
+	{
+		addHazard(hash, hazard);
+	}
+	addUnordered(hash, battle.projectiles, &addProjectile);
+}
+
+} // anonymous namespace
+
+uint64_t hashGameState(const GameState &state)
+{
+	StateHash hash;
+	hash.add(state.gameTime.getTicks());
+	uint64_t rngState[2];
+	state.rng.getState(rngState);
+	hash.add(rngState[0]);
+	hash.add(rngState[1]);
+	for (auto &o : state.organisations)
+	{
+		hash.add(o.first);
+		hash.add(o.second->balance);
+	}
+	for (auto &v : state.vehicles)
+	{
+		hash.add(v.first);
+		addVehicle(hash, *v.second);
+	}
+	for (auto &c : state.cities)
+	{
+		hash.add(c.first);
+		addCity(hash, *c.second);
+	}
+	hash.add((bool)state.current_battle);
+	if (state.current_battle)
+	{
+		addBattle(hash, *state.current_battle);
+	}
+	return hash.get();
+}
+
+} // namespace OpenApoc
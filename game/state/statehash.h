@@ -0,0 +1,49 @@
+#pragma once
+
+#include "library/strings.h"
+#include "library/vec.h"
+#include <cstdint>
+
+namespace OpenApoc
+{
+
+class GameState;
+
+// FNV-1a hash of the values added to it, in the order they're added
+class StateHash
+{
+  public:
+	void add(uint64_t value);
+	void add(int64_t value) { add((uint64_t)value); }
+	void add(uint32_t value) { add((uint64_t)value); }
+	void add(int value) { add((uint64_t)(int64_t)value); }
+	void add(bool value) { add((uint64_t)(value ? 1 : 0)); }
+	// Floats are hashed by their bits, so any difference at all shows
+	void add(float value);
+	void add(const UString &value);
+	template <typename T> void add(const Vec2<T> &value)
+	{
+		add(value.x);
+		add(value.y);
+	}
+	template <typename T> void add(const Vec3<T> &value)
+	{
+		add(value.x);
+		add(value.y);
+		add(value.z);
+	}
+
+	uint64_t get() const { return value; }
+
+  private:
+	uint64_t value = 14695981039346656037ULL;
+};
+
+// Hashes what the simulation depends on: game time, the random number generator, organisations,
+// vehicles and cities, and the battle if there is one. Two runs that end up with the same hash
+// after every tick evolved the same way, as far as anyone can tell.
+// Objects kept in sets of pointers are hashed in an order that doesn't depend on where they
+// happen to be allocated
+uint64_t hashGameState(const GameState &state);
+
+} // namespace OpenApoc
@@ -2,8 +2,10 @@
 
 #include "library/sp.h"
 #include "library/strings.h"
+#include <atomic>
 #include <exception>
 #include <map>
+#include <mutex>
 
 #ifndef NDEBUG
 #include "framework/logger.h"
@@ -76,12 +78,25 @@ template <typename T> class StateRef
 
   private:
 	mutable sp<T> obj;
+	// Set once 'obj' is, after which 'obj' is only read. Refs shared between threads (like those
+	// of units deciding in parallel) may then resolve at the same time
+	mutable std::atomic<bool> resolved;
 	const GameState *state;
 
+	void ensureResolved() const
+	{
+		if (!resolved.load(std::memory_order_acquire))
+			resolve();
+	}
+
 	void resolve() const
 	{
 		if (id.empty())
 			return;
+		static std::mutex resolveLock;
+		std::lock_guard<std::mutex> l(resolveLock);
+		if (resolved.load(std::memory_order_relaxed))
+			return;
 #ifndef NDEBUG
 		auto &prefix = T::getPrefix();
 		auto idPrefix = id.substr(0, prefix.length());
@@ -104,16 +119,24 @@ template <typename T> class StateRef
 			    format("No %s object matching ID \"%s\"", T::getTypeName(), id).str());
 		}
 #endif
+		resolved.store(!!obj, std::memory_order_release);
 	}
 
   public:
 	UString id;
-	StateRef() : state(nullptr){};
-	StateRef(const GameState *state) : state(state) {}
-	StateRef(const GameState *state, const UString &id) : state(state), id(id) {}
-	StateRef(const StateRef<T> &other) = default;
+	StateRef() : resolved(false), state(nullptr){};
+	StateRef(const GameState *state) : resolved(false), state(state) {}
+	StateRef(const GameState *state, const UString &id) : resolved(false), state(state), id(id) {}
+	// An unresolved ref's 'obj' may be being set by another thread, so it isn't copied
+	StateRef(const StateRef<T> &other)
+	    : resolved(other.resolved.load(std::memory_order_acquire)), state(other.state),
+	      id(other.id)
+	{
+		if (resolved.load(std::memory_order_relaxed))
+			obj = other.obj;
+	}
 
-	StateRef(const GameState *state, sp<T> ptr) : obj(ptr), state(state)
+	StateRef(const GameState *state, sp<T> ptr) : obj(ptr), resolved(!!ptr), state(state)
 	{
 		if (obj)
 			id = T::getId(*state, obj);
@@ -121,44 +144,37 @@ template <typename T> class StateRef
 
 	T &operator*()
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return *obj;
 	}
 	const T &operator*() const
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return *obj;
 	}
 	T *operator->()
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return obj.get();
 	}
 	const T *operator->() const
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return obj.get();
 	}
 	operator sp<T>()
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return obj;
 	}
 	operator const sp<T>() const
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return obj;
 	}
 	explicit operator bool() const
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return !!obj;
 	}
 	bool operator==(const StateRef<T> &other) const
@@ -172,29 +188,35 @@ template <typename T> class StateRef
 	bool operator!=(const StateRef<T> &other) const { return !(*this == other); }
 	bool operator==(const sp<T> &other) const
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return obj == other;
 	}
 	bool operator!=(const sp<T> &other) const
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return obj != other;
 	}
 	bool operator==(const T *other) const
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return obj.get() == other;
 	}
 	bool operator!=(const T *other) const
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return obj.get() != other;
 	}
-	StateRef<T> &operator=(const StateRef<T> &other) = default;
+	StateRef<T> &operator=(const StateRef<T> &other)
+	{
+		if (this == &other)
+			return *this;
+		bool otherResolved = other.resolved.load(std::memory_order_acquire);
+		obj = otherResolved ? other.obj : nullptr;
+		resolved.store(otherResolved, std::memory_order_relaxed);
+		state = other.state;
+		id = other.id;
+		return *this;
+	}
 	// Explicity handle "object = nullptr", as otherwise gcc doesn't know which overload to use
 	StateRef<T> &operator=(std::nullptr_t)
 	{
@@ -204,19 +226,20 @@ template <typename T> class StateRef
 	StateRef<T> &operator=(const UString newId)
 	{
 		obj = nullptr;
+		resolved.store(false, std::memory_order_relaxed);
 		id = newId;
 		return *this;
 	}
 	sp<T> getSp() const
 	{
-		if (!obj)
-			resolve();
+		ensureResolved();
 		return obj;
 	}
 	bool operator<(const StateRef<T> &other) const { return this->id < other.id; }
 	void clear()
 	{
 		this->obj = nullptr;
+		this->resolved.store(false, std::memory_order_relaxed);
 		this->id = "";
 	}
 };
@@ -0,0 +1,119 @@
+#include "game/state/staterecording.h"
+#include "framework/logger.h"
+#include "game/state/gamestate.h"
+#include "game/state/statehash.h"
+#include <sstream>
+
+namespace OpenApoc
+{
+
+namespace
+{
+const char *const RECORDING_MAGIC = "OpenApocStateRecording";
+const int RECORDING_VERSION = 1;
+} // anonymous namespace
+
+up<StateRecorder> StateRecorder::start(GameState &state, const UString &path)
+{
+	auto savePath = path + ".save";
+	if (!state.saveGame(savePath))
+	{
+		LogError("Failed to save the state to record from to \"%s\"", savePath);
+		return nullptr;
+	}
+	up<StateRecorder> recorder(new StateRecorder());
+	recorder->out.open(path.str());
+	if (!recorder->out)
+	{
+		LogError("Failed to open recording \"%s\"", path);
+		return nullptr;
+	}
+	uint64_t rngState[2];
+	state.rng.getState(rngState);
+	recorder->out << RECORDING_MAGIC << " " << RECORDING_VERSION << "\n";
+	recorder->out << "save " << savePath.str() << "\n";
+	recorder->out << std::hex;
+	recorder->out << "rng " << rngState[0] << " " << rngState[1] << "\n";
+	recorder->out << "hash " << hashGameState(state) << "\n";
+	recorder->out << std::dec;
+	recorder->out.flush();
+	return recorder;
+}
+
+void StateRecorder::recordStep(const GameState &state, uint64_t ticksBefore, bool fastForward,
+                               unsigned int ticksRequested, unsigned int ticksAdvanced)
+{
+	out << "step " << ticksBefore << " " << (fastForward ? "f" : "u") << " " << ticksRequested
+	    << " " << ticksAdvanced << " " << std::hex << hashGameState(state) << std::dec << "\n";
+}
+
+bool StateRecording::load(const UString &path)
+{
+	std::ifstream in(path.str());
+	if (!in)
+	{
+		LogError("Failed to open recording \"%s\"", path);
+		return false;
+	}
+	std::string magic;
+	int version = 0;
+	in >> magic >> version;
+	if (magic != RECORDING_MAGIC || version != RECORDING_VERSION)
+	{
+		LogError("\"%s\" isn't a recording this version can replay", path);
+		return false;
+	}
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(in, line))
+	{
+		lineNumber++;
+		std::istringstream fields(line);
+		std::string key;
+		if (!(fields >> key))
+		{
+			continue;
+		}
+		if (key == "save")
+		{
+			std::string save;
+			std::getline(fields >> std::ws, save);
+			savePath = save;
+		}
+		else if (key == "rng")
+		{
+			fields >> std::hex >> rngState[0] >> rngState[1];
+		}
+		else if (key == "hash")
+		{
+			fields >> std::hex >> initialHash;
+		}
+		else if (key == "step")
+		{
+			RecordedStep step;
+			std::string kind;
+			fields >> step.ticks >> kind >> step.ticksRequested >> step.ticksAdvanced >> std::hex >>
+			    step.hash;
+			step.fastForward = kind == "f";
+			steps.push_back(step);
+		}
+		else
+		{
+			LogError("Unknown entry \"%s\" on line %d of \"%s\"", UString(key), lineNumber, path);
+			return false;
+		}
+		if (fields.fail())
+		{
+			LogError("Malformed line %d of \"%s\"", lineNumber, path);
+			return false;
+		}
+	}
+	if (savePath.empty())
+	{
+		LogError("Recording \"%s\" has no save to start from", path);
+		return false;
+	}
+	return true;
+}
+
+} // namespace OpenApoc
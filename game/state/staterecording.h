@@ -0,0 +1,58 @@
+#pragma once
+
+#include "library/sp.h"
+#include "library/strings.h"
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class GameState;
+
+// One call advancing the simulation, and the hash of the state it left behind
+class RecordedStep
+{
+  public:
+	// Game time before the step
+	uint64_t ticks = 0;
+	// GameState::fastForward() rather than GameState::update()
+	bool fastForward = false;
+	// The ticks asked to fast-forward, and the ticks it did
+	unsigned int ticksRequested = 1;
+	unsigned int ticksAdvanced = 1;
+	uint64_t hash = 0;
+};
+
+// Logs every step a GameState is advanced by along with its hash, once it's attached as the
+// state's recorder. The log starts with a save of the state and its random number generator, so
+// that the steps can be run again from there (see StateRecording)
+class StateRecorder
+{
+  public:
+	// Saves 'state' next to the log at 'path' and starts the log, returns nullptr if either can't
+	// be written
+	static up<StateRecorder> start(GameState &state, const UString &path);
+
+	void recordStep(const GameState &state, uint64_t ticksBefore, bool fastForward,
+	                unsigned int ticksRequested, unsigned int ticksAdvanced);
+
+  private:
+	std::ofstream out;
+};
+
+// A log written by StateRecorder
+class StateRecording
+{
+  public:
+	bool load(const UString &path);
+
+	UString savePath;
+	uint64_t rngState[2] = {0, 0};
+	// Hash of the state as it was saved
+	uint64_t initialHash = 0;
+	std::vector<RecordedStep> steps;
+};
+
+} // namespace OpenApoc
@@ -13,7 +13,7 @@ namespace OpenApoc
 {
 
 Collision TileMap::findCollision(Vec3<float> lineSegmentStart, Vec3<float> lineSegmentEnd,
-                                 const std::set<TileObject::Type> validTypes,
+                                 const std::set<TileObject::Type> &validTypes,
                                  sp<TileObject> ignoredObject, bool useLOS, bool check_full_path,
                                  unsigned maxRange, bool recordPassedTiles) const
 {
@@ -115,7 +115,7 @@ Collision TileMap::findCollision(Vec3<float> lineSegmentStart, Vec3<float> lineS
 		{
 			if ((!obj->hasVoxelMap()) ||
 			    (typeChecking && validTypes.find(obj->type) == validTypes.end()) ||
-			    (obj == ignoredObject))
+			    (obj == ignoredObject.get()))
 			{
 				continue;
 			}
@@ -134,7 +134,7 @@ Collision TileMap::findCollision(Vec3<float> lineSegmentStart, Vec3<float> lineS
 			Vec3<int> voxelPosWithinMap = voxelPos % tileSize;
 			if (voxelMap->getBit(voxelPosWithinMap))
 			{
-				c.obj = obj;
+				c.obj = obj->shared_from_this();
 				c.position = Vec3<float>{point};
 				c.position /= tileSizef;
 				return c;
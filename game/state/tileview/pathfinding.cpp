@@ -3,47 +3,21 @@
 #include "game/state/battle/battlemap.h"
 #include "game/state/battle/battleunit.h"
 #include "game/state/battle/battleunitmission.h"
+#include "game/state/tileview/pathsearch.h"
 #include "game/state/tileview/tile.h"
+#include "library/arena.h"
 #include "limits.h"
 #include <algorithm>
+#include <functional>
 #include <glm/glm.hpp>
+#include <limits>
+#include <queue>
 
 namespace OpenApoc
 {
 
 namespace
 {
-class PathNode
-{
-  public:
-	PathNode(float costToGetHere, float trueCost, float distanceToGoal, PathNode *parentNode,
-	         Tile *thisTile)
-	    : costToGetHere(costToGetHere), trueCost(trueCost), parentNode(parentNode),
-	      thisTile(thisTile), distanceToGoal(distanceToGoal)
-	{
-	}
-
-	std::list<Vec3<int>> getPathToNode()
-	{
-		std::list<Vec3<int>> path;
-		path.push_back(thisTile->position);
-		PathNode *t = parentNode;
-		while (t)
-		{
-			path.push_front(t->thisTile->position);
-			t = t->parentNode;
-		}
-
-		return path;
-	}
-
-	float costToGetHere;
-	float trueCost;
-	PathNode *parentNode;
-	Tile *thisTile;
-	float distanceToGoal;
-};
-
 class LosNode
 {
   public:
@@ -102,122 +76,41 @@ std::list<Vec3<int>> TileMap::findShortestPath(Vec3<int> origin, Vec3<int> desti
 #endif
 
 	TRACE_FN;
-	maxCost /= canEnterTile.pathOverheadAlloawnce();
-	// Faster than looking up in a set
-	std::vector<bool> visitedTiles = std::vector<bool>(size.x * size.y * size.z, false);
-	int strideZ = size.x * size.y;
-	int strideY = size.x;
-	std::list<PathNode *> nodesToDelete;
-	std::list<PathNode *> fringe;
-	Vec3<float> goalPositionStart;
-	Vec3<float> goalPositionEnd;
-	bool destinationIsSingleTile = destinationStart == destinationEnd - Vec3<int>{1, 1, 1};
-	int iterationCount = 0;
-
-	// Approach Only makes no sense with pathing into a block, but we'll fix it anyway
-	if (approachOnly && !destinationIsSingleTile)
-	{
-		LogWarning("Trying to route from %s to %s-%s in approachOnly mode? Extending destination's "
-		           "xy boundaries by 1.",
-		           origin, destinationStart, destinationEnd);
-		approachOnly = false;
-		destinationStart -=
-		    Vec3<int>(destinationStart.x > 0 ? 1 : 0, destinationStart.y > 0 ? 1 : 0, 0);
-		destinationEnd +=
-		    Vec3<int>(destinationEnd.x < size.x ? 1 : 0, destinationEnd.y < size.y ? 1 : 0, 0);
-	}
-
-	LogInfo("Trying to route from %s to %s-%s", origin, destinationStart, destinationEnd);
-
-	if (!tileIsValid(origin))
-	{
-		LogError("Bad origin %s", origin);
-		return {};
-	}
-	if (!tileIsValid(destinationStart))
-	{
-		LogError("Bad destinationStart %s", destinationStart);
-		return {};
-	}
-	if (destinationEnd.x <= destinationStart.x || destinationEnd.x > this->size.x ||
-	    destinationEnd.y <= destinationStart.y || destinationEnd.y > this->size.y ||
-	    destinationEnd.z <= destinationStart.z || destinationEnd.z > this->size.z)
-	{
-		LogError("Bad destinationEnd %s", destinationEnd);
-		return {};
-	}
-
-	goalPositionStart = destinationStart;
-	goalPositionEnd = destinationEnd;
-
-	Tile *startTile = this->getTile(origin);
-	if (!startTile)
-	{
-		LogError("Failed to get origin tile at %s", origin);
-		return {};
-	}
-
-	if (origin.x >= destinationStart.x && origin.x < destinationEnd.x &&
-	    origin.y >= destinationStart.y && origin.y < destinationEnd.y &&
-	    origin.z >= destinationStart.z && origin.z < destinationEnd.z)
-	{
-		LogInfo("Origin is within destination!");
-		return {startTile->position};
-	}
-
-	auto startNode = new PathNode(
-	    0.0f, 0.0f, canEnterTile.getDistance(origin, goalPositionStart, goalPositionEnd), nullptr,
-	    startTile);
-	nodesToDelete.push_back(startNode);
-	fringe.emplace_back(startNode);
-
-	auto closestNodeSoFar = *fringe.begin();
-
-	while (iterationCount++ < iterationLimit)
-	{
-		auto first = fringe.begin();
-		if (first == fringe.end())
-		{
-			LogInfo("No more tiles to expand after %d iterations", iterationCount);
-			break;
-		}
-		auto nodeToExpand = *first;
-		fringe.erase(first);
+	// Nodes and the fringe live in the arena and are all released on return
+	auto &arena = tickArena();
+	MemoryArena::Scope pathScope(arena);
+	PathSearch search(arena, *this, origin, destinationStart, destinationEnd, iterationLimit,
+	                  canEnterTile, approachOnly, ignoreStaticUnits, ignoreAllUnits, maxCost);
+	search.run(std::numeric_limits<int>::max());
+	return search.getPath(cost);
+}
 
-		// Skip if we've already expanded this, as in a 3d-grid we know the first
-		// expansion will be the shortest route
-		if (visitedTiles[nodeToExpand->thisTile->position.z * strideZ +
-		                 nodeToExpand->thisTile->position.y * strideY +
-		                 nodeToExpand->thisTile->position.x])
+std::map<Vec3<int>, float> TileMap::findCostsAround(Vec3<int> origin, float maxCost,
+                                                    int iterationLimit,
+                                                    const CanEnterTileHelper &canEnterTile,
+                                                    bool ignoreStaticUnits, bool ignoreAllUnits)
+{
+	TRACE_FN;
+	std::map<Vec3<int>, float> costs;
+	std::set<Vec3<int>> expanded;
+	std::vector<Vec3<int>> positions;
+	using Node = std::pair<float, size_t>;
+	std::priority_queue<Node, std::vector<Node>, std::greater<Node>> fringe;
+	costs[origin] = 0.0f;
+	positions.push_back(origin);
+	fringe.emplace(0.0f, 0);
+	int iterations = 0;
+	while (!fringe.empty() && iterations < iterationLimit)
+	{
+		auto node = fringe.top();
+		fringe.pop();
+		auto currentPosition = positions[node.second];
+		if (!expanded.insert(currentPosition).second)
 		{
-			iterationCount--;
 			continue;
 		}
-		visitedTiles[nodeToExpand->thisTile->position.z * strideZ +
-		             nodeToExpand->thisTile->position.y * strideY +
-		             nodeToExpand->thisTile->position.x] = true;
-
-#ifdef PATHFINDING_DEBUG
-		nodeToExpand->thisTile->pathfindingDebugFlag = true;
-#endif
-
-		// Make it so we always try to move at least one tile
-		if (closestNodeSoFar->parentNode == nullptr)
-			closestNodeSoFar = nodeToExpand;
-
-		if (nodeToExpand->distanceToGoal == 0 ||
-		    (approachOnly && nodeToExpand->thisTile->position.z == goalPositionStart.z &&
-		     std::max(std::abs(nodeToExpand->thisTile->position.x - goalPositionStart.x),
-		              std::abs(nodeToExpand->thisTile->position.y - goalPositionStart.y)) <= 1))
-		{
-			closestNodeSoFar = nodeToExpand;
-			break;
-		}
-		else if (nodeToExpand->distanceToGoal < closestNodeSoFar->distanceToGoal)
-		{
-			closestNodeSoFar = nodeToExpand;
-		}
-		Vec3<int> currentPosition = nodeToExpand->thisTile->position;
+		iterations++;
+		auto currentTile = getTile(currentPosition);
 		for (int z = -1; z <= 1; z++)
 		{
 			for (int y = -1; y <= 1; y++)
@@ -228,26 +121,22 @@ std::list<Vec3<int>> TileMap::findShortestPath(Vec3<int> origin, Vec3<int> desti
 					{
 						continue;
 					}
-					auto nextPosition = currentPosition;
-					nextPosition.x += x;
-					nextPosition.y += y;
-					nextPosition.z += z;
-					if (!tileIsValid(nextPosition))
-						continue;
-
-					Tile *tile = this->getTile(nextPosition);
-					if (visitedTiles[tile->position.z * strideZ + tile->position.y * strideY +
-					                 tile->position.x])
+					auto nextPosition = currentPosition + Vec3<int>{x, y, z};
+					if (!tileIsValid(nextPosition) ||
+					    expanded.find(nextPosition) != expanded.end())
 					{
 						continue;
 					}
+					Tile *tile = getTile(nextPosition);
 					float thisCost = 0.0f;
 					bool unused = false;
 					bool jumped = false;
-					if (!canEnterTile.canEnterTile(nodeToExpand->thisTile, tile,
-					                               canEnterTile.allowJumping, jumped, thisCost,
-					                               unused, ignoreStaticUnits, ignoreAllUnits))
+					if (!canEnterTile.canEnterTile(currentTile, tile, canEnterTile.allowJumping,
+					                               jumped, thisCost, unused, ignoreStaticUnits,
+					                               ignoreAllUnits))
+					{
 						continue;
+					}
 					// Jumped flag set, must immediately land
 					if (jumped)
 					{
@@ -256,102 +145,32 @@ std::list<Vec3<int>> TileMap::findShortestPath(Vec3<int> origin, Vec3<int> desti
 						{
 							continue;
 						}
-						auto nextTile = this->getTile(nextNextPosition);
+						auto nextTile = getTile(nextNextPosition);
 						if (!canEnterTile.canEnterTile(tile, nextTile, false, jumped, thisCost,
 						                               unused, ignoreStaticUnits, ignoreAllUnits))
 						{
 							continue;
 						}
-						// Jump success, replace values
 						nextPosition = nextNextPosition;
-						tile = nextTile;
 					}
-					float newNodeCost = nodeToExpand->costToGetHere;
-					float newTrueCost = nodeToExpand->trueCost;
-
-					newNodeCost += thisCost /* * (jumped ? 2 : 1) */
-					               / canEnterTile.pathOverheadAlloawnce();
-					newTrueCost += thisCost;
-
-					// make pathfinder biased towards vehicle's altitude preference
-					newNodeCost += canEnterTile.adjustCost(nextPosition, z);
-
-					// Do not add to the fringe if too far
-					if (maxCost != 0.0f && newNodeCost >= maxCost)
+					auto newCost = node.first + thisCost;
+					if (newCost >= maxCost)
+					{
 						continue;
-
-					auto newNode =
-					    new PathNode(newNodeCost, newTrueCost,
-					                 destinationIsSingleTile
-					                     ? canEnterTile.getDistance(nextPosition, goalPositionStart)
-					                     : canEnterTile.getDistance(nextPosition, goalPositionStart,
-					                                                goalPositionEnd),
-					                 nodeToExpand, tile);
-					nodesToDelete.push_back(newNode);
-
-					// Put node at appropriate place in the list
-					auto it = fringe.begin();
-					while (it != fringe.end() &&
-					       ((*it)->costToGetHere + (*it)->distanceToGoal) <
-					           (newNode->costToGetHere + newNode->distanceToGoal))
-						it++;
-					fringe.emplace(it, newNode);
+					}
+					auto it = costs.find(nextPosition);
+					if (it != costs.end() && it->second <= newCost)
+					{
+						continue;
+					}
+					costs[nextPosition] = newCost;
+					positions.push_back(nextPosition);
+					fringe.emplace(newCost, positions.size() - 1);
 				}
 			}
 		}
 	}
-	if (iterationCount > iterationLimit)
-	{
-		if (approachOnly && closestNodeSoFar->thisTile->position.z == goalPositionStart.z &&
-		    std::max(std::abs(closestNodeSoFar->thisTile->position.x - goalPositionStart.x),
-		             std::abs(closestNodeSoFar->thisTile->position.y - goalPositionStart.y)) <= 1)
-		{
-			// Nothing?
-		}
-		else if (maxCost > 0.0f)
-		{
-			LogInfo("No route from %s to %s-%s found after %d iterations, returning "
-			        "closest path %s",
-			        origin, destinationStart, destinationEnd, iterationCount,
-			        closestNodeSoFar->thisTile->position);
-		}
-		else
-		{
-			LogWarning("No route from %s to %s-%s found after %d iterations, returning "
-			           "closest path %s",
-			           origin, destinationStart, destinationEnd, iterationCount,
-			           closestNodeSoFar->thisTile->position);
-		}
-	}
-	else if (closestNodeSoFar->distanceToGoal > 0)
-	{
-		if (maxCost > 0.0f)
-		{
-			LogInfo("Could not find path within maxPath, returning closest path %s",
-			        closestNodeSoFar->thisTile->position.x);
-		}
-		else
-		{
-			LogInfo("Surprisingly, no nodes to expand! Closest path %s",
-			        closestNodeSoFar->thisTile->position);
-		}
-	}
-	/*else
-	{
-	    LogInfo("Path of length %d found in %d iterations", (int)(closestNodeSoFar->costToGetHere *
-	canEnterTile.pathOverheadAlloawnce() / 4.0f), iterationCount);
-	}*/
-
-	auto result = closestNodeSoFar->getPathToNode();
-	if (cost)
-	{
-		*cost = closestNodeSoFar->trueCost;
-	}
-
-	for (auto &p : nodesToDelete)
-		delete p;
-
-	return result;
+	return costs;
 }
 
 std::list<Vec3<int>> Battle::findShortestPath(Vec3<int> origin, Vec3<int> destination,
@@ -667,10 +486,12 @@ std::list<Vec3<int>> Battle::findShortestPathUsingLB(Vec3<int> origin, Vec3<int>
 std::list<int> Battle::findLosBlockPath(int origin, int destination, BattleUnitType type,
                                         int iterationLimit)
 {
+	// Nodes and the fringe live in the arena and are all released on return
+	auto &arena = tickArena();
+	MemoryArena::Scope pathScope(arena);
 	int lbCount = losBlocks.size();
-	std::vector<bool> visitedBlocks = std::vector<bool>(lbCount, false);
-	std::list<LosNode *> nodesToDelete;
-	std::list<LosNode *> fringe;
+	ArenaVector<bool> visitedBlocks(lbCount, false);
+	ArenaList<LosNode *> fringe;
 	int iterationCount = 0;
 
 	LogInfo("Trying to route from lb %d to lb %d", origin, destination);
@@ -693,11 +514,10 @@ std::list<int> Battle::findLosBlockPath(int origin, int destination, BattleUnitT
 		return {};
 	}
 
-	auto startNode =
-	    new LosNode(0.0f, BattleUnitTileHelper::getDistanceStatic(
-	                          blockCenterPos[type][origin], blockCenterPos[type][destination]),
-	                nullptr, origin);
-	nodesToDelete.push_back(startNode);
+	auto startNode = arena.create<LosNode>(
+	    0.0f, BattleUnitTileHelper::getDistanceStatic(blockCenterPos[type][origin],
+	                                                  blockCenterPos[type][destination]),
+	    nullptr, origin);
 	fringe.emplace_back(startNode);
 
 	auto closestNodeSoFar = *fringe.begin();
@@ -744,11 +564,10 @@ std::list<int> Battle::findLosBlockPath(int origin, int destination, BattleUnitT
 			float newNodeCost = nodeToExpand->costToGetHere;
 			newNodeCost += linkCost[type][i + j * lbCount];
 
-			auto newNode = new LosNode(
+			auto newNode = arena.create<LosNode>(
 			    newNodeCost, BattleUnitTileHelper::getDistanceStatic(
 			                     blockCenterPos[type][j], blockCenterPos[type][destination]),
 			    nodeToExpand, j);
-			nodesToDelete.push_back(newNode);
 
 			// Put node at appropriate place in the list
 			auto it = fringe.begin();
@@ -773,9 +592,6 @@ std::list<int> Battle::findLosBlockPath(int origin, int destination, BattleUnitT
 
 	auto result = closestNodeSoFar->getPathToNode();
 
-	for (auto &p : nodesToDelete)
-		delete p;
-
 	return result;
 }
 
@@ -1009,6 +825,26 @@ void Battle::groupMove(GameState &state, std::list<StateRef<BattleUnit>> &select
 	log += format("\nTarget location is now %d, %d, %d. Leader is %s", targetLocation.x,
 	              targetLocation.y, targetLocation.z, leadUnit.id);
 
+	// A location is fit for a unit if the leader could walk there from the target within a limit
+	// that grows with its offset. One search from the target covers every location, instead of
+	// one search per location tried
+	auto getCostLimit = [](Vec3<int> offset) {
+		return 1.50f * 2.0f *
+		       (float)(std::max(std::abs(offset.x), std::abs(offset.y)) + std::abs(offset.x) +
+		               std::abs(offset.y));
+	};
+	// The search may expand as many tiles as the searches for every location could together,
+	// each of which was limited to half its cost limit
+	float maxCostLimit = 0.0f;
+	int iterationLimit = 0;
+	for (auto &offset : targetOffsets)
+	{
+		maxCostLimit = std::max(maxCostLimit, getCostLimit(offset));
+		iterationLimit += (int)(getCostLimit(offset) / 2.0f);
+	}
+	auto costsAroundTarget =
+	    map.findCostsAround(targetLocation, maxCostLimit, iterationLimit, h, true, false);
+
 	auto itOffset = targetOffsets.begin();
 	for (auto &unit : localUnits)
 	{
@@ -1035,14 +871,9 @@ void Battle::groupMove(GameState &state, std::list<StateRef<BattleUnit>> &select
 			log += format("\nTrying location %d, %d, %d at offset %d, %d, %d",
 			              targetLocationOffsetted.x, targetLocationOffsetted.y,
 			              targetLocationOffsetted.z, offset.x, offset.y, offset.z);
-			float costLimit =
-			    1.50f * 2.0f * (float)(std::max(std::abs(offset.x), std::abs(offset.y)) +
-			                           std::abs(offset.x) + std::abs(offset.y));
-			auto path =
-			    map.findShortestPath(targetLocation, targetLocationOffsetted, costLimit / 2.0f, h,
-			                         false, true, false, nullptr, costLimit);
+			auto cost = costsAroundTarget.find(targetLocationOffsetted);
 			itOffset++;
-			if (!path.empty() && path.back() == targetLocationOffsetted)
+			if (cost != costsAroundTarget.end() && cost->second < getCostLimit(offset))
 			{
 				log += format("\nLocation checks out, pathing to it");
 				unit->setMission(state, BattleUnitMission::gotoLocation(
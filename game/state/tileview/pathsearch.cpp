@@ -0,0 +1,352 @@
+#include "game/state/tileview/pathsearch.h"
+#include "framework/logger.h"
+#include "game/state/tileview/tile.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+namespace OpenApoc
+{
+
+namespace
+{
+// Arena block size for queued searches, most of them need a lot less than a tick does
+static const size_t JOB_ARENA_BLOCK_SIZE = 64 * 1024;
+} // anonymous namespace
+
+PathSearch::PathSearch(MemoryArena &arena, TileMap &map, Vec3<int> origin,
+                       Vec3<int> destinationStart, Vec3<int> destinationEnd, int iterationLimit,
+                       const CanEnterTileHelper &canEnterTile, bool approachOnly,
+                       bool ignoreStaticUnits, bool ignoreAllUnits, float maxCost)
+    : arena(arena), map(map), canEnterTile(canEnterTile), origin(origin),
+      destinationStart(destinationStart), destinationEnd(destinationEnd),
+      iterationLimit(iterationLimit), approachOnly(approachOnly),
+      ignoreStaticUnits(ignoreStaticUnits), ignoreAllUnits(ignoreAllUnits),
+      maxCost(maxCost / canEnterTile.pathOverheadAlloawnce()),
+      visitedTiles(map.size.x * map.size.y * map.size.z, false, ArenaAllocator<bool>(arena)),
+      fringe(ArenaAllocator<PathNode *>(arena)),
+      destinationIsSingleTile(destinationStart == destinationEnd - Vec3<int>{1, 1, 1})
+{
+	// Approach Only makes no sense with pathing into a block, but we'll fix it anyway
+	if (this->approachOnly && !destinationIsSingleTile)
+	{
+		LogWarning("Trying to route from %s to %s-%s in approachOnly mode? Extending destination's "
+		           "xy boundaries by 1.",
+		           origin, destinationStart, destinationEnd);
+		this->approachOnly = false;
+		this->destinationStart -=
+		    Vec3<int>(destinationStart.x > 0 ? 1 : 0, destinationStart.y > 0 ? 1 : 0, 0);
+		this->destinationEnd +=
+		    Vec3<int>(destinationEnd.x < map.size.x ? 1 : 0, destinationEnd.y < map.size.y ? 1 : 0,
+		              0);
+	}
+	destinationStart = this->destinationStart;
+	destinationEnd = this->destinationEnd;
+
+	LogInfo("Trying to route from %s to %s-%s", origin, destinationStart, destinationEnd);
+
+	finished = true;
+	failed = true;
+	if (!map.tileIsValid(origin))
+	{
+		LogError("Bad origin %s", origin);
+		return;
+	}
+	if (!map.tileIsValid(destinationStart))
+	{
+		LogError("Bad destinationStart %s", destinationStart);
+		return;
+	}
+	if (destinationEnd.x <= destinationStart.x || destinationEnd.x > map.size.x ||
+	    destinationEnd.y <= destinationStart.y || destinationEnd.y > map.size.y ||
+	    destinationEnd.z <= destinationStart.z || destinationEnd.z > map.size.z)
+	{
+		LogError("Bad destinationEnd %s", destinationEnd);
+		return;
+	}
+
+	goalPositionStart = destinationStart;
+	goalPositionEnd = destinationEnd;
+
+	Tile *startTile = map.getTile(origin);
+	if (!startTile)
+	{
+		LogError("Failed to get origin tile at %s", origin);
+		return;
+	}
+
+	auto startNode = arena.create<PathNode>(
+	    0.0f, 0.0f, canEnterTile.getDistance(origin, goalPositionStart, goalPositionEnd), nullptr,
+	    startTile);
+	closestNodeSoFar = startNode;
+	failed = false;
+
+	if (origin.x >= destinationStart.x && origin.x < destinationEnd.x &&
+	    origin.y >= destinationStart.y && origin.y < destinationEnd.y &&
+	    origin.z >= destinationStart.z && origin.z < destinationEnd.z)
+	{
+		LogInfo("Origin is within destination!");
+		originInDestination = true;
+		return;
+	}
+
+	fringe.emplace_back(startNode);
+	finished = false;
+}
+
+int PathSearch::run(int iterations)
+{
+	int strideZ = map.size.x * map.size.y;
+	int strideY = map.size.x;
+	int expanded = 0;
+	while (!finished && expanded < iterations)
+	{
+		if (iterationCount++ >= iterationLimit)
+		{
+			finish();
+			break;
+		}
+		auto first = fringe.begin();
+		if (first == fringe.end())
+		{
+			LogInfo("No more tiles to expand after %d iterations", iterationCount);
+			finish();
+			break;
+		}
+		auto nodeToExpand = *first;
+		fringe.erase(first);
+
+		// Skip if we've already expanded this, as in a 3d-grid we know the first
+		// expansion will be the shortest route
+		if (visitedTiles[nodeToExpand->thisTile->position.z * strideZ +
+		                 nodeToExpand->thisTile->position.y * strideY +
+		                 nodeToExpand->thisTile->position.x])
+		{
+			iterationCount--;
+			continue;
+		}
+		visitedTiles[nodeToExpand->thisTile->position.z * strideZ +
+		             nodeToExpand->thisTile->position.y * strideY +
+		             nodeToExpand->thisTile->position.x] = true;
+		expanded++;
+
+#ifdef PATHFINDING_DEBUG
+		nodeToExpand->thisTile->pathfindingDebugFlag = true;
+#endif
+
+		// Make it so we always try to move at least one tile
+		if (closestNodeSoFar->parentNode == nullptr)
+			closestNodeSoFar = nodeToExpand;
+
+		if (nodeToExpand->distanceToGoal == 0 ||
+		    (approachOnly && nodeToExpand->thisTile->position.z == goalPositionStart.z &&
+		     std::max(std::abs(nodeToExpand->thisTile->position.x - goalPositionStart.x),
+		              std::abs(nodeToExpand->thisTile->position.y - goalPositionStart.y)) <= 1))
+		{
+			closestNodeSoFar = nodeToExpand;
+			finish();
+			break;
+		}
+		else if (nodeToExpand->distanceToGoal < closestNodeSoFar->distanceToGoal)
+		{
+			closestNodeSoFar = nodeToExpand;
+		}
+		Vec3<int> currentPosition = nodeToExpand->thisTile->position;
+		for (int z = -1; z <= 1; z++)
+		{
+			for (int y = -1; y <= 1; y++)
+			{
+				for (int x = -1; x <= 1; x++)
+				{
+					if (x == 0 && y == 0 && z == 0)
+					{
+						continue;
+					}
+					auto nextPosition = currentPosition;
+					nextPosition.x += x;
+					nextPosition.y += y;
+					nextPosition.z += z;
+					if (!map.tileIsValid(nextPosition))
+						continue;
+
+					Tile *tile = map.getTile(nextPosition);
+					if (visitedTiles[tile->position.z * strideZ + tile->position.y * strideY +
+					                 tile->position.x])
+					{
+						continue;
+					}
+					float thisCost = 0.0f;
+					bool unused = false;
+					bool jumped = false;
+					if (!canEnterTile.canEnterTile(nodeToExpand->thisTile, tile,
+					                               canEnterTile.allowJumping, jumped, thisCost,
+					                               unused, ignoreStaticUnits, ignoreAllUnits))
+						continue;
+					// Jumped flag set, must immediately land
+					if (jumped)
+					{
+						auto nextNextPosition = nextPosition + Vec3<int>{x, y, 0};
+						if (!map.tileIsValid(nextNextPosition))
+						{
+							continue;
+						}
+						auto nextTile = map.getTile(nextNextPosition);
+						if (!canEnterTile.canEnterTile(tile, nextTile, false, jumped, thisCost,
+						                               unused, ignoreStaticUnits, ignoreAllUnits))
+						{
+							continue;
+						}
+						// Jump success, replace values
+						nextPosition = nextNextPosition;
+						tile = nextTile;
+					}
+					float newNodeCost = nodeToExpand->costToGetHere;
+					float newTrueCost = nodeToExpand->trueCost;
+
+					newNodeCost += thisCost /* * (jumped ? 2 : 1) */
+					               / canEnterTile.pathOverheadAlloawnce();
+					newTrueCost += thisCost;
+
+					// make pathfinder biased towards vehicle's altitude preference
+					newNodeCost += canEnterTile.adjustCost(nextPosition, z);
+
+					// Do not add to the fringe if too far
+					if (maxCost != 0.0f && newNodeCost >= maxCost)
+						continue;
+
+					auto newNode = arena.create<PathNode>(
+					    newNodeCost, newTrueCost,
+					    destinationIsSingleTile
+					        ? canEnterTile.getDistance(nextPosition, goalPositionStart)
+					        : canEnterTile.getDistance(nextPosition, goalPositionStart,
+					                                   goalPositionEnd),
+					    nodeToExpand, tile);
+
+					// Put node at appropriate place in the list
+					auto it = fringe.begin();
+					while (it != fringe.end() &&
+					       ((*it)->costToGetHere + (*it)->distanceToGoal) <
+					           (newNode->costToGetHere + newNode->distanceToGoal))
+						it++;
+					fringe.emplace(it, newNode);
+				}
+			}
+		}
+	}
+	return expanded;
+}
+
+void PathSearch::finish()
+{
+	finished = true;
+	if (iterationCount > iterationLimit)
+	{
+		if (approachOnly && closestNodeSoFar->thisTile->position.z == goalPositionStart.z &&
+		    std::max(std::abs(closestNodeSoFar->thisTile->position.x - goalPositionStart.x),
+		             std::abs(closestNodeSoFar->thisTile->position.y - goalPositionStart.y)) <= 1)
+		{
+			// Nothing?
+		}
+		else if (maxCost > 0.0f)
+		{
+			LogInfo("No route from %s to %s-%s found after %d iterations, returning "
+			        "closest path %s",
+			        origin, destinationStart, destinationEnd, iterationCount,
+			        closestNodeSoFar->thisTile->position);
+		}
+		else
+		{
+			LogWarning("No route from %s to %s-%s found after %d iterations, returning "
+			           "closest path %s",
+			           origin, destinationStart, destinationEnd, iterationCount,
+			           closestNodeSoFar->thisTile->position);
+		}
+	}
+	else if (closestNodeSoFar->distanceToGoal > 0)
+	{
+		if (maxCost > 0.0f)
+		{
+			LogInfo("Could not find path within maxPath, returning closest path %s",
+			        closestNodeSoFar->thisTile->position.x);
+		}
+		else
+		{
+			LogInfo("Surprisingly, no nodes to expand! Closest path %s",
+			        closestNodeSoFar->thisTile->position);
+		}
+	}
+	// Nothing more will be expanded
+	fringe.clear();
+}
+
+std::list<Vec3<int>> PathSearch::getPath(float *cost) const
+{
+	if (!finished)
+	{
+		LogError("Path search from %s to %s-%s isn't finished", origin, destinationStart,
+		         destinationEnd);
+		return {};
+	}
+	if (failed)
+	{
+		return {};
+	}
+	std::list<Vec3<int>> path;
+	for (auto node = closestNodeSoFar; node; node = node->parentNode)
+	{
+		path.push_front(node->thisTile->position);
+	}
+	if (cost && !originInDestination)
+	{
+		*cost = closestNodeSoFar->trueCost;
+	}
+	return path;
+}
+
+PathSearchQueue::Job::Job(TileMap &map, Vec3<int> origin, Vec3<int> destination,
+                          int iterationLimit, up<CanEnterTileHelper> canEnterTile)
+    : origin(origin), arena(JOB_ARENA_BLOCK_SIZE), scope(arena),
+      canEnterTile(std::move(canEnterTile))
+{
+	search.reset(new PathSearch(arena, map, origin, destination,
+	                            destination + Vec3<int>{1, 1, 1}, iterationLimit,
+	                            *this->canEnterTile, false, false, false, 0.0f));
+}
+
+PathSearchQueue::Job::~Job() = default;
+
+void PathSearchQueue::update(unsigned int ticks)
+{
+	budget = (int)std::min<uint64_t>((uint64_t)NODES_PER_TICK * std::max(ticks, 1u), INT_MAX);
+	for (auto it = queue.begin(); it != queue.end() && budget > 0;)
+	{
+		auto job = it->lock();
+		if (job)
+		{
+			budget -= job->search->run(budget);
+		}
+		if (!job || job->isFinished())
+		{
+			it = queue.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+}
+
+void PathSearchQueue::submit(sp<Job> job)
+{
+	// Searches queued before this one go first
+	if (queue.empty() && budget > 0)
+	{
+		budget -= job->search->run(budget);
+	}
+	if (!job->isFinished())
+	{
+		queue.push_back(job);
+	}
+}
+
+} // namespace OpenApoc
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "library/arena.h"
+#include "library/sp.h"
+#include "library/vec.h"
+#include <list>
+#include <vector>
+
+namespace OpenApoc
+{
+
+class CanEnterTileHelper;
+class Tile;
+class TileMap;
+
+// A* search through a TileMap that can be stopped after any number of iterations and carried on
+// later. Nodes and the fringe live in 'arena', which must stay in the same scope for as long as
+// the search exists. See TileMap::findShortestPath() for what the parameters mean
+class PathSearch
+{
+  public:
+	PathSearch(MemoryArena &arena, TileMap &map, Vec3<int> origin, Vec3<int> destinationStart,
+	           Vec3<int> destinationEnd, int iterationLimit, const CanEnterTileHelper &canEnterTile,
+	           bool approachOnly, bool ignoreStaticUnits, bool ignoreAllUnits, float maxCost);
+
+	// Expands at most 'iterations' more nodes, returns the amount expanded
+	int run(int iterations);
+	bool isFinished() const { return finished; }
+	// The path found, or the path to the node closest to the goal. Only valid once finished
+	std::list<Vec3<int>> getPath(float *cost = nullptr) const;
+
+  private:
+	class PathNode
+	{
+	  public:
+		PathNode(float costToGetHere, float trueCost, float distanceToGoal, PathNode *parentNode,
+		         Tile *thisTile)
+		    : costToGetHere(costToGetHere), trueCost(trueCost), parentNode(parentNode),
+		      thisTile(thisTile), distanceToGoal(distanceToGoal)
+		{
+		}
+
+		float costToGetHere;
+		float trueCost;
+		PathNode *parentNode;
+		Tile *thisTile;
+		float distanceToGoal;
+	};
+
+	MemoryArena &arena;
+	TileMap &map;
+	const CanEnterTileHelper &canEnterTile;
+	Vec3<int> origin;
+	Vec3<int> destinationStart;
+	Vec3<int> destinationEnd;
+	int iterationLimit;
+	bool approachOnly;
+	bool ignoreStaticUnits;
+	bool ignoreAllUnits;
+	float maxCost;
+
+	// Faster than looking up in a set
+	ArenaVector<bool> visitedTiles;
+	ArenaList<PathNode *> fringe;
+	Vec3<float> goalPositionStart;
+	Vec3<float> goalPositionEnd;
+	bool destinationIsSingleTile;
+	int iterationCount = 0;
+	PathNode *closestNodeSoFar = nullptr;
+	bool finished = false;
+	// Set when the search ended before it began
+	bool failed = false;
+	bool originInDestination = false;
+
+	void finish();
+};
+
+// Path searches that are carried on across ticks, a few nodes at a time, so that long ones don't
+// hold up a tick. Every search gets the nodes left in the budget of the current tick right away,
+// so that short ones still finish when they are started, the rest queue up for the next ticks.
+// Whoever starts a search owns it, a search nobody holds on to any more is dropped from the queue
+class PathSearchQueue
+{
+  public:
+	// A search with everything it needs, kept alive as long as the search is
+	class Job
+	{
+	  public:
+		Job(TileMap &map, Vec3<int> origin, Vec3<int> destination, int iterationLimit,
+		    up<CanEnterTileHelper> canEnterTile);
+		~Job();
+
+		bool isFinished() const { return search->isFinished(); }
+		std::list<Vec3<int>> getPath() const { return search->getPath(); }
+		Vec3<int> getOrigin() const { return origin; }
+
+	  private:
+		friend class PathSearchQueue;
+
+		Vec3<int> origin;
+
+		// Declared in the order they must be constructed in
+		MemoryArena arena;
+		MemoryArena::Scope scope;
+		up<CanEnterTileHelper> canEnterTile;
+		up<PathSearch> search;
+	};
+
+	// How many nodes all searches may expand in a tick
+	static const int NODES_PER_TICK = 2000;
+
+	// Refills the budget for 'ticks' ticks and carries on with the queued searches. Updates
+	// covering many ticks at once (when fast-forwarding) get all of their ticks' nodes, so that
+	// searches don't fall behind the vehicles waiting for them
+	void update(unsigned int ticks);
+	// Runs the search as far as the budget left allows, and queues it if it isn't finished then
+	void submit(sp<Job> job);
+	bool empty() const { return queue.empty(); }
+
+  private:
+	std::list<wp<Job>> queue;
+	int budget = NODES_PER_TICK;
+};
+
+} // namespace OpenApoc
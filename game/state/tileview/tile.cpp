@@ -2,7 +2,7 @@
 #include "framework/image.h"
 #include "framework/trace.h"
 #include "game/state/battle/battledoor.h"
-#include "game/state/battle/battlehazard.h"
+#include "game/state/battle/battlehazardfield.h"
 #include "game/state/battle/battleitem.h"
 #include "game/state/battle/battlemappart.h"
 #include "game/state/battle/battleunit.h"
@@ -29,10 +29,51 @@
 namespace OpenApoc
 {
 
+namespace
+{
+bool compareObjectIndex(const TileObject *object, uint64_t index)
+{
+	return object->getObjectIndex() < index;
+}
+} // anonymous namespace
+
+bool TileObjectList::insert(TileObject *object)
+{
+	auto it = std::lower_bound(objects.begin(), objects.end(), object->getObjectIndex(),
+	                           compareObjectIndex);
+	if (it != objects.end() && *it == object)
+	{
+		return false;
+	}
+	objects.insert(it, object);
+	return true;
+}
+
+bool TileObjectList::erase(TileObject *object)
+{
+	auto it = std::lower_bound(objects.begin(), objects.end(), object->getObjectIndex(),
+	                           compareObjectIndex);
+	if (it == objects.end() || *it != object)
+	{
+		return false;
+	}
+	objects.erase(it);
+	return true;
+}
+
+bool TileObjectList::contains(const TileObject *object) const
+{
+	auto it = std::lower_bound(objects.begin(), objects.end(), object->getObjectIndex(),
+	                           compareObjectIndex);
+	return it != objects.end() && *it == object;
+}
+
 TileMap::TileMap(Vec3<int> size, Vec3<float> velocityScale, Vec3<int> voxelMapSize,
                  std::vector<std::set<TileObject::Type>> layerMap)
-    : layerMap(layerMap), size(size), voxelMapSize(voxelMapSize), velocityScale(velocityScale)
+    : layerMap(layerMap), drawChunksPerRow((size.x + DRAW_CHUNK_SIZE - 1) / DRAW_CHUNK_SIZE),
+      size(size), voxelMapSize(voxelMapSize), velocityScale(velocityScale)
 {
+	drawChunkRevisions.resize(drawChunksPerRow * size.y * size.z, 0);
 	tiles.reserve(size.x * size.y * size.z);
 	for (int z = 0; z < size.z; z++)
 	{
@@ -314,10 +355,11 @@ void Tile::updateBattlescapeUnitPresent()
 	{
 		if (o->getType() == TileObject::Type::Unit)
 		{
-			auto u = std::static_pointer_cast<TileObjectBattleUnit>(o);
+			auto u = static_cast<TileObjectBattleUnit *>(o);
 			if (!firstUnitPresent)
 			{
-				firstUnitPresent = u;
+				firstUnitPresent =
+				    std::static_pointer_cast<TileObjectBattleUnit>(u->shared_from_this());
 			}
 			auto pos = o->getPosition();
 			auto x = pos.x - position.x;
@@ -362,7 +404,7 @@ void Tile::updateBattlescapeParameters()
 	{
 		if (o->getType() == TileObject::Type::Ground || o->getType() == TileObject::Type::Feature)
 		{
-			auto mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+			auto mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 			if (!mp->isAlive())
 			{
 				continue;
@@ -390,7 +432,7 @@ void Tile::updateBattlescapeParameters()
 		}
 		if (o->getType() == TileObject::Type::LeftWall)
 		{
-			auto mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+			auto mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 			if (!mp->isAlive())
 			{
 				continue;
@@ -400,7 +442,7 @@ void Tile::updateBattlescapeParameters()
 		}
 		if (o->getType() == TileObject::Type::RightWall)
 		{
-			auto mp = std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+			auto mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 			if (!mp->isAlive())
 			{
 				continue;
@@ -500,9 +542,9 @@ sp<TileObjectBattleUnit> Tile::getUnitIfPresent(bool onlyConscious, bool mustOcc
 	{
 		if (o->getType() == TileObject::Type::Unit)
 		{
-			auto unitTileObject = std::static_pointer_cast<TileObjectBattleUnit>(o);
+			auto unitTileObject = static_cast<TileObjectBattleUnit *>(o);
 			auto unit = unitTileObject->getUnit();
-			if ((onlyConscious && !unit->isConscious()) || (exceptThis == unitTileObject) ||
+			if ((onlyConscious && !unit->isConscious()) || (exceptThis.get() == unitTileObject) ||
 			    (mustOccupy &&
 			     unitTileObject->occupiedTiles.find(position) ==
 			         unitTileObject->occupiedTiles.end()) ||
@@ -510,7 +552,7 @@ sp<TileObjectBattleUnit> Tile::getUnitIfPresent(bool onlyConscious, bool mustOcc
 			{
 				continue;
 			}
-			return unitTileObject;
+			return std::static_pointer_cast<TileObjectBattleUnit>(o->shared_from_this());
 		}
 	}
 	return nullptr;
@@ -553,9 +595,9 @@ std::list<sp<BattleUnit>> Tile::getUnits(bool onlyConscious, bool mustOccupy, bo
 	{
 		if (o->getType() == TileObject::Type::Unit)
 		{
-			auto unitTileObject = std::static_pointer_cast<TileObjectBattleUnit>(o);
+			auto unitTileObject = static_cast<TileObjectBattleUnit *>(o);
 			auto unit = unitTileObject->getUnit();
-			if ((onlyConscious && !unit->isConscious()) || (exceptThis == unitTileObject) ||
+			if ((onlyConscious && !unit->isConscious()) || (exceptThis.get() == unitTileObject) ||
 			    (mustOccupy &&
 			     unitTileObject->occupiedTiles.find(position) ==
 			         unitTileObject->occupiedTiles.end()) ||
@@ -576,7 +618,7 @@ std::list<sp<BattleItem>> Tile::getItems()
 	{
 		if (o->getType() == TileObject::Type::Item)
 		{
-			auto item = std::static_pointer_cast<TileObjectBattleItem>(o)->getItem();
+			auto item = static_cast<TileObjectBattleItem *>(o)->getItem();
 			if (!item->falling)
 			{
 				result.push_back(item);
@@ -599,7 +641,7 @@ std::list<sp<BattleItem>> Tile::getItems()
 			{
 				if (o->getType() == TileObject::Type::Item)
 				{
-					auto item = std::static_pointer_cast<TileObjectBattleItem>(o)->getItem();
+					auto item = static_cast<TileObjectBattleItem *>(o)->getItem();
 					if (!item->falling)
 					{
 						result.push_back(item);
@@ -729,17 +771,17 @@ void TileMap::addObjectToMap(sp<BattleUnit> unit)
 	unit->shadowObject = shadow;
 }
 
-void TileMap::addObjectToMap(sp<BattleHazard> hazard)
+void TileMap::addObjectToMap(BattleHazardField &hazards, int index)
 {
-	if (hazard->tileObject)
+	if (hazards.tileObjects[index])
 	{
 		LogError("Hazard already has tile object");
 	}
 	// FIXME: mksp<> doesn't work for private (but accessible due to friend)
 	// constructors?
-	sp<TileObjectBattleHazard> obj(new TileObjectBattleHazard(*this, hazard));
-	obj->setPosition(hazard->getPosition());
-	hazard->tileObject = obj;
+	sp<TileObjectBattleHazard> obj(new TileObjectBattleHazard(*this, hazards, index));
+	obj->setPosition(hazards.getPosition(index));
+	hazards.tileObjects[index] = obj;
 }
 
 unsigned int TileMap::getLayer(TileObject::Type type) const
@@ -765,6 +807,13 @@ bool TileMap::tileIsValid(Vec3<int> tile) const
 	return true;
 }
 
+void TileMap::invalidateDrawnObjects(Vec3<int> tilePosition)
+{
+	getTile(tilePosition)->drawnObjectsRevision++;
+	drawChunkRevisions[(tilePosition.z * size.y + tilePosition.y) * drawChunksPerRow +
+	                   tilePosition.x / DRAW_CHUNK_SIZE]++;
+}
+
 sp<Image> TileMap::dumpVoxelView(const Rect<int> viewRect, const TileTransform &transform,
                                  float maxZ, bool fast, bool los) const
 {
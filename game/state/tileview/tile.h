@@ -25,6 +25,9 @@ static const Colour COLOUR_BLACK = {0, 0, 0, 255};
 // FIXME: Alexey Andronov: Does anyone know why we divide by 4 here?
 static const unsigned TICK_SCALE = TICKS_PER_SECOND / 4;
 
+// Width (in tiles along x) of the strips that tile views cache their draw lists in
+static const int DRAW_CHUNK_SIZE = 16;
+
 class Image;
 class TileMap;
 class Tile;
@@ -46,7 +49,7 @@ class BattleUnit;
 class TileObjectBattleUnit;
 class BattleItem;
 class TileObjectBattleItem;
-class BattleHazard;
+class BattleHazardField;
 class TileObjectBattleHazard;
 class Sample;
 
@@ -71,19 +74,44 @@ enum class MapDirection
 	West = 4
 };
 
+// Objects present on a tile. Only keeps raw pointers, the objects are kept alive by the drawn
+// object lists and their owners. Ordered by object index, so that iteration order does not depend
+// on where the objects were allocated, and no allocations happen once the list has grown
+class TileObjectList
+{
+  private:
+	std::vector<TileObject *> objects;
+
+  public:
+	using const_iterator = std::vector<TileObject *>::const_iterator;
+
+	// Returns false if the object was already in the list
+	bool insert(TileObject *object);
+	// Returns false if the object was not in the list
+	bool erase(TileObject *object);
+	bool contains(const TileObject *object) const;
+
+	const_iterator begin() const { return objects.begin(); }
+	const_iterator end() const { return objects.end(); }
+	bool empty() const { return objects.empty(); }
+	size_t size() const { return objects.size(); }
+};
+
 class Tile
 {
   public:
 	TileMap &map;
 	Vec3<int> position;
 
-	std::set<sp<TileObject>> ownedObjects;
-	std::set<sp<TileObject>> intersectingObjects;
+	TileObjectList ownedObjects;
+	TileObjectList intersectingObjects;
 
 	// FIXME: This is effectively a z-sorted list of ownedObjects - can this be merged somehow?
 	// Alexey Andronov (Istrebitel): This is no longer so, because
 	// units are drawn on a tile different to their owner tile.
 	std::vector<std::vector<sp<TileObject>>> drawnObjects;
+	// Bumped whenever drawnObjects change, or an object in them changes how it looks
+	unsigned int drawnObjectsRevision = 0;
 
 	Tile(TileMap &map, Vec3<int> position, int layerCount);
 
@@ -208,6 +236,10 @@ class TileMap
   private:
 	std::vector<Tile> tiles;
 	std::vector<std::set<TileObject::Type>> layerMap;
+	// Revision of every DRAW_CHUNK_SIZE-wide strip of tiles, bumped when drawnObjects change
+	std::vector<unsigned int> drawChunkRevisions;
+	int drawChunksPerRow;
+	uint64_t nextObjectIndex = 0;
 
   public:
 	const Tile *getTile(int x, int y, int z) const
@@ -251,6 +283,9 @@ class TileMap
 	        std::vector<std::set<TileObject::Type>> layerMap);
 	~TileMap();
 
+	// Returns a new index for an object created on this map, see TileObjectList
+	uint64_t getNextObjectIndex() { return nextObjectIndex++; }
+
 	std::list<Vec3<int>> findShortestPath(Vec3<int> origin, Vec3<int> destinationStart,
 	                                      Vec3<int> destinationEnd, int iterationLimit,
 	                                      const CanEnterTileHelper &canEnterTile,
@@ -270,8 +305,16 @@ class TileMap
 		                        ignoreAllUnits, cost, maxCost);
 	}
 
+	// Costs of the ways from 'origin' to every tile that can be reached for less than 'maxCost',
+	// with the same moves findShortestPath() makes, found with one search instead of one per tile.
+	// The search gives up after expanding 'iterationLimit' tiles, the cheapest to reach first
+	std::map<Vec3<int>, float> findCostsAround(Vec3<int> origin, float maxCost, int iterationLimit,
+	                                           const CanEnterTileHelper &canEnterTile,
+	                                           bool ignoreStaticUnits = false,
+	                                           bool ignoreAllUnits = false);
+
 	Collision findCollision(Vec3<float> lineSegmentStart, Vec3<float> lineSegmentEnd,
-	                        const std::set<TileObject::Type> validTypes = {},
+	                        const std::set<TileObject::Type> &validTypes = {},
 	                        sp<TileObject> ignoredObject = nullptr, bool useLOS = false,
 	                        bool check_full_path = false, unsigned maxRange = 0,
 	                        bool recordPassedTiles = false) const;
@@ -286,12 +329,21 @@ class TileMap
 	void addObjectToMap(sp<BattleMapPart>);
 	void addObjectToMap(sp<BattleItem>);
 	void addObjectToMap(sp<BattleUnit>);
-	void addObjectToMap(sp<BattleHazard>);
+	void addObjectToMap(BattleHazardField &hazards, int index);
 
 	unsigned int getLayer(TileObject::Type type) const;
 	unsigned int getLayerCount() const;
 	bool tileIsValid(Vec3<int> tile) const;
 
+	// Called whenever an object is added to or removed from a tile's drawnObjects (or changes how
+	// it looks), so that views can tell which of their cached draw lists went stale
+	void invalidateDrawnObjects(Vec3<int> tilePosition);
+	unsigned int getDrawChunkRevision(int chunkX, int y, int z) const
+	{
+		return drawChunkRevisions[(z * size.y + y) * drawChunksPerRow + chunkX];
+	}
+	int getDrawChunksPerRow() const { return drawChunksPerRow; }
+
 	sp<Image> dumpVoxelView(const Rect<int> viewRect, const TileTransform &transform, float maxZ,
 	                        bool fast = false, bool los = false) const;
 
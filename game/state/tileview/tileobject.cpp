@@ -10,12 +10,17 @@ namespace OpenApoc
 {
 
 TileObject::TileObject(TileMap &map, Type type, Vec3<float> bounds)
-    : map(map), type(type), owningTile(nullptr), name("UNKNOWN_OBJECT")
+    : map(map), type(type), objectIndex(map.getNextObjectIndex()), owningTile(nullptr),
+      name("UNKNOWN_OBJECT")
 {
 	setBounds(bounds);
 }
 
-TileObject::~TileObject() = default;
+TileObject::~TileObject()
+{
+	// Tiles don't keep objects alive, so make sure they can't be left with a dangling pointer
+	removeFromTiles();
+}
 
 void TileObject::setBounds(Vec3<float> bounds)
 {
@@ -41,21 +46,39 @@ void TileObject::removeFromMap()
 	/* owner may be NULL as this can be used to set the initial position after creation */
 	if (this->owningTile)
 	{
-		auto erased = this->owningTile->ownedObjects.erase(thisPtr);
-		if (erased != 1)
+		int layer = map.getLayer(this->type);
+		auto &drawnObjects = this->drawOnTile->drawnObjects[layer];
+		auto it = std::find(drawnObjects.begin(), drawnObjects.end(), thisPtr);
+		if (it != drawnObjects.end())
+		{
+			drawnObjects.erase(it);
+		}
+		map.invalidateDrawnObjects(this->drawOnTile->position);
+	}
+	removeFromTiles();
+}
+
+void TileObject::invalidateDrawing()
+{
+	if (this->owningTile)
+	{
+		map.invalidateDrawnObjects(this->drawOnTile->position);
+	}
+}
+
+void TileObject::removeFromTiles()
+{
+	if (this->owningTile)
+	{
+		if (!this->owningTile->ownedObjects.erase(this))
 		{
 			LogError("Nothing erased?");
 		}
-		int layer = map.getLayer(this->type);
-		this->drawOnTile->drawnObjects[layer].erase(
-		    std::remove(this->drawOnTile->drawnObjects[layer].begin(),
-		                this->drawOnTile->drawnObjects[layer].end(), thisPtr),
-		    this->drawOnTile->drawnObjects[layer].end());
 		this->owningTile = nullptr;
 	}
 	for (auto *tile : this->intersectingTiles)
 	{
-		tile->intersectingObjects.erase(thisPtr);
+		tile->intersectingObjects.erase(this);
 	}
 	this->intersectingTiles.clear();
 }
@@ -114,8 +137,7 @@ void TileObject::setPosition(Vec3<float> newPosition)
 		return;
 	}
 
-	auto inserted = this->owningTile->ownedObjects.insert(thisPtr);
-	if (!inserted.second)
+	if (!this->owningTile->ownedObjects.insert(this))
 	{
 		LogError("Object already in owned object list?");
 	}
@@ -147,14 +169,14 @@ void TileObject::setPosition(Vec3<float> newPosition)
 					continue;
 				}
 				this->intersectingTiles.push_back(intersectingTile);
-				intersectingTile->intersectingObjects.insert(thisPtr);
+				intersectingTile->intersectingObjects.insert(this);
 			}
 		}
 	}
 	// Quick sanity check
 	for (auto &t : this->intersectingTiles)
 	{
-		if (t->intersectingObjects.find(shared_from_this()) == t->intersectingObjects.end())
+		if (!t->intersectingObjects.contains(this))
 		{
 			LogError("Intersecting objects inconsistent");
 		}
@@ -167,9 +189,13 @@ void TileObject::addToDrawnTiles(Tile *tile)
 {
 	this->drawOnTile = tile;
 	int layer = map.getLayer(this->type);
-	this->drawOnTile->drawnObjects[layer].push_back(shared_from_this());
-	std::sort(this->drawOnTile->drawnObjects[layer].begin(),
-	          this->drawOnTile->drawnObjects[layer].end(), TileObjectZComparer{});
+	// The list is kept sorted, so there's no need to re-sort it on every move
+	auto &drawnObjects = this->drawOnTile->drawnObjects[layer];
+	auto thisPtr = shared_from_this();
+	drawnObjects.insert(
+	    std::upper_bound(drawnObjects.begin(), drawnObjects.end(), thisPtr, TileObjectZComparer{}),
+	    thisPtr);
+	map.invalidateDrawnObjects(this->drawOnTile->position);
 }
 
 } // namespace OpenApoc
@@ -3,6 +3,7 @@
 #include "library/sp.h"
 #include "library/strings.h"
 #include "library/vec.h"
+#include <cstdint>
 #include <vector>
 
 namespace OpenApoc
@@ -43,6 +44,17 @@ class TileObject : public std::enable_shared_from_this<TileObject>
 	virtual void draw(Renderer &r, TileTransform &transform, Vec2<float> screenPosition,
 	                  TileViewMode mode, bool visible = true, int currentLevel = 0,
 	                  bool friendly = false, bool hostile = false) = 0;
+	// Sprites draw() draws in 'mode' and their offset from the object's screen position, if they
+	// only change when the object is moved or invalidateDrawing() is called, so that views can
+	// draw them without asking the object every frame. Returns false if draw() has to be called
+	virtual bool getStaticSprites(TileViewMode /*mode*/, sp<Image> & /*sprite*/,
+	                              sp<Image> & /*overlaySprite*/, Vec2<float> & /*offset*/) const
+	{
+		return false;
+	}
+	// Objects that move every tick even though their type is static (e.g. falling map parts)
+	// are drawn where they are at render time, like units, rather than from a cached position
+	virtual bool isMoving() const { return false; }
 	const Type &getType() const { return this->type; }
 	virtual Vec3<float> getPosition() const = 0;
 	// Vector from object position to object center
@@ -64,7 +76,11 @@ class TileObject : public std::enable_shared_from_this<TileObject>
 	virtual void setPosition(Vec3<float> newPosition);
 	virtual void removeFromMap();
 	virtual void addToDrawnTiles(Tile *tile);
+	// Has views draw the object again, for when its sprites changed without it moving
+	void invalidateDrawing();
 
+	// Index of the object in order of creation on the map, used to order objects within tiles
+	uint64_t getObjectIndex() const { return this->objectIndex; }
 	Tile *getOwningTile() const { return this->owningTile; }
 	std::vector<Tile *> getIntersectingTiles() const { return this->intersectingTiles; }
 
@@ -92,6 +108,7 @@ class TileObject : public std::enable_shared_from_this<TileObject>
 	friend class TileMap;
 
 	Type type;
+	uint64_t objectIndex;
 
 	Tile *owningTile;
 	Tile *drawOnTile;
@@ -110,6 +127,8 @@ class TileObject : public std::enable_shared_from_this<TileObject>
 	UString name;
 
   private:
+	// Removes raw pointers to this object from the tiles it is listed in
+	void removeFromTiles();
 };
 
 } // namespace OpenApoc
@@ -1,6 +1,6 @@
 #include "game/state/tileview/tileobject_battlehazard.h"
 #include "framework/renderer.h"
-#include "game/state/battle/battlehazard.h"
+#include "game/state/battle/battlehazardfield.h"
 #include "game/state/rules/damage.h"
 #include "game/state/rules/doodad_type.h"
 #include "game/state/tileview/tile.h"
@@ -19,9 +19,7 @@ void TileObjectBattleHazard::draw(Renderer &r, TileTransform &, Vec2<float> scre
 	// Mode isn't used as TileView::tileToScreenCoords already transforms according to the mode
 	std::ignore = mode;
 
-	auto h = hazard.lock();
-
-	if (h->ticksUntilVisible > 0)
+	if (!field.isVisible(index))
 	{
 		return;
 	}
@@ -31,8 +29,9 @@ void TileObjectBattleHazard::draw(Renderer &r, TileTransform &, Vec2<float> scre
 	switch (mode)
 	{
 		case TileViewMode::Isometric:
-			sprite = h->hazardType->getFrame(h->age, h->frame);
-			transformedScreenPos -= h->hazardType->doodadType->imageOffset;
+			sprite = field.getHazardType(index)->getFrame(field.getAge(index),
+			                                              field.getFrame(index));
+			transformedScreenPos -= field.getHazardType(index)->doodadType->imageOffset;
 			break;
 		case TileViewMode::Strategy:
 		{
@@ -48,32 +47,13 @@ void TileObjectBattleHazard::draw(Renderer &r, TileTransform &, Vec2<float> scre
 
 TileObjectBattleHazard::~TileObjectBattleHazard() = default;
 
-TileObjectBattleHazard::TileObjectBattleHazard(TileMap &map, sp<BattleHazard> hazard)
-    : TileObject(map, Type::Hazard, Vec3<float>{0.0f, 0.0f, 0.0f}), hazard(hazard)
+TileObjectBattleHazard::TileObjectBattleHazard(TileMap &map, BattleHazardField &field,
+                                               int index)
+    : TileObject(map, Type::Hazard, Vec3<float>{0.0f, 0.0f, 0.0f}), field(field), index(index)
 {
 }
 
-sp<BattleHazard> TileObjectBattleHazard::getHazard()
-{
-	auto i = hazard.lock();
-	if (!i)
-	{
-		LogError("Item disappeared");
-		return nullptr;
-	}
-	return i;
-}
-
-Vec3<float> TileObjectBattleHazard::getPosition() const
-{
-	auto p = this->hazard.lock();
-	if (!p)
-	{
-		LogError("Called with no owning hazard object");
-		return {0, 0, 0};
-	}
-	return p->getPosition();
-}
+Vec3<float> TileObjectBattleHazard::getPosition() const { return field.getPosition(index); }
 
 float TileObjectBattleHazard::getZOrder() const { return getPosition().z - 7.0f; }
 
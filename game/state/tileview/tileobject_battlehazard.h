@@ -7,22 +7,26 @@
 namespace OpenApoc
 {
 
-class BattleHazard;
+class BattleHazardField;
 
+// Draws the hazard on a tile, the hazard itself lives in the battle's hazard field
 class TileObjectBattleHazard : public TileObject
 {
   public:
 	void draw(Renderer &r, TileTransform &transform, Vec2<float> screenPosition, TileViewMode mode,
 	          bool visible, int, bool, bool) override;
 	~TileObjectBattleHazard() override;
-	sp<BattleHazard> getHazard();
+	BattleHazardField &getField() const { return field; }
+	// Index of the hazard in the field
+	int getIndex() const { return index; }
 	Vec3<float> getPosition() const override;
 	float getZOrder() const override;
 
   private:
 	friend class TileMap;
-	wp<BattleHazard> hazard;
-	TileObjectBattleHazard(TileMap &map, sp<BattleHazard> hazard);
+	BattleHazardField &field;
+	int index;
+	TileObjectBattleHazard(TileMap &map, BattleHazardField &field, int index);
 };
 
 } // namespace OpenApoc
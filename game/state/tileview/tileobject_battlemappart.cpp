@@ -46,6 +46,32 @@ void TileObjectBattleMapPart::draw(Renderer &r, TileTransform &transform,
 		drawTinted(r, sprite, transformedScreenPos, visible);
 }
 
+bool TileObjectBattleMapPart::getStaticSprites(TileViewMode mode, sp<Image> &sprite,
+                                               sp<Image> &overlaySprite,
+                                               Vec2<float> &offset) const
+{
+	auto &type = map_part->type;
+	overlaySprite = nullptr;
+	switch (mode)
+	{
+		case TileViewMode::Isometric:
+			// Doors and animated parts change frames without being moved
+			if (map_part->getAnimationFrame() != -1)
+			{
+				return false;
+			}
+			sprite = type->sprite;
+			offset = -type->imageOffset;
+			return true;
+		case TileViewMode::Strategy:
+			sprite = type->strategySprite;
+			offset = {-4, -4};
+			return true;
+		default:
+			return false;
+	}
+}
+
 TileObject::Type TileObjectBattleMapPart::convertType(BattleMapPartType::Type type)
 {
 	switch (type)
@@ -86,6 +112,8 @@ void TileObjectBattleMapPart::removeFromMap()
 		prevDrawOnTile->updateBattlescapeUIDrawOrder();
 	}
 }
+bool TileObjectBattleMapPart::isMoving() const { return map_part->falling; }
+
 TileObjectBattleMapPart::~TileObjectBattleMapPart() { map_part = nullptr; }
 
 TileObjectBattleMapPart::TileObjectBattleMapPart(TileMap &map, sp<BattleMapPart> map_part)
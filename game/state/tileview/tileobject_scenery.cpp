@@ -46,6 +46,38 @@ void TileObjectScenery::draw(Renderer &r, TileTransform &transform, Vec2<float>
 		r.draw(overlaySprite, transformedScreenPos);
 }
 
+bool TileObjectScenery::getStaticSprites(TileViewMode mode, sp<Image> &sprite,
+                                         sp<Image> &overlaySprite, Vec2<float> &offset) const
+{
+	auto scenery = this->scenery.lock();
+	if (!scenery)
+	{
+		return false;
+	}
+	auto &type = scenery->type;
+	switch (mode)
+	{
+		case TileViewMode::Isometric:
+			sprite = type->sprite;
+			overlaySprite = type->overlaySprite;
+			offset = -type->imageOffset;
+			return true;
+		case TileViewMode::Strategy:
+			sprite = type->strategySprite;
+			overlaySprite = nullptr;
+			offset = {-4, -4};
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool TileObjectScenery::isMoving() const
+{
+	auto s = this->scenery.lock();
+	return s && s->falling;
+}
+
 TileObjectScenery::~TileObjectScenery() = default;
 
 TileObjectScenery::TileObjectScenery(TileMap &map, sp<Scenery> scenery)
@@ -14,6 +14,9 @@ class TileObjectScenery : public TileObject
   public:
 	void draw(Renderer &r, TileTransform &transform, Vec2<float> screenPosition, TileViewMode mode,
 	          bool visible, int, bool, bool) override;
+	bool getStaticSprites(TileViewMode mode, sp<Image> &sprite, sp<Image> &overlaySprite,
+	                      Vec2<float> &offset) const override;
+	bool isMoving() const override;
 	~TileObjectScenery() override;
 
 	wp<Scenery> scenery;
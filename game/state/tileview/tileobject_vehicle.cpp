@@ -1,6 +1,8 @@
 #include "game/state/tileview/tileobject_vehicle.h"
 #include "framework/renderer.h"
+#include "game/state/city/city.h"
 #include "game/state/city/vehicle.h"
+#include "game/state/city/vehiclegrid.h"
 #include "game/state/city/vehiclemission.h"
 #include "game/state/rules/vehicle_type.h"
 #include "game/state/tileview/tile.h"
@@ -108,7 +110,13 @@ void TileObjectVehicle::draw(Renderer &r, TileTransform &transform, Vec2<float>
 	}
 }
 
-TileObjectVehicle::~TileObjectVehicle() = default;
+TileObjectVehicle::~TileObjectVehicle()
+{
+	if (grid)
+	{
+		grid->remove(*this);
+	}
+}
 
 TileObjectVehicle::TileObjectVehicle(TileMap &map, sp<Vehicle> vehicle)
     : TileObject(map, Type::Vehicle, {0.0f, 0.0f, 0.0f}), vehicle(vehicle), animationDelay(0)
@@ -210,6 +218,21 @@ void TileObjectVehicle::setPosition(Vec3<float> newPosition)
 	setBounds({size.x, size.y, size.z});
 
 	TileObject::setPosition(newPosition);
+
+	auto v = getVehicle();
+	if (v && v->city && v->city->vehicleGrid)
+	{
+		v->city->vehicleGrid->update(*this, newPosition);
+	}
+}
+
+void TileObjectVehicle::removeFromMap()
+{
+	if (grid)
+	{
+		grid->remove(*this);
+	}
+	TileObject::removeFromMap();
 }
 
 void TileObjectVehicle::addToDrawnTiles(Tile *tile)
@@ -9,6 +9,7 @@ namespace OpenApoc
 {
 
 class Vehicle;
+class VehicleGrid;
 class Image;
 
 class TileObjectVehicle : public TileObject
@@ -27,14 +28,19 @@ class TileObjectVehicle : public TileObject
 	sp<VoxelMap> getVoxelMap(Vec3<int> mapIndex, bool los) const override;
 	Vec3<float> getPosition() const override;
 	void setPosition(Vec3<float> newPosition) override;
+	void removeFromMap() override;
 	void nextFrame(int ticks);
 	void addToDrawnTiles(Tile *tile) override;
 
   private:
 	friend class TileMap;
+	friend class VehicleGrid;
 	wp<Vehicle> vehicle;
 	std::list<sp<Image>>::iterator animationFrame;
 	int animationDelay;
+	// Grid of the city the vehicle is in and its cell there, maintained by the grid itself
+	VehicleGrid *grid = nullptr;
+	int gridCell = -1;
 
 	TileObjectVehicle(TileMap &map, sp<Vehicle> vehicle);
 };
@@ -21,7 +21,7 @@
 #include "game/state/aequipment.h"
 #include "game/state/battle/ai/aitype.h"
 #include "game/state/battle/battle.h"
-#include "game/state/battle/battlehazard.h"
+#include "game/state/battle/battlehazardfield.h"
 #include "game/state/battle/battleitem.h"
 #include "game/state/battle/battlemappart.h"
 #include "game/state/battle/battlemappart_type.h"
@@ -30,6 +30,7 @@
 #include "game/state/gameevent.h"
 #include "game/state/gamestate.h"
 #include "game/state/message.h"
+#include "game/state/simulationrunner.h"
 #include "game/state/rules/aequipment_type.h"
 #include "game/state/rules/damage.h"
 #include "game/state/tileview/collision.h"
@@ -79,7 +80,9 @@ BattleView::BattleView(sp<GameState> gameState)
                      gameState->current_battle->battleViewScreenCenter, *gameState),
       baseForm(ui().getForm("battle/battle")), state(gameState), battle(*state->current_battle),
       followAgent(false), palette(fw().data->loadPalette("xcom3/tacdata/tactical.pal")),
-      selectionState(BattleSelectionState::Normal)
+      selectionState(BattleSelectionState::Normal),
+      simulation(mkup<SimulationRunner>([this](unsigned int ticks) { updateSimulation(ticks); })),
+      snapshotHidden(false)
 {
 	pal = palette;
 
@@ -1276,6 +1279,9 @@ BattleView::~BattleView() = default;
 
 void BattleView::begin()
 {
+	state->events.subscribeAll(this, [this](GameEvent &event) { handleGameEvent(event); });
+	recordSnapshot();
+	simulation->start();
 	uiTabsRT[0]->findControl("BUTTON_LAYER_1")->setVisible(maxZDraw >= 1);
 	uiTabsRT[0]->findControl("BUTTON_LAYER_2")->setVisible(maxZDraw >= 2);
 	uiTabsRT[0]->findControl("BUTTON_LAYER_3")->setVisible(maxZDraw >= 3);
@@ -1310,8 +1316,20 @@ void BattleView::begin()
 	}
 }
 
+void BattleView::pause()
+{
+	// Whatever stage comes next is free to use the game state
+	simulation->stop();
+	pendingEvents.clear();
+	state->events.unsubscribe(this);
+	BattleTileView::pause();
+}
+
 void BattleView::resume()
 {
+	state->events.subscribeAll(this, [this](GameEvent &event) { handleGameEvent(event); });
+	recordSnapshot();
+	simulation->start();
 	modifierLAlt = false;
 	modifierLCtrl = false;
 	modifierLShift = false;
@@ -1324,11 +1342,20 @@ void BattleView::render()
 {
 	TRACE_FN;
 
-	BattleTileView::render();
-	if (hideDisplay)
+	// Drawn from the snapshot, so that a frame never waits for a tick to finish
+	Renderer &r = *fw().renderer;
+	if (snapshotHidden)
 	{
+		r.clear();
+		r.setPalette(this->pal);
+		hiddenForm->render();
 		return;
 	}
+	auto map = snapshot.get();
+	if (map)
+	{
+		map->submit(r);
+	}
 
 	activeTab->render();
 	baseForm->render();
@@ -1348,7 +1375,7 @@ void BattleView::render()
 		}
 	}
 	// Pause icon
-	if (battle.mode == Battle::Mode::TurnBased)
+	if (turnBased)
 	{
 		int PAUSE_ICON_BLINK_TIME = 30;
 		pauseIconTimer++;
@@ -1390,8 +1417,84 @@ void BattleView::setUpdateSpeed(BattleUpdateSpeed updateSpeed)
 	}
 }
 
+void BattleView::updateSimulation(unsigned int ticks)
+{
+	while (ticks > 0)
+	{
+		state->update();
+		ticks--;
+		if (hideDisplay)
+		{
+			if (battle.ticksWithoutSeenAction[battle.currentPlayer] == 0)
+			{
+				if (battle.lastSeenActionLocation[battle.currentPlayer] !=
+				    EventMessage::NO_LOCATION)
+				{
+					state->events.raise<GameLocationEvent>(
+					    GameEventType::ZoomView, battle.lastSeenActionLocation[battle.currentPlayer]);
+				}
+				hideDisplay = false;
+				break;
+			}
+			else if (battle.currentPlayer == battle.currentActiveOrganisation)
+			{
+				if (!lastSelectedUnits.empty())
+				{
+					state->events.raise<GameLocationEvent>(GameEventType::ZoomView,
+					                                       lastSelectedUnits.front()->position);
+				}
+				hideDisplay = false;
+				break;
+			}
+		}
+	}
+	recordSnapshot();
+}
+
+void BattleView::recordSnapshot()
+{
+	snapshotHidden = hideDisplay;
+	if (hideDisplay)
+	{
+		return;
+	}
+	auto frame = snapshot.beginFrame();
+	renderMap(*frame);
+	snapshot.publish(frame);
+}
+
+void BattleView::handlePendingEvents()
+{
+	while (!pendingEvents.empty())
+	{
+		auto e = std::move(pendingEvents.front());
+		pendingEvents.pop_front();
+		handleEvent(e.get());
+	}
+}
+
 void BattleView::update()
 {
+	auto lock = simulation->tryLock();
+	if (!lock.owns_lock())
+	{
+		// Keeps drawing the last snapshot until the simulation lets go of the state
+		return;
+	}
+	handlePendingEvents();
+	updateView();
+	turnBased = battle.mode == Battle::Mode::TurnBased;
+	advanceAnimations();
+	// Otherwise the next tick picks up whatever changed, camera included
+	if (simulation->isPaused())
+	{
+		recordSnapshot();
+	}
+}
+
+void BattleView::updateView()
+{
+	state->events.drain();
 	bool realTime = battle.mode == Battle::Mode::RealTime;
 
 	// Parent update
@@ -1426,6 +1529,7 @@ void BattleView::update()
 					             state->current_battle->currentActiveOrganisation;
 					     })});
 				updateHiddenForm();
+				simulation->setTicksPerSecond(0);
 				return;
 			}
 		}
@@ -1504,36 +1608,7 @@ void BattleView::update()
 	{
 		ticks = 16;
 	}
-	while (ticks > 0)
-	{
-		state->update();
-		ticks--;
-		if (hideDisplay)
-		{
-			if (battle.ticksWithoutSeenAction[battle.currentPlayer] == 0)
-			{
-				if (battle.lastSeenActionLocation[battle.currentPlayer] !=
-				    EventMessage::NO_LOCATION)
-				{
-					fw().pushEvent(
-					    new GameLocationEvent(GameEventType::ZoomView,
-					                          battle.lastSeenActionLocation[battle.currentPlayer]));
-				}
-				hideDisplay = false;
-				break;
-			}
-			else if (battle.currentPlayer == battle.currentActiveOrganisation)
-			{
-				if (!lastSelectedUnits.empty())
-				{
-					fw().pushEvent(new GameLocationEvent(GameEventType::ZoomView,
-					                                     lastSelectedUnits.front()->position));
-				}
-				hideDisplay = false;
-				break;
-			}
-		}
-	}
+	simulation->setTicksPerSecond(ticks * SimulationRunner::BASE_TICKS_PER_SECOND);
 
 	updateSelectedUnits();
 	updateSelectionMode();
@@ -2840,6 +2915,19 @@ void BattleView::orderHeal(BodyPart part)
 }
 
 void BattleView::eventOccurred(Event *e)
+{
+	auto lock = simulation->tryLock();
+	if (!lock.owns_lock())
+	{
+		// Handled at the next tick boundary, once the simulation lets go of the state
+		pendingEvents.push_back(e->clone());
+		return;
+	}
+	handlePendingEvents();
+	handleEvent(e);
+}
+
+void BattleView::handleEvent(Event *e)
 {
 	activeTab->eventOccured(e);
 	baseForm->eventOccured(e);
@@ -2903,12 +2991,11 @@ void BattleView::eventOccurred(Event *e)
 						    o->getType() == TileObject::Type::LeftWall ||
 						    o->getType() == TileObject::Type::RightWall)
 						{
-							auto mp =
-							    std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+							auto mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 							auto set = mksp<std::set<BattleMapPart *>>();
 							set->insert(mp.get());
-							mp->queueCollapse();
-							BattleMapPart::attemptReLinkSupports(set);
+							mp->queueCollapse(*state);
+							BattleMapPart::attemptReLinkSupports(*state, set);
 						}
 					}
 					return;
@@ -3359,46 +3446,40 @@ void BattleView::eventOccurred(Event *e)
 		handleMouseDown(e);
 		return;
 	}
-	if (e->type() == EVENT_GAME_STATE)
+	BattleTileView::eventOccurred(e);
+}
+
+void BattleView::handleGameEvent(GameEvent &event)
+{
+	if (!event.message().empty())
 	{
-		auto gameEvent = dynamic_cast<GameEvent *>(e);
-		if (!gameEvent)
+		state->logEvent(&event);
+		baseForm->findControlTyped<Ticker>("NEWS_TICKER")->addMessage(event.message());
+		if (battle.mode == Battle::Mode::RealTime && !DEBUG_DISABLE_NOTIFICATIONS)
 		{
-			LogError("Invalid game state event");
-			return;
+			fw().stageQueueCommand(
+			    {StageCmd::Command::PUSH,
+			     mksp<NotificationScreen>(state, *this, event.message())});
 		}
-		if (!gameEvent->message().empty())
-		{
-			state->logEvent(gameEvent);
-			baseForm->findControlTyped<Ticker>("NEWS_TICKER")->addMessage(gameEvent->message());
-			if (battle.mode == Battle::Mode::RealTime && !DEBUG_DISABLE_NOTIFICATIONS)
+	}
+	switch (event.type)
+	{
+		case GameEventType::ZoomView:
+			if (GameLocationEvent *gle = dynamic_cast<GameLocationEvent *>(&event))
 			{
-				fw().stageQueueCommand(
-				    {StageCmd::Command::PUSH,
-				     mksp<NotificationScreen>(state, *this, gameEvent->message())});
+				zoomAt(gle->location);
 			}
-		}
-		switch (gameEvent->type)
+			break;
+		case GameEventType::AgentPsiProbed:
 		{
-			case GameEventType::ZoomView:
-				if (GameLocationEvent *gle = dynamic_cast<GameLocationEvent *>(gameEvent))
-				{
-					zoomAt(gle->location);
-				}
-				break;
-			case GameEventType::AgentPsiProbed:
-			{
-				auto gameAgentEvent = dynamic_cast<GameAgentEvent *>(e);
-				fw().stageQueueCommand(
-				    {StageCmd::Command::PUSH, mksp<AEquipScreen>(state, gameAgentEvent->agent)});
-				break;
-			}
-			default:
-				break;
+			auto gameAgentEvent = dynamic_cast<GameAgentEvent *>(&event);
+			fw().stageQueueCommand(
+			    {StageCmd::Command::PUSH, mksp<AEquipScreen>(state, gameAgentEvent->agent)});
+			break;
 		}
-		return;
+		default:
+			break;
 	}
-	BattleTileView::eventOccurred(e);
 }
 
 void BattleView::handleMouseDown(Event *e)
@@ -3633,8 +3714,7 @@ void BattleView::handleMouseDown(Event *e)
 						    o->getType() == TileObject::Type::LeftWall ||
 						    o->getType() == TileObject::Type::RightWall)
 						{
-							auto mp =
-							    std::static_pointer_cast<TileObjectBattleMapPart>(o)->getOwner();
+							auto mp = static_cast<TileObjectBattleMapPart *>(o)->getOwner();
 							debug += format(
 							    "\n[%s] SBT %d STATUS %s\nFIRE Res=%d Tim=%d Burned=%D",
 							    mp->type.id, mp->type->getVanillaSupportedById(),
@@ -3663,9 +3743,9 @@ void BattleView::handleMouseDown(Event *e)
 											    o2->getType() == TileObject::Type::LeftWall ||
 											    o2->getType() == TileObject::Type::RightWall)
 											{
-												auto mp2 = std::static_pointer_cast<
-												               TileObjectBattleMapPart>(o2)
-												               ->getOwner();
+												auto mp2 =
+												    static_cast<TileObjectBattleMapPart *>(o2)
+												        ->getOwner();
 												for (auto &p : mp2->supportedParts)
 												{
 													if (p.first == t && p.second == mp->type->type)
@@ -3684,11 +3764,11 @@ void BattleView::handleMouseDown(Event *e)
 						}
 						if (o->getType() == TileObject::Type::Hazard)
 						{
-							auto h =
-							    std::static_pointer_cast<TileObjectBattleHazard>(o)->getHazard();
-							debug +=
-							    format("\nHazard %s %s Pow=%d Age=%d LT=%d  ", h->damageType.id,
-							           h->damageType->hazardType.id, h->power, h->age, h->lifetime);
+							auto h = static_cast<TileObjectBattleHazard *>(o);
+							auto hazard = h->getField().get(h->getIndex());
+							debug += format("\nHazard %s %s Pow=%d Age=%d LT=%d  ",
+							                hazard.damageType.id, hazard.damageType->hazardType.id,
+							                hazard.power, hazard.age, hazard.lifetime);
 						}
 					}
 
@@ -4375,7 +4455,13 @@ void BattleView::updateSquadInfo(int index)
 	    ->setImage(squadOverlay[info.selectedMode]);
 }
 
-void BattleView::finish() { fw().getCursor().CurrentType = ApocCursor::CursorType::Normal; }
+void BattleView::finish()
+{
+	simulation->stop();
+	pendingEvents.clear();
+	state->events.unsubscribe(this);
+	fw().getCursor().CurrentType = ApocCursor::CursorType::Normal;
+}
 
 AgentEquipmentInfo BattleView::createItemOverlayInfo(bool rightHand)
 {
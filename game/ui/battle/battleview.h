@@ -1,10 +1,12 @@
 #pragma once
 
+#include "framework/drawcommandbuffer.h"
 #include "game/state/battle/battleunit.h"
 #include "game/ui/general/notificationscreen.h"
 #include "game/ui/tileview/battletileview.h"
 #include "library/colour.h"
 #include "library/sp.h"
+#include <atomic>
 
 namespace OpenApoc
 {
@@ -17,6 +19,8 @@ class AEquipment;
 class AEquipmentType;
 class Graphic;
 class BattleTurnBasedConfirmBox;
+class SimulationRunner;
+class GameEvent;
 
 enum class BattleUpdateSpeed
 {
@@ -252,10 +256,33 @@ class BattleView : public BattleTileView
 	void orderFocus(StateRef<BattleUnit> u);
 	void orderHeal(BodyPart part);
 
+	// Runs the battle while it's the current stage, the state must only be touched with its lock
+	// held
+	up<SimulationRunner> simulation;
+	void updateSimulation(unsigned int ticks);
+	// The map as of the last tick, so that frames can be drawn without the state
+	DrawCommandSnapshot snapshot;
+	// Whether the display was hidden when the snapshot was taken
+	std::atomic<bool> snapshotHidden;
+	// Needs the state lock
+	void recordSnapshot();
+	// Input that came in while the simulation was busy, handled in order once it's done
+	std::list<up<Event>> pendingEvents;
+	void handlePendingEvents();
+	void handleEvent(Event *e);
+	// Updates everything that needs the state, with its lock held
+	void updateView();
+	// As of the last update
+	bool turnBased = false;
+
+	// Called for every game event raised while the battle is the current stage
+	void handleGameEvent(GameEvent &event);
+
   public:
 	BattleView(sp<GameState> gameState);
 	~BattleView() override;
 	void begin() override;
+	void pause() override;
 	void resume() override;
 	void update() override;
 	void render() override;
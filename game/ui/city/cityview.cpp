@@ -30,6 +30,7 @@
 #include "game/state/message.h"
 #include "game/state/organisation.h"
 #include "game/state/research.h"
+#include "game/state/simulationrunner.h"
 #include "game/state/rules/aequipment_type.h"
 #include "game/state/rules/vammo_type.h"
 #include "game/state/rules/vehicle_type.h"
@@ -102,6 +103,9 @@ static const std::vector<UString> CITY_ICON_VEHICLE_PASSENGER_COUNT_RESOURCES =
     {"PCK:xcom3/ufodata/vs_icon.pck:xcom3/ufodata/vs_icon.tab:63:xcom3/ufodata/pal_01.dat"}, // 13+
 };
 
+// Game time the top speed goes through every frame, if nothing happens that stops it
+static const unsigned FAST_FORWARD_TICKS = TICKS_PER_HOUR;
+
 } // anonymous namespace
 
 CityView::CityView(sp<GameState> state)
@@ -112,7 +116,8 @@ CityView::CityView(sp<GameState> state)
       selectionState(SelectionState::Normal),
       day_palette(fw().data->loadPalette("xcom3/ufodata/pal_01.dat")),
       twilight_palette(fw().data->loadPalette("xcom3/ufodata/pal_02.dat")),
-      night_palette(fw().data->loadPalette("xcom3/ufodata/pal_03.dat"))
+      night_palette(fw().data->loadPalette("xcom3/ufodata/pal_03.dat")),
+      simulation(mkup<SimulationRunner>([this](unsigned int ticks) { updateSimulation(ticks); }))
 {
 	baseForm->findControlTyped<RadioButton>("BUTTON_SPEED1")->setChecked(true);
 	for (auto &formName : TAB_FORM_NAMES)
@@ -433,6 +438,9 @@ CityView::~CityView() = default;
 
 void CityView::begin()
 {
+	state->events.subscribeAll(this, [this](GameEvent &event) { handleGameEvent(event); });
+	recordSnapshot();
+	simulation->start();
 	if (state->newGame)
 	{
 		state->newGame = false;
@@ -441,8 +449,20 @@ void CityView::begin()
 	}
 }
 
+void CityView::pause()
+{
+	// Whatever stage comes next is free to use the game state
+	simulation->stop();
+	pendingEvents.clear();
+	state->events.unsubscribe(this);
+	CityTileView::pause();
+}
+
 void CityView::resume()
 {
+	state->events.subscribeAll(this, [this](GameEvent &event) { handleGameEvent(event); });
+	recordSnapshot();
+	simulation->start();
 	this->uiTabs[0]->findControlTyped<Label>("TEXT_BASE_NAME")->setText(state->current_base->name);
 	miniViews.clear();
 	int b = 0;
@@ -469,6 +489,14 @@ void CityView::resume()
 	}
 }
 
+void CityView::finish()
+{
+	simulation->stop();
+	pendingEvents.clear();
+	state->events.unsubscribe(this);
+	CityTileView::finish();
+}
+
 void CityView::render()
 {
 	TRACE_FN;
@@ -484,46 +512,20 @@ void CityView::render()
 		this->drawCity = false;
 		RendererSurfaceBinding b(*fw().renderer, this->surface);
 
-		CityTileView::render();
-		if (state->showVehiclePath)
+		// Drawn from the snapshot, so that a frame never waits for a tick to finish
+		auto map = snapshot.get();
+		if (map)
 		{
-			for (auto &pair : state->vehicles)
-			{
-				auto v = pair.second;
-				if (v->city != state->current_city)
-					continue;
-				auto vTile = v->tileObject;
-				if (!vTile)
-					continue;
-				auto &path = v->missions.front()->currentPlannedPath;
-				Vec3<float> prevPos = vTile->getPosition();
-				for (auto &pos : path)
-				{
-					Vec2<float> screenPosA = this->tileToOffsetScreenCoords(prevPos);
-					Vec2<float> screenPosB = this->tileToOffsetScreenCoords(pos);
-
-					fw().renderer->drawLine(screenPosA, screenPosB, Colour{255, 0, 0, 128});
-
-					prevPos = pos;
-				}
-			}
+			map->submit(*fw().renderer);
 		}
 		activeTab->render();
 		baseForm->render();
-		if (activeTab == uiTabs[0])
+		if (activeTab == uiTabs[0] && selectedMiniView)
 		{
 			// Highlight selected base
-			for (auto &view : miniViews)
-			{
-				auto viewBase = view->getData<Base>();
-				if (state->current_base == viewBase)
-				{
-					Vec2<int> pos = uiTabs[0]->Location + view->Location - 1;
-					Vec2<int> size = view->Size + 2;
-					fw().renderer->drawRect(pos, size, Colour{255, 0, 0});
-					break;
-				}
-			}
+			Vec2<int> pos = uiTabs[0]->Location + selectedMiniView->Location - 1;
+			Vec2<int> size = selectedMiniView->Size + 2;
+			fw().renderer->drawRect(pos, size, Colour{255, 0, 0});
 		}
 	}
 
@@ -538,13 +540,82 @@ void CityView::render()
 	}
 }
 
+void CityView::updateSimulation(unsigned int ticks)
+{
+	if (this->updateSpeed == UpdateSpeed::Speed5)
+	{
+		// Every tick is a frame's worth of fast-forward
+		if (this->state->canTurbo())
+		{
+			this->state->fastForward(FAST_FORWARD_TICKS);
+		}
+	}
+	else
+	{
+		while (ticks > 0)
+		{
+			this->state->update();
+			ticks--;
+		}
+	}
+	recordSnapshot();
+}
+
+void CityView::recordSnapshot()
+{
+	auto frame = snapshot.beginFrame();
+	renderMap(*frame);
+	if (state->showVehiclePath)
+	{
+		for (auto &pair : state->vehicles)
+		{
+			auto v = pair.second;
+			if (v->city != state->current_city)
+				continue;
+			auto vTile = v->tileObject;
+			if (!vTile)
+				continue;
+			auto &path = v->missions.front()->currentPlannedPath;
+			Vec3<float> prevPos = vTile->getPosition();
+			for (auto &pos : path)
+			{
+				Vec2<float> screenPosA = this->tileToOffsetScreenCoords(prevPos);
+				Vec2<float> screenPosB = this->tileToOffsetScreenCoords(pos);
+
+				frame->drawLine(screenPosA, screenPosB, Colour{255, 0, 0, 128});
+
+				prevPos = pos;
+			}
+		}
+	}
+	snapshot.publish(frame);
+}
+
+void CityView::handlePendingEvents()
+{
+	while (!pendingEvents.empty())
+	{
+		auto e = std::move(pendingEvents.front());
+		pendingEvents.pop_front();
+		handleEvent(e.get());
+	}
+}
+
 void CityView::update()
 {
 	this->drawCity = true;
+	auto lock = simulation->tryLock();
+	if (!lock.owns_lock())
+	{
+		// Keeps drawing the last snapshot until the simulation lets go of the state
+		return;
+	}
+	handlePendingEvents();
+	state->events.drain();
 	CityTileView::update();
 
+	// Ticks the game goes through at the base rate, once per frame at 60 frames per second
 	unsigned int ticks = 0;
-	bool turbo = false;
 	switch (this->updateSpeed)
 	{
 		case UpdateSpeed::Pause:
@@ -568,35 +639,17 @@ void CityView::update()
 			ticks = 6;
 			break;
 		case UpdateSpeed::Speed5:
+			// Drops down to normal speed as soon as the simulation can't fast-forward anymore
 			if (!this->state->canTurbo())
 			{
 				setUpdateSpeed(UpdateSpeed::Speed1);
-				ticks = 1;
-			}
-			else
-			{
-				turbo = true;
 			}
+			ticks = 1;
 			break;
 	}
 	baseForm->findControl("BUTTON_SPEED5")->Enabled = this->state->canTurbo();
+	simulation->setTicksPerSecond(ticks * SimulationRunner::BASE_TICKS_PER_SECOND);
 
-	if (turbo)
-	{
-		this->state->updateTurbo();
-		if (!this->state->canTurbo())
-		{
-			setUpdateSpeed(UpdateSpeed::Speed1);
-		}
-	}
-	else
-	{
-		while (ticks > 0)
-		{
-			this->state->update();
-			ticks--;
-		}
-	}
 	auto clockControl = baseForm->findControlTyped<Label>("CLOCK");
 
 	clockControl->setText(state->gameTime.getLongTimeString());
@@ -777,6 +830,22 @@ void CityView::update()
 			}
 		}
 	}
+
+	selectedMiniView = nullptr;
+	for (auto &view : miniViews)
+	{
+		if (state->current_base == view->getData<Base>())
+		{
+			selectedMiniView = view;
+			break;
+		}
+	}
+
+	// Otherwise the next tick picks up whatever changed, camera included
+	if (simulation->isPaused())
+	{
+		recordSnapshot();
+	}
 }
 
 std::shared_future<void> loadBattleBase(sp<GameState> state, StateRef<Base> base,
@@ -802,6 +871,19 @@ void CityView::initiateDefenseMission(StateRef<Base> base, StateRef<Organisation
 }
 
 void CityView::eventOccurred(Event *e)
+{
+	auto lock = simulation->tryLock();
+	if (!lock.owns_lock())
+	{
+		// Handled at the next tick boundary, once the simulation lets go of the state
+		pendingEvents.push_back(e->clone());
+		return;
+	}
+	handlePendingEvents();
+	handleEvent(e);
+}
+
+void CityView::handleEvent(Event *e)
 {
 	this->drawCity = true;
 	activeTab->eventOccured(e);
@@ -972,266 +1054,262 @@ void CityView::eventOccurred(Event *e)
 			}
 		}
 	}
-	else if (e->type() == EVENT_GAME_STATE)
+	else
+	{
+		CityTileView::eventOccurred(e);
+	}
+}
+
+void CityView::handleGameEvent(GameEvent &event)
+{
+	if (!event.message().empty())
 	{
-		auto gameEvent = dynamic_cast<GameEvent *>(e);
-		if (!gameEvent)
+		state->logEvent(&event);
+		baseForm->findControlTyped<Ticker>("NEWS_TICKER")->addMessage(event.message());
+		if (event.type != GameEventType::AlienSpotted)
 		{
-			LogError("Invalid game state event");
+			fw().stageQueueCommand(
+			    {StageCmd::Command::PUSH,
+			     mksp<NotificationScreen>(state, *this, event.message())});
 		}
-		if (!gameEvent->message().empty())
+	}
+	switch (event.type)
+	{
+		default:
+			break;
+		case GameEventType::AlienTakeover:
 		{
-			state->logEvent(gameEvent);
-			baseForm->findControlTyped<Ticker>("NEWS_TICKER")->addMessage(gameEvent->message());
-			if (gameEvent->type != GameEventType::AlienSpotted)
-			{
-				fw().stageQueueCommand(
-				    {StageCmd::Command::PUSH,
-				     mksp<NotificationScreen>(state, *this, gameEvent->message())});
-			}
+			// FIXME: Proper takeover message
+			auto gameOrgEvent = dynamic_cast<GameOrganisationEvent *>(&event);
+			fw().stageQueueCommand(
+			    {StageCmd::Command::PUSH,
+			     mksp<NotificationScreen>(
+			         state, *this,
+			         format("Aliens have taken over %s", gameOrgEvent->organisation->name))});
 		}
-		switch (gameEvent->type)
+		break;
+		case GameEventType::DefendTheBase:
 		{
-			default:
-				break;
-			case GameEventType::AlienTakeover:
+			auto gameDefenseEvent = dynamic_cast<GameDefenseEvent *>(&event);
+			initiateDefenseMission(gameDefenseEvent->base, gameDefenseEvent->organisation);
+			break;
+		}
+		case GameEventType::AlienSpotted:
+		{
+			auto ev = dynamic_cast<GameBuildingEvent *>(&event);
+			if (!ev)
 			{
-				// FIXME: Proper takeover message
-				auto gameOrgEvent = dynamic_cast<GameOrganisationEvent *>(e);
-				fw().stageQueueCommand(
-				    {StageCmd::Command::PUSH,
-				     mksp<NotificationScreen>(
-				         state, *this,
-				         format("Aliens have taken over %s", gameOrgEvent->organisation->name))});
+				LogError("Invalid spotted event");
 			}
+			fw().soundBackend->playSample(listRandomiser(state->rng, alertSounds));
+			zoomLastEvent();
+			setUpdateSpeed(UpdateSpeed::Speed1);
+			fw().stageQueueCommand(
+			    {StageCmd::Command::PUSH, mksp<AlertScreen>(state, ev->building)});
 			break;
-			case GameEventType::DefendTheBase:
+		}
+		case GameEventType::ResearchCompleted:
+		{
+			auto ev = dynamic_cast<GameResearchEvent *>(&event);
+			if (!ev)
 			{
-				auto gameDefenseEvent = dynamic_cast<GameDefenseEvent *>(e);
-				initiateDefenseMission(gameDefenseEvent->base, gameDefenseEvent->organisation);
-				break;
+				LogError("Invalid research event");
 			}
-			case GameEventType::AlienSpotted:
+			this->state->research.resortTopicList();
+			sp<Facility> lab_facility;
+			for (auto &base : state->player_bases)
 			{
-				auto ev = dynamic_cast<GameBuildingEvent *>(e);
-				if (!ev)
+				for (auto &facility : base.second->facilities)
 				{
-					LogError("Invalid spotted event");
+					if (ev->lab == facility->lab)
+					{
+						lab_facility = facility;
+						break;
+					}
 				}
-				fw().soundBackend->playSample(listRandomiser(state->rng, alertSounds));
-				zoomLastEvent();
-				setUpdateSpeed(UpdateSpeed::Speed1);
-				fw().stageQueueCommand(
-				    {StageCmd::Command::PUSH, mksp<AlertScreen>(state, ev->building)});
-				break;
+				if (lab_facility)
+					break;
 			}
-			case GameEventType::ResearchCompleted:
+			if (!lab_facility)
 			{
-				auto ev = dynamic_cast<GameResearchEvent *>(e);
-				if (!ev)
-				{
-					LogError("Invalid research event");
-				}
-				this->state->research.resortTopicList();
-				sp<Facility> lab_facility;
-				for (auto &base : state->player_bases)
+				LogError("No facilities matching lab");
+			}
+			auto game_state = this->state;
+			auto ufopaedia_entry = ev->topic->ufopaedia_entry;
+			sp<UfopaediaCategory> ufopaedia_category;
+			if (ufopaedia_entry)
+			{
+				for (auto &cat : this->state->ufopaedia)
 				{
-					for (auto &facility : base.second->facilities)
+					for (auto &entry : cat.second->entries)
 					{
-						if (ev->lab == facility->lab)
+						if (ufopaedia_entry == entry.second)
 						{
-							lab_facility = facility;
+							ufopaedia_category = cat.second;
 							break;
 						}
 					}
-					if (lab_facility)
+					if (ufopaedia_category)
 						break;
 				}
-				if (!lab_facility)
+				if (!ufopaedia_category)
 				{
-					LogError("No facilities matching lab");
+					LogError("No UFOPaedia category found for entry %s",
+					         ufopaedia_entry->title);
 				}
-				auto game_state = this->state;
-				auto ufopaedia_entry = ev->topic->ufopaedia_entry;
-				sp<UfopaediaCategory> ufopaedia_category;
-				if (ufopaedia_entry)
-				{
-					for (auto &cat : this->state->ufopaedia)
-					{
-						for (auto &entry : cat.second->entries)
-						{
-							if (ufopaedia_entry == entry.second)
-							{
-								ufopaedia_category = cat.second;
-								break;
-							}
-						}
-						if (ufopaedia_category)
-							break;
-					}
-					if (!ufopaedia_category)
-					{
-						LogError("No UFOPaedia category found for entry %s",
-						         ufopaedia_entry->title);
-					}
-				}
-				auto message_box = mksp<MessageBox>(
-				    tr("RESEARCH COMPLETE"),
-				    format("%s\n%s\n%s", tr("Research project completed:"), ev->topic->name,
-				           tr("Do you wish to view the UFOpaedia report?")),
-				    MessageBox::ButtonOptions::YesNo,
-				    // Yes callback
-				    [game_state, lab_facility, ufopaedia_category, ufopaedia_entry]() {
-					    fw().stageQueueCommand({StageCmd::Command::PUSH,
-					                            mksp<ResearchScreen>(game_state, lab_facility)});
-					    if (ufopaedia_entry)
-					    {
-						    fw().stageQueueCommand(
-						        {StageCmd::Command::PUSH,
-						         mksp<UfopaediaCategoryView>(game_state, ufopaedia_category,
-						                                     ufopaedia_entry)});
-					    }
-					},
-				    // No callback
-				    [game_state, lab_facility]() {
-					    fw().stageQueueCommand({StageCmd::Command::PUSH,
-					                            mksp<ResearchScreen>(game_state, lab_facility)});
-					});
-				fw().stageQueueCommand({StageCmd::Command::PUSH, message_box});
 			}
-			break;
-			case GameEventType::ManufactureCompleted:
+			auto message_box = mksp<MessageBox>(
+			    tr("RESEARCH COMPLETE"),
+			    format("%s\n%s\n%s", tr("Research project completed:"), ev->topic->name,
+			           tr("Do you wish to view the UFOpaedia report?")),
+			    MessageBox::ButtonOptions::YesNo,
+			    // Yes callback
+			    [game_state, lab_facility, ufopaedia_category, ufopaedia_entry]() {
+				    fw().stageQueueCommand({StageCmd::Command::PUSH,
+				                            mksp<ResearchScreen>(game_state, lab_facility)});
+				    if (ufopaedia_entry)
+				    {
+					    fw().stageQueueCommand(
+					        {StageCmd::Command::PUSH,
+					         mksp<UfopaediaCategoryView>(game_state, ufopaedia_category,
+					                                     ufopaedia_entry)});
+				    }
+				},
+			    // No callback
+			    [game_state, lab_facility]() {
+				    fw().stageQueueCommand({StageCmd::Command::PUSH,
+				                            mksp<ResearchScreen>(game_state, lab_facility)});
+				});
+			fw().stageQueueCommand({StageCmd::Command::PUSH, message_box});
+		}
+		break;
+		case GameEventType::ManufactureCompleted:
+		{
+			auto ev = dynamic_cast<GameManufactureEvent *>(&event);
+			if (!ev)
 			{
-				auto ev = dynamic_cast<GameManufactureEvent *>(e);
-				if (!ev)
-				{
-					LogError("Invalid manufacture event");
-				}
-				sp<Facility> lab_facility;
-				sp<Base> lab_base;
-				for (auto &base : state->player_bases)
+				LogError("Invalid manufacture event");
+			}
+			sp<Facility> lab_facility;
+			sp<Base> lab_base;
+			for (auto &base : state->player_bases)
+			{
+				for (auto &facility : base.second->facilities)
 				{
-					for (auto &facility : base.second->facilities)
+					if (ev->lab == facility->lab)
 					{
-						if (ev->lab == facility->lab)
-						{
-							lab_facility = facility;
-							lab_base = base.second;
-							break;
-						}
-					}
-					if (lab_facility)
+						lab_facility = facility;
+						lab_base = base.second;
 						break;
+					}
 				}
-				if (!lab_facility)
-				{
-					LogError("No facilities matching lab");
-				}
-				auto game_state = this->state;
+				if (lab_facility)
+					break;
+			}
+			if (!lab_facility)
+			{
+				LogError("No facilities matching lab");
+			}
+			auto game_state = this->state;
 
-				UString item_name;
-				switch (ev->topic->item_type)
-				{
-					case ResearchTopic::ItemType::VehicleEquipment:
-						item_name = game_state->vehicle_equipment[ev->topic->item_produced]->name;
-						break;
-					case ResearchTopic::ItemType::VehicleEquipmentAmmo:
-						item_name = game_state->vehicle_ammo[ev->topic->item_produced]->name;
-						break;
-					case ResearchTopic::ItemType::AgentEquipment:
-						item_name = game_state->agent_equipment[ev->topic->item_produced]->name;
-						break;
-					case ResearchTopic::ItemType::Craft:
-						item_name = game_state->vehicle_types[ev->topic->item_produced]->name;
-						break;
-				}
-				auto message_box = mksp<MessageBox>(
-				    tr("MANUFACTURE COMPLETED"),
-				    format("%s\n%s\n%s %d\n%d", lab_base->name, tr(item_name), tr("Quantity:"),
-				           ev->goal, tr("Do you wish to reasign the Workshop?")),
-				    MessageBox::ButtonOptions::YesNo,
-				    // Yes callback
-				    [game_state, lab_facility]() {
-					    fw().stageQueueCommand({StageCmd::Command::PUSH,
-					                            mksp<ResearchScreen>(game_state, lab_facility)});
-					});
-				fw().stageQueueCommand({StageCmd::Command::PUSH, message_box});
+			UString item_name;
+			switch (ev->topic->item_type)
+			{
+				case ResearchTopic::ItemType::VehicleEquipment:
+					item_name = game_state->vehicle_equipment[ev->topic->item_produced]->name;
+					break;
+				case ResearchTopic::ItemType::VehicleEquipmentAmmo:
+					item_name = game_state->vehicle_ammo[ev->topic->item_produced]->name;
+					break;
+				case ResearchTopic::ItemType::AgentEquipment:
+					item_name = game_state->agent_equipment[ev->topic->item_produced]->name;
+					break;
+				case ResearchTopic::ItemType::Craft:
+					item_name = game_state->vehicle_types[ev->topic->item_produced]->name;
+					break;
 			}
-			break;
-			case GameEventType::ManufactureHalted:
+			auto message_box = mksp<MessageBox>(
+			    tr("MANUFACTURE COMPLETED"),
+			    format("%s\n%s\n%s %d\n%d", lab_base->name, tr(item_name), tr("Quantity:"),
+			           ev->goal, tr("Do you wish to reasign the Workshop?")),
+			    MessageBox::ButtonOptions::YesNo,
+			    // Yes callback
+			    [game_state, lab_facility]() {
+				    fw().stageQueueCommand({StageCmd::Command::PUSH,
+				                            mksp<ResearchScreen>(game_state, lab_facility)});
+				});
+			fw().stageQueueCommand({StageCmd::Command::PUSH, message_box});
+		}
+		break;
+		case GameEventType::ManufactureHalted:
+		{
+			auto ev = dynamic_cast<GameManufactureEvent *>(&event);
+			if (!ev)
 			{
-				auto ev = dynamic_cast<GameManufactureEvent *>(e);
-				if (!ev)
-				{
-					LogError("Invalid manufacture event");
-				}
-				sp<Facility> lab_facility;
-				sp<Base> lab_base;
-				for (auto &base : state->player_bases)
+				LogError("Invalid manufacture event");
+			}
+			sp<Facility> lab_facility;
+			sp<Base> lab_base;
+			for (auto &base : state->player_bases)
+			{
+				for (auto &facility : base.second->facilities)
 				{
-					for (auto &facility : base.second->facilities)
+					if (ev->lab == facility->lab)
 					{
-						if (ev->lab == facility->lab)
-						{
-							lab_facility = facility;
-							lab_base = base.second;
-							break;
-						}
-					}
-					if (lab_facility)
+						lab_facility = facility;
+						lab_base = base.second;
 						break;
+					}
 				}
-				if (!lab_facility)
-				{
-					LogError("No facilities matching lab");
-				}
-				auto game_state = this->state;
+				if (lab_facility)
+					break;
+			}
+			if (!lab_facility)
+			{
+				LogError("No facilities matching lab");
+			}
+			auto game_state = this->state;
 
-				UString item_name;
-				switch (ev->topic->item_type)
-				{
-					case ResearchTopic::ItemType::VehicleEquipment:
-						item_name = game_state->vehicle_equipment[ev->topic->item_produced]->name;
-						break;
-					case ResearchTopic::ItemType::VehicleEquipmentAmmo:
-						item_name = game_state->vehicle_ammo[ev->topic->item_produced]->name;
-						break;
-					case ResearchTopic::ItemType::AgentEquipment:
-						item_name = game_state->agent_equipment[ev->topic->item_produced]->name;
-						break;
-					case ResearchTopic::ItemType::Craft:
-						item_name = game_state->vehicles[ev->topic->item_produced]->name;
-						break;
-				}
-				auto message_box =
-				    mksp<MessageBox>(tr("MANUFACTURING HALTED"),
-				                     format("%s\n%s\n%s %d/%d\n%d", lab_base->name, tr(item_name),
-				                            tr("Completion status:"), ev->done, ev->goal,
-				                            tr("Production costs exceed your available funds.")),
-				                     MessageBox::ButtonOptions::Ok);
-				fw().stageQueueCommand({StageCmd::Command::PUSH, message_box});
+			UString item_name;
+			switch (ev->topic->item_type)
+			{
+				case ResearchTopic::ItemType::VehicleEquipment:
+					item_name = game_state->vehicle_equipment[ev->topic->item_produced]->name;
+					break;
+				case ResearchTopic::ItemType::VehicleEquipmentAmmo:
+					item_name = game_state->vehicle_ammo[ev->topic->item_produced]->name;
+					break;
+				case ResearchTopic::ItemType::AgentEquipment:
+					item_name = game_state->agent_equipment[ev->topic->item_produced]->name;
+					break;
+				case ResearchTopic::ItemType::Craft:
+					item_name = game_state->vehicles[ev->topic->item_produced]->name;
+					break;
 			}
-			break;
-			case GameEventType::FacilityCompleted:
+			auto message_box =
+			    mksp<MessageBox>(tr("MANUFACTURING HALTED"),
+			                     format("%s\n%s\n%s %d/%d\n%d", lab_base->name, tr(item_name),
+			                            tr("Completion status:"), ev->done, ev->goal,
+			                            tr("Production costs exceed your available funds.")),
+			                     MessageBox::ButtonOptions::Ok);
+			fw().stageQueueCommand({StageCmd::Command::PUSH, message_box});
+		}
+		break;
+		case GameEventType::FacilityCompleted:
+		{
+			auto ev = dynamic_cast<GameFacilityEvent *>(&event);
+			if (!ev)
 			{
-				auto ev = dynamic_cast<GameFacilityEvent *>(e);
-				if (!ev)
-				{
-					LogError("Invalid facility event");
-					return;
-				}
-				auto message_box =
-				    mksp<MessageBox>(tr("FACILITY COMPLETED"),
-				                     format("%s\n%s", ev->base->name, tr(ev->facility->type->name)),
-				                     MessageBox::ButtonOptions::Ok);
-				fw().stageQueueCommand({StageCmd::Command::PUSH, message_box});
+				LogError("Invalid facility event");
+				return;
 			}
-			break;
+			auto message_box =
+			    mksp<MessageBox>(tr("FACILITY COMPLETED"),
+			                     format("%s\n%s", ev->base->name, tr(ev->facility->type->name)),
+			                     MessageBox::ButtonOptions::Ok);
+			fw().stageQueueCommand({StageCmd::Command::PUSH, message_box});
 		}
-	}
-	else
-	{
-		CityTileView::eventOccurred(e);
+		break;
 	}
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "framework/drawcommandbuffer.h"
 #include "game/state/stateobject.h"
 #include "game/ui/tileview/citytileview.h"
 #include "library/sp.h"
@@ -17,6 +18,8 @@ class Vehicle;
 class Sample;
 class Base;
 class Organisation;
+class SimulationRunner;
+class GameEvent;
 
 enum class UpdateSpeed
 {
@@ -110,6 +113,24 @@ class CityView : public CityTileView
 
 	bool drawCity = true;
 	sp<Surface> surface;
+	// The mini view of the current base, as of the last update
+	sp<GraphicButton> selectedMiniView;
+
+	// Runs the game while the city is the current stage, the state must only be touched with its
+	// lock held
+	up<SimulationRunner> simulation;
+	void updateSimulation(unsigned int ticks);
+	// The map as of the last tick, so that frames can be drawn without the state
+	DrawCommandSnapshot snapshot;
+	// Needs the state lock
+	void recordSnapshot();
+	// Input that came in while the simulation was busy, handled in order once it's done
+	std::list<up<Event>> pendingEvents;
+	void handlePendingEvents();
+	void handleEvent(Event *e);
+
+	// Called for every game event raised while the city is the current stage
+	void handleGameEvent(GameEvent &event);
 
   public:
 	CityView(sp<GameState> state);
@@ -118,7 +139,9 @@ class CityView : public CityTileView
 	void initiateDefenseMission(StateRef<Base> base, StateRef<Organisation> attacker);
 
 	void begin() override;
+	void pause() override;
 	void resume() override;
+	void finish() override;
 	void update() override;
 	void render() override;
 	void eventOccurred(Event *e) override;
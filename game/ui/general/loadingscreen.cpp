@@ -41,6 +41,16 @@ void LoadingScreen::begin()
 	}
 	fw().displaySetIcon();
 	loadingimageangle = 0;
+	if (state)
+	{
+		// Only logged, nothing else is shown for what happens while loading
+		state->events.subscribeAll(this, [this](GameEvent &event) {
+			if (!event.message().empty())
+			{
+				state->logEvent(&event);
+			}
+		});
+	}
 	if (asyncLoading.get() == false)
 	{
 		loadingTask.wait();
@@ -51,34 +61,16 @@ void LoadingScreen::pause() {}
 
 void LoadingScreen::resume() {}
 
-void LoadingScreen::finish() {}
-
-void LoadingScreen::eventOccurred(Event *e)
+void LoadingScreen::finish()
 {
-	if (!state)
+	if (state)
 	{
-		return;
-	}
-	if (e->type() == EVENT_GAME_STATE)
-	{
-		auto gameEvent = dynamic_cast<GameEvent *>(e);
-		if (!gameEvent)
-		{
-			LogError("Invalid game state event");
-			return;
-		}
-		if (!gameEvent->message().empty())
-		{
-			state->logEvent(gameEvent);
-		}
-		switch (gameEvent->type)
-		{
-			default:
-				break;
-		}
+		state->events.unsubscribe(this);
 	}
 }
 
+void LoadingScreen::eventOccurred(Event *) {}
+
 void LoadingScreen::update()
 {
 	loadingimageangle += (float)(M_PI + 0.05f);
@@ -94,6 +86,11 @@ void LoadingScreen::update()
 	{
 		case std::future_status::ready:
 		{
+			// The state is all ours once loading is done
+			if (state)
+			{
+				state->events.drain();
+			}
 			fw().stageQueueCommand({StageCmd::Command::REPLACE, nextScreenFn()});
 			return;
 		}
@@ -95,6 +95,11 @@ void VideoScreen::render()
 		auto time_since_last_frame = time_now - this->last_frame_time;
 		while (time_since_last_frame >= this->video->getFrameTime())
 		{
+			// Keep showing the current frame rather than wait for the decoder to catch up
+			if (!this->video->imageReady())
+			{
+				break;
+			}
 			this->last_frame_time += video->getFrameTime();
 			this->current_frame = this->video->popImage();
 
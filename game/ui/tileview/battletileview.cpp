@@ -2,7 +2,9 @@
 #include "forms/form.h"
 #include "forms/graphic.h"
 #include "forms/ui.h"
+#include "framework/configfile.h"
 #include "framework/data.h"
+#include "framework/drawcommandbuffer.h"
 #include "framework/event.h"
 #include "framework/font.h"
 #include "framework/framework.h"
@@ -10,15 +12,19 @@
 #include "framework/renderer.h"
 #include "framework/sound.h"
 #include "framework/trace.h"
+#include "game/state/aequipment.h"
 #include "game/state/battle/battle.h"
 #include "game/state/battle/battlecommonimagelist.h"
 #include "game/state/battle/battlecommonsamplelist.h"
-#include "game/state/battle/battlehazard.h"
+#include "game/state/battle/battledoor.h"
+#include "game/state/battle/battlehazardfield.h"
 #include "game/state/battle/battleitem.h"
 #include "game/state/battle/battlemappart.h"
 #include "game/state/battle/battleunitmission.h"
+#include "game/state/city/doodad.h"
 #include "game/state/gamestate.h"
 #include "game/state/organisation.h"
+#include "game/state/rules/doodad_type.h"
 #include "game/state/tileview/tileobject_battlehazard.h"
 #include "game/state/tileview/tileobject_battleitem.h"
 #include "game/state/tileview/tileobject_battlemappart.h"
@@ -26,9 +32,93 @@
 #include "game/state/tileview/tileobject_shadow.h"
 #include "library/strings_format.h"
 #include <glm/glm.hpp>
+#include <tuple>
 
 namespace OpenApoc
 {
+
+ConfigOptionBool parallelRenderOption("Game", "ParallelRender",
+                                      "Generate battlescape draw commands on multiple threads",
+                                      true);
+
+namespace
+{
+// Minimum amount of visible rows (of one layer on one level) to bother with threads
+static const int PARALLEL_RENDER_MIN_ROWS = 256;
+// Approximate amount of rows given to each thread
+static const int PARALLEL_RENDER_ROWS_PER_BATCH = 64;
+
+// Selection bracket and cost indicators to draw on one level
+class LevelSelection
+{
+  public:
+	Tile *tile = nullptr;
+	Vec3<int> position;
+	sp<Image> imageBack;
+	sp<Image> imageFront;
+	bool drawPathPreview = false;
+	bool drawAttackCost = false;
+};
+
+// Everything gathered while generating a range of rows, merged back in row order afterwards
+class RowBatch
+{
+  public:
+	// List of units that require drawing of an overhead icon (bool = is first)
+	std::list<std::pair<sp<BattleUnit>, bool>> unitsToDrawSelectionArrows;
+	// List of units that require drawing of focus arrows (bool = islarge)
+	std::list<std::pair<sp<TileObject>, bool>> unitsToDrawFocusArrows;
+	bool fireEncountered = false;
+	float closestFireDistance = FLT_MAX;
+	Vec3<float> closestFirePosition;
+};
+
+template <typename T> void resolveStateRef(const StateRef<T> &ref)
+{
+	std::ignore = static_cast<bool>(ref);
+}
+
+// StateRefs resolve themselves lazily on first use, which is not safe to happen on multiple
+// threads at once, so resolve everything drawing the battlescape can touch up front
+void resolveRenderedStateRefs(Battle &battle)
+{
+	resolveStateRef(battle.currentPlayer);
+	for (auto &u : battle.battleViewSelectedUnits)
+	{
+		resolveStateRef(u);
+	}
+	for (auto &entry : battle.units)
+	{
+		auto &u = entry.second;
+		resolveStateRef(u->owner);
+		resolveStateRef(u->agent);
+		resolveStateRef(u->agent->type);
+		for (auto &e : u->agent->equipment)
+		{
+			resolveStateRef(e->type);
+		}
+	}
+	for (auto &mp : battle.map_parts)
+	{
+		resolveStateRef(mp->type);
+		resolveStateRef(mp->alternative_type);
+		resolveStateRef(mp->door);
+	}
+	for (auto &i : battle.items)
+	{
+		resolveStateRef(i->item->type);
+	}
+	for (auto h : battle.hazards.getHazards())
+	{
+		resolveStateRef(battle.hazards.getHazardType(h));
+	}
+	for (auto &d : battle.doodads)
+	{
+		resolveStateRef(d->type);
+	}
+}
+} // anonymous namespace
+
 void BattleTileView::updateHiddenBar()
 {
 	hiddenBarTicksAccumulated = 0;
@@ -386,13 +476,8 @@ void BattleTileView::eventOccurred(Event *e)
 	TileView::eventOccurred(e);
 }
 
-void BattleTileView::render()
+void BattleTileView::advanceAnimations()
 {
-	TRACE_FN;
-	Renderer &r = *fw().renderer;
-	r.clear();
-	r.setPalette(this->pal);
-
 	if (hideDisplay)
 	{
 		hiddenBarTicksAccumulated++;
@@ -400,24 +485,42 @@ void BattleTileView::render()
 		{
 			updateHiddenBar();
 		}
-		hiddenForm->render();
 		return;
 	}
 
 	// Rotate Icons
+	healingIconTicksAccumulated++;
+	healingIconTicksAccumulated %= 2 * HEALING_ICON_ANIMATION_DELAY;
+	lowMoraleIconTicksAccumulated++;
+	lowMoraleIconTicksAccumulated %= 2 * LOWMORALE_ICON_ANIMATION_DELAY;
+	psiIconTicksAccumulated++;
+	psiIconTicksAccumulated %= 2 * PSI_ICON_ANIMATION_DELAY;
+	iconAnimationTicksAccumulated++;
+	iconAnimationTicksAccumulated %= targetLocationIcons.size() * TARGET_ICONS_ANIMATION_DELAY;
+	focusAnimationTicksAccumulated++;
+	focusAnimationTicksAccumulated %=
+	    (2 * FOCUS_ICONS_ANIMATION_FRAMES - 2) * FOCUS_ICONS_ANIMATION_DELAY;
+}
+
+void BattleTileView::render()
+{
+	TRACE_FN;
+	advanceAnimations();
+	if (hideDisplay)
 	{
-		healingIconTicksAccumulated++;
-		healingIconTicksAccumulated %= 2 * HEALING_ICON_ANIMATION_DELAY;
-		lowMoraleIconTicksAccumulated++;
-		lowMoraleIconTicksAccumulated %= 2 * LOWMORALE_ICON_ANIMATION_DELAY;
-		psiIconTicksAccumulated++;
-		psiIconTicksAccumulated %= 2 * PSI_ICON_ANIMATION_DELAY;
-		iconAnimationTicksAccumulated++;
-		iconAnimationTicksAccumulated %= targetLocationIcons.size() * TARGET_ICONS_ANIMATION_DELAY;
-		focusAnimationTicksAccumulated++;
-		focusAnimationTicksAccumulated %=
-		    (2 * FOCUS_ICONS_ANIMATION_FRAMES - 2) * FOCUS_ICONS_ANIMATION_DELAY;
+		Renderer &r = *fw().renderer;
+		r.clear();
+		r.setPalette(this->pal);
+		hiddenForm->render();
+		return;
 	}
+	renderMap(*fw().renderer);
+}
+
+void BattleTileView::renderMap(Renderer &r)
+{
+	r.clear();
+	r.setPalette(this->pal);
 
 	// screenOffset.x/screenOffset.y is the 'amount added to the tile coords' - so we want
 	// the inverse to tell which tiles are at the screen bounds
@@ -432,6 +535,8 @@ void BattleTileView::render()
 	int minY = std::max(0, topRight.y);
 	int maxY = std::min(map.size.y, bottomLeft.y);
 
+	Vec2<float> screenOffset = getScreenOffset();
+
 	int zFrom = 0;
 	int zTo = maxZDraw;
 
@@ -558,32 +663,26 @@ void BattleTileView::render()
 
 			static const Vec2<float> offsetFaceIcon = {-7.0f, -1.0f};
 
+			std::vector<LevelSelection> levelSelections;
 			for (int z = zFrom; z < zTo; z++)
 			{
-				int currentLevel = z - battle.battleViewZLevel + 1;
-
 				// Find out when to draw selection bracket parts (if ever)
-				Tile *selTileOnCurLevel = nullptr;
-				Vec3<int> selTilePosOnCurLevel;
-				sp<Image> selectionImageBack;
-				sp<Image> selectionImageFront;
-				bool drawPathPreview = false;
-				bool drawAttackCost = false;
+				levelSelections.emplace_back();
+				auto &sel = levelSelections.back();
 				if (selectedTilePosition.z >= z && selectedTilePosition.x >= minX &&
 				    selectedTilePosition.x < maxX && selectedTilePosition.y >= minY &&
 				    selectedTilePosition.y < maxY)
 				{
-					selTilePosOnCurLevel = {selectedTilePosition.x, selectedTilePosition.y, z};
-					selTileOnCurLevel = map.getTile(selTilePosOnCurLevel.x, selTilePosOnCurLevel.y,
-					                                selTilePosOnCurLevel.z);
+					sel.position = {selectedTilePosition.x, selectedTilePosition.y, z};
+					sel.tile = map.getTile(sel.position.x, sel.position.y, sel.position.z);
 
 					// Find what kind of selection bracket to draw (yellow or green)
 					// Yellow if this tile intersects with a unit
 					if (selectedTilePosition.z == z)
 					{
-						drawPathPreview = previewedPathCost != -1;
-						drawAttackCost = calculatedAttackCost != -1;
-						auto u = selTileOnCurLevel->getUnitIfPresent(true);
+						sel.drawPathPreview = previewedPathCost != -1;
+						sel.drawAttackCost = calculatedAttackCost != -1;
+						auto u = sel.tile->getUnitIfPresent(true);
 						auto unit = u ? u->getUnit() : nullptr;
 						if (unit &&
 						    (unit->owner == battle.currentPlayer ||
@@ -593,301 +692,382 @@ void BattleTileView::render()
 							if (battle.currentPlayer->isRelatedTo(unit->owner) ==
 							    Organisation::Relation::Hostile)
 							{
-								selectionImageBack = selectedTileFireImageBack;
-								selectionImageFront = selectedTileFireImageFront;
+								sel.imageBack = selectedTileFireImageBack;
+								sel.imageFront = selectedTileFireImageFront;
 							}
 							else
 							{
-								selectionImageBack = selectedTileFilledImageBack;
-								selectionImageFront = selectedTileFilledImageFront;
+								sel.imageBack = selectedTileFilledImageBack;
+								sel.imageFront = selectedTileFilledImageFront;
 							}
 						}
 						else
 						{
-							selectionImageBack = selectedTileEmptyImageBack;
-							selectionImageFront = selectedTileEmptyImageFront;
+							sel.imageBack = selectedTileEmptyImageBack;
+							sel.imageFront = selectedTileEmptyImageFront;
 						}
 					}
 					else
 					{
-						selectionImageBack = selectedTileBackgroundImageBack;
-						selectionImageFront = selectedTileBackgroundImageFront;
+						sel.imageBack = selectedTileBackgroundImageBack;
+						sel.imageFront = selectedTileBackgroundImageFront;
 					}
 				}
+			}
 
-				// Actually draw stuff
-				for (unsigned int layer = 0; layer < map.getLayerCount(); layer++)
+			// Generates draw commands for one row of tiles on one layer of one level
+			auto drawRow = [&](RowBatch &batch, Renderer &r, int z, unsigned int layer, int y) {
+				int currentLevel = z - battle.battleViewZLevel + 1;
+				auto &sel = levelSelections[z - zFrom];
+				for (int x = minX; x < maxX; x++)
 				{
-					for (int y = minY; y < maxY; y++)
+					auto tile = map.getTile(x, y, z);
+					bool visible = battle.getVisible(battle.currentPlayer, x, y, z);
+					auto &chunk = drawListCache.getCachedChunk(x, y, z);
+					auto objects = chunk.tileBegin(layer, x);
+					size_t object_count = chunk.tileEnd(layer, x) - objects;
+					size_t obj_id = 0;
+					do
 					{
-						for (int x = minX; x < maxX; x++)
+						if (tile == sel.tile && layer == 0 &&
+						    sel.tile->drawBattlescapeSelectionBackAt == obj_id)
 						{
-							auto tile = map.getTile(x, y, z);
-							bool visible = battle.getVisible(battle.currentPlayer, x, y, z);
-							auto object_count = tile->drawnObjects[layer].size();
-							size_t obj_id = 0;
-							do
+							r.draw(sel.imageBack,
+							       tileToOffsetScreenCoords(sel.position) -
+							           selectedTileImageOffset);
+						}
+						if (tile->drawTargetLocationIconAt == obj_id)
+						{
+							if (targetIconLocations.find({x, y, z}) !=
+							    targetIconLocations.end())
+							{
+								r.draw(targetLocationIcons[iconAnimationTicksAccumulated /
+								                           TARGET_ICONS_ANIMATION_DELAY],
+								       tileToOffsetScreenCoords(Vec3<float>{
+								           x, y, tile->getRestingPosition().z}) -
+								           targetLocationOffset);
+							}
+							if (waypointLocations.find({x, y, z}) !=
+							    waypointLocations.end())
 							{
-								if (tile == selTileOnCurLevel && layer == 0 &&
-								    selTileOnCurLevel->drawBattlescapeSelectionBackAt == obj_id)
+								r.draw(waypointImageSource[iconAnimationTicksAccumulated /
+								                           TARGET_ICONS_ANIMATION_DELAY],
+								       tileToOffsetScreenCoords(Vec3<float>{
+								           x, y, tile->getRestingPosition().z}) -
+								           targetLocationOffset);
+							}
+						}
+						if (obj_id >= object_count)
+						{
+							break;
+						}
+						auto &entry = objects[obj_id];
+						auto obj = entry.object;
+						bool friendly = false;
+						bool hostile = false;
+						bool unitLowMorale = false;
+						bool unitPsiAttacker = false;
+						PsiStatus unitPsiAttackedStatus = PsiStatus::NotEngaged;
+						Vec2<float> unitFaceIconPos;
+						bool objectVisible = visible;
+						switch (obj->getType())
+						{
+							case TileObject::Type::Shadow:
+							{
+								auto s = static_cast<TileObjectShadow *>(obj);
+								auto u = s->ownerBattleUnit.lock();
+								if (u)
 								{
-									r.draw(selectionImageBack,
-									       tileToOffsetScreenCoords(selTilePosOnCurLevel) -
-									           selectedTileImageOffset);
+									objectVisible =
+									    !u->isConscious() ||
+									    u->owner == battle.currentPlayer ||
+									    battle.visibleUnits.at(battle.currentPlayer)
+									            .find({&state, u->id}) !=
+									        battle.visibleUnits.at(battle.currentPlayer)
+									            .end();
 								}
-								if (tile->drawTargetLocationIconAt == obj_id)
+								break;
+							}
+							case TileObject::Type::Unit:
+							{
+								auto u = static_cast<TileObjectBattleUnit *>(obj)->getUnit();
+								objectVisible =
+								    !u->isConscious() || u->owner == battle.currentPlayer ||
+								    battle.visibleUnits.at(battle.currentPlayer)
+								            .find({&state, u->id}) !=
+								        battle.visibleUnits.at(battle.currentPlayer).end();
+								friendly = u->owner == battle.currentPlayer;
+								hostile = battle.currentPlayer->isRelatedTo(u->owner) ==
+								          Organisation::Relation::Hostile;
+								if (objectVisible)
 								{
-									if (targetIconLocations.find({x, y, z}) !=
-									    targetIconLocations.end())
+									if (u->moraleState != MoraleState::Normal)
+									{
+										unitLowMorale = true;
+									}
+									else if (u->psiStatus != PsiStatus::NotEngaged)
+									{
+										unitPsiAttacker = true;
+									}
+									if (!u->psiAttackers.empty())
 									{
-										r.draw(targetLocationIcons[iconAnimationTicksAccumulated /
-										                           TARGET_ICONS_ANIMATION_DELAY],
-										       tileToOffsetScreenCoords(Vec3<float>{
-										           x, y, tile->getRestingPosition().z}) -
-										           targetLocationOffset);
+										unitPsiAttackedStatus =
+										    u->psiAttackers.begin()->second;
 									}
-									if (waypointLocations.find({x, y, z}) !=
-									    waypointLocations.end())
+									if (unitLowMorale || unitPsiAttacker ||
+									    unitPsiAttackedStatus != PsiStatus::NotEngaged)
 									{
-										r.draw(waypointImageSource[iconAnimationTicksAccumulated /
-										                           TARGET_ICONS_ANIMATION_DELAY],
-										       tileToOffsetScreenCoords(Vec3<float>{
-										           x, y, tile->getRestingPosition().z}) -
-										           targetLocationOffset);
+										unitFaceIconPos =
+										    tileToOffsetScreenCoords(
+										        u->getPosition() +
+										        Vec3<float>{0.0f, 0.0f,
+										                    (u->getCurrentHeight() - 4.0f) *
+										                        1.5f / 40.0f}) +
+										    offsetFaceIcon;
 									}
 								}
-								if (obj_id >= object_count)
+								if (!battle.battleViewSelectedUnits.empty())
 								{
-									break;
-								}
-								auto &obj = tile->drawnObjects[layer][obj_id];
-								bool friendly = false;
-								bool hostile = false;
-								bool unitLowMorale = false;
-								bool unitPsiAttacker = false;
-								PsiStatus unitPsiAttackedStatus = PsiStatus::NotEngaged;
-								Vec2<float> unitFaceIconPos;
-								bool objectVisible = visible;
-								switch (obj->getType())
-								{
-									case TileObject::Type::Shadow:
+									auto selectedPos =
+									    std::find(battle.battleViewSelectedUnits.begin(),
+									              battle.battleViewSelectedUnits.end(), u);
+
+									if (selectedPos ==
+									    battle.battleViewSelectedUnits.begin())
 									{
-										auto s = std::static_pointer_cast<TileObjectShadow>(obj);
-										auto u = s->ownerBattleUnit.lock();
-										if (u)
-										{
-											objectVisible =
-											    !u->isConscious() ||
-											    u->owner == battle.currentPlayer ||
-											    battle.visibleUnits.at(battle.currentPlayer)
-											            .find({&state, u->id}) !=
-											        battle.visibleUnits.at(battle.currentPlayer)
-											            .end();
-										}
-										break;
+										batch.unitsToDrawSelectionArrows.push_back({u, true});
 									}
-									case TileObject::Type::Unit:
+									else if (selectedPos !=
+									         battle.battleViewSelectedUnits.end())
 									{
-										auto u = std::static_pointer_cast<TileObjectBattleUnit>(obj)
-										             ->getUnit();
-										objectVisible =
-										    !u->isConscious() || u->owner == battle.currentPlayer ||
-										    battle.visibleUnits.at(battle.currentPlayer)
-										            .find({&state, u->id}) !=
-										        battle.visibleUnits.at(battle.currentPlayer).end();
-										friendly = u->owner == battle.currentPlayer;
-										hostile = battle.currentPlayer->isRelatedTo(u->owner) ==
-										          Organisation::Relation::Hostile;
-										if (objectVisible)
-										{
-											if (u->moraleState != MoraleState::Normal)
-											{
-												unitLowMorale = true;
-											}
-											else if (u->psiStatus != PsiStatus::NotEngaged)
-											{
-												unitPsiAttacker = true;
-											}
-											if (!u->psiAttackers.empty())
-											{
-												unitPsiAttackedStatus =
-												    u->psiAttackers.begin()->second;
-											}
-											if (unitLowMorale || unitPsiAttacker ||
-											    unitPsiAttackedStatus != PsiStatus::NotEngaged)
-											{
-												unitFaceIconPos =
-												    tileToOffsetScreenCoords(
-												        u->getPosition() +
-												        Vec3<float>{0.0f, 0.0f,
-												                    (u->getCurrentHeight() - 4.0f) *
-												                        1.5f / 40.0f}) +
-												    offsetFaceIcon;
-											}
-										}
-										if (!battle.battleViewSelectedUnits.empty())
-										{
-											auto selectedPos =
-											    std::find(battle.battleViewSelectedUnits.begin(),
-											              battle.battleViewSelectedUnits.end(), u);
-
-											if (selectedPos ==
-											    battle.battleViewSelectedUnits.begin())
-											{
-												unitsToDrawSelectionArrows.push_back({u, true});
-											}
-											else if (selectedPos !=
-											         battle.battleViewSelectedUnits.end())
-											{
-												unitsToDrawSelectionArrows.push_back({u, false});
-											}
-											// If visible and focused by selected - draw focus
-											// arrows
-											if (objectVisible)
-											{
-												bool focusedBySelectedUnits = false;
-												for (auto &su : battle.battleViewSelectedUnits)
-												{
-													if (std::find(u->focusedByUnits.begin(),
-													              u->focusedByUnits.end(),
-													              su) != u->focusedByUnits.end())
-													{
-														focusedBySelectedUnits = true;
-														break;
-													}
-												}
-												if (focusedBySelectedUnits)
-												{
-													unitsToDrawFocusArrows.push_back(
-													    {obj, u->isLarge()});
-												}
-											}
-										}
-										break;
+										batch.unitsToDrawSelectionArrows.push_back({u, false});
 									}
-									case TileObject::Type::Hazard:
+									// If visible and focused by selected - draw focus
+									// arrows
+									if (objectVisible)
 									{
-										if (visible && ticksUntilFireSound == 0)
+										bool focusedBySelectedUnits = false;
+										for (auto &su : battle.battleViewSelectedUnits)
 										{
-											auto h =
-											    std::static_pointer_cast<TileObjectBattleHazard>(
-											        obj)
-											        ->getHazard();
-											if (h->hazardType->fire)
+											if (std::find(u->focusedByUnits.begin(),
+											              u->focusedByUnits.end(),
+											              su) != u->focusedByUnits.end())
 											{
-												auto distance =
-												    glm::length(centerPos - h->position);
-												if (distance < closestFireDistance)
-												{
-													fireEncountered = true;
-													closestFireDistance = distance;
-													closestFirePosition = h->position;
-												}
+												focusedBySelectedUnits = true;
+												break;
 											}
 										}
+										if (focusedBySelectedUnits)
+										{
+											batch.unitsToDrawFocusArrows.push_back(
+											    {obj->shared_from_this(), u->isLarge()});
+										}
 									}
-									default:
-										break;
 								}
-								Vec2<float> pos = tileToOffsetScreenCoords(obj->getCenter());
-								obj->draw(r, *this, pos, this->viewMode,
-								          revealWholeMap || objectVisible, currentLevel, friendly,
-								          hostile);
-								int faceShift = 0;
-								if (unitPsiAttacker)
-								{
-									r.draw(
-									    psiIcons[PsiStatus::NotEngaged][psiIconTicksAccumulated /
-									                                    PSI_ICON_ANIMATION_DELAY],
-									    unitFaceIconPos);
-									faceShift = 1;
-								}
-								if (unitPsiAttackedStatus != PsiStatus::NotEngaged)
-								{
-									r.draw(
-									    psiIcons[unitPsiAttackedStatus][psiIconTicksAccumulated /
-									                                    PSI_ICON_ANIMATION_DELAY],
-									    unitFaceIconPos + Vec2<float>{0, faceShift * 16.0f});
-									faceShift = -1;
-								}
-								if (unitLowMorale)
-								{
-									r.draw(lowMoraleIcons[lowMoraleIconTicksAccumulated /
-									                      LOWMORALE_ICON_ANIMATION_DELAY],
-									       unitFaceIconPos + Vec2<float>{0, faceShift * 16.0f});
-								}
-								// Loop ends when "break" is reached above
-								obj_id++;
-							} while (true);
-							// When done with all objects, draw the front selection image
-							if (tile == selTileOnCurLevel && layer == 0)
+								break;
+							}
+							case TileObject::Type::Hazard:
 							{
-								static const Vec2<int> offset = {2, -53};
-
-								r.draw(selectionImageFront,
-								       tileToOffsetScreenCoords(selTilePosOnCurLevel) -
-								           selectedTileImageOffset);
-								if (drawPathPreview)
+								if (visible && ticksUntilFireSound == 0)
 								{
-									sp<Image> img;
-									switch (previewedPathCost)
-									{
-										case -3:
-											img = pathPreviewUnreachable;
-											break;
-										case -2:
-											img = pathPreviewTooFar;
-											break;
-										default:
-											img = tuIndicators[previewedPathCost];
-											break;
-									}
-									if (img)
+									auto h = static_cast<TileObjectBattleHazard *>(obj);
+									if (h->getField().getHazardType(h->getIndex())->fire)
 									{
-										r.draw(img,
-										       tileToOffsetScreenCoords(selTilePosOnCurLevel) +
-										           offset -
-										           Vec2<int>{img->size.x / 2, img->size.y / 2});
-									}
-								}
-								if (drawAttackCost)
-								{
-									sp<Image> img;
-									switch (calculatedAttackCost)
-									{
-										case -4:
-											img = nullptr;
-											break;
-										case -3:
-											img = attackCostNoArc;
-											break;
-										case -2:
-											img = attackCostOutOfRange;
-											break;
-										default:
-											img = tuIndicators[calculatedAttackCost];
-											break;
-									}
-									if (img)
-									{
-										r.draw(img,
-										       tileToOffsetScreenCoords(selTilePosOnCurLevel) +
-										           offset -
-										           Vec2<int>{img->size.x / 2, img->size.y / 2});
+										auto position = h->getPosition();
+										auto distance = glm::length(centerPos - position);
+										if (distance < batch.closestFireDistance)
+										{
+											batch.fireEncountered = true;
+											batch.closestFireDistance = distance;
+											batch.closestFirePosition = position;
+										}
 									}
 								}
 							}
+							default:
+								break;
+						}
+						Vec2<float> pos = getDrawPosition(entry, screenOffset);
+						if (entry.cached)
+						{
+							entry.drawCached(r, pos, revealWholeMap || objectVisible);
+						}
+						else
+						{
+							obj->draw(r, *this, pos, this->viewMode,
+							          revealWholeMap || objectVisible, currentLevel, friendly,
+							          hostile);
+						}
+						int faceShift = 0;
+						if (unitPsiAttacker)
+						{
+							r.draw(
+							    psiIcons[PsiStatus::NotEngaged][psiIconTicksAccumulated /
+							                                    PSI_ICON_ANIMATION_DELAY],
+							    unitFaceIconPos);
+							faceShift = 1;
+						}
+						if (unitPsiAttackedStatus != PsiStatus::NotEngaged)
+						{
+							r.draw(
+							    psiIcons[unitPsiAttackedStatus][psiIconTicksAccumulated /
+							                                    PSI_ICON_ANIMATION_DELAY],
+							    unitFaceIconPos + Vec2<float>{0, faceShift * 16.0f});
+							faceShift = -1;
+						}
+						if (unitLowMorale)
+						{
+							r.draw(lowMoraleIcons[lowMoraleIconTicksAccumulated /
+							                      LOWMORALE_ICON_ANIMATION_DELAY],
+							       unitFaceIconPos + Vec2<float>{0, faceShift * 16.0f});
+						}
+						// Loop ends when "break" is reached above
+						obj_id++;
+					} while (true);
+					// When done with all objects, draw the front selection image
+					if (tile == sel.tile && layer == 0)
+					{
+						static const Vec2<int> offset = {2, -53};
+
+						r.draw(sel.imageFront,
+						       tileToOffsetScreenCoords(sel.position) -
+						           selectedTileImageOffset);
+						if (sel.drawPathPreview)
+						{
+							sp<Image> img;
+							switch (previewedPathCost)
+							{
+								case -3:
+									img = pathPreviewUnreachable;
+									break;
+								case -2:
+									img = pathPreviewTooFar;
+									break;
+								default:
+									img = tuIndicators[previewedPathCost];
+									break;
+							}
+							if (img)
+							{
+								r.draw(img,
+								       tileToOffsetScreenCoords(sel.position) +
+								           offset -
+								           Vec2<int>{img->size.x / 2, img->size.y / 2});
+							}
+						}
+						if (sel.drawAttackCost)
+						{
+							sp<Image> img;
+							switch (calculatedAttackCost)
+							{
+								case -4:
+									img = nullptr;
+									break;
+								case -3:
+									img = attackCostNoArc;
+									break;
+								case -2:
+									img = attackCostOutOfRange;
+									break;
+								default:
+									img = tuIndicators[calculatedAttackCost];
+									break;
+							}
+							if (img)
+							{
+								r.draw(img,
+								       tileToOffsetScreenCoords(sel.position) +
+								           offset -
+								           Vec2<int>{img->size.x / 2, img->size.y / 2});
+							}
+						}
+					}
 #ifdef PATHFINDING_DEBUG
-							if (tile->pathfindingDebugFlag)
-								r.draw(waypointIcons[0],
-								       tileToOffsetScreenCoords(Vec3<int>{x, y, z}) -
-								           selectedTileImageOffset);
+					if (tile->pathfindingDebugFlag)
+						r.draw(waypointIcons[0],
+						       tileToOffsetScreenCoords(Vec3<int>{x, y, z}) -
+						           selectedTileImageOffset);
 #endif
-						}
+				}
+			};
+
+			// Rows are independent of each other, so their draw commands can be generated in
+			// parallel, only the submission has to happen in the original (level, layer, row) order
+			int rowWidth = std::max(0, maxY - minY);
+			int rowsPerLevel = rowWidth * map.getLayerCount();
+			int rowCount = rowsPerLevel * std::max(0, zTo - zFrom);
+			auto drawRows = [&](RowBatch &batch, Renderer &r, int firstRow, int lastRow) {
+				for (int row = firstRow; row < lastRow; row++)
+				{
+					drawRow(batch, r, zFrom + row / rowsPerLevel, row % rowsPerLevel / rowWidth,
+					        minY + row % rowWidth);
+				}
+			};
+
+			// The cache is only read from here on, so bring it up to date first
+			for (int z = zFrom; z < zTo; z++)
+			{
+				for (int y = minY; y < maxY; y++)
+				{
+					for (int x = minX; x < maxX; x += DRAW_CHUNK_SIZE - x % DRAW_CHUNK_SIZE)
+					{
+						drawListCache.getChunk(*this, viewMode, x, y, z);
 					}
 				}
 			}
 
+			int batchCount = 1;
+			if (parallelRenderOption.get() && rowCount >= PARALLEL_RENDER_MIN_ROWS)
+			{
+				batchCount = clamp(rowCount / PARALLEL_RENDER_ROWS_PER_BATCH, 1,
+				                   fw().threadPoolGetSize());
+			}
+			std::vector<RowBatch> batches(batchCount);
+			if (batchCount == 1)
+			{
+				drawRows(batches[0], r, 0, rowCount);
+			}
+			else
+			{
+				resolveRenderedStateRefs(battle);
+				while (static_cast<int>(drawCommandBuffers.size()) < batchCount)
+				{
+					drawCommandBuffers.emplace_back(new DrawCommandBuffer());
+				}
+				std::vector<std::shared_future<void>> tasks;
+				for (int i = 1; i < batchCount; i++)
+				{
+					tasks.push_back(fw().threadPoolEnqueue([&, i]() {
+						drawRows(batches[i], *drawCommandBuffers[i], i * rowCount / batchCount,
+						         (i + 1) * rowCount / batchCount);
+					}));
+				}
+				// Main thread takes the first batch instead of idling
+				drawRows(batches[0], *drawCommandBuffers[0], 0, rowCount / batchCount);
+				for (auto &task : tasks)
+				{
+					task.get();
+				}
+				for (int i = 0; i < batchCount; i++)
+				{
+					drawCommandBuffers[i]->submit(r);
+					drawCommandBuffers[i]->reset();
+				}
+			}
+			for (auto &batch : batches)
+			{
+				unitsToDrawSelectionArrows.splice(unitsToDrawSelectionArrows.end(),
+				                                  batch.unitsToDrawSelectionArrows);
+				unitsToDrawFocusArrows.splice(unitsToDrawFocusArrows.end(),
+				                              batch.unitsToDrawFocusArrows);
+				if (batch.fireEncountered && batch.closestFireDistance < closestFireDistance)
+				{
+					fireEncountered = true;
+					closestFireDistance = batch.closestFireDistance;
+					closestFirePosition = batch.closestFirePosition;
+				}
+			}
+
 			// Draw next level, units whose "legs" are below "zTo", projectiles and items moving
 			for (int z = zTo; z < maxZDraw && z < zTo + 1; z++)
 			{
@@ -904,9 +1084,10 @@ void BattleTileView::render()
 					{
 						for (int x = minX; x < maxX; x++)
 						{
-							auto tile = map.getTile(x, y, z);
 							bool visible = battle.getVisible(battle.currentPlayer, x, y, z);
-							auto object_count = tile->drawnObjects[layer].size();
+							auto &chunk = drawListCache.getChunk(*this, viewMode, x, y, z);
+							auto objects = chunk.tileBegin(layer, x);
+							size_t object_count = chunk.tileEnd(layer, x) - objects;
 							size_t obj_id = 0;
 							do
 							{
@@ -914,7 +1095,8 @@ void BattleTileView::render()
 								{
 									break;
 								}
-								auto &obj = tile->drawnObjects[layer][obj_id];
+								auto &entry = objects[obj_id];
+								auto obj = entry.object;
 								bool objectVisible = visible;
 								bool friendly = false;
 								bool hostile = false;
@@ -927,7 +1109,7 @@ void BattleTileView::render()
 								{
 									case TileObject::Type::Unit:
 									{
-										auto u = std::static_pointer_cast<TileObjectBattleUnit>(obj)
+										auto u = static_cast<TileObjectBattleUnit *>(obj)
 										             ->getUnit();
 										if (u->position.z < zTo)
 										{
@@ -1005,7 +1187,8 @@ void BattleTileView::render()
 													if (focusedBySelectedUnits)
 													{
 														unitsToDrawFocusArrows.push_back(
-														    {obj, u->isLarge()});
+														    {obj->shared_from_this(),
+														     u->isLarge()});
 													}
 												}
 											}
@@ -1014,8 +1197,7 @@ void BattleTileView::render()
 									}
 									case TileObject::Type::Item:
 									{
-										draw = std::static_pointer_cast<TileObjectBattleItem>(obj)
-										           ->getItem()
+										draw = static_cast<TileObjectBattleItem *>(obj)->getItem()
 										           ->falling;
 										break;
 									}
@@ -1030,8 +1212,7 @@ void BattleTileView::render()
 									case TileObject::Type::Feature:
 									{
 										draw =
-										    std::static_pointer_cast<TileObjectBattleMapPart>(obj)
-										        ->getOwner()
+										    static_cast<TileObjectBattleMapPart *>(obj)->getOwner()
 										        ->falling;
 										break;
 									}
@@ -1040,7 +1221,7 @@ void BattleTileView::render()
 								}
 								if (draw)
 								{
-									Vec2<float> pos = tileToOffsetScreenCoords(obj->getCenter());
+									Vec2<float> pos = getDrawPosition(entry, screenOffset);
 									obj->draw(r, *this, pos, this->viewMode,
 									          revealWholeMap || objectVisible, currentLevel,
 									          friendly, hostile);
@@ -1223,17 +1404,19 @@ void BattleTileView::render()
 					{
 						for (int x = minX; x < maxX; x++)
 						{
-							auto tile = map.getTile(x, y, z);
-							auto object_count = tile->drawnObjects[layer].size();
+							auto &chunk = drawListCache.getChunk(*this, viewMode, x, y, z);
+							auto objects = chunk.tileBegin(layer, x);
+							size_t object_count = chunk.tileEnd(layer, x) - objects;
 
 							for (size_t obj_id = 0; obj_id < object_count; obj_id++)
 							{
-								auto &obj = tile->drawnObjects[layer][obj_id];
+								auto &entry = objects[obj_id];
+								auto obj = entry.object;
 								switch (obj->getType())
 								{
 									case TileObject::Type::Unit:
 									{
-										auto u = std::static_pointer_cast<TileObjectBattleUnit>(obj)
+										auto u = static_cast<TileObjectBattleUnit *>(obj)
 										             ->getUnit();
 										bool objectVisible =
 										    !u->isConscious() || u->owner == battle.currentPlayer ||
@@ -1245,7 +1428,7 @@ void BattleTileView::render()
 										    battle.currentPlayer->isRelatedTo(u->owner) ==
 										    Organisation::Relation::Hostile;
 
-										unitsToDraw.emplace_back(obj,
+										unitsToDraw.emplace_back(obj->shared_from_this(),
 										                         revealWholeMap || objectVisible,
 										                         obj->getOwningTile()->position.z -
 										                             (battle.battleViewZLevel - 1),
@@ -1302,19 +1485,21 @@ void BattleTileView::render()
 					{
 						for (int x = minX; x < maxX; x++)
 						{
-							auto tile = map.getTile(x, y, z);
 							bool visible = battle.getVisible(battle.currentPlayer, x, y, z);
-							auto object_count = tile->drawnObjects[layer].size();
+							auto &chunk = drawListCache.getChunk(*this, viewMode, x, y, z);
+							auto objects = chunk.tileBegin(layer, x);
+							size_t object_count = chunk.tileEnd(layer, x) - objects;
 
 							for (size_t obj_id = 0; obj_id < object_count; obj_id++)
 							{
-								auto &obj = tile->drawnObjects[layer][obj_id];
+								auto &entry = objects[obj_id];
+								auto obj = entry.object;
 								bool objectVisible = visible;
 								switch (obj->getType())
 								{
 									case TileObject::Type::Unit:
 									{
-										auto u = std::static_pointer_cast<TileObjectBattleUnit>(obj)
+										auto u = static_cast<TileObjectBattleUnit *>(obj)
 										             ->getUnit();
 										objectVisible =
 										    !u->isConscious() || u->owner == battle.currentPlayer ||
@@ -1326,7 +1511,7 @@ void BattleTileView::render()
 										    battle.currentPlayer->isRelatedTo(u->owner) ==
 										    Organisation::Relation::Hostile;
 
-										unitsToDraw.emplace_back(obj,
+										unitsToDraw.emplace_back(obj->shared_from_this(),
 										                         revealWholeMap || objectVisible,
 										                         obj->getOwningTile()->position.z -
 										                             (battle.battleViewZLevel - 1),
@@ -1365,7 +1550,7 @@ void BattleTileView::render()
 										if (currentLevel == 0)
 										{
 											itemsToDraw.emplace_back(
-											    obj, revealWholeMap || visible,
+											    obj->shared_from_this(), revealWholeMap || visible,
 											    obj->getOwningTile()->position.z -
 											        (battle.battleViewZLevel - 1));
 										}
@@ -1375,19 +1560,16 @@ void BattleTileView::render()
 									{
 										if (visible && ticksUntilFireSound == 0)
 										{
-											auto h =
-											    std::static_pointer_cast<TileObjectBattleHazard>(
-											        obj)
-											        ->getHazard();
-											if (h->hazardType->fire)
+											auto h = static_cast<TileObjectBattleHazard *>(obj);
+											if (h->getField().getHazardType(h->getIndex())->fire)
 											{
-												auto distance =
-												    glm::length(centerPos - h->position);
+												auto position = h->getPosition();
+												auto distance = glm::length(centerPos - position);
 												if (distance < closestFireDistance)
 												{
 													fireEncountered = true;
 													closestFireDistance = distance;
-													closestFirePosition = h->position;
+													closestFirePosition = position;
 												}
 											}
 										}
@@ -1395,9 +1577,16 @@ void BattleTileView::render()
 									default:
 										break;
 								}
-								Vec2<float> pos = tileToOffsetScreenCoords(obj->getCenter());
-								obj->draw(r, *this, pos, this->viewMode,
-								          revealWholeMap || objectVisible, currentLevel);
+								Vec2<float> pos = getDrawPosition(entry, screenOffset);
+								if (entry.cached)
+								{
+									entry.drawCached(r, pos, revealWholeMap || objectVisible);
+								}
+								else
+								{
+									obj->draw(r, *this, pos, this->viewMode,
+									          revealWholeMap || objectVisible, currentLevel);
+								}
 							}
 						}
 					}
@@ -1413,17 +1602,19 @@ void BattleTileView::render()
 					{
 						for (int x = minX; x < maxX; x++)
 						{
-							auto tile = map.getTile(x, y, z);
-							auto object_count = tile->drawnObjects[layer].size();
+							auto &chunk = drawListCache.getChunk(*this, viewMode, x, y, z);
+							auto objects = chunk.tileBegin(layer, x);
+							size_t object_count = chunk.tileEnd(layer, x) - objects;
 
 							for (size_t obj_id = 0; obj_id < object_count; obj_id++)
 							{
-								auto &obj = tile->drawnObjects[layer][obj_id];
+								auto &entry = objects[obj_id];
+								auto obj = entry.object;
 								switch (obj->getType())
 								{
 									case TileObject::Type::Unit:
 									{
-										auto u = std::static_pointer_cast<TileObjectBattleUnit>(obj)
+										auto u = static_cast<TileObjectBattleUnit *>(obj)
 										             ->getUnit();
 										bool objectVisible =
 										    !u->isConscious() || u->owner == battle.currentPlayer ||
@@ -1435,7 +1626,7 @@ void BattleTileView::render()
 										    battle.currentPlayer->isRelatedTo(u->owner) ==
 										    Organisation::Relation::Hostile;
 
-										unitsToDraw.emplace_back(obj,
+										unitsToDraw.emplace_back(obj->shared_from_this(),
 										                         revealWholeMap || objectVisible,
 										                         obj->getOwningTile()->position.z -
 										                             (battle.battleViewZLevel - 1),
@@ -12,6 +12,7 @@ namespace OpenApoc
 
 class TileObjectBattleUnit;
 class Battle;
+class DrawCommandBuffer;
 class Form;
 class Image;
 
@@ -80,6 +81,15 @@ class BattleTileView : public TileView
 	int psiIconTicksAccumulated = 0;
 	int focusAnimationTicksAccumulated = 0;
 
+	// One per thread generating draw commands, kept around to reuse their storage
+	std::vector<up<DrawCommandBuffer>> drawCommandBuffers;
+
+  protected:
+	// Moves the icon animations, or the hidden display's bar, on by a frame
+	void advanceAnimations();
+	// Draws the map as seen from the current camera, which may be a recording of it
+	void renderMap(Renderer &r);
+
   public:
 	BattleTileView(TileMap &map, Vec3<int> isoTileSize, Vec2<int> stratTileSize,
 	               TileViewMode initialMode, Vec3<float> screenCenterTile, GameState &gameState);
@@ -91,7 +91,11 @@ void CityTileView::eventOccurred(Event *e)
 void CityTileView::render()
 {
 	TRACE_FN;
-	Renderer &r = *fw().renderer;
+	renderMap(*fw().renderer);
+}
+
+void CityTileView::renderMap(Renderer &r)
+{
 	r.clear();
 	r.setPalette(this->pal);
 
@@ -108,6 +112,8 @@ void CityTileView::render()
 	int minY = std::max(0, topRight.y);
 	int maxY = std::min(map.size.y, bottomLeft.y);
 
+	Vec2<float> screenOffset = getScreenOffset();
+
 	for (int z = 0; z < maxZDraw; z++)
 	{
 		for (unsigned int layer = 0; layer < map.getLayerCount(); layer++)
@@ -116,15 +122,22 @@ void CityTileView::render()
 			{
 				for (int x = minX; x < maxX; x++)
 				{
-					auto tile = map.getTile(x, y, z);
-					auto object_count = tile->drawnObjects[layer].size();
-					for (size_t obj_id = 0; obj_id < object_count; obj_id++)
+					auto &chunk = drawListCache.getChunk(*this, viewMode, x, y, z);
+					auto end = chunk.tileEnd(layer, x);
+					for (auto entry = chunk.tileBegin(layer, x); entry != end; entry++)
 					{
-						auto &obj = tile->drawnObjects[layer][obj_id];
-						Vec2<float> pos = tileToOffsetScreenCoords(obj->getCenter());
-						obj->draw(r, *this, pos, this->viewMode);
+						auto pos = getDrawPosition(*entry, screenOffset);
+						if (entry->cached)
+						{
+							entry->drawCached(r, pos, true);
+						}
+						else
+						{
+							entry->object->draw(r, *this, pos, this->viewMode);
+						}
 					}
 #ifdef PATHFINDING_DEBUG
+					auto tile = map.getTile(x, y, z);
 					if (tile->pathfindingDebugFlag && viewMode == TileViewMode::Isometric)
 						r.draw(selectedTileImageFront,
 						       tileToOffsetScreenCoords(Vec3<int>{x, y, z}) -
@@ -150,9 +163,10 @@ void CityTileView::render()
 			    Vec3<int>{(b.second->bounds.p0.x + b.second->bounds.p1.x) / 2,
 			              (b.second->bounds.p0.y + b.second->bounds.p1.y) / 2, 2});
 
-			float radius =
-			    70.0f * (float)b.second->ticksDetectionTimeOut / (float)TICKS_DETECTION_TIMEOUT +
-			    30.0f;
+			auto ticks = state.gameTime.getTicks();
+			auto timeOutEnd = b.second->ticksDetectionTimeOutEnd;
+			auto timeOut = timeOutEnd > ticks ? timeOutEnd - ticks : 0;
+			float radius = 70.0f * (float)timeOut / (float)TICKS_DETECTION_TIMEOUT + 30.0f;
 			float interval = M_PI / 8.0f;
 			float angle = 0.0f;
 			Vec2<float> posNew = {pos.x + radius, pos.y};
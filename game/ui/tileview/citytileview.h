@@ -9,6 +9,7 @@ namespace OpenApoc
 
 class Image;
 class GameState;
+class Renderer;
 
 class CityTileView : public TileView
 {
@@ -22,6 +23,10 @@ class CityTileView : public TileView
 
 	bool DEBUG_SHOW_ALIEN_CREW = false;
 
+  protected:
+	// Draws the map as seen from the current camera, which may be a recording of it
+	void renderMap(Renderer &r);
+
   private:
 	GameState &state;
 	sp<Image> selectedTileImageBack;
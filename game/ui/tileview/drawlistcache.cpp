@@ -0,0 +1,146 @@
+#include "game/ui/tileview/drawlistcache.h"
+#include "framework/renderer.h"
+#include "game/state/tileview/tileobject.h"
+#include <iterator>
+
+namespace OpenApoc
+{
+
+namespace
+{
+bool isDynamic(TileObject::Type type)
+{
+	switch (type)
+	{
+		case TileObject::Type::Ground:
+		case TileObject::Type::LeftWall:
+		case TileObject::Type::RightWall:
+		case TileObject::Type::Feature:
+		case TileObject::Type::Scenery:
+			return false;
+		default:
+			return true;
+	}
+}
+
+DrawListEntry makeEntry(TileObject &object, const TileTransform &transform, TileViewMode mode)
+{
+	DrawListEntry entry;
+	entry.object = &object;
+	entry.dynamic = isDynamic(object.getType()) || object.isMoving();
+	if (!entry.dynamic)
+	{
+		entry.screenPosition = transform.tileToScreenCoords(object.getCenter());
+		entry.cached =
+		    object.getStaticSprites(mode, entry.sprite, entry.overlaySprite, entry.spriteOffset);
+	}
+	return entry;
+}
+} // anonymous namespace
+
+void DrawListEntry::drawCached(Renderer &r, Vec2<float> position, bool visible) const
+{
+	if (sprite)
+	{
+		TileObject::drawTinted(r, sprite, position + spriteOffset, visible);
+	}
+	if (overlaySprite)
+	{
+		TileObject::drawTinted(r, overlaySprite, position + spriteOffset, visible);
+	}
+}
+
+DrawListCache::DrawListCache(TileMap &map, TileViewMode mode)
+    : map(map), mode(mode), chunks(map.getDrawChunksPerRow() * map.size.y * map.size.z)
+{
+}
+
+void DrawListCache::clear()
+{
+	for (auto &chunk : chunks)
+	{
+		chunk.valid = false;
+		chunk.layers.clear();
+		chunk.tileOffsets.clear();
+		chunk.tileRevisions.clear();
+	}
+}
+
+const DrawListChunk &DrawListCache::getChunk(const TileTransform &transform,
+                                             TileViewMode mode, int x, int y, int z)
+{
+	// Cached screen positions are only valid for the mode they were calculated in
+	if (mode != this->mode)
+	{
+		clear();
+		this->mode = mode;
+	}
+	int chunkX = x / DRAW_CHUNK_SIZE;
+	auto &chunk = chunks[(z * map.size.y + y) * map.getDrawChunksPerRow() + chunkX];
+	auto revision = map.getDrawChunkRevision(chunkX, y, z);
+	if (!chunk.valid || chunk.revision != revision)
+	{
+		rebuildChunk(chunk, transform, chunkX, y, z);
+		chunk.revision = revision;
+		chunk.valid = true;
+	}
+	return chunk;
+}
+
+void DrawListCache::rebuildChunk(DrawListChunk &chunk, const TileTransform &transform, int chunkX,
+                                 int y, int z)
+{
+	auto layerCount = map.getLayerCount();
+	chunk.layers.resize(layerCount);
+	chunk.tileOffsets.resize(layerCount);
+	chunk.tileRevisions.resize(DRAW_CHUNK_SIZE, 0);
+	// A unit moving only changes the tiles it left and entered, the rest are moved over as they are
+	bool tileChanged[DRAW_CHUNK_SIZE];
+	for (int i = 0; i < DRAW_CHUNK_SIZE; i++)
+	{
+		int x = chunkX * DRAW_CHUNK_SIZE + i;
+		if (x >= map.size.x)
+		{
+			tileChanged[i] = false;
+			continue;
+		}
+		auto revision = map.getTile(x, y, z)->drawnObjectsRevision;
+		tileChanged[i] = !chunk.valid || chunk.tileRevisions[i] != revision;
+		chunk.tileRevisions[i] = revision;
+	}
+	for (unsigned int layer = 0; layer < layerCount; layer++)
+	{
+		auto &entries = chunk.layers[layer];
+		auto &offsets = chunk.tileOffsets[layer];
+		std::swap(entries, previousEntries);
+		std::swap(offsets, previousOffsets);
+		entries.clear();
+		offsets.clear();
+		for (int i = 0; i < DRAW_CHUNK_SIZE; i++)
+		{
+			offsets.push_back((unsigned)entries.size());
+			int x = chunkX * DRAW_CHUNK_SIZE + i;
+			if (x >= map.size.x)
+			{
+				continue;
+			}
+			if (!tileChanged[i])
+			{
+				entries.insert(entries.end(),
+				               std::make_move_iterator(previousEntries.begin() +
+				                                       previousOffsets[i]),
+				               std::make_move_iterator(previousEntries.begin() +
+				                                       previousOffsets[i + 1]));
+				continue;
+			}
+			for (auto &obj : map.getTile(x, y, z)->drawnObjects[layer])
+			{
+				entries.push_back(makeEntry(*obj, transform, mode));
+			}
+		}
+		offsets.push_back((unsigned)entries.size());
+	}
+	previousEntries.clear();
+}
+
+} // namespace OpenApoc
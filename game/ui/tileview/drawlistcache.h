@@ -0,0 +1,98 @@
+#pragma once
+
+#include "game/state/tileview/tile.h"
+#include "library/sp.h"
+#include "library/vec.h"
+#include <vector>
+
+namespace OpenApoc
+{
+
+class Image;
+class Renderer;
+class TileObject;
+class TileMap;
+class TileTransform;
+
+class DrawListEntry
+{
+  public:
+	// Only valid until the entry's tile changes, when the chunk is rebuilt before it's used again
+	TileObject *object = nullptr;
+	// Screen position relative to the view origin, only kept up to date for static objects
+	Vec2<float> screenPosition;
+	// Dynamic objects (units, vehicles, projectiles etc.) have their position calculated at render
+	// time, as their owner may change it (for example, unit's height) without moving the object
+	bool dynamic = false;
+	// Static objects whose sprites don't change by themselves (see
+	// TileObject::getStaticSprites()) are drawn from these rather than by the object
+	bool cached = false;
+	sp<Image> sprite;
+	sp<Image> overlaySprite;
+	Vec2<float> spriteOffset;
+
+	// Draws the cached sprites at the object's screen position, in black if it's not visible
+	void drawCached(Renderer &r, Vec2<float> position, bool visible) const;
+};
+
+// Flattened, pre-sorted list of everything drawn on a DRAW_CHUNK_SIZE-wide strip of tiles
+class DrawListChunk
+{
+  public:
+	// Revision of the strip in the TileMap the chunk was built from
+	unsigned int revision = 0;
+	// Revision of each tile the chunk was built from, tiles that didn't change since keep their
+	// entries when the chunk is rebuilt
+	std::vector<unsigned int> tileRevisions;
+	bool valid = false;
+	// Per layer, entries of every tile in the strip, ordered by x and then by draw order
+	std::vector<std::vector<DrawListEntry>> layers;
+	// Per layer, index of the first entry of each tile (DRAW_CHUNK_SIZE + 1 values)
+	std::vector<std::vector<unsigned int>> tileOffsets;
+
+	// Returns pointer to the first entry drawn on the tile at x in the layer
+	const DrawListEntry *tileBegin(unsigned int layer, int x) const
+	{
+		return layers[layer].data() + tileOffsets[layer][x % DRAW_CHUNK_SIZE];
+	}
+	// Returns pointer past the last entry drawn on the tile at x in the layer
+	const DrawListEntry *tileEnd(unsigned int layer, int x) const
+	{
+		return layers[layer].data() + tileOffsets[layer][x % DRAW_CHUNK_SIZE + 1];
+	}
+};
+
+// Per-view cache of the tile map's drawn objects. Chunks are only rebuilt when an object in them
+// was added, removed or moved, and then only for the tiles that changed, so static scenery and
+// its sprites are reused across frames, while positions of dynamic objects are still calculated
+// every frame
+class DrawListCache
+{
+  private:
+	TileMap &map;
+	TileViewMode mode;
+	std::vector<DrawListChunk> chunks;
+	// Entries of the layer being rebuilt as they were before, kept to reuse their storage
+	std::vector<DrawListEntry> previousEntries;
+	std::vector<unsigned int> previousOffsets;
+
+	void rebuildChunk(DrawListChunk &chunk, const TileTransform &transform, int chunkX, int y,
+	                  int z);
+
+  public:
+	DrawListCache(TileMap &map, TileViewMode mode);
+
+	// Returns the chunk containing the tile at x,y,z, rebuilding it if it is out of date
+	const DrawListChunk &getChunk(const TileTransform &transform, TileViewMode mode, int x, int y,
+	                              int z);
+	// Returns the chunk containing the tile at x,y,z as it is, without checking if it's up to date.
+	// Does not modify the cache, so it can be used from multiple threads at once after getChunk()
+	// was called for every chunk that is going to be accessed
+	const DrawListChunk &getCachedChunk(int x, int y, int z) const
+	{
+		return chunks[(z * map.size.y + y) * map.getDrawChunksPerRow() + x / DRAW_CHUNK_SIZE];
+	}
+	void clear();
+};
+
+} // namespace OpenApoc
@@ -3,6 +3,7 @@
 #include "framework/logger.h"
 #include "framework/stage.h"
 #include "game/state/tileview/tile.h"
+#include "game/ui/tileview/drawlistcache.h"
 #include "library/colour.h"
 #include "library/sp.h"
 #include "library/vec.h"
@@ -37,6 +38,15 @@ class TileView : public Stage, public TileTransform
 
 	Vec3<int> selectedTilePosition;
 
+	DrawListCache drawListCache;
+
+	// Returns where the cached entry should be drawn, given the current screen offset
+	Vec2<float> getDrawPosition(const DrawListEntry &entry, Vec2<float> screenOffset) const
+	{
+		return entry.dynamic ? tileToScreenCoords(entry.object->getCenter()) + screenOffset
+		                     : entry.screenPosition + screenOffset;
+	}
+
   public:
 	int maxZDraw;
 	Vec3<float> centerPos;
@@ -0,0 +1,29 @@
+#include "library/allocationcount.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+std::atomic<uint64_t> allocationCount{0};
+} // anonymous namespace
+
+void *operator new(size_t size)
+{
+	allocationCount++;
+	if (auto ptr = std::malloc(size ? size : 1))
+	{
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+
+namespace OpenApoc
+{
+
+uint64_t getGlobalAllocationCount() { return allocationCount.load(); }
+
+} // namespace OpenApoc
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+namespace OpenApoc
+{
+
+// Number of times the global operator new was called so far, from any thread. The counting
+// replacements for the global operator new and delete live in the separate OpenApoc_AllocationCount
+// library, which only the bench and test_arena link against
+uint64_t getGlobalAllocationCount();
+
+} // namespace OpenApoc
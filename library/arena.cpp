@@ -0,0 +1,103 @@
+#include "library/arena.h"
+#include <algorithm>
+#include <new>
+
+namespace OpenApoc
+{
+
+MemoryArena::Scope::Scope(MemoryArena &arena)
+    : arena(arena), block(arena.currentBlock), offset(arena.offset)
+{
+	arena.scopeDepth++;
+}
+
+MemoryArena::Scope::~Scope()
+{
+	arena.scopeDepth--;
+	arena.rewind(block, offset);
+}
+
+MemoryArena::MemoryArena(size_t blockSize) : blockSize(blockSize) {}
+
+void *MemoryArena::allocate(size_t size, size_t alignment)
+{
+	allocationCount++;
+	if (scopeDepth == 0)
+	{
+		heapAllocationCount++;
+		return ::operator new(size);
+	}
+	while (true)
+	{
+		if (currentBlock == blocks.size())
+		{
+			heapAllocationCount++;
+			blocks.emplace_back(std::max(blockSize, size + alignment));
+		}
+		auto &block = blocks[currentBlock];
+		auto base = reinterpret_cast<uintptr_t>(block.data.get());
+		auto start = ((base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+		if (start + size <= block.size)
+		{
+			offset = start + size;
+			return block.data.get() + start;
+		}
+		// Blocks left over from earlier scopes are reused before a new one is made
+		currentBlock++;
+		offset = 0;
+	}
+}
+
+void MemoryArena::deallocate(void *ptr)
+{
+	if (!owns(ptr))
+	{
+		::operator delete(ptr);
+	}
+}
+
+size_t MemoryArena::getCapacity() const
+{
+	size_t capacity = 0;
+	for (auto &block : blocks)
+	{
+		capacity += block.size;
+	}
+	return capacity;
+}
+
+bool MemoryArena::owns(const void *ptr) const
+{
+	auto p = static_cast<const char *>(ptr);
+	for (auto &block : blocks)
+	{
+		if (p >= block.data.get() && p < block.data.get() + block.size)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void MemoryArena::rewind(size_t block, size_t offset)
+{
+	currentBlock = block;
+	this->offset = offset;
+	// Nothing is alive when rewinding to the very start, so merge the blocks into one big enough
+	// to fit everything, and subsequent scopes don't have to jump between blocks
+	if (block == 0 && offset == 0 && blocks.size() > 1)
+	{
+		auto capacity = getCapacity();
+		blocks.clear();
+		heapAllocationCount++;
+		blocks.emplace_back(capacity);
+	}
+}
+
+MemoryArena &tickArena()
+{
+	static thread_local MemoryArena arena;
+	return arena;
+}
+
+} // namespace OpenApoc
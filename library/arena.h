@@ -0,0 +1,131 @@
+#pragma once
+
+#include "library/sp.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <new>
+#include <set>
+#include <type_traits>
+#include <vector>
+
+namespace OpenApoc
+{
+
+// Bump allocator for short-lived data. Memory is handed out linearly from large blocks and is
+// only reclaimed all at once, when the Scope that was opened before the allocation is closed.
+// Once the blocks have grown to fit the busiest scope, no more heap allocations are made.
+// Allocations made while no scope is open go straight to the heap, so arena containers are
+// always safe to use, they just don't benefit from the arena then.
+class MemoryArena
+{
+  public:
+	static const size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+	// Releases everything allocated from the arena since its construction on destruction.
+	// Scopes must be strictly nested, and nothing allocated within a scope may outlive it
+	class Scope
+	{
+	  private:
+		MemoryArena &arena;
+		size_t block;
+		size_t offset;
+
+	  public:
+		Scope(MemoryArena &arena);
+		~Scope();
+		Scope(const Scope &) = delete;
+		Scope &operator=(const Scope &) = delete;
+	};
+
+	MemoryArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+	MemoryArena(const MemoryArena &) = delete;
+	MemoryArena &operator=(const MemoryArena &) = delete;
+
+	void *allocate(size_t size, size_t alignment);
+	// Only frees heap fallback allocations, arena memory is released by closing the scope
+	void deallocate(void *ptr);
+
+	// Constructs an object in the arena, its destructor is never called
+	template <typename T, typename... Args> T *create(Args &&... args)
+	{
+		static_assert(std::is_trivially_destructible<T>::value,
+		              "Arena objects are never destroyed");
+		return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	bool inScope() const { return scopeDepth > 0; }
+	// Total amount of allocations requested from the arena
+	uint64_t getAllocationCount() const { return allocationCount; }
+	// Amount of allocations the arena had to make on the heap, either for a new block or because
+	// no scope was open. Stays the same across scopes once the arena has warmed up
+	uint64_t getHeapAllocationCount() const { return heapAllocationCount; }
+	// Total size of all blocks owned by the arena
+	size_t getCapacity() const;
+
+  private:
+	class Block
+	{
+	  public:
+		up<char[]> data;
+		size_t size;
+
+		Block(size_t size) : data(new char[size]), size(size) {}
+	};
+
+	std::vector<Block> blocks;
+	size_t currentBlock = 0;
+	size_t offset = 0;
+	size_t blockSize;
+	int scopeDepth = 0;
+	uint64_t allocationCount = 0;
+	uint64_t heapAllocationCount = 0;
+
+	bool owns(const void *ptr) const;
+	void rewind(size_t block, size_t offset);
+};
+
+// Arena of the calling thread. Game ticks open a scope on it, so everything allocated by arena
+// containers during the tick is released at once when the tick ends
+MemoryArena &tickArena();
+
+// Standard allocator handing out memory from a MemoryArena, the calling thread's tick arena
+// by default
+template <typename T> class ArenaAllocator
+{
+  public:
+	using value_type = T;
+
+	MemoryArena *arena;
+
+	ArenaAllocator() : arena(&tickArena()) {}
+	ArenaAllocator(MemoryArena &arena) : arena(&arena) {}
+	template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+	T *allocate(size_t count)
+	{
+		return static_cast<T *>(arena->allocate(count * sizeof(T), alignof(T)));
+	}
+	void deallocate(T *ptr, size_t) { arena->deallocate(ptr); }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+	return a.arena == b.arena;
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+	return a.arena != b.arena;
+}
+
+// Containers for temporary data that does not outlive the current tick
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+template <typename T> using ArenaList = std::list<T, ArenaAllocator<T>>;
+template <typename T, typename Compare = std::less<T>>
+using ArenaSet = std::set<T, Compare, ArenaAllocator<T>>;
+
+} // namespace OpenApoc
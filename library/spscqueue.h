@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace OpenApoc
+{
+
+// Fixed size lock-free queue for passing values from exactly one producer thread to exactly one
+// consumer thread, neither of which ever waits for the other. Several producers have to agree on
+// who's pushing among themselves.
+// Capacity must be a power of two, one slot is always left empty to tell a full queue apart from
+// an empty one.
+template <typename T, size_t Capacity> class SpscQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+	              "SpscQueue capacity must be a power of two");
+
+  public:
+	// Producer only, returns false (and leaves 'value' alone) if the queue is full
+	bool push(T &&value)
+	{
+		auto tail = this->tail.load(std::memory_order_relaxed);
+		auto next = (tail + 1) & (Capacity - 1);
+		if (next == this->head.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		slots[tail] = std::move(value);
+		this->tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only, returns false if the queue is empty
+	bool pop(T &value)
+	{
+		auto head = this->head.load(std::memory_order_relaxed);
+		if (head == this->tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		value = std::move(slots[head]);
+		// Don't keep whatever the value holds on to alive until the slot is reused
+		slots[head] = T();
+		this->head.store((head + 1) & (Capacity - 1), std::memory_order_release);
+		return true;
+	}
+
+	// Only a hint while the other thread is using the queue
+	bool empty() const
+	{
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+
+	// Only a hint while the other thread is using the queue
+	size_t size() const
+	{
+		return (tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire)) &
+		       (Capacity - 1);
+	}
+
+  private:
+	T slots[Capacity];
+	// Next slot to pop, only written by the consumer
+	std::atomic<size_t> head{0};
+	// Next slot to push to, only written by the producer
+	std::atomic<size_t> tail{0};
+};
+
+} // namespace OpenApoc
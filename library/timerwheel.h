@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+namespace OpenApoc
+{
+
+// Hierarchical timing wheel. Timers are kept in buckets of coarser and coarser granularity and
+// are only sorted out once their bucket comes due, so scheduling is constant time and advancing
+// the time skips over empty stretches instead of looking at every timer every tick.
+// Timers due on the same tick expire in order of priority, then in the order they were scheduled.
+template <typename T> class TimerWheel
+{
+  public:
+	static const int SLOT_BITS = 6;
+	static const int SLOT_COUNT = 1 << SLOT_BITS;
+	static const int LEVEL_COUNT = 4;
+
+	TimerWheel(uint64_t currentTick = 0) : currentTick(currentTick) {}
+
+	// The first tick that has not been advanced through yet
+	uint64_t getCurrentTick() const { return currentTick; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	// The tick the earliest timer is due at, or the largest possible tick if there's none
+	uint64_t getNextExpiry() const
+	{
+		// Every timer of a level is due after all the timers of the levels below
+		for (int level = 0; level < LEVEL_COUNT; level++)
+		{
+			if (levelCounts[level] == 0)
+			{
+				continue;
+			}
+			auto first = (currentTick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1);
+			for (auto slot = first; slot < SLOT_COUNT; slot++)
+			{
+				if (!slots[level][slot].empty())
+				{
+					return getEarliest(slots[level][slot]);
+				}
+			}
+		}
+		return getEarliest(overflow);
+	}
+
+	// Timers scheduled for a tick that was already advanced through expire on the next advance
+	void schedule(uint64_t tick, T value, int priority = 0)
+	{
+		insert(Entry{std::max(tick, currentTick), priority, nextSequence++, std::move(value)});
+		count++;
+	}
+
+	// Moves the time forward up to and including 'tick', calling 'expire' with every timer due
+	// until then. Timers scheduled by 'expire' are handled in the same call if they're due
+	template <typename Callback> void advance(uint64_t tick, Callback expire)
+	{
+		while (currentTick <= tick)
+		{
+			auto &slot = slots[0][currentTick & (SLOT_COUNT - 1)];
+			while (!slot.empty())
+			{
+				std::vector<Entry> due;
+				due.swap(slot);
+				levelCounts[0] -= due.size();
+				count -= due.size();
+				// Cascading can mix up the order of timers within a slot
+				std::sort(due.begin(), due.end(), [](const Entry &a, const Entry &b) {
+					if (a.priority != b.priority)
+					{
+						return a.priority < b.priority;
+					}
+					return a.sequence < b.sequence;
+				});
+				for (auto &entry : due)
+				{
+					expire(entry.value);
+				}
+			}
+			currentTick = getNextTick(tick);
+			cascade();
+		}
+	}
+
+	void clear()
+	{
+		for (auto &level : slots)
+		{
+			for (auto &slot : level)
+			{
+				slot.clear();
+			}
+		}
+		overflow.clear();
+		std::fill(std::begin(levelCounts), std::end(levelCounts), 0);
+		count = 0;
+	}
+
+  private:
+	class Entry
+	{
+	  public:
+		uint64_t tick;
+		int priority;
+		uint64_t sequence;
+		T value;
+	};
+
+	std::vector<Entry> slots[LEVEL_COUNT][SLOT_COUNT];
+	// Timers too far in the future for the wheel
+	std::vector<Entry> overflow;
+	size_t levelCounts[LEVEL_COUNT] = {};
+	uint64_t currentTick;
+	uint64_t nextSequence = 0;
+	size_t count = 0;
+
+	void insert(Entry entry)
+	{
+		for (int level = 0; level < LEVEL_COUNT; level++)
+		{
+			int shift = SLOT_BITS * (level + 1);
+			// A level can hold every tick that only differs from the current one in its bits
+			if ((entry.tick >> shift) == (currentTick >> shift))
+			{
+				auto slot = (entry.tick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1);
+				slots[level][slot].push_back(std::move(entry));
+				levelCounts[level]++;
+				return;
+			}
+		}
+		overflow.push_back(std::move(entry));
+	}
+
+	// Where to go after the current tick: the next one if the lowest level has timers, otherwise
+	// the start of the next bucket of the lowest level that has any, as nothing can be due before
+	uint64_t getNextTick(uint64_t limit) const
+	{
+		int level = 0;
+		while (level < LEVEL_COUNT && levelCounts[level] == 0)
+		{
+			level++;
+		}
+		if (level == 0)
+		{
+			return currentTick + 1;
+		}
+		auto granularity = (uint64_t)1 << (SLOT_BITS * level);
+		auto next = (currentTick / granularity + 1) * granularity;
+		// Don't skip past the requested tick, so that timers scheduled afterwards still end up
+		// in the right bucket
+		return std::min(next, limit + 1);
+	}
+
+	// Spreads the timers of the buckets that start at the current tick into finer ones
+	void cascade()
+	{
+		if (currentTick % ((uint64_t)1 << (SLOT_BITS * LEVEL_COUNT)) == 0)
+		{
+			redistribute(overflow);
+		}
+		for (int level = LEVEL_COUNT - 1; level > 0; level--)
+		{
+			if (currentTick % ((uint64_t)1 << (SLOT_BITS * level)) != 0)
+			{
+				continue;
+			}
+			auto &slot = slots[level][(currentTick >> (SLOT_BITS * level)) & (SLOT_COUNT - 1)];
+			levelCounts[level] -= slot.size();
+			redistribute(slot);
+		}
+	}
+
+	static uint64_t getEarliest(const std::vector<Entry> &entries)
+	{
+		auto earliest = std::numeric_limits<uint64_t>::max();
+		for (auto &entry : entries)
+		{
+			earliest = std::min(earliest, entry.tick);
+		}
+		return earliest;
+	}
+
+	void redistribute(std::vector<Entry> &entries)
+	{
+		std::vector<Entry> moved;
+		moved.swap(entries);
+		for (auto &entry : moved)
+		{
+			insert(std::move(entry));
+		}
+	}
+};
+
+} // namespace OpenApoc
@@ -201,7 +201,8 @@ template <typename T, typename Generator> T randDamage025075(Generator &g, T val
 	std::uniform_int_distribution<T> dist(min, max);
 	return dist(g);
 }
-template <typename T, typename Generator> T listRandomiser(Generator &g, const std::list<T> &list)
+template <typename T, typename Alloc, typename Generator>
+T listRandomiser(Generator &g, const std::list<T, Alloc> &list)
 {
 	// we can't do index lookups in a list, so we just have to iterate N times
 	if (list.size() == 1)
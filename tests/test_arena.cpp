@@ -0,0 +1,107 @@
+#include "framework/configfile.h"
+#include "framework/logger.h"
+#include "library/allocationcount.h"
+#include "library/arena.h"
+
+using namespace OpenApoc;
+
+namespace
+{
+// Fills some arena containers the way a game tick would
+int simulateTick(MemoryArena &arena, int size)
+{
+	MemoryArena::Scope scope(arena);
+	ArenaSet<int> set{ArenaAllocator<int>(arena)};
+	ArenaList<int> list{ArenaAllocator<int>(arena)};
+	ArenaVector<int> vector{ArenaAllocator<int>(arena)};
+	for (int i = 0; i < size; i++)
+	{
+		set.insert(size - i);
+		list.push_front(i);
+		vector.push_back(i);
+	}
+	// Nested scopes release only what was allocated within them
+	{
+		MemoryArena::Scope nestedScope(arena);
+		ArenaVector<int> nested(size, 1, ArenaAllocator<int>(arena));
+	}
+	return (int)set.size() + (int)list.size() + (int)vector.size();
+}
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+
+	MemoryArena arena(1024);
+
+	if (simulateTick(arena, 1000) != 3000)
+	{
+		LogError("unexpected container contents");
+		return EXIT_FAILURE;
+	}
+	if (arena.inScope())
+	{
+		LogError("scope not closed");
+		return EXIT_FAILURE;
+	}
+
+	// The first tick outgrew the initial block, so it will have hit the heap, but once the arena
+	// has warmed up ticks of the same size must not allocate anything on the heap, neither through
+	// the arena nor anywhere else (counted by the global operator new)
+	simulateTick(arena, 1000);
+	auto heapAllocations = arena.getHeapAllocationCount();
+	auto globalAllocations = getGlobalAllocationCount();
+	auto capacity = arena.getCapacity();
+	for (int i = 0; i < 100; i++)
+	{
+		simulateTick(arena, 1000);
+	}
+	auto globalAllocationsMade = getGlobalAllocationCount() - globalAllocations;
+	if (arena.getHeapAllocationCount() != heapAllocations)
+	{
+		LogError("steady state made %u heap allocations through the arena",
+		         (unsigned)(arena.getHeapAllocationCount() - heapAllocations));
+		return EXIT_FAILURE;
+	}
+	if (globalAllocationsMade != 0)
+	{
+		LogError("steady state made %u global heap allocations", (unsigned)globalAllocationsMade);
+		return EXIT_FAILURE;
+	}
+	if (arena.getCapacity() != capacity)
+	{
+		LogError("arena grew from %u to %u in steady state", (unsigned)capacity,
+		         (unsigned)arena.getCapacity());
+		return EXIT_FAILURE;
+	}
+
+	// Alignment must be respected
+	{
+		MemoryArena::Scope scope(arena);
+		arena.allocate(1, 1);
+		auto ptr = arena.allocate(sizeof(double), alignof(double));
+		if (reinterpret_cast<uintptr_t>(ptr) % alignof(double) != 0)
+		{
+			LogError("misaligned allocation");
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Without a scope allocations must go to the heap and be freed there
+	{
+		auto before = arena.getHeapAllocationCount();
+		ArenaVector<int> vector{ArenaAllocator<int>(arena)};
+		vector.push_back(1);
+		if (arena.getHeapAllocationCount() == before)
+		{
+			LogError("unscoped allocation was not made on the heap");
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+#include "framework/configfile.h"
+#include "framework/logger.h"
+#include "library/sp.h"
+#include "library/spscqueue.h"
+#include <thread>
+
+using namespace OpenApoc;
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+
+	// Fills up and drains on a single thread
+	{
+		SpscQueue<int, 8> queue;
+		int value = 0;
+		for (int i = 0; i < 7; i++)
+		{
+			if (!queue.push(std::move(i)))
+			{
+				LogError("push %d failed on a queue that isn't full", i);
+				return EXIT_FAILURE;
+			}
+		}
+		int overflow = 7;
+		if (queue.push(std::move(overflow)))
+		{
+			LogError("push succeeded on a full queue");
+			return EXIT_FAILURE;
+		}
+		for (int i = 0; i < 7; i++)
+		{
+			if (!queue.pop(value) || value != i)
+			{
+				LogError("popped %d, expected %d", value, i);
+				return EXIT_FAILURE;
+			}
+		}
+		if (queue.pop(value) || !queue.empty())
+		{
+			LogError("pop succeeded on an empty queue");
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Popped values are released right away
+	{
+		SpscQueue<sp<int>, 4> queue;
+		auto shared = mksp<int>(1);
+		auto copy = shared;
+		queue.push(std::move(copy));
+		sp<int> popped;
+		queue.pop(popped);
+		popped.reset();
+		if (shared.use_count() != 1)
+		{
+			LogError("queue kept a popped value alive");
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Everything pushed on one thread arrives in order on another
+	{
+		static const int count = 1000000;
+		SpscQueue<int, 64> queue;
+		std::thread producer([&queue] {
+			for (int i = 0; i < count; i++)
+			{
+				int value = i;
+				while (!queue.push(std::move(value)))
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+		int expected = 0;
+		int value = 0;
+		bool ordered = true;
+		// Keep draining after a mismatch, so that the producer can finish
+		while (expected < count)
+		{
+			if (!queue.pop(value))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			if (value != expected && ordered)
+			{
+				LogError("popped %d, expected %d", value, expected);
+				ordered = false;
+			}
+			expected++;
+		}
+		producer.join();
+		if (!ordered)
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+#include "framework/configfile.h"
+#include "framework/logger.h"
+#include "library/timerwheel.h"
+#include "library/xorshift.h"
+#include <limits>
+#include <map>
+#include <vector>
+
+using namespace OpenApoc;
+
+namespace
+{
+class Timer
+{
+  public:
+	uint64_t tick;
+	int id;
+};
+
+// Checks that every timer expired exactly once, in order of tick and then scheduling order
+bool checkExpired(const std::vector<Timer> &scheduled, const std::vector<Timer> &expired)
+{
+	if (expired.size() != scheduled.size())
+	{
+		LogError("%u timers expired, expected %u", (unsigned)expired.size(),
+		         (unsigned)scheduled.size());
+		return false;
+	}
+	for (size_t i = 1; i < expired.size(); i++)
+	{
+		auto &a = expired[i - 1];
+		auto &b = expired[i];
+		if (a.tick > b.tick || (a.tick == b.tick && a.id > b.id))
+		{
+			LogError("timer %d (tick %u) expired after timer %d (tick %u)", b.id, (unsigned)b.tick,
+			         a.id, (unsigned)a.tick);
+			return false;
+		}
+	}
+	return true;
+}
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+
+	Xorshift128Plus<uint64_t> rng{};
+
+	// Random timers spanning every level of the wheel and the overflow, advanced in uneven steps
+	{
+		TimerWheel<Timer> wheel(12345);
+		std::vector<Timer> scheduled;
+		std::vector<Timer> expired;
+		uint64_t currentTick = 12345;
+		for (int i = 0; i < 10000; i++)
+		{
+			uint64_t range = (uint64_t)1 << randBoundsInclusive(rng, 0, 30);
+			Timer timer{currentTick + randBoundsExclusive<uint64_t>(rng, 0, range), i};
+			scheduled.push_back(timer);
+			wheel.schedule(timer.tick, timer);
+		}
+		std::vector<bool> isExpired(scheduled.size(), false);
+		bool early = false;
+		uint64_t lastTick = 0;
+		for (auto &timer : scheduled)
+		{
+			lastTick = std::max(lastTick, timer.tick);
+		}
+		while (!wheel.empty())
+		{
+			// The earliest timer not expired yet is the next one due
+			auto nextExpiry = std::numeric_limits<uint64_t>::max();
+			for (auto &timer : scheduled)
+			{
+				if (!isExpired[timer.id])
+				{
+					nextExpiry = std::min(nextExpiry, timer.tick);
+				}
+			}
+			if (wheel.getNextExpiry() != nextExpiry)
+			{
+				LogError("next expiry at %u, expected %u", (unsigned)wheel.getNextExpiry(),
+				         (unsigned)nextExpiry);
+				return EXIT_FAILURE;
+			}
+			currentTick += randBoundsInclusive<uint64_t>(rng, 1, 1 << 20);
+			wheel.advance(currentTick, [&](const Timer &timer) {
+				if (timer.tick > currentTick)
+				{
+					LogError("timer %d for tick %u expired at %u", timer.id, (unsigned)timer.tick,
+					         (unsigned)currentTick);
+					early = true;
+				}
+				expired.push_back(timer);
+				isExpired[timer.id] = true;
+			});
+		}
+		if (early || currentTick < lastTick || !checkExpired(scheduled, expired))
+		{
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Timers scheduled while expiring, including for the current tick, are handled in the same
+	// advance
+	{
+		TimerWheel<int> wheel;
+		int expiredCount = 0;
+		wheel.schedule(100, 0);
+		wheel.advance(1000000, [&](int generation) {
+			expiredCount++;
+			if (generation < 10)
+			{
+				wheel.schedule(wheel.getCurrentTick() + generation * 1000, generation + 1);
+			}
+		});
+		if (expiredCount != 11 || !wheel.empty())
+		{
+			LogError("%d rescheduled timers expired, expected 11", expiredCount);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Timers due on the same tick expire by priority first
+	{
+		TimerWheel<int> wheel;
+		std::vector<int> expired;
+		wheel.schedule(70000, 2, 2);
+		wheel.schedule(70000, 0, 0);
+		wheel.schedule(70000, 3, 2);
+		wheel.schedule(70000, 1, 1);
+		wheel.advance(70000, [&](int value) { expired.push_back(value); });
+		if (expired != std::vector<int>{0, 1, 2, 3})
+		{
+			LogError("timers on the same tick expired out of priority order");
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Timers scheduled in the past expire on the next advance
+	{
+		TimerWheel<int> wheel;
+		wheel.advance(5000, [](int) {});
+		wheel.schedule(10, 1);
+		int expiredCount = 0;
+		wheel.advance(5000, [&](int) { expiredCount++; });
+		if (expiredCount != 0)
+		{
+			LogError("advancing to a past tick expired a timer");
+			return EXIT_FAILURE;
+		}
+		wheel.advance(5001, [&](int) { expiredCount++; });
+		if (expiredCount != 1)
+		{
+			LogError("late timer did not expire");
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,422 @@
+#include "framework/configfile.h"
+#include "framework/filesystem.h"
+#include "framework/framework.h"
+#include "framework/logger.h"
+#include "framework/trace.h"
+#include "game/state/agent.h"
+#include "game/state/base/base.h"
+#include "game/state/battle/ai/tacticalaivanilla.h"
+#include "game/state/battle/battle.h"
+#include "game/state/battle/battlemap.h"
+#include "game/state/battle/battleunit.h"
+#include "game/state/battle/battleunitmission.h"
+#include "game/state/city/building.h"
+#include "game/state/city/city.h"
+#include "game/state/gamestate.h"
+#include "game/state/gametime.h"
+#include "game/state/organisation.h"
+#include "game/state/tileview/collision.h"
+#include "game/state/tileview/tile.h"
+#include "library/allocationcount.h"
+#include "library/xorshift.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+// windows.h must come first
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace OpenApoc;
+
+static ConfigOptionString difficulty("", "difficulty", "Difficulty gamestate to start from",
+                                     "difficulty1_patched");
+static ConfigOptionInt seed("", "seed", "Seed for the game's random number generator", 1);
+static ConfigOptionInt cityDays("", "cityDays", "Days of city time to run tick by tick", 1);
+static ConfigOptionInt turboDays("", "turboDays", "Days of city time to fast-forward through",
+                                 7);
+static ConfigOptionInt saveRoundTrips("", "saveRoundTrips",
+                                      "Number of times to save and load the game", 3);
+static ConfigOptionInt collisionRays("", "collisionRays",
+                                     "Number of random rays to cast across the city", 100000);
+static ConfigOptionInt battleAliens("", "battleAliens", "Number of aliens in the battle", 12);
+static ConfigOptionInt battleTicks("", "battleTicks",
+                                   "Ticks to run the battle for, with the AI playing both sides",
+                                   (int)TICKS_PER_MINUTE * 5);
+static ConfigOptionInt pathQueries("", "pathQueries",
+                                   "Number of paths to find between units in the battle", 1000);
+static ConfigOptionString output("", "output", "File to write the results to as json",
+                                 "bench.json");
+
+namespace
+{
+
+uint64_t getPeakRSSKiB()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage))
+	{
+		return 0;
+	}
+#ifdef __APPLE__
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+UString jsonEscape(const UString &str)
+{
+	std::stringstream ss;
+	for (auto c : str.str())
+	{
+		if (c == '"' || c == '\\')
+		{
+			ss << '\\';
+		}
+		ss << c;
+	}
+	return ss.str();
+}
+
+class ScenarioResult
+{
+  public:
+	UString name;
+	// Ticks for the simulation scenarios, queries for the others
+	uint64_t iterations = 0;
+	double seconds = 0.0;
+	uint64_t allocations = 0;
+	uint64_t peakRSSKiB = 0;
+	std::map<UString, TraceSummary> trace;
+};
+
+// Times 'scenario', which returns the number of ticks or queries it ran, along with everything
+// traced and allocated while it runs
+ScenarioResult runScenario(const UString &name, std::function<uint64_t()> scenario)
+{
+	LogInfo("Running scenario \"%s\"", name);
+	ScenarioResult result;
+	result.name = name;
+	auto traceBefore = Trace::getSummary();
+	auto allocationsBefore = getGlobalAllocationCount();
+	auto start = std::chrono::steady_clock::now();
+
+	result.iterations = scenario();
+
+	auto end = std::chrono::steady_clock::now();
+	result.seconds = std::chrono::duration<double>(end - start).count();
+	result.allocations = getGlobalAllocationCount() - allocationsBefore;
+	result.peakRSSKiB = getPeakRSSKiB();
+	result.trace = Trace::getSummary();
+	for (auto &entry : traceBefore)
+	{
+		result.trace[entry.first].calls -= entry.second.calls;
+		result.trace[entry.first].totalNS -= entry.second.totalNS;
+	}
+	for (auto it = result.trace.begin(); it != result.trace.end();)
+	{
+		if (it->second.calls == 0)
+		{
+			it = result.trace.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+
+	std::cout << format("%-16s %10u in %8.3fs (%12.1f/s) %12u allocations, peak RSS %u KiB\n",
+	                    name, (unsigned)result.iterations, result.seconds,
+	                    result.seconds > 0 ? result.iterations / result.seconds : 0.0,
+	                    (unsigned)result.allocations, (unsigned)result.peakRSSKiB)
+	                 .str();
+	return result;
+}
+
+bool writeResults(const UString &path, const std::vector<ScenarioResult> &results)
+{
+	std::ofstream out(path.str());
+	if (!out)
+	{
+		LogError("Failed to open \"%s\"", path);
+		return false;
+	}
+	out << "{\n\"difficulty\":\"" << jsonEscape(difficulty.get()) << "\",\n";
+	out << "\"seed\":" << seed.get() << ",\n";
+	out << "\"scenarios\":[\n";
+	bool firstResult = true;
+	for (auto &result : results)
+	{
+		if (!firstResult)
+			out << ",\n";
+		firstResult = false;
+		out << "{\"name\":\"" << jsonEscape(result.name) << "\","
+		    << "\"iterations\":" << result.iterations << ","
+		    << "\"seconds\":" << result.seconds << ","
+		    << "\"per_second\":" << (result.seconds > 0 ? result.iterations / result.seconds : 0.0)
+		    << ","
+		    << "\"allocations\":" << result.allocations << ","
+		    << "\"peak_rss_kib\":" << result.peakRSSKiB << ","
+		    << "\"trace\":{";
+		bool firstTrace = true;
+		for (auto &entry : result.trace)
+		{
+			if (!firstTrace)
+				out << ",";
+			firstTrace = false;
+			out << "\n\t\"" << jsonEscape(entry.first) << "\":{\"calls\":" << entry.second.calls
+			    << ",\"ns\":" << entry.second.totalNS << "}";
+		}
+		out << "}}";
+	}
+	out << "\n]}\n";
+	return true;
+}
+
+bool loadDifficulty(GameState &state)
+{
+	if (!state.loadGame(fw().getDataDir() + "/gamestate_common"))
+	{
+		LogError("Failed to load common gamestate");
+		return false;
+	}
+	if (!state.loadGame(fw().getDataDir() + "/" + difficulty.get()))
+	{
+		LogError("Failed to load \"%s\"", difficulty.get());
+		return false;
+	}
+	state.startGame();
+	state.initState();
+	state.fillPlayerStartingProperty();
+	state.rng = Xorshift128Plus<uint32_t>(seed.get());
+	return true;
+}
+
+uint64_t runSaveRoundTrips(sp<GameState> state)
+{
+	std::stringstream ss;
+	ss << "openapoc_bench-" << std::this_thread::get_id();
+	auto tempPath = fs::temp_directory_path() / ss.str();
+	UString pathString(tempPath.string());
+	uint64_t roundTrips = 0;
+	for (int i = 0; i < saveRoundTrips.get(); i++)
+	{
+		if (!state->saveGame(pathString))
+		{
+			LogError("Failed to save to \"%s\"", pathString);
+			break;
+		}
+		auto loadedState = mksp<GameState>();
+		if (!loadedState->loadGame(pathString))
+		{
+			LogError("Failed to load \"%s\"", pathString);
+			break;
+		}
+		roundTrips++;
+	}
+	fs::remove(tempPath);
+	return roundTrips;
+}
+
+uint64_t runCity(sp<GameState> state)
+{
+	uint64_t ticks = (uint64_t)cityDays.get() * TICKS_PER_DAY;
+	for (uint64_t i = 0; i < ticks; i++)
+	{
+		state->update();
+	}
+	return ticks;
+}
+
+uint64_t runTurbo(sp<GameState> state)
+{
+	uint64_t ticks = (uint64_t)turboDays.get() * TICKS_PER_DAY;
+	uint64_t ticksDone = 0;
+	while (ticksDone < ticks)
+	{
+		auto ticksLeft = (unsigned int)std::min<uint64_t>(ticks - ticksDone, TICKS_PER_HOUR);
+		unsigned int ticksAdvanced = 0;
+		if (state->canTurbo())
+		{
+			ticksAdvanced = state->fastForward(ticksLeft);
+		}
+		// Whatever stops fast-forwarding is played through at normal speed
+		if (ticksAdvanced == 0)
+		{
+			state->update();
+			ticksAdvanced = 1;
+		}
+		ticksDone += ticksAdvanced;
+	}
+	return ticksDone;
+}
+
+uint64_t runCollisions(sp<GameState> state)
+{
+	auto &map = *state->current_city->map;
+	Xorshift128Plus<uint32_t> rng(seed.get());
+	auto randomPoint = [&]() {
+		return Vec3<float>{randBoundsExclusive(rng, 0, map.size.x) + 0.5f,
+		                   randBoundsExclusive(rng, 0, map.size.y) + 0.5f,
+		                   randBoundsExclusive(rng, 0, map.size.z) + 0.5f};
+	};
+	uint64_t rays = collisionRays.get();
+	for (uint64_t i = 0; i < rays; i++)
+	{
+		auto start = randomPoint();
+		auto end = randomPoint();
+		map.findCollision(start, end);
+	}
+	return rays;
+}
+
+// Sets up a battle between the player's soldiers and aliens in the first building that has a
+// battle map, with the tactical AI playing the player's side as well
+bool beginBattle(sp<GameState> state)
+{
+	StateRef<Building> building;
+	for (auto &b : state->current_city->buildings)
+	{
+		if (b.second->battle_map && b.second->owner != state->getPlayer())
+		{
+			building = {state.get(), b.first};
+			break;
+		}
+	}
+	if (!building)
+	{
+		LogError("No building to fight in");
+		return false;
+	}
+	std::list<StateRef<Agent>> agents;
+	for (auto &a : state->agents)
+	{
+		if (a.second->type->role == AgentType::Role::Soldier &&
+		    a.second->home_base == state->current_base)
+		{
+			agents.emplace_back(state.get(), a.second);
+		}
+	}
+	std::map<StateRef<AgentType>, int> aliens;
+	aliens[{state.get(), "AGENTTYPE_ANTHROPOD"}] = battleAliens.get();
+	int guards = 0;
+	int civilians = 0;
+	Battle::beginBattle(*state, false, state->getAliens(), agents, &aliens, &guards, &civilians,
+	                    {}, building);
+	if (!state->current_battle)
+	{
+		LogError("Failed to begin battle in \"%s\"", building.id);
+		return false;
+	}
+	Battle::enterBattle(*state);
+	auto &aiList = state->current_battle->aiBlock.aiList;
+	aiList[state->getPlayer()] = mksp<TacticalAIVanilla>();
+	aiList[state->getPlayer()]->reset(*state, state->getPlayer());
+	return true;
+}
+
+uint64_t runPathfinding(sp<GameState> state)
+{
+	auto &battle = *state->current_battle;
+	std::vector<sp<BattleUnit>> units;
+	for (auto &u : battle.units)
+	{
+		if (u.second->isConscious())
+		{
+			units.push_back(u.second);
+		}
+	}
+	if (units.size() < 2)
+	{
+		LogError("Not enough units to find paths between");
+		return 0;
+	}
+	Xorshift128Plus<uint32_t> rng(seed.get());
+	uint64_t queries = pathQueries.get();
+	for (uint64_t i = 0; i < queries; i++)
+	{
+		auto &from = units[randBoundsExclusive<size_t>(rng, 0, units.size())];
+		auto &to = units[randBoundsExclusive<size_t>(rng, 0, units.size())];
+		BattleUnitTileHelper helper(*battle.map, *from);
+		battle.findShortestPath(Vec3<int>{from->position}, Vec3<int>{to->position}, helper);
+	}
+	return queries;
+}
+
+uint64_t runBattle(sp<GameState> state)
+{
+	uint64_t ticks = battleTicks.get();
+	for (uint64_t i = 0; i < ticks; i++)
+	{
+		state->update();
+	}
+	return ticks;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+
+	Framework fw("OpenApoc", false);
+	Trace::enableSummary();
+
+	std::vector<ScenarioResult> results;
+	auto state = mksp<GameState>();
+	bool loaded = false;
+	results.push_back(runScenario("load", [&]() -> uint64_t {
+		loaded = loadDifficulty(*state);
+		return 1;
+	}));
+	if (!loaded)
+	{
+		return EXIT_FAILURE;
+	}
+
+	results.push_back(runScenario("save_load", [&]() { return runSaveRoundTrips(state); }));
+	results.push_back(runScenario("city", [&]() { return runCity(state); }));
+	results.push_back(runScenario("turbo", [&]() { return runTurbo(state); }));
+	results.push_back(runScenario("collision", [&]() { return runCollisions(state); }));
+
+	bool battleBegun = false;
+	results.push_back(runScenario("battle_setup", [&]() -> uint64_t {
+		battleBegun = beginBattle(state);
+		return 1;
+	}));
+	if (battleBegun)
+	{
+		results.push_back(runScenario("pathfinding", [&]() { return runPathfinding(state); }));
+		results.push_back(runScenario("battle", [&]() { return runBattle(state); }));
+	}
+
+	if (!writeResults(output.get(), results))
+	{
+		return EXIT_FAILURE;
+	}
+	Trace::disable();
+	return battleBegun ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,197 @@
+#include "framework/configfile.h"
+#include "framework/filesystem.h"
+#include "framework/framework.h"
+#include "framework/logger.h"
+#include "game/state/gamestate.h"
+#include "game/state/gametime.h"
+#include "game/state/statehash.h"
+#include "game/state/staterecording.h"
+#include "library/xorshift.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace OpenApoc;
+
+static ConfigOptionString recordingPath("", "recording", "Recording to write or replay",
+                                        "replay.rec");
+static ConfigOptionBool record("", "record",
+                               "Record a new game instead of replaying the recording", false);
+static ConfigOptionString difficulty("", "difficulty", "Difficulty gamestate to record from",
+                                     "difficulty1_patched");
+static ConfigOptionInt seed("", "seed", "Seed for the game's random number generator", 1);
+static ConfigOptionInt cityDays("", "cityDays", "Days of city time to record tick by tick", 1);
+static ConfigOptionInt turboDays("", "turboDays", "Days of city time to record fast-forwarding",
+                                 7);
+
+namespace
+{
+
+UString formatHash(uint64_t hash)
+{
+	std::stringstream ss;
+	ss << std::hex << hash;
+	return ss.str();
+}
+
+// Starts a new game and saves and loads it again, so that the recording starts from a state that
+// went through the same loading as the one replaying it
+sp<GameState> newGame()
+{
+	auto state = mksp<GameState>();
+	if (!state->loadGame(fw().getDataDir() + "/gamestate_common"))
+	{
+		LogError("Failed to load common gamestate");
+		return nullptr;
+	}
+	if (!state->loadGame(fw().getDataDir() + "/" + difficulty.get()))
+	{
+		LogError("Failed to load \"%s\"", difficulty.get());
+		return nullptr;
+	}
+	state->startGame();
+	state->initState();
+	state->fillPlayerStartingProperty();
+	state->rng = Xorshift128Plus<uint32_t>(seed.get());
+
+	std::stringstream ss;
+	ss << "openapoc_replay-" << std::this_thread::get_id();
+	auto tempPath = fs::temp_directory_path() / ss.str();
+	UString pathString(tempPath.string());
+	if (!state->saveGame(pathString))
+	{
+		LogError("Failed to save to \"%s\"", pathString);
+		return nullptr;
+	}
+	auto loadedState = mksp<GameState>();
+	bool loaded = loadedState->loadGame(pathString);
+	fs::remove(tempPath);
+	if (!loaded)
+	{
+		LogError("Failed to load \"%s\"", pathString);
+		return nullptr;
+	}
+	loadedState->initState();
+	return loadedState;
+}
+
+int recordGame()
+{
+	auto state = newGame();
+	if (!state)
+	{
+		return EXIT_FAILURE;
+	}
+	state->recorder = StateRecorder::start(*state, recordingPath.get());
+	if (!state->recorder)
+	{
+		return EXIT_FAILURE;
+	}
+	uint64_t ticks = (uint64_t)cityDays.get() * TICKS_PER_DAY;
+	for (uint64_t i = 0; i < ticks; i++)
+	{
+		state->update();
+	}
+	ticks = (uint64_t)turboDays.get() * TICKS_PER_DAY;
+	uint64_t ticksDone = 0;
+	while (ticksDone < ticks)
+	{
+		auto ticksLeft = (unsigned int)std::min<uint64_t>(ticks - ticksDone, TICKS_PER_HOUR);
+		unsigned int ticksAdvanced = 0;
+		if (state->canTurbo())
+		{
+			ticksAdvanced = state->fastForward(ticksLeft);
+		}
+		// Whatever stops fast-forwarding is played through at normal speed
+		if (ticksAdvanced == 0)
+		{
+			state->update();
+			ticksAdvanced = 1;
+		}
+		ticksDone += ticksAdvanced;
+	}
+	state->recorder.reset();
+	LogInfo("Recorded to \"%s\"", recordingPath.get());
+	return EXIT_SUCCESS;
+}
+
+int replayGame()
+{
+	StateRecording recording;
+	if (!recording.load(recordingPath.get()))
+	{
+		return EXIT_FAILURE;
+	}
+	auto state = mksp<GameState>();
+	if (!state->loadGame(recording.savePath))
+	{
+		LogError("Failed to load \"%s\"", recording.savePath);
+		return EXIT_FAILURE;
+	}
+	state->initState();
+	state->rng.setState(recording.rngState);
+
+	auto hash = hashGameState(*state);
+	if (hash != recording.initialHash)
+	{
+		std::cout << format("Loaded state differs from the one recorded: hash %s, expected %s\n",
+		                    formatHash(hash), formatHash(recording.initialHash))
+		                 .str();
+		return EXIT_FAILURE;
+	}
+	for (size_t i = 0; i < recording.steps.size(); i++)
+	{
+		auto &step = recording.steps[i];
+		if (state->gameTime.getTicks() != step.ticks)
+		{
+			std::cout << format("Step %u starts at tick %u, expected %u\n", (unsigned)i,
+			                    (unsigned)state->gameTime.getTicks(), (unsigned)step.ticks)
+			                 .str();
+			return EXIT_FAILURE;
+		}
+		if (step.fastForward)
+		{
+			auto ticksAdvanced = state->fastForward(step.ticksRequested);
+			if (ticksAdvanced != step.ticksAdvanced)
+			{
+				std::cout << format("Fast-forwarding from tick %u advanced %u ticks, expected %u\n",
+				                    (unsigned)step.ticks, ticksAdvanced, step.ticksAdvanced)
+				                 .str();
+				return EXIT_FAILURE;
+			}
+		}
+		else
+		{
+			state->update();
+		}
+		hash = hashGameState(*state);
+		if (hash != step.hash)
+		{
+			std::cout << format("First difference after the step from tick %u: hash %s, "
+			                    "expected %s\n",
+			                    (unsigned)step.ticks, formatHash(hash), formatHash(step.hash))
+			                 .str();
+			return EXIT_FAILURE;
+		}
+	}
+	std::cout << format("Replayed %u steps to tick %u, all hashes match\n",
+	                    (unsigned)recording.steps.size(), (unsigned)state->gameTime.getTicks())
+	                 .str();
+	return EXIT_SUCCESS;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+	if (config().parseOptions(argc, argv))
+	{
+		return EXIT_FAILURE;
+	}
+
+	Framework fw("OpenApoc", false);
+
+	return record.get() ? recordGame() : replayGame();
+}